@@ -48,6 +48,38 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <math.h>
+
+// 平台相关（线程）
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <unistd.h>
+#include <sched.h>
+#define w_THREAD_ENABLED_ 1
+#else
+#define w_THREAD_ENABLED_ 0
+#endif
+
+// 平台相关（Linux 系统调用 futex/mbind，严格 C 标准模式下 syscall 不可用）
+#if defined(__linux__) && (!defined(__STRICT_ANSI__) || defined(_GNU_SOURCE) || defined(_DEFAULT_SOURCE))
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#define w_LINUX_SYSCALL_ENABLED_ 1
+#else
+#define w_LINUX_SYSCALL_ENABLED_ 0
+#endif
+
+// 平台相关（内存映射）
+#if w_THREAD_ENABLED_
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+#if defined(MAP_ANONYMOUS)
+#define w_MMAP_ENABLED_ 1
+#else
+#define w_MMAP_ENABLED_ 0
+#endif
 
 // 统一内存的申请和释放
 #define w_malloc(size) malloc(size)
@@ -74,1710 +106,12941 @@
         }                                                                         \
     })
 
-// ========================================================================================================================================================
-//  哈希和比较操作
-// ========================================================================================================================================================
+// 检查级别（可在引入头文件前定义）
+// 0：不检查，检查条件作为编译器的优化假设（条件不成立时行为未定义）
+// 1：只检查索引越界
+// 2：全部检查（默认）
+// 内存申请失败等运行时错误不受检查级别影响，始终使用 w_assert 检查
+#ifndef w_CHECK_LEVEL
+#define w_CHECK_LEVEL 2
+#endif
 
-// 哈希函数
-// 函数原型：int64_t w_hash(T)(T* this);
-#define w_hash(T) w_concat(w_hash_, T)
+/**
+ * 假设条件成立，编译器可以据此优化（条件不成立时行为未定义）
+ * @param expr 假设条件
+ */
+#define w_assume_(expr)              \
+    ({                               \
+        if (!(expr))                 \
+        {                            \
+            __builtin_unreachable(); \
+        }                            \
+    })
 
-// 比较函数
-// 函数原型：int64_t w_compare(T)(T* this, T* other);
-#define w_compare(T) w_concat(w_compare_, T)
+/**
+ * 参数和状态检查（检查级别为 2 时使用 w_assert，否则作为假设）
+ * @param expr 检查条件
+ */
+#if w_CHECK_LEVEL >= 2
+#define w_check(expr) w_assert(expr)
+#else
+#define w_check(expr) w_assume_(expr)
+#endif
 
-// 判断是否相等
-// 函数原型：bool w_equals(T)(T* this, T* other);
-#define w_equals(T) w_concat(w_equals_, T)
+/**
+ * 索引越界检查（检查级别不小于 1 时使用 w_assert，否则作为假设）
+ * @param expr 检查条件
+ */
+#if w_CHECK_LEVEL >= 1
+#define w_checkIndex(expr) w_assert(expr)
+#else
+#define w_checkIndex(expr) w_assume_(expr)
+#endif
 
 // ========================================================================================================================================================
-//  数组
+//  并行
 // ========================================================================================================================================================
 
-// 数组类型
-#define w_Array(T) w_concat(w_Array_, T)
+// 并行任务
+// 函数原型：void task(void *context, int64_t begin, int64_t end);
+typedef void (*w_ParallelTask_)(void *context, int64_t begin, int64_t end);
 
-// 数组类型定义
-#define w_Array_type_define_(T)        \
-    typedef struct                     \
-    {                                  \
-        T *elementData; /* 元素数据 */ \
-        int size;       /* 元素数量 */ \
-    } w_Array(T);
+// 并行任务参数
+typedef struct
+{
+    w_ParallelTask_ task; /* 任务 */
+    void *context;        /* 上下文 */
+    int64_t begin;        /* 起始索引 */
+    int64_t end;          /* 结束索引（不包含） */
+} w_ParallelTaskArgs_;
 
-// 数组初始化
-#define w_Array_init(T) w_concat(w_Array(T), _init)
-#define w_Array_init_define_(T)                                         \
-    /**                                                                 \
-     * 数组初始化                                                  \
-     * @param this 数组                                               \
-     * @param size 数组大小                                         \
-     * @return void                                                     \
-     */                                                                 \
-    static inline void w_Array_init(T)(w_Array(T) * this, int64_t size) \
-    {                                                                   \
-        w_assert(this != NULL);                                         \
-        w_assert(size >= 0);                                            \
-        this->elementData = w_malloc(sizeof(T) * size);                 \
-        w_assert(this->elementData != NULL);                            \
-        this->size = size;                                              \
-    }
+/**
+ * 获取默认线程数（在线 CPU 核心数）
+ * @return int 线程数
+ */
+static inline int w_defaultThreadCount(void)
+{
+#if w_THREAD_ENABLED_
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#else
+    return 1;
+#endif
+}
 
-// 数组反初始化
-#define w_Array_deinit(T) w_concat(w_Array(T), _deinit)
-#define w_Array_deinit_define_(T)                           \
-    /**                                                     \
-     * 数组反初始化                                   \
-     * @param this 数组                                   \
-     * @return void                                         \
-     */                                                     \
-    static inline void w_Array_deinit(T)(w_Array(T) * this) \
-    {                                                       \
-        w_assert(this != NULL);                             \
-        w_assert(this->elementData != NULL);                \
-        w_free(this->elementData);                          \
-        memset(this, 0, sizeof(w_Array(T)));                \
+/**
+ * 并行任务线程入口
+ * @param args 任务参数
+ * @return void * NULL
+ */
+static inline void *w_parallelWorker_(void *args)
+{
+    w_ParallelTaskArgs_ *taskArgs = args;
+    taskArgs->task(taskArgs->context, taskArgs->begin, taskArgs->end);
+    return NULL;
+}
+
+/**
+ * 并行执行任务，将 [0, size) 均分为 threadCount 段，每段由一个线程执行（调用线程执行最后一段）
+ * @param size 任务区间大小
+ * @param threadCount 线程数（<= 0 时使用默认线程数）
+ * @param task 任务
+ * @param context 任务上下文
+ * @return void
+ */
+static inline void w_parallelFor_(int64_t size, int threadCount, w_ParallelTask_ task, void *context)
+{
+    w_check(size >= 0);
+    w_check(task != NULL);
+    if (threadCount <= 0)
+    {
+        threadCount = w_defaultThreadCount();
+    }
+    if (threadCount > size)
+    {
+        threadCount = (int)size;
+    }
+    if (threadCount <= 1)
+    {
+        task(context, 0, size);
+        return;
     }
 
-// 获取数组元素
-#define w_Array_get(T) w_concat(w_Array(T), _get)
-#define w_Array_get_define_(T)                                       \
-    /**                                                              \
-     * 获取数组元素                                            \
-     * @param this 数组                                            \
-     * @param index 索引                                           \
-     * @return T 数组元素                                        \
-     */                                                              \
-    static inline T w_Array_get(T)(w_Array(T) * this, int64_t index) \
-    {                                                                \
-        w_assert(this != NULL);                                      \
-        w_assert(this->elementData != NULL);                         \
-        w_assert(index >= 0 && index < this->size);                  \
-        return this->elementData[index];                             \
+#if w_THREAD_ENABLED_
+    /* 划分任务 */
+    w_ParallelTaskArgs_ *args = w_malloc(sizeof(w_ParallelTaskArgs_) * threadCount);
+    w_assert(args != NULL);
+    pthread_t *threads = w_malloc(sizeof(pthread_t) * threadCount);
+    w_assert(threads != NULL);
+    for (int i = 0; i < threadCount; i++)
+    {
+        args[i] = (w_ParallelTaskArgs_){task, context, size * i / threadCount, size * (i + 1) / threadCount};
     }
 
-// 设置数组元素
-#define w_Array_set(T) w_concat(w_Array(T), _set)
-#define w_Array_set_define_(T)                                                 \
-    /**                                                                        \
-     * 设置数组元素                                                      \
-     * @param this 数组                                                      \
-     * @param index 索引                                                     \
-     * @param val 值                                                          \
-     * @return void                                                            \
-     */                                                                        \
-    static inline void w_Array_set(T)(w_Array(T) * this, int64_t index, T val) \
-    {                                                                          \
-        w_assert(this != NULL);                                                \
-        w_assert(this->elementData != NULL);                                   \
-        w_assert(index >= 0 && index < this->size);                            \
-        this->elementData[index] = val;                                        \
+    /* 启动线程，创建失败时由调用线程执行 */
+    bool *started = w_malloc(sizeof(bool) * threadCount);
+    w_assert(started != NULL);
+    for (int i = 0; i < threadCount - 1; i++)
+    {
+        started[i] = pthread_create(&threads[i], NULL, w_parallelWorker_, &args[i]) == 0;
+        if (!started[i])
+        {
+            w_parallelWorker_(&args[i]);
+        }
     }
+    w_parallelWorker_(&args[threadCount - 1]);
 
-// 数组大小
-#define w_Array_size(T) w_concat(w_Array(T), _size)
-#define w_Array_size_define_(T)                              \
-    /**                                                      \
-     * 获取数组大小                                    \
-     * @param this 数组                                    \
-     * @return int64_t 数组大小                          \
-     */                                                      \
-    static inline int64_t w_Array_size(T)(w_Array(T) * this) \
-    {                                                        \
-        w_assert(this != NULL);                              \
-        return this->size;                                   \
+    /* 等待 */
+    for (int i = 0; i < threadCount - 1; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
     }
+    w_free(started);
+    w_free(threads);
+    w_free(args);
+#else
+    task(context, 0, size);
+#endif
+}
 
-// 数组定义
-#define w_Array_define(T)      \
-    w_Array_type_define_(T);   \
-    w_Array_init_define_(T);   \
-    w_Array_deinit_define_(T); \
-    w_Array_get_define_(T);    \
-    w_Array_set_define_(T);    \
-    w_Array_size_define_(T)
+// 并行内存拷贝上下文
+typedef struct
+{
+    char *dst;       /* 目标 */
+    const char *src; /* 源 */
+} w_ParallelCopyContext_;
+
+/**
+ * 并行内存拷贝任务
+ * @param context 上下文
+ * @param begin 起始字节
+ * @param end 结束字节
+ * @return void
+ */
+static inline void w_parallelCopyTask_(void *context, int64_t begin, int64_t end)
+{
+    w_ParallelCopyContext_ *copyContext = context;
+    memcpy(copyContext->dst + begin, copyContext->src + begin, end - begin);
+}
+
+/**
+ * 并行内存拷贝
+ * @param dst 目标
+ * @param src 源
+ * @param bytes 字节数
+ * @param threadCount 线程数（<= 0 时使用默认线程数）
+ * @return void
+ */
+static inline void w_parallelCopy_(void *dst, const void *src, int64_t bytes, int threadCount)
+{
+    w_ParallelCopyContext_ context = {dst, src};
+    /* 小块内存不值得启动线程 */
+    if (bytes < (1 << 20))
+    {
+        threadCount = 1;
+    }
+    w_parallelFor_(bytes, threadCount, w_parallelCopyTask_, &context);
+}
 
 // ========================================================================================================================================================
-//  多维数组
+//  内存分配策略
 // ========================================================================================================================================================
 
-// 多维数组类型
-#define w_NDArray(T) w_concat(w_NDArray_, T)
+// 内存分配标志：透明大页（madvise(MADV_HUGEPAGE)）
+#define w_ALLOC_HUGE_PAGES 1
 
-// 多维数组类型定义
-#define w_NDArray_type_define_(T)      \
-    typedef struct                     \
-    {                                  \
-        T *elementData; /* 元素数据 */ \
-        int64_t *shape; /* 形状*/      \
-        int64_t shapeSize;             \
-    } w_NDArray(T);
+// 内存分配标志：预留大页（MAP_HUGETLB，没有可用的预留大页时退化为透明大页）
+#define w_ALLOC_HUGETLB 2
 
-// 多维数组初始化
-#define w_NDArray_init(T) w_concat(w_NDArray(T), _init)
-#define w_NDArray_init_define_(T)                                                     \
-    /**                                                                               \
-     * 多维数组初始化                                                          \
-     * @param this 多维数组                                                       \
-     * @param shapeSize 形状大小                                                  \
-     * @param ... 形状（必须传入 int64 类型，否则会报错）             \
-     * @return void                                                                   \
-     */                                                                               \
-    static inline void w_NDArray_init(T)(w_NDArray(T) * this, int64_t shapeSize, ...) \
-    {                                                                                 \
-        /* 处理可变参数 */                                                            \
-        va_list shape;                                                                \
-        va_start(shape, shapeSize);                                                   \
-        w_assert(shapeSize > 0);                                                      \
-        w_assert(this != NULL);                                                       \
-                                                                                      \
-        /* 创建形状 */                                                                \
-        this->shape = w_malloc(sizeof(int64_t) * shapeSize);                          \
-        w_assert(this->shape != NULL);                                                \
-        w_assert(shapeSize > 0);                                                      \
-        int64_t elementSize = 1;                                                      \
-        for (int64_t i = 0; i < shapeSize; i++)                                       \
-        {                                                                             \
-            this->shape[i] = va_arg(shape, int64_t);                                  \
-            elementSize *= this->shape[i];                                            \
-        }                                                                             \
-                                                                                      \
-        /* 创建元素数据 */                                                            \
-        this->elementData = w_malloc(sizeof(T) * elementSize);                        \
-        w_assert(this->elementData != NULL);                                          \
-        this->shapeSize = shapeSize;                                                  \
-                                                                                      \
-        /* 清理可变参数 */                                                            \
-        va_end(shape);                                                                \
-    }
+// 内存分配标志：在所有 NUMA 节点间交错分配
+#define w_ALLOC_NUMA_INTERLEAVE 4
 
-// 多维数组销毁
-#define w_NDArray_deinit(T) w_concat(w_NDArray(T), _deinit)
-#define w_NDArray_deinit_define_(T)                             \
-    /**                                                         \
-     * 多维数组销毁                                       \
-     * @param this 多维数组                                 \
-     * @return void                                             \
-     */                                                         \
-    static inline void w_NDArray_deinit(T)(w_NDArray(T) * this) \
-    {                                                           \
-        w_assert(this != NULL);                                 \
-        w_assert(this->elementData != NULL);                    \
-        w_assert(this->shape != NULL);                          \
-        w_free(this->elementData);                              \
-        w_free(this->shape);                                    \
-        memset(this, 0, sizeof(w_NDArray(T)));                  \
-    }
+// 大页大小
+#define w_HUGE_PAGE_SIZE_ ((int64_t)2 * 1024 * 1024)
 
-// 多维数组下标映射
-#define w_NDArray_map_(T) w_concat(w_NDArray(T), _map_)
-#define w_NDArray_map_define_(T)                                                  \
-    /**                                                                           \
-     * 多维数组下标映射                                                   \
-     * @param this 多维数组                                                   \
-     * @param indices 索引（必须传入 int64 类型，否则会报错）     \
-     * @return int64_t 索引                                                     \
-     */                                                                           \
-    static inline int64_t w_NDArray_map_(T)(w_NDArray(T) * this, va_list indices) \
-    {                                                                             \
-        w_assert(this != NULL);                                                   \
-        w_assert(this->shape != NULL);                                            \
-        w_assert(this->shapeSize > 0);                                            \
-        w_assert(this->elementData != NULL);                                      \
-                                                                                  \
-        /* 计算索引 */                                                            \
-        int64_t index = 0;                                                        \
-        for (int64_t i = 0; i < this->shapeSize - 1; i++)                         \
-        {                                                                         \
-            int64_t index_ = va_arg(indices, int64_t);                            \
-            w_assert(index_ >= 0 && index_ < this->shape[i]);                     \
-            /*  计算索引 (i1 - i(n-1)) */                                         \
-            index += index_;                                                      \
-            index *= this->shape[i + 1];                                          \
-        }                                                                         \
-        /* i(n) */                                                                \
-        int64_t index_ = va_arg(indices, int64_t);                                \
-        w_assert(index_ >= 0 && index_ < this->shape[this->shapeSize - 1]);       \
-        index += index_;                                                          \
-                                                                                  \
-        /* 返回索引 */                                                            \
-        return index;                                                             \
-    }
+// 支持的最大 NUMA 节点数量
+#define w_NUMA_MAX_NODES_ 64
 
-// 多维数组获取元素
-#define w_NDArray_get(T) w_concat(w_NDArray(T), _get)
-#define w_NDArray_get_define_(T)                                          \
-    /**                                                                   \
-     * 多维数组获取元素                                           \
-     * @param this 多维数组                                           \
-     * @param ... 索引（必须传入 int64 类型，否则会报错） \
-     * @return T 元素                                                   \
-     */                                                                   \
-    static inline T w_NDArray_get(T)(w_NDArray(T) * this, ...)            \
-    { /* 返回 */                                                          \
-        va_list indices;                                                  \
-        va_start(indices, this);                                          \
-        int64_t index = w_NDArray_map_(T)(this, indices);                 \
-        va_end(indices);                                                  \
-        return this->elementData[index];                                  \
-    }
+// 内存分配策略
+typedef struct
+{
+    int64_t alignment; /* 对齐字节数（2 的幂），0 表示使用 w_malloc 的默认对齐 */
+    int32_t flags;     /* w_ALLOC_* 标志的组合 */
+    int32_t numaNode;  /* 绑定的 NUMA 节点，-1 表示不绑定 */
+    int32_t mappedMode_; /* 文件映射模式 w_MAPPED_*（内部使用），0 表示不是文件映射 */
+    int32_t mappedFd_;   /* 共享文件映射的文件描述符（内部使用） */
+} w_AllocPolicy;
 
-// 多维数组设置元素
-#define w_NDArray_set(T) w_concat(w_NDArray(T), _set)
-#define w_NDArray_set_define_(T)                                           \
-    /**                                                                    \
-     * 多维数组设置元素                                            \
-     * @param this 多维数组                                            \
-     * @param value 值                                                    \
-     * @param ... 索引（必须传入 int64 类型，否则会报错）  \
-     * @return void                                                        \
-     */                                                                    \
-    static inline void w_NDArray_set(T)(w_NDArray(T) * this, T value, ...) \
-    { /* 设置 */                                                           \
-        va_list indices;                                                   \
-        va_start(indices, value);                                          \
-        int64_t index = w_NDArray_map_(T)(this, indices);                  \
-        va_end(indices);                                                   \
-        this->elementData[index] = value;                                  \
-    }
+// 按策略申请的内存块头部（位于返回的指针之前）
+typedef struct
+{
+    void *base;         /* 实际申请的内存地址 */
+    int64_t mappedSize; /* 映射的字节数，0 表示由 w_malloc 申请 */
+} w_AllocHeader_;
 
-// 多维数组获取形状
-#define w_NDArray_shape(T) w_concat(w_NDArray(T), _shape)
-#define w_NDArray_shape_define_(T)                                 \
-    /**                                                            \
-     * 多维数组获取形状                                    \
-     * @param this 多维数组                                    \
-     * @return int64_t * 形状                                    \
-     */                                                            \
-    static inline int64_t *w_NDArray_shape(T)(w_NDArray(T) * this) \
-    {                                                              \
-        w_assert(this != NULL);                                    \
-        w_assert(this->shape != NULL);                             \
-        w_assert(this->shapeSize > 0);                             \
-        w_assert(this->elementData != NULL);                       \
-        return this->shape;                                        \
-    }
+/**
+ * 默认内存分配策略（直接使用 w_malloc 和 w_free）
+ * @return w_AllocPolicy 内存分配策略
+ */
+static inline w_AllocPolicy w_AllocPolicy_default(void)
+{
+    w_AllocPolicy policy = {0, 0, -1, 0, -1};
+    return policy;
+}
 
-// 多维数组获取形状大小
-#define w_NDArray_shapeSize(T) w_concat(w_NDArray(T), _shapeSize)
-#define w_NDArray_shapeSize_define_(T)                                \
-    /**                                                               \
-     * 多维数组获取形状大小                                 \
-     * @param this 多维数组                                       \
-     * @return int64_t 形状大小                                   \
-     */                                                               \
-    static inline int64_t w_NDArray_shapeSize(T)(w_NDArray(T) * this) \
-    {                                                                 \
-        w_assert(this != NULL);                                       \
-        w_assert(this->shape != NULL);                                \
-        w_assert(this->shapeSize > 0);                                \
-        w_assert(this->elementData != NULL);                          \
-        return this->shapeSize;                                       \
-    }
+/**
+ * 对齐的内存分配策略
+ * @param alignment 对齐字节数（2 的幂，如 64 对应缓存行和 AVX-512 向量）
+ * @return w_AllocPolicy 内存分配策略
+ */
+static inline w_AllocPolicy w_AllocPolicy_aligned(int64_t alignment)
+{
+    w_AllocPolicy policy = {alignment, 0, -1, 0, -1};
+    return policy;
+}
 
-// 多维数组定义
-#define w_NDArray_define(T)      \
-    w_NDArray_type_define_(T);   \
-    w_NDArray_init_define_(T);   \
-    w_NDArray_deinit_define_(T); \
-    w_NDArray_map_define_(T);    \
-    w_NDArray_get_define_(T);    \
-    w_NDArray_set_define_(T);    \
-    w_NDArray_shape_define_(T);  \
-    w_NDArray_shapeSize_define_(T);
+/**
+ * 是否为默认内存分配策略
+ * @param policy 内存分配策略
+ * @return bool true:默认策略 false:非默认策略
+ */
+static inline bool w_AllocPolicy_isDefault_(const w_AllocPolicy *policy)
+{
+    return policy->alignment == 0 && policy->flags == 0 && policy->numaNode < 0 && policy->mappedMode_ == 0;
+}
 
-// ========================================================================================================================================================
-//  列表
-// ========================================================================================================================================================
-
-// 列表类型
-#define w_List(T) w_concat(w_List_, T)
-
-// 列表类型定义
-#define w_List_type_define_(T)       \
-    typedef struct                   \
-    {                                \
-        T *elementData;              \
-        int64_t size;     /* 大小 */ \
-        int64_t capacity; /* 容量 */ \
-    } w_List(T);
-
-// 列表初始化
-#define w_List_initWithCapacity(T) w_concat(w_List(T), _initWithCapacity)
-#define w_List_initWithCapacity_define_(T)                                                \
-    /**                                                                                   \
-     * 列表初始化                                                                    \
-     * @param this 列表                                                                 \
-     * @param initCapacity 初始容量                                                   \
-     * @return void                                                                       \
-     */                                                                                   \
-    static inline void w_List_initWithCapacity(T)(w_List(T) * this, int64_t initCapacity) \
-    {                                                                                     \
-        w_assert(this != NULL);                                                           \
-        this->elementData = w_malloc(sizeof(T) * initCapacity);                           \
-        w_assert(this->elementData != NULL);                                              \
-        this->size = 0;                                                                   \
-        this->capacity = initCapacity;                                                    \
+/**
+ * 按策略设置映射内存的 NUMA 分布（只是提示，失败时忽略）
+ * @param policy 内存分配策略
+ * @param address 映射地址
+ * @param size 映射字节数
+ * @return void
+ */
+static inline void w_AllocPolicy_bind_(const w_AllocPolicy *policy, void *address, int64_t size)
+{
+#if w_LINUX_SYSCALL_ENABLED_
+    uint64_t nodeMask = 0;
+    int mode = 0;
+    if (policy->numaNode >= 0)
+    {
+        w_check(policy->numaNode < w_NUMA_MAX_NODES_);
+        nodeMask = (uint64_t)1 << policy->numaNode;
+        mode = 2; /* MPOL_BIND */
     }
-
-// 列表初始化
-#define w_List_init(T) w_concat(w_List(T), _init)
-#define w_List_init_define_(T)                          \
-    /**                                                 \
-     * 列表初始化                                  \
-     * @param this 列表                               \
-     */                                                 \
-    static inline void w_List_init(T)(w_List(T) * this) \
-    {                                                   \
-        w_List_initWithCapacity(T)(this, 16);           \
+    else if (policy->flags & w_ALLOC_NUMA_INTERLEAVE)
+    {
+        nodeMask = ~(uint64_t)0;
+        mode = 3; /* MPOL_INTERLEAVE */
     }
-
-// 列表销毁
-#define w_List_deinit(T) w_concat(w_List(T), _deinit)
-#define w_List_deinit_define_(T)                          \
-    /**                                                   \
-     * 列表销毁                                       \
-     * @param this 列表                                 \
-     * @return void                                       \
-     */                                                   \
-    static inline void w_List_deinit(T)(w_List(T) * this) \
-    {                                                     \
-        w_assert(this != NULL);                           \
-        w_assert(this->elementData != NULL);              \
-        w_free(this->elementData);                        \
-        memset(this, 0, sizeof(w_List(T)));               \
+    if (mode != 0)
+    {
+        syscall(SYS_mbind, address, (unsigned long)size, mode, &nodeMask, (unsigned long)w_NUMA_MAX_NODES_ + 1, 0);
     }
+#else
+    (void)policy;
+    (void)address;
+    (void)size;
+#endif
+}
 
-// 列表获取大小
-#define w_List_size(T) w_concat(w_List(T), _size)
-#define w_List_size_define_(T)                             \
-    /**                                                    \
-     * 列表获取大小                                  \
-     * @param this 列表                                  \
-     * @return int64_t 大小                              \
-     */                                                    \
-    static inline int64_t w_List_size(T)(w_List(T) * this) \
-    {                                                      \
-        w_assert(this != NULL);                            \
-        w_assert(this->elementData != NULL);               \
-        return this->size;                                 \
+/**
+ * 按策略申请内存
+ * 默认策略直接使用 w_malloc；需要大页或 NUMA 时使用匿名映射，否则使用 w_malloc 多申请一部分用于对齐
+ * @param policy 内存分配策略
+ * @param size 字节数
+ * @return void * 内存地址（需要使用 w_AllocPolicy_free_ 以同样的策略释放）
+ */
+static inline void *w_AllocPolicy_malloc_(const w_AllocPolicy *policy, int64_t size)
+{
+    if (w_AllocPolicy_isDefault_(policy))
+    {
+        return w_malloc(size);
     }
-
-// 列表获取容量
-#define w_List_capacity(T) w_concat(w_List(T), _capacity)
-#define w_List_capacity_define_(T)                             \
-    /**                                                        \
-     * 列表获取容量                                      \
-     * @param this 列表                                      \
-     * @return int64_t 容量                                  \
-     */                                                        \
-    static inline int64_t w_List_capacity(T)(w_List(T) * this) \
-    {                                                          \
-        w_assert(this != NULL);                                \
-        w_assert(this->elementData != NULL);                   \
-        return this->capacity;                                 \
+    w_check(policy->alignment >= 0 && (policy->alignment & (policy->alignment - 1)) == 0);
+    int64_t alignment = policy->alignment > 16 ? policy->alignment : 16;
+    char *base = NULL;
+    int64_t mappedSize = 0;
+#if w_MMAP_ENABLED_
+    if (policy->flags != 0 || policy->numaNode >= 0)
+    {
+        /* 大页时数据按大页对齐，否则按页对齐 */
+        int64_t pageSize = (policy->flags & (w_ALLOC_HUGE_PAGES | w_ALLOC_HUGETLB)) ? w_HUGE_PAGE_SIZE_ : sysconf(_SC_PAGESIZE);
+        alignment = alignment > pageSize ? alignment : pageSize;
+        mappedSize = (size + alignment + (int64_t)sizeof(w_AllocHeader_) + pageSize - 1) / pageSize * pageSize;
+        void *address = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+        if (policy->flags & w_ALLOC_HUGETLB)
+        {
+            address = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+#endif
+        if (address == MAP_FAILED)
+        {
+            address = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            w_assert(address != MAP_FAILED);
+#if defined(MADV_HUGEPAGE)
+            if (policy->flags & (w_ALLOC_HUGE_PAGES | w_ALLOC_HUGETLB))
+            {
+                madvise(address, mappedSize, MADV_HUGEPAGE);
+            }
+#endif
+        }
+        /* 在第一次访问之前设置 NUMA 分布 */
+        w_AllocPolicy_bind_(policy, address, mappedSize);
+        base = address;
     }
-
-// 列表获取元素
-#define w_List_get(T) w_concat(w_List(T), _get)
-#define w_List_get_define_(T)                                      \
-    /**                                                            \
-     * 列表获取元素                                          \
-     * @param this 列表                                          \
-     * @param index 索引                                         \
-     * @return T 元素                                            \
-     */                                                            \
-    static inline T w_List_get(T)(w_List(T) * this, int64_t index) \
-    {                                                              \
-        w_assert(this != NULL);                                    \
-        w_assert(this->elementData != NULL);                       \
-        w_assert(index >= 0 && index < this->size);                \
-        return this->elementData[index];                           \
+    else
+#endif
+    {
+        base = w_malloc(size + alignment + sizeof(w_AllocHeader_));
+        w_assert(base != NULL);
     }
+    /* 在对齐后的地址之前保存头部 */
+    char *data = (char *)(((uintptr_t)base + sizeof(w_AllocHeader_) + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    w_AllocHeader_ *header = (w_AllocHeader_ *)data - 1;
+    header->base = base;
+    header->mappedSize = mappedSize;
+    return data;
+}
 
-// 列表设置元素
-#define w_List_set(T) w_concat(w_List(T), _set)
-#define w_List_set_define_(T)                                                    \
-    /**                                                                          \
-     * 列表设置元素                                                        \
-     * @param this 列表                                                        \
-     * @param index 索引                                                       \
-     * @param element 元素                                                     \
-     * @return void                                                              \
-     */                                                                          \
-    static inline void w_List_set(T)(w_List(T) * this, int64_t index, T element) \
-    {                                                                            \
-        w_assert(this != NULL);                                                  \
-        w_assert(this->elementData != NULL);                                     \
-        w_assert(index >= 0 && index < this->size);                              \
-        this->elementData[index] = element;                                      \
+/**
+ * 按策略释放内存
+ * @param policy 内存分配策略（必须与申请时相同）
+ * @param ptr 内存地址（可以为 NULL）
+ * @param size 字节数（用于解除文件映射）
+ * @return void
+ */
+static inline void w_AllocPolicy_free_(const w_AllocPolicy *policy, void *ptr, int64_t size)
+{
+    if (w_AllocPolicy_isDefault_(policy))
+    {
+        w_free(ptr);
+        return;
     }
-
-// 列表添加元素
-#define w_List_add(T) w_concat(w_List(T), _add)
-#define w_List_add_define_(T)                                                    \
-    /**                                                                          \
-     * 列表添加元素                                                        \
-     * @param this 列表                                                        \
-     * @param index 索引（插入到这个位置）                            \
-     * @param element 元素                                                     \
-     */                                                                          \
-    static inline void w_List_add(T)(w_List(T) * this, int64_t index, T element) \
-    {                                                                            \
-        /* 断言 */                                                               \
-        w_assert(this != NULL);                                                  \
-        w_assert(this->elementData != NULL);                                     \
-        w_assert(index >= 0 && index <= this->size);                             \
-                                                                                 \
-        /* 扩容 */                                                               \
-        if (this->size >= this->capacity)                                        \
-        {                                                                        \
-            this->capacity *= 2;                                                 \
-            T *newElementData = w_malloc(this->capacity * sizeof(T));            \
-            w_assert(newElementData != NULL);                                    \
-            memcpy(newElementData, this->elementData, this->size * sizeof(T));   \
-            w_free(this->elementData);                                           \
-            this->elementData = newElementData;                                  \
-        }                                                                        \
-                                                                                 \
-        /* 添加元素 */                                                           \
-        for (int64_t i = this->size; i > index; i--)                             \
-        {                                                                        \
-            this->elementData[i] = this->elementData[i - 1];                     \
-        }                                                                        \
-        this->elementData[index] = element;                                      \
-        this->size++;                                                            \
+#if w_MMAP_ENABLED_
+    if (policy->mappedMode_ != 0)
+    {
+        if (ptr != NULL)
+        {
+            /* 映射的数据可能不是从页的起始位置开始（如 NPY 文件的头部之后） */
+            uintptr_t begin = (uintptr_t)ptr & ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1);
+            munmap((void *)begin, (uintptr_t)ptr + size - begin);
+        }
+        if (policy->mappedFd_ >= 0)
+        {
+            close(policy->mappedFd_);
+        }
+        return;
     }
-
-// 列表删除元素
-#define w_List_remove(T) w_concat(w_List(T), _remove)
-#define w_List_remove_define_(T)                                      \
-    /**                                                               \
-     * 列表删除元素                                             \
-     * @param this 列表                                             \
-     * @param index 索引                                            \
-     * @return T 删除的元素                                      \
-     */                                                               \
-    static inline T w_List_remove(T)(w_List(T) * this, int64_t index) \
-    {                                                                 \
-        /* 断言 */                                                    \
-        w_assert(this != NULL);                                       \
-        w_assert(this->elementData != NULL);                          \
-        w_assert(index >= 0 && index < this->size);                   \
-                                                                      \
-        /* 删除元素 */                                                \
-        T element = this->elementData[index];                         \
-        for (int64_t i = index; i < this->size - 1; i++)              \
-        {                                                             \
-            this->elementData[i] = this->elementData[i + 1];          \
-        }                                                             \
-        this->size--;                                                 \
-        return element;                                               \
+#endif
+    (void)size;
+    if (ptr == NULL)
+    {
+        return;
     }
-
-// 列表是否为空
-#define w_List_isEmpty(T) w_concat(w_List(T), _isEmpty)
-#define w_List_isEmpty_define_(T)                          \
-    /**                                                    \
-     * 列表是否为空                                  \
-     * @param this 列表                                  \
-     * @return bool true:为空 false:不为空            \
-     */                                                    \
-    static inline bool w_List_isEmpty(T)(w_List(T) * this) \
-    {                                                      \
-        w_assert(this != NULL);                            \
-        w_assert(this->elementData != NULL);               \
-        return this->size == 0;                            \
+    w_AllocHeader_ *header = (w_AllocHeader_ *)ptr - 1;
+#if w_MMAP_ENABLED_
+    if (header->mappedSize > 0)
+    {
+        munmap(header->base, header->mappedSize);
+        return;
     }
+#endif
+    w_free(header->base);
+}
 
-// 列表插入元素到头部
-#define w_List_addFirst(T) w_concat(w_List(T), _addFirst)
-#define w_List_addFirst_define_(T)                                     \
-    /**                                                                \
-     * 列表插入元素到头部                                     \
-     * @param this 列表                                              \
-     * @param element 元素                                           \
-     */                                                                \
-    static inline void w_List_addFirst(T)(w_List(T) * this, T element) \
-    {                                                                  \
-        w_List_add(T)(this, 0, element);                               \
+// 文件映射模式：只读，多个进程共享同一份页缓存
+#define w_MAPPED_READONLY 1
+
+// 文件映射模式：私有（写时复制，修改不会写回文件；扩容时转移到堆内存）
+#define w_MAPPED_PRIVATE 2
+
+// 文件映射模式：共享可写（修改写回文件，扩容时扩大文件）
+#define w_MAPPED_SHARED 3
+
+// 访问模式提示：默认
+#define w_ADVICE_NORMAL 0
+
+// 访问模式提示：顺序访问（加大预读）
+#define w_ADVICE_SEQUENTIAL 1
+
+// 访问模式提示：随机访问（关闭预读）
+#define w_ADVICE_RANDOM 2
+
+// 访问模式提示：即将访问（提前读入）
+#define w_ADVICE_WILLNEED 3
+
+/**
+ * 映射文件
+ * @param policy 内存分配策略（输出，记录映射模式和文件描述符）
+ * @param path 文件路径
+ * @param mode 映射模式 w_MAPPED_*
+ * @param createSize 大于等于 0 时创建文件并截断到该字节数（只用于共享模式），-1 表示打开已有文件（共享模式下不存在时创建空文件）
+ * @param elementSize 元素字节数（只映射完整的元素）
+ * @param data 映射地址（输出，没有完整的元素时为 NULL）
+ * @param bytes 映射的字节数（输出，elementSize 的倍数）
+ * @return bool 是否成功
+ */
+static inline bool w_AllocPolicy_mapFile_(w_AllocPolicy *policy, const char *path, int mode, int64_t createSize, int64_t elementSize, void **data, int64_t *bytes)
+{
+    w_check(policy != NULL && path != NULL && data != NULL && bytes != NULL);
+    w_check(mode == w_MAPPED_READONLY || mode == w_MAPPED_PRIVATE || mode == w_MAPPED_SHARED);
+    w_check(createSize < 0 || mode == w_MAPPED_SHARED);
+#if w_MMAP_ENABLED_
+    int openFlags = mode == w_MAPPED_SHARED ? O_RDWR | O_CREAT : O_RDONLY;
+    int fd = open(path, createSize >= 0 ? openFlags | O_TRUNC : openFlags, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    if ((createSize >= 0 && ftruncate(fd, createSize) != 0) || fstat(fd, &status) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    *bytes = status.st_size / elementSize * elementSize;
+    *data = NULL;
+    if (*bytes > 0)
+    {
+        int protection = mode == w_MAPPED_READONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+        void *address = mmap(NULL, *bytes, protection, mode == w_MAPPED_PRIVATE ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+        *data = address;
+    }
+    /* 只有共享模式扩容时需要文件描述符 */
+    if (mode != w_MAPPED_SHARED)
+    {
+        close(fd);
+        fd = -1;
     }
+    *policy = w_AllocPolicy_default();
+    policy->mappedMode_ = mode;
+    policy->mappedFd_ = fd;
+    return true;
+#else
+    (void)createSize;
+    (void)elementSize;
+    (void)data;
+    (void)bytes;
+    return false;
+#endif
+}
 
-// 列表插入元素到尾部
-#define w_List_addLast(T) w_concat(w_List(T), _addLast)
-#define w_List_addLast_define_(T)                                     \
-    /**                                                               \
-     * 列表插入元素到尾部                                    \
-     * @param this 列表                                             \
-     * @param element 元素                                          \
-     */                                                               \
-    static inline void w_List_addLast(T)(w_List(T) * this, T element) \
-    {                                                                 \
-        w_List_add(T)(this, this->size, element);                     \
+/**
+ * 解除映射中数据所在的页以外的部分（数据之前和之后的整页）
+ * @param base 映射地址
+ * @param bytes 映射的字节数
+ * @param data 需要保留的数据地址
+ * @param size 需要保留的字节数（大于 0）
+ * @return void
+ */
+static inline void w_AllocPolicy_trimMapping_(void *base, int64_t bytes, void *data, int64_t size)
+{
+#if w_MMAP_ENABLED_
+    uintptr_t pageMask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+    uintptr_t begin = (uintptr_t)data & ~pageMask;
+    uintptr_t end = ((uintptr_t)data + size + pageMask) & ~pageMask;
+    uintptr_t mappedEnd = ((uintptr_t)base + bytes + pageMask) & ~pageMask;
+    if (begin > (uintptr_t)base)
+    {
+        munmap(base, begin - (uintptr_t)base);
+    }
+    if (mappedEnd > end)
+    {
+        munmap((void *)end, mappedEnd - end);
     }
+#else
+    (void)base;
+    (void)bytes;
+    (void)data;
+    (void)size;
+#endif
+}
 
-// 列表删除头部元素
-#define w_List_removeFirst(T) w_concat(w_List(T), _removeFirst)
-#define w_List_removeFirst_define_(T)                       \
-    /**                                                     \
-     * 列表删除头部元素                             \
-     * @param this 列表                                   \
-     * @return T 删除的元素                            \
-     */                                                     \
-    static inline T w_List_removeFirst(T)(w_List(T) * this) \
-    {                                                       \
-        return w_List_remove(T)(this, 0);                   \
+/**
+ * 共享映射截断文件（销毁列表时去掉未使用的容量）
+ * @param policy 内存分配策略
+ * @param bytes 文件字节数
+ * @return void
+ */
+static inline void w_AllocPolicy_truncate_(const w_AllocPolicy *policy, int64_t bytes)
+{
+#if w_MMAP_ENABLED_
+    if (policy->mappedMode_ == w_MAPPED_SHARED)
+    {
+        w_assert(ftruncate(policy->mappedFd_, bytes) == 0);
     }
+#else
+    (void)policy;
+    (void)bytes;
+#endif
+}
 
-// 列表删除尾部元素
-#define w_List_removeLast(T) w_concat(w_List(T), _removeLast)
-#define w_List_removeLast_define_(T)                       \
-    /**                                                    \
-     * 列表删除尾部元素                            \
-     * @param this 列表                                  \
-     * @return T 删除的元素                           \
-     */                                                    \
-    static inline T w_List_removeLast(T)(w_List(T) * this) \
-    {                                                      \
-        return w_List_remove(T)(this, this->size - 1);     \
+/**
+ * 共享映射写回文件（其他策略什么都不做）
+ * @param policy 内存分配策略
+ * @param ptr 内存地址
+ * @param bytes 字节数
+ * @return void
+ */
+static inline void w_AllocPolicy_sync_(const w_AllocPolicy *policy, void *ptr, int64_t bytes)
+{
+#if w_MMAP_ENABLED_
+    if (policy->mappedMode_ == w_MAPPED_SHARED && ptr != NULL && bytes > 0)
+    {
+        msync(ptr, bytes, MS_SYNC);
     }
+#else
+    (void)policy;
+    (void)ptr;
+    (void)bytes;
+#endif
+}
 
-// 列表获取数据指针
-#define w_List_data(T) w_concat(w_List(T), _data)
-#define w_List_data_define_(T)                                                        \
-    /**                                                                               \
-     * 列表获取数据指针                                                       \
-     * @param this 列表                                                             \
-     * @return T * 数据指针（慎用，如果扩容会导致该指针被释放） \
-     */                                                                               \
-    static inline T *w_List_data(T)(w_List(T) * this)                                 \
-    {                                                                                 \
-        w_assert(this != NULL);                                                       \
-        w_assert(this->elementData != NULL);                                          \
-        return this->elementData;                                                     \
+/**
+ * 访问模式提示（只是提示，失败时忽略）
+ * @param ptr 内存地址
+ * @param bytes 字节数
+ * @param advice 访问模式 w_ADVICE_*
+ * @return void
+ */
+static inline void w_adviseMemory_(const void *ptr, int64_t bytes, int advice)
+{
+#if w_MMAP_ENABLED_
+    if (ptr == NULL || bytes <= 0)
+    {
+        return;
     }
+    /* madvise 要求起始地址按页对齐 */
+    uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+    uintptr_t begin = (uintptr_t)ptr & ~(pageSize - 1);
+    int advices[] = {MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED};
+    w_check(advice >= w_ADVICE_NORMAL && advice <= w_ADVICE_WILLNEED);
+    madvise((void *)begin, (uintptr_t)ptr + bytes - begin, advices[advice]);
+#else
+    (void)ptr;
+    (void)bytes;
+    (void)advice;
+#endif
+}
 
-// 列表定义
-#define w_List_define(T)                \
-    w_List_type_define_(T);             \
-    w_List_initWithCapacity_define_(T); \
-    w_List_init_define_(T);             \
-    w_List_deinit_define_(T);           \
-    w_List_size_define_(T);             \
-    w_List_capacity_define_(T);         \
-    w_List_get_define_(T);              \
-    w_List_set_define_(T);              \
-    w_List_add_define_(T);              \
-    w_List_remove_define_(T);           \
-    w_List_isEmpty_define_(T);          \
-    w_List_addFirst_define_(T);         \
-    w_List_addLast_define_(T);          \
-    w_List_removeFirst_define_(T);      \
-    w_List_removeLast_define_(T);       \
-    w_List_data_define_(T);
+/**
+ * 按策略重新申请内存，保留前 usedSize 字节的数据
+ * 共享映射扩大文件后重新映射；私有映射转移到堆内存并改为默认策略；只读映射不能重新申请
+ * @param policy 内存分配策略
+ * @param ptr 原内存地址（可以为 NULL）
+ * @param oldSize 原字节数
+ * @param usedSize 需要保留的字节数
+ * @param newSize 新字节数
+ * @return void * 新内存地址
+ */
+static inline void *w_AllocPolicy_realloc_(w_AllocPolicy *policy, void *ptr, int64_t oldSize, int64_t usedSize, int64_t newSize)
+{
+#if w_MMAP_ENABLED_
+    if (policy->mappedMode_ == w_MAPPED_SHARED)
+    {
+        /* 数据保存在文件中，扩大文件后重新映射即可 */
+        if (ptr != NULL)
+        {
+            munmap(ptr, oldSize);
+        }
+        w_assert(ftruncate(policy->mappedFd_, newSize) == 0);
+        void *address = mmap(NULL, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, policy->mappedFd_, 0);
+        w_assert(address != MAP_FAILED);
+        return address;
+    }
+    w_assert(policy->mappedMode_ != w_MAPPED_READONLY);
+    if (policy->mappedMode_ == w_MAPPED_PRIVATE)
+    {
+        void *data = w_malloc(newSize);
+        w_assert(data != NULL);
+        if (usedSize > 0)
+        {
+            memcpy(data, ptr, usedSize);
+        }
+        w_AllocPolicy_free_(policy, ptr, oldSize);
+        *policy = w_AllocPolicy_default();
+        return data;
+    }
+#endif
+    void *data = w_AllocPolicy_malloc_(policy, newSize);
+    w_assert(data != NULL);
+    if (usedSize > 0)
+    {
+        memcpy(data, ptr, usedSize);
+    }
+    w_AllocPolicy_free_(policy, ptr, oldSize);
+    return data;
+}
 
 // ========================================================================================================================================================
-//  Map
+//  哈希和比较操作
 // ========================================================================================================================================================
 
-// MapEntry 类型
-#define w_Map_Entry(K, V) w_concat(w_concat(w_concat(w_Map_Entry_, K), _), V)
+// 哈希函数
+// 函数原型：int64_t w_hash(T)(T* this);
+#define w_hash(T) w_concat(w_hash_, T)
 
-// MapEntry 定义
-#define w_Map_Entry_type_define_(K, V)   \
-    typedef struct w_Map_Entry(K, V)     \
-    {                                    \
-        K key;                           \
-        V value;                         \
-        struct w_Map_Entry(K, V) * next; \
-    } w_Map_Entry(K, V);
+// 比较函数
+// 函数原型：int64_t w_compare(T)(T* this, T* other);
+#define w_compare(T) w_concat(w_compare_, T)
 
-// Map 类型
-#define w_Map(K, V) w_concat(w_concat(w_concat(w_Map_, K), _), V)
+// 判断是否相等
+// 函数原型：bool w_equals(T)(T* this, T* other);
+#define w_equals(T) w_concat(w_equals_, T)
 
-// Map 类型定义
-#define w_Map_type_define_(K, V)        \
-    typedef struct w_Map(K, V)          \
-    {                                   \
-        w_Map_Entry(K, V) * *entryData; \
-        int64_t entryDataSize;          \
-        int64_t size;                   \
-    } w_Map(K, V);
+// 字节序列哈希的密钥（wyhash 的默认参数）
+#define w_HASH_SECRET0_ UINT64_C(0x2d358dccaa6c78a5)
+#define w_HASH_SECRET1_ UINT64_C(0x8bb84b93962eacc9)
+#define w_HASH_SECRET2_ UINT64_C(0x4b33a62ed433d4a3)
+#define w_HASH_SECRET3_ UINT64_C(0x4d5a2da51de1aa47)
 
-// Map 初始化
-#define w_Map_init(K, V) w_concat(w_Map(K, V), _init)
-#define w_Map_init_define_(K, V)                                                       \
-    /**                                                                                \
-     * Map 初始化                                                                   \
-     * @param this Map                                                                 \
-     * @return void                                                                    \
-     */                                                                                \
-    static inline void w_Map_init(K, V)(w_Map(K, V) * this)                            \
-    {                                                                                  \
-        this->entryDataSize = 16;                                                      \
-        this->entryData = w_malloc(sizeof(w_Map_Entry(K, V) *) * this->entryDataSize); \
-        w_assert(this->entryData != NULL);                                             \
-        memset(this->entryData, 0, sizeof(w_Map_Entry(K, V) *) * this->entryDataSize); \
-        this->size = 0;                                                                \
+/**
+ * 64 位乘法，a 和 b 分别替换为 128 位乘积的低 64 位和高 64 位
+ * @param a
+ * @param b
+ * @return void
+ */
+static inline void w_hashMultiply_(uint64_t *a, uint64_t *b)
+{
+#ifdef __SIZEOF_INT128__
+    __extension__ unsigned __int128 product = (unsigned __int128)*a * *b;
+    *a = (uint64_t)product;
+    *b = (uint64_t)(product >> 64);
+#else
+    uint64_t aHigh = *a >> 32, aLow = (uint32_t)*a, bHigh = *b >> 32, bLow = (uint32_t)*b;
+    uint64_t highLow = aHigh * bLow, lowHigh = aLow * bHigh, low = aLow * bLow;
+    uint64_t middle = (low >> 32) + (uint32_t)highLow + (uint32_t)lowHigh;
+    *a = (middle << 32) | (uint32_t)low;
+    *b = aHigh * bHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+#endif
+}
+
+/**
+ * 64 位乘法，返回 128 位乘积的低 64 位和高 64 位的异或
+ * @param a
+ * @param b
+ * @return uint64_t
+ */
+static inline uint64_t w_hashMix_(uint64_t a, uint64_t b)
+{
+    w_hashMultiply_(&a, &b);
+    return a ^ b;
+}
+
+/**
+ * 读取 8 个字节（按小端序）
+ * @param p
+ * @return uint64_t
+ */
+static inline uint64_t w_readLE64_(const uint8_t *p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+/**
+ * 读取 4 个字节（按小端序）
+ * @param p
+ * @return uint64_t
+ */
+static inline uint64_t w_readLE32_(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+/**
+ * 字节序列哈希（wyhash 算法，每次处理 8 个字节，结果在所有位上均匀分布，适合 Map 按 2 的幂取模）
+ * @param data 数据
+ * @param size 长度
+ * @return int64_t
+ */
+static inline int64_t w_hashBytes(const void *data, int64_t size)
+{
+    w_check(data != NULL || size == 0);
+    w_check(size >= 0);
+    const uint8_t *p = data;
+    uint64_t seed = w_hashMix_(w_HASH_SECRET0_, w_HASH_SECRET1_);
+    uint64_t a, b;
+    if (size <= 16)
+    {
+        if (size >= 4)
+        {
+            /* 首尾各取两段 4 字节（可能重叠） */
+            int64_t middle = (size >> 3) << 2;
+            a = (w_readLE32_(p) << 32) | w_readLE32_(p + middle);
+            b = (w_readLE32_(p + size - 4) << 32) | w_readLE32_(p + size - 4 - middle);
+        }
+        else if (size > 0)
+        {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[size >> 1] << 8) | p[size - 1];
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        int64_t i = size;
+        if (i >= 48)
+        {
+            /* 三条独立的链并行处理 48 字节 */
+            uint64_t seed1 = seed, seed2 = seed;
+            do
+            {
+                seed = w_hashMix_(w_readLE64_(p) ^ w_HASH_SECRET1_, w_readLE64_(p + 8) ^ seed);
+                seed1 = w_hashMix_(w_readLE64_(p + 16) ^ w_HASH_SECRET2_, w_readLE64_(p + 24) ^ seed1);
+                seed2 = w_hashMix_(w_readLE64_(p + 32) ^ w_HASH_SECRET3_, w_readLE64_(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (i > 16)
+        {
+            seed = w_hashMix_(w_readLE64_(p) ^ w_HASH_SECRET1_, w_readLE64_(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = w_readLE64_(p + i - 16);
+        b = w_readLE64_(p + i - 8);
     }
+    a ^= w_HASH_SECRET1_;
+    b ^= seed;
+    w_hashMultiply_(&a, &b);
+    return (int64_t)w_hashMix_(a ^ w_HASH_SECRET0_ ^ (uint64_t)size, b ^ w_HASH_SECRET1_);
+}
 
-// Map 释放
-#define w_Map_deinit(K, V) w_concat(w_Map(K, V), _deinit)
-#define w_Map_deinit_define_(K, V)                            \
-    /**                                                       \
-     * Map 释放                                             \
-     * @param this Map                                        \
-     * @return void                                           \
-     */                                                       \
-    static inline void w_Map_deinit(K, V)(w_Map(K, V) * this) \
-    {                                                         \
-        /* 遍历链表 */                                        \
-        for (int64_t i = 0; i < this->entryDataSize; i++)     \
-        {                                                     \
-            /* 链表头 */                                      \
-            w_Map_Entry(K, V) *entry = this->entryData[i];    \
-            while (entry != NULL)                             \
-            {                                                 \
-                /* 释放节点 */                                \
-                w_Map_Entry(K, V) *next = entry->next;        \
-                w_free(entry);                                \
-                entry = next;                                 \
-            }                                                 \
-        }                                                     \
-        memset(this, 0, sizeof(w_Map(K, V)));                 \
+// ========================================================================================================================================================
+//  数组
+// ========================================================================================================================================================
+
+// 数组类型
+#define w_Array(T) w_concat(w_Array_, T)
+
+// 数组类型定义
+#define w_Array_type_define_(T)                  \
+    typedef struct                               \
+    {                                            \
+        T *elementData;       /* 元素数据 */     \
+        int64_t size;         /* 元素数量 */     \
+        w_AllocPolicy policy; /* 内存分配策略 */ \
+    } w_Array(T);
+
+// 数组按内存分配策略初始化
+#define w_Array_initWithPolicy(T) w_concat(w_Array(T), _initWithPolicy)
+#define w_Array_initWithPolicy_define_(T)                                                               \
+    /**                                                                                                 \
+     * 数组按内存分配策略初始化                                                             \
+     * @param this 数组                                                                               \
+     * @param size 数组大小                                                                         \
+     * @param policy 内存分配策略（对齐、大页、NUMA）                                     \
+     * @return void                                                                                     \
+     */                                                                                                 \
+    static inline void w_Array_initWithPolicy(T)(w_Array(T) * this, int64_t size, w_AllocPolicy policy) \
+    {                                                                                                   \
+        w_check(this != NULL);                                                                          \
+        w_check(size >= 0);                                                                             \
+        this->policy = policy;                                                                          \
+        this->elementData = w_AllocPolicy_malloc_(&this->policy, sizeof(T) * size);                     \
+        w_assert(this->elementData != NULL);                                                            \
+        this->size = size;                                                                              \
     }
 
-// Map 放置 键值对 到 键值对数组
-#define w_Map_putToEntryData_(K, V) w_concat(w_Map(K, V), _putToEntryData_)
-#define w_Map_putToEntryData_define_(K, V)                                                                                \
-    /**                                                                                                                   \
-     * 放置 键值对 到 键值对数组                                                                               \
-     * @param entryData 键值对数组                                                                                   \
-     * @param entryDataSize 键值对数组大小                                                                         \
-     * @param key 键                                                                                                     \
-     * @param value 值                                                                                                   \
-     * @return bool 是否添加新的元素                                                                              \
-     */                                                                                                                   \
-    static inline bool w_Map_putToEntryData_(K, V)(w_Map_Entry(K, V) * *entryData, int64_t entryDataSize, K key, V value) \
-    {                                                                                                                     \
-        w_assert(entryData != NULL);                                                                                      \
-        w_assert(entryDataSize > 0);                                                                                      \
-        /* 计算索引 */                                                                                                    \
-        int64_t index = w_hash(K)(&key) & (entryDataSize - 1);                                                            \
-                                                                                                                          \
-        /* 链表头 */                                                                                                      \
-        w_Map_Entry(K, V) *entry = entryData[index];                                                                      \
-        while (entry != NULL)                                                                                             \
-        {                                                                                                                 \
-            /* 键相等 */                                                                                                  \
-            if (w_equals(K)(&(entry->key), &key))                                                                         \
-            {                                                                                                             \
-                /* 覆盖值 */                                                                                              \
-                entry->value = value;                                                                                     \
-                return false;                                                                                             \
-            }                                                                                                             \
-            entry = entry->next;                                                                                          \
-        }                                                                                                                 \
-                                                                                                                          \
-        /* 创建节点 */                                                                                                    \
-        entry = w_malloc(sizeof(w_Map_Entry(K, V)));                                                                      \
-        w_assert(entry != NULL);                                                                                          \
-        entry->key = key;                                                                                                 \
-        entry->value = value;                                                                                             \
-        /* 头插法 */                                                                                                      \
-        entry->next = entryData[index];                                                                                   \
-        entryData[index] = entry;                                                                                         \
-        return true;                                                                                                      \
+// 数组初始化
+#define w_Array_init(T) w_concat(w_Array(T), _init)
+#define w_Array_init_define_(T)                                         \
+    /**                                                                 \
+     * 数组初始化                                                  \
+     * @param this 数组                                               \
+     * @param size 数组大小                                         \
+     * @return void                                                     \
+     */                                                                 \
+    static inline void w_Array_init(T)(w_Array(T) * this, int64_t size) \
+    {                                                                   \
+        w_Array_initWithPolicy(T)(this, size, w_AllocPolicy_default()); \
     }
 
-// Map 扩容
-#define w_Map_realloc_(K, V) w_concat(w_Map(K, V), _realloc_)
-#define w_Map_realloc_define_(K, V)                                                                           \
-    /**                                                                                                       \
-     * Map 扩容                                                                                             \
-     * @param this Map                                                                                        \
-     * @return void                                                                                           \
-     */                                                                                                       \
-    static inline void w_Map_realloc_(K, V)(w_Map(K, V) * this)                                               \
-    {                                                                                                         \
-        /* 申请新的键值对数组 */                                                                              \
-        w_Map_Entry(K, V) **newEntryData = w_malloc(sizeof(w_Map_Entry(K, V) *) * this->entryDataSize * 2);   \
-        w_assert(newEntryData != NULL);                                                                       \
-        memset(newEntryData, 0, sizeof(w_Map_Entry(K, V) *) * this->entryDataSize * 2);                       \
-                                                                                                              \
-        /* 将旧键值对数组中的键值对放置到新键值对数组中 */                                                    \
-        for (int64_t i = 0; i < this->entryDataSize; i++)                                                     \
-        {                                                                                                     \
-            w_Map_Entry(K, V) *entry = this->entryData[i];                                                    \
-            while (entry != NULL)                                                                             \
-            {                                                                                                 \
-                w_Map_putToEntryData_(K, V)(newEntryData, this->entryDataSize * 2, entry->key, entry->value); \
-                w_Map_Entry(K, V) *next = entry->next;                                                        \
-                w_free(entry);                                                                                \
-                entry = next;                                                                                 \
-            }                                                                                                 \
-        }                                                                                                     \
-                                                                                                              \
-        /*  更新 */                                                                                           \
-        w_free(this->entryData);                                                                              \
-        this->entryData = newEntryData;                                                                       \
-        this->entryDataSize *= 2;                                                                             \
+// 数组映射文件初始化
+#define w_Array_initMapped(T) w_concat(w_Array(T), _initMapped)
+#define w_Array_initMapped_define_(T)                                                                                                   \
+    /**                                                                                                                                 \
+     * 数组映射文件初始化，元素直接存放在文件的映射中，不读入内存                                          \
+     * @param this 数组                                                                                                               \
+     * @param path 文件路径（文件大小为 size * sizeof(T)，多余的字节被忽略；空文件得到大小为 0 的数组） \
+     * @param mode 映射模式 w_MAPPED_READONLY / w_MAPPED_PRIVATE / w_MAPPED_SHARED                                                  \
+     * @return bool 是否成功（文件打开或映射失败时返回 false，this 不会被初始化）                              \
+     */                                                                                                                                 \
+    static inline bool w_Array_initMapped(T)(w_Array(T) * this, const char *path, int mode)                                             \
+    {                                                                                                                                   \
+        w_check(this != NULL);                                                                                                          \
+        void *data;                                                                                                                     \
+        int64_t bytes;                                                                                                                  \
+        if (!w_AllocPolicy_mapFile_(&this->policy, path, mode, -1, sizeof(T), &data, &bytes))                                           \
+        {                                                                                                                               \
+            return false;                                                                                                               \
+        }                                                                                                                               \
+        this->elementData = data;                                                                                                       \
+        this->size = bytes / sizeof(T);                                                                                                 \
+        return true;                                                                                                                    \
     }
 
-// Map 放置键值对
-#define w_Map_put(K, V) w_concat(w_Map(K, V), _put)
-#define w_Map_put_define_(K, V)                                                            \
-    /**                                                                                    \
-     * Map 放置键值对                                                                 \
-     * @param this Map                                                                     \
-     * @param key 键                                                                      \
-     * @param value 值                                                                    \
-     * @return void                                                                        \
-     */                                                                                    \
-    static inline void w_Map_put(K, V)(w_Map(K, V) * this, K key, V value)                 \
-    {                                                                                      \
-        w_assert(this != NULL);                                                            \
-        w_assert(this->entryData != NULL);                                                 \
-        w_assert(this->entryDataSize > 0);                                                 \
-        w_assert(this->size >= 0);                                                         \
-                                                                                           \
-        /* 扩容 */                                                                         \
-        if ((double)this->size / this->entryDataSize >= 0.75)                              \
-        {                                                                                  \
-            w_Map_realloc_(K, V)(this);                                                    \
-        }                                                                                  \
-                                                                                           \
-        /* 添加键值对 */                                                                   \
-        if (w_Map_putToEntryData_(K, V)(this->entryData, this->entryDataSize, key, value)) \
-        {                                                                                  \
-            this->size++;                                                                  \
-        }                                                                                  \
+// 数组创建映射文件
+#define w_Array_createMapped(T) w_concat(w_Array(T), _createMapped)
+#define w_Array_createMapped_define_(T)                                                                                \
+    /**                                                                                                                \
+     * 数组创建映射文件（共享可写模式，已有的文件会被截断）                                  \
+     * @param this 数组                                                                                              \
+     * @param path 文件路径                                                                                        \
+     * @param size 数组大小                                                                                        \
+     * @return bool 是否成功（文件创建或映射失败时返回 false，this 不会被初始化）             \
+     */                                                                                                                \
+    static inline bool w_Array_createMapped(T)(w_Array(T) * this, const char *path, int64_t size)                      \
+    {                                                                                                                  \
+        w_check(this != NULL);                                                                                         \
+        w_check(size >= 0);                                                                                            \
+        void *data;                                                                                                    \
+        int64_t bytes;                                                                                                 \
+        if (!w_AllocPolicy_mapFile_(&this->policy, path, w_MAPPED_SHARED, size * sizeof(T), sizeof(T), &data, &bytes)) \
+        {                                                                                                              \
+            return false;                                                                                              \
+        }                                                                                                              \
+        this->elementData = data;                                                                                      \
+        this->size = size;                                                                                             \
+        return true;                                                                                                   \
     }
 
-// Map 获取值
-#define w_Map_get(K, V) w_concat(w_Map(K, V), _get)
-#define w_Map_get_define_(K, V)                                      \
-    /**                                                              \
-     * Map 获取值                                                 \
-     * 如果元素不存在，则报错                             \
-     * @param this Map                                               \
-     * @param key 键                                                \
-     * @return 值                                                   \
-     */                                                              \
-    static inline V w_Map_get(K, V)(w_Map(K, V) * this, K key)       \
-    {                                                                \
-        w_assert(this != NULL);                                      \
-        w_assert(this->entryData != NULL);                           \
-        w_assert(this->entryDataSize > 0);                           \
-        w_assert(this->size >= 0);                                   \
-                                                                     \
-        /* 计算索引 */                                               \
-        int64_t index = w_hash(K)(&key) & (this->entryDataSize - 1); \
-                                                                     \
-        /* 查找 */                                                   \
-        w_Map_Entry(K, V) *entry = this->entryData[index];           \
-        while (entry != NULL)                                        \
-        {                                                            \
-            if (w_equals(K)(&(entry->key), &key))                    \
-            {                                                        \
-                return entry->value;                                 \
-            }                                                        \
-            entry = entry->next;                                     \
-        }                                                            \
-                                                                     \
-        /* 未找到 */                                                 \
-        w_assert(false);                                             \
+// 数组访问模式提示
+#define w_Array_advise(T) w_concat(w_Array(T), _advise)
+#define w_Array_advise_define_(T)                                           \
+    /**                                                                     \
+     * 数组访问模式提示（主要用于映射文件的数组）      \
+     * @param this 数组                                                   \
+     * @param advice 访问模式 w_ADVICE_*                                \
+     * @return void                                                         \
+     */                                                                     \
+    static inline void w_Array_advise(T)(w_Array(T) * this, int advice)     \
+    {                                                                       \
+        w_check(this != NULL);                                              \
+        w_adviseMemory_(this->elementData, this->size * sizeof(T), advice); \
     }
 
-// Map 删除键值对
-#define w_Map_remove(K, V) w_concat(w_Map(K, V), _remove)
-#define w_Map_remove_define_(K, V)                                   \
+// 数组写回文件
+#define w_Array_sync(T) w_concat(w_Array(T), _sync)
+#define w_Array_sync_define_(T)                                                                \
+    /**                                                                                        \
+     * 数组写回文件（只对共享可写的映射有效，其他情况什么都不做） \
+     * @param this 数组                                                                      \
+     * @return void                                                                            \
+     */                                                                                        \
+    static inline void w_Array_sync(T)(w_Array(T) * this)                                      \
+    {                                                                                          \
+        w_check(this != NULL);                                                                 \
+        w_AllocPolicy_sync_(&this->policy, this->elementData, this->size * sizeof(T));         \
+    }
+
+// 数组反初始化
+#define w_Array_deinit(T) w_concat(w_Array(T), _deinit)
+#define w_Array_deinit_define_(T)                                                      \
+    /**                                                                                \
+     * 数组反初始化                                                              \
+     * @param this 数组                                                              \
+     * @return void                                                                    \
+     */                                                                                \
+    static inline void w_Array_deinit(T)(w_Array(T) * this)                            \
+    {                                                                                  \
+        w_check(this != NULL);                                                         \
+        /* 映射空文件时没有数据，仍然需要关闭映射的文件描述符 */                       \
+        w_check(this->elementData != NULL || this->size == 0);                         \
+        w_AllocPolicy_free_(&this->policy, this->elementData, this->size * sizeof(T)); \
+        memset(this, 0, sizeof(w_Array(T)));                                           \
+    }
+
+// 获取数组元素
+#define w_Array_get(T) w_concat(w_Array(T), _get)
+#define w_Array_get_define_(T)                                       \
     /**                                                              \
-     * Map 删除键值对                                           \
-     * @param this Map                                               \
-     * @param key 键                                                \
-     * @return void                                                  \
+     * 获取数组元素                                            \
+     * @param this 数组                                            \
+     * @param index 索引                                           \
+     * @return T 数组元素                                        \
      */                                                              \
-    static inline void w_Map_remove(K, V)(w_Map(K, V) * this, K key) \
+    static inline T w_Array_get(T)(w_Array(T) * this, int64_t index) \
     {                                                                \
-        w_assert(this != NULL);                                      \
-        w_assert(this->entryData != NULL);                           \
-        w_assert(this->entryDataSize > 0);                           \
-        w_assert(this->size >= 0);                                   \
-                                                                     \
-        /* 删除 */                                                   \
-        int64_t index = w_hash(K)(&key) & (this->entryDataSize - 1); \
-        w_Map_Entry(K, V) *entry = this->entryData[index];           \
-        if (entry == NULL)                                           \
-        {                                                            \
-            return;                                                  \
-        }                                                            \
-        /* 头 */                                                     \
-        if (w_equals(K)(&(entry->key), &key))                        \
-        {                                                            \
-            this->entryData[index] = entry->next;                    \
-            w_free(entry);                                           \
-            this->size--;                                            \
-            return;                                                  \
-        }                                                            \
-        /* 中间 */                                                   \
-        while (entry->next != NULL)                                  \
-        {                                                            \
-            if (w_equals(K)(&(entry->next->key), &key))              \
-            {                                                        \
-                w_Map_Entry(K, V) *next = entry->next;               \
-                entry->next = next->next;                            \
-                w_free(next);                                        \
-                this->size--;                                        \
-                return;                                              \
-            }                                                        \
-            entry = entry->next;                                     \
-        }                                                            \
+        w_check(this != NULL);                                       \
+        w_check(this->elementData != NULL);                          \
+        w_checkIndex(index >= 0 && index < this->size);              \
+        return this->elementData[index];                             \
     }
 
-// Map 大小
-#define w_Map_size(K, V) w_concat(w_Map(K, V), _size)
-#define w_Map_size_define_(K, V)                               \
-    /**                                                        \
-     * Map 大小                                              \
-     * @param this Map                                         \
-     * @return int64_t 键值对数量                         \
-     */                                                        \
-    static inline int64_t w_Map_size(K, V)(w_Map(K, V) * this) \
-    {                                                          \
-        w_assert(this != NULL);                                \
-        w_assert(this->entryData != NULL);                     \
-        w_assert(this->entryDataSize > 0);                     \
-        w_assert(this->size >= 0);                             \
-        return this->size;                                     \
+// 设置数组元素
+#define w_Array_set(T) w_concat(w_Array(T), _set)
+#define w_Array_set_define_(T)                                                 \
+    /**                                                                        \
+     * 设置数组元素                                                      \
+     * @param this 数组                                                      \
+     * @param index 索引                                                     \
+     * @param val 值                                                          \
+     * @return void                                                            \
+     */                                                                        \
+    static inline void w_Array_set(T)(w_Array(T) * this, int64_t index, T val) \
+    {                                                                          \
+        w_check(this != NULL);                                                 \
+        w_check(this->elementData != NULL);                                    \
+        w_checkIndex(index >= 0 && index < this->size);                        \
+        this->elementData[index] = val;                                        \
     }
 
-// Map 是否包含键
-#define w_Map_containsKey(K, V) w_concat(w_Map(K, V), _containsKey)
-#define w_Map_containsKey_define_(K, V)                                   \
-    /**                                                                   \
-     * Map 是否包含键                                                \
-     * @param this Map                                                    \
-     * @param key 键                                                     \
-     * @return bool                                                       \
-     */                                                                   \
-    static inline bool w_Map_containsKey(K, V)(w_Map(K, V) * this, K key) \
-    {                                                                     \
-        w_assert(this != NULL);                                           \
-        w_assert(this->entryData != NULL);                                \
-        w_assert(this->entryDataSize > 0);                                \
-        w_assert(this->size >= 0);                                        \
-                                                                          \
-        /* 索引 */                                                        \
-        int64_t index = w_hash(K)(&key) & (this->entryDataSize - 1);      \
-        w_Map_Entry(K, V) *entry = this->entryData[index];                \
-        while (entry != NULL)                                             \
-        {                                                                 \
-            if (w_equals(K)(&(entry->key), &key))                         \
-            {                                                             \
-                return true;                                              \
-            }                                                             \
-            entry = entry->next;                                          \
-        }                                                                 \
-        return false;                                                     \
+// 数组获取元素（不检查）
+#define w_Array_getUnchecked(T) w_concat(w_Array(T), _getUnchecked)
+#define w_Array_getUnchecked_define_(T)                                         \
+    /**                                                                         \
+     * 数组获取元素，不受检查级别影响，始终不做任何检查 \
+     * @param this 数组                                                       \
+     * @param index 索引（调用者保证在 [0, size) 内）                \
+     * @return T 元素                                                         \
+     */                                                                         \
+    static inline T w_Array_getUnchecked(T)(w_Array(T) * this, int64_t index)   \
+    {                                                                           \
+        return this->elementData[index];                                        \
     }
 
-// Map 迭代器
-#define w_Map_Iterator(K, V) w_concat(w_Map(K, V), _Iterator)
-#define w_Map_Iterator_type_define_(K, V) \
-    typedef struct                        \
-    {                                     \
-        w_Map(K, V) * map;                \
-        int64_t index;                    \
-        w_Map_Entry(K, V) * entry;        \
-    } w_Map_Iterator(K, V);
-
-// Map 获取迭代器
-#define w_Map_iterator(K, V) w_concat(w_Map(K, V), _iterator)
-#define w_Map_iterator_define_(K, V)                                                                               \
-    /**                                                                                                            \
-     * Map 获取迭代器                                                                                         \
-     * 使用完毕后不需要释放，使用期间不允许修改 Map，Map 修改后需要重新获取迭代器 \
-     * @param this Map                                                                                             \
-     * @return w_Map_Iterator 返回一个新的迭代器                                                          \
-     */                                                                                                            \
-    static inline w_Map_Iterator(K, V) w_Map_iterator(K, V)(w_Map(K, V) * this)                                    \
-    {                                                                                                              \
-        w_assert(this != NULL);                                                                                    \
-        w_assert(this->entryData != NULL);                                                                         \
-        w_assert(this->entryDataSize > 0);                                                                         \
-        return (w_Map_Iterator(K, V)){this, 0, this->entryData[0]};                                                \
+// 数组设置元素（不检查）
+#define w_Array_setUnchecked(T) w_concat(w_Array(T), _setUnchecked)
+#define w_Array_setUnchecked_define_(T)                                                     \
+    /**                                                                                     \
+     * 数组设置元素，不受检查级别影响，始终不做任何检查             \
+     * @param this 数组                                                                   \
+     * @param index 索引（调用者保证在 [0, size) 内）                            \
+     * @param element 元素                                                                \
+     * @return void                                                                         \
+     */                                                                                     \
+    static inline void w_Array_setUnchecked(T)(w_Array(T) * this, int64_t index, T element) \
+    {                                                                                       \
+        this->elementData[index] = element;                                                 \
     }
 
-// Map 迭代器获取下一个
-#define w_Map_Iterator_next(K, V) w_concat(w_Map(K, V), _Iterator_next)
-#define w_Map_Iterator_next_define_(K, V)                                                                 \
-    /**                                                                                                   \
-     * 迭代器获取下一个键值对（可以修改值，但不能修改键，会同步到 Map 中） \
-     * @param this 迭代器                                                                              \
-     * @return w_Map_Entry 键值对，如果为 NULL 则迭代结束                                     \
-     */                                                                                                   \
-    static inline w_Map_Entry(K, V) * w_Map_Iterator_next(K, V)(w_Map_Iterator(K, V) * this)              \
-    {                                                                                                     \
-        w_assert(this != NULL);                                                                           \
-        w_assert(this->map != NULL);                                                                      \
-        w_assert(this->map->entryData != NULL);                                                           \
-        w_assert(this->map->entryDataSize > 0);                                                           \
-                                                                                                          \
-        /* 移动到下一个索引 */                                                                            \
-        while (this->entry == NULL)                                                                       \
-        {                                                                                                 \
-            this->index++;                                                                                \
-            this->entry = this->map->entryData[this->index];                                              \
-            if (this->index >= this->map->entryDataSize)                                                  \
-            {                                                                                             \
-                return NULL;                                                                              \
-            }                                                                                             \
-        }                                                                                                 \
-                                                                                                          \
-        /* 返回并移动到下一个位置 */                                                                      \
-        w_Map_Entry(K, V) *entry = this->entry;                                                           \
-        this->entry = this->entry->next;                                                                  \
-        return entry;                                                                                     \
+// 数组大小
+#define w_Array_size(T) w_concat(w_Array(T), _size)
+#define w_Array_size_define_(T)                              \
+    /**                                                      \
+     * 获取数组大小                                    \
+     * @param this 数组                                    \
+     * @return int64_t 数组大小                          \
+     */                                                      \
+    static inline int64_t w_Array_size(T)(w_Array(T) * this) \
+    {                                                        \
+        w_check(this != NULL);                               \
+        return this->size;                                   \
     }
 
-// Map 定义
-// 定义 Map 需要定义 K 的 w_hash 和 w_equals 函数
-#define w_Map_define(K, V)              \
-    w_Map_Entry_type_define_(K, V);     \
-    w_Map_type_define_(K, V);           \
-    w_Map_init_define_(K, V);           \
-    w_Map_deinit_define_(K, V);         \
-    w_Map_putToEntryData_define_(K, V); \
-    w_Map_realloc_define_(K, V);        \
-    w_Map_put_define_(K, V);            \
-    w_Map_get_define_(K, V);            \
-    w_Map_remove_define_(K, V);         \
-    w_Map_size_define_(K, V);           \
-    w_Map_containsKey_define_(K, V);    \
-    w_Map_Iterator_type_define_(K, V);  \
-    w_Map_iterator_define_(K, V);       \
-    w_Map_Iterator_next_define_(K, V);
+// 数组定义
+#define w_Array_define(T)              \
+    w_Array_type_define_(T);           \
+    w_Array_initWithPolicy_define_(T); \
+    w_Array_init_define_(T);           \
+    w_Array_initMapped_define_(T);     \
+    w_Array_createMapped_define_(T);   \
+    w_Array_advise_define_(T);         \
+    w_Array_sync_define_(T);           \
+    w_Array_deinit_define_(T);         \
+    w_Array_get_define_(T);            \
+    w_Array_set_define_(T);            \
+    w_Array_getUnchecked_define_(T);   \
+    w_Array_setUnchecked_define_(T);   \
+    w_Array_size_define_(T)
 
 // ========================================================================================================================================================
-//  Set
+//  多维数组
 // ========================================================================================================================================================
 
-// Set 类型
-#define w_Set(T) w_concat(w_Set_, T)
+// 多维数组类型
+#define w_NDArray(T) w_concat(w_NDArray_, T)
+
+// 多维数组类型定义
+#define w_NDArray_type_define_(T)                                             \
+    typedef struct                                                            \
+    {                                                                         \
+        T *elementData;       /* 元素数据 */                                  \
+        int64_t *shape;       /* 形状*/                                       \
+        int64_t *strides;     /* 步长（以元素为单位，与 shape 同一块内存） */ \
+        int64_t shapeSize;                                                    \
+        int64_t size;         /* 元素总数 */                                  \
+        w_AllocPolicy policy; /* 内存分配策略 */                              \
+    } w_NDArray(T);
+
+// 多维数组分配形状和步长
+#define w_NDArray_allocShape_(T) w_concat(w_NDArray(T), _allocShape_)
+#define w_NDArray_allocShape_define_(T)                                                 \
+    /**                                                                                 \
+     * 多维数组分配形状和步长（形状由调用者填写）                  \
+     * @param this 多维数组                                                         \
+     * @param shapeSize 形状大小                                                    \
+     * @return void                                                                     \
+     */                                                                                 \
+    static inline void w_NDArray_allocShape_(T)(w_NDArray(T) * this, int64_t shapeSize) \
+    {                                                                                   \
+        w_check(shapeSize > 0);                                                         \
+        w_check(this != NULL);                                                          \
+        this->shape = w_malloc(sizeof(int64_t) * shapeSize * 2);                        \
+        w_assert(this->shape != NULL);                                                  \
+        this->strides = this->shape + shapeSize;                                        \
+        this->shapeSize = shapeSize;                                                    \
+    }
+
+// 多维数组计算步长并分配元素
+#define w_NDArray_initLayout_(T) w_concat(w_NDArray(T), _initLayout_)
+#define w_NDArray_initLayout_define_(T)                                                    \
+    /**                                                                                    \
+     * 多维数组按 C 顺序计算步长并分配元素数据                           \
+     * @param this 多维数组（形状已填写）                                       \
+     * @param policy 内存分配策略                                                    \
+     * @return void                                                                        \
+     */                                                                                    \
+    static inline void w_NDArray_initLayout_(T)(w_NDArray(T) * this, w_AllocPolicy policy) \
+    {                                                                                      \
+        /* 计算步长 */                                                                     \
+        int64_t elementSize = 1;                                                           \
+        for (int64_t i = this->shapeSize - 1; i >= 0; i--)                                 \
+        {                                                                                  \
+            w_check(this->shape[i] >= 0);                                                  \
+            this->strides[i] = elementSize;                                                \
+            elementSize *= this->shape[i];                                                 \
+        }                                                                                  \
+        this->size = elementSize;                                                          \
+                                                                                           \
+        /* 创建元素数据 */                                                                 \
+        this->policy = policy;                                                             \
+        this->elementData = w_AllocPolicy_malloc_(&this->policy, sizeof(T) * elementSize); \
+        w_assert(this->elementData != NULL);                                               \
+    }
+
+// 多维数组按内存分配策略初始化（可变参数列表版本）
+#define w_NDArray_initVa_(T) w_concat(w_NDArray(T), _initVa_)
+#define w_NDArray_initVa_define_(T)                                                                                      \
+    /**                                                                                                                  \
+     * 多维数组按内存分配策略初始化                                                                        \
+     * @param this 多维数组                                                                                          \
+     * @param policy 内存分配策略                                                                                  \
+     * @param shapeSize 形状大小                                                                                     \
+     * @param shape 形状（int64 类型的可变参数列表）                                                        \
+     * @return void                                                                                                      \
+     */                                                                                                                  \
+    static inline void w_NDArray_initVa_(T)(w_NDArray(T) * this, w_AllocPolicy policy, int64_t shapeSize, va_list shape) \
+    {                                                                                                                    \
+        w_NDArray_allocShape_(T)(this, shapeSize);                                                                       \
+        for (int64_t i = 0; i < shapeSize; i++)                                                                          \
+        {                                                                                                                \
+            this->shape[i] = va_arg(shape, int64_t);                                                                     \
+        }                                                                                                                \
+        w_NDArray_initLayout_(T)(this, policy);                                                                          \
+    }
+
+// 多维数组初始化
+#define w_NDArray_init(T) w_concat(w_NDArray(T), _init)
+#define w_NDArray_init_define_(T)                                                     \
+    /**                                                                               \
+     * 多维数组初始化                                                          \
+     * @param this 多维数组                                                       \
+     * @param shapeSize 形状大小                                                  \
+     * @param ... 形状（必须传入 int64 类型，否则会报错）             \
+     * @return void                                                                   \
+     */                                                                               \
+    static inline void w_NDArray_init(T)(w_NDArray(T) * this, int64_t shapeSize, ...) \
+    {                                                                                 \
+        va_list shape;                                                                \
+        va_start(shape, shapeSize);                                                   \
+        w_NDArray_initVa_(T)(this, w_AllocPolicy_default(), shapeSize, shape);        \
+        va_end(shape);                                                                \
+    }
+
+// 多维数组按内存分配策略初始化
+#define w_NDArray_initWithPolicy(T) w_concat(w_NDArray(T), _initWithPolicy)
+#define w_NDArray_initWithPolicy_define_(T)                                                                           \
+    /**                                                                                                               \
+     * 多维数组按内存分配策略初始化                                                                     \
+     * @param this 多维数组                                                                                       \
+     * @param policy 内存分配策略（对齐、大页、NUMA）                                                   \
+     * @param shapeSize 形状大小                                                                                  \
+     * @param ... 形状（必须传入 int64 类型，否则会报错）                                             \
+     * @return void                                                                                                   \
+     */                                                                                                               \
+    static inline void w_NDArray_initWithPolicy(T)(w_NDArray(T) * this, w_AllocPolicy policy, int64_t shapeSize, ...) \
+    {                                                                                                                 \
+        va_list shape;                                                                                                \
+        va_start(shape, shapeSize);                                                                                   \
+        w_NDArray_initVa_(T)(this, policy, shapeSize, shape);                                                         \
+        va_end(shape);                                                                                                \
+    }
+
+// 多维数组按形状数组和内存分配策略初始化
+#define w_NDArray_initShapeWithPolicy(T) w_concat(w_NDArray(T), _initShapeWithPolicy)
+#define w_NDArray_initShapeWithPolicy_define_(T)                                                                                            \
+    /**                                                                                                                                     \
+     * 多维数组按形状数组和内存分配策略初始化                                                                            \
+     * @param this 多维数组                                                                                                             \
+     * @param policy 内存分配策略                                                                                                     \
+     * @param shape 形状数组                                                                                                            \
+     * @param shapeSize 形状大小                                                                                                        \
+     * @return void                                                                                                                         \
+     */                                                                                                                                     \
+    static inline void w_NDArray_initShapeWithPolicy(T)(w_NDArray(T) * this, w_AllocPolicy policy, const int64_t *shape, int64_t shapeSize) \
+    {                                                                                                                                       \
+        w_check(shape != NULL);                                                                                                             \
+        w_NDArray_allocShape_(T)(this, shapeSize);                                                                                          \
+        memcpy(this->shape, shape, sizeof(int64_t) * shapeSize);                                                                            \
+        w_NDArray_initLayout_(T)(this, policy);                                                                                             \
+    }
+
+// 多维数组按形状数组初始化
+#define w_NDArray_initShape(T) w_concat(w_NDArray(T), _initShape)
+#define w_NDArray_initShape_define_(T)                                                                      \
+    /**                                                                                                     \
+     * 多维数组按形状数组初始化                                                                 \
+     * @param this 多维数组                                                                             \
+     * @param shape 形状数组                                                                            \
+     * @param shapeSize 形状大小                                                                        \
+     * @return void                                                                                         \
+     */                                                                                                     \
+    static inline void w_NDArray_initShape(T)(w_NDArray(T) * this, const int64_t *shape, int64_t shapeSize) \
+    {                                                                                                       \
+        w_NDArray_initShapeWithPolicy(T)(this, w_AllocPolicy_default(), shape, shapeSize);                  \
+    }
+
+// 多维数组销毁
+#define w_NDArray_deinit(T) w_concat(w_NDArray(T), _deinit)
+#define w_NDArray_deinit_define_(T)                                                    \
+    /**                                                                                \
+     * 多维数组销毁                                                              \
+     * @param this 多维数组                                                        \
+     * @return void                                                                    \
+     */                                                                                \
+    static inline void w_NDArray_deinit(T)(w_NDArray(T) * this)                        \
+    {                                                                                  \
+        w_check(this != NULL);                                                         \
+        w_check(this->elementData != NULL);                                            \
+        w_check(this->shape != NULL);                                                  \
+        w_AllocPolicy_free_(&this->policy, this->elementData, this->size * sizeof(T)); \
+        w_free(this->shape);                                                           \
+        memset(this, 0, sizeof(w_NDArray(T)));                                         \
+    }
+
+// 多维数组下标映射
+#define w_NDArray_map_(T) w_concat(w_NDArray(T), _map_)
+#define w_NDArray_map_define_(T)                                                  \
+    /**                                                                           \
+     * 多维数组下标映射                                                   \
+     * @param this 多维数组                                                   \
+     * @param indices 索引（必须传入 int64 类型，否则会报错）     \
+     * @return int64_t 索引                                                     \
+     */                                                                           \
+    static inline int64_t w_NDArray_map_(T)(w_NDArray(T) * this, va_list indices) \
+    {                                                                             \
+        w_check(this != NULL);                                                    \
+        w_check(this->shape != NULL);                                             \
+        w_check(this->shapeSize > 0);                                             \
+        w_check(this->elementData != NULL);                                       \
+                                                                                  \
+        /* 计算索引 */                                                            \
+        int64_t index = 0;                                                        \
+        for (int64_t i = 0; i < this->shapeSize; i++)                             \
+        {                                                                         \
+            int64_t index_ = va_arg(indices, int64_t);                            \
+            w_checkIndex(index_ >= 0 && index_ < this->shape[i]);                 \
+            index += index_ * this->strides[i];                                   \
+        }                                                                         \
+                                                                                  \
+        /* 返回索引 */                                                            \
+        return index;                                                             \
+    }
+
+// 多维数组获取元素
+#define w_NDArray_get(T) w_concat(w_NDArray(T), _get)
+#define w_NDArray_get_define_(T)                                          \
+    /**                                                                   \
+     * 多维数组获取元素                                           \
+     * @param this 多维数组                                           \
+     * @param ... 索引（必须传入 int64 类型，否则会报错） \
+     * @return T 元素                                                   \
+     */                                                                   \
+    static inline T w_NDArray_get(T)(w_NDArray(T) * this, ...)            \
+    { /* 返回 */                                                          \
+        va_list indices;                                                  \
+        va_start(indices, this);                                          \
+        int64_t index = w_NDArray_map_(T)(this, indices);                 \
+        va_end(indices);                                                  \
+        return this->elementData[index];                                  \
+    }
+
+// 多维数组设置元素
+#define w_NDArray_set(T) w_concat(w_NDArray(T), _set)
+#define w_NDArray_set_define_(T)                                           \
+    /**                                                                    \
+     * 多维数组设置元素                                            \
+     * @param this 多维数组                                            \
+     * @param value 值                                                    \
+     * @param ... 索引（必须传入 int64 类型，否则会报错）  \
+     * @return void                                                        \
+     */                                                                    \
+    static inline void w_NDArray_set(T)(w_NDArray(T) * this, T value, ...) \
+    { /* 设置 */                                                           \
+        va_list indices;                                                   \
+        va_start(indices, value);                                          \
+        int64_t index = w_NDArray_map_(T)(this, indices);                  \
+        va_end(indices);                                                   \
+        this->elementData[index] = value;                                  \
+    }
+
+// 多维数组获取元素指针
+#define w_NDArray_ptr(T) w_concat(w_NDArray(T), _ptr)
+#define w_NDArray_ptr_define_(T)                                                   \
+    /**                                                                            \
+     * 多维数组获取元素指针                                              \
+     * @param this 多维数组                                                    \
+     * @param indices 索引数组（长度为 shapeSize）                        \
+     * @return T * 元素指针                                                    \
+     */                                                                            \
+    static inline T *w_NDArray_ptr(T)(w_NDArray(T) * this, const int64_t *indices) \
+    {                                                                              \
+        w_check(this != NULL);                                                     \
+        w_check(indices != NULL);                                                  \
+        int64_t index = 0;                                                         \
+        for (int64_t i = 0; i < this->shapeSize; i++)                              \
+        {                                                                          \
+            w_checkIndex(indices[i] >= 0 && indices[i] < this->shape[i]);          \
+            index += indices[i] * this->strides[i];                                \
+        }                                                                          \
+        return this->elementData + index;                                          \
+    }
+
+// 多维数组获取元素指针（不检查）
+#define w_NDArray_ptrUnchecked(T) w_concat(w_NDArray(T), _ptrUnchecked)
+#define w_NDArray_ptrUnchecked_define_(T)                                                          \
+    /**                                                                                            \
+     * 多维数组获取元素指针，不受检查级别影响，始终不做任何检查        \
+     * @param this 多维数组                                                                    \
+     * @param indices 索引数组（长度为 shapeSize，调用者保证每一维都不越界） \
+     * @return T * 元素指针                                                                    \
+     */                                                                                            \
+    static inline T *w_NDArray_ptrUnchecked(T)(w_NDArray(T) * this, const int64_t *indices)        \
+    {                                                                                              \
+        int64_t index = 0;                                                                         \
+        for (int64_t i = 0; i < this->shapeSize; i++)                                              \
+        {                                                                                          \
+            index += indices[i] * this->strides[i];                                                \
+        }                                                                                          \
+        return this->elementData + index;                                                          \
+    }
+
+// 二维数组获取元素
+#define w_NDArray_get2(T) w_concat(w_NDArray(T), _get2)
+#define w_NDArray_get2_define_(T)                                                      \
+    /**                                                                                \
+     * 二维数组获取元素（不经过可变参数）                             \
+     * @param this 多维数组（shapeSize 必须为 2）                             \
+     * @param i 第 0 维索引                                                        \
+     * @param j 第 1 维索引                                                        \
+     * @return T 元素                                                                \
+     */                                                                                \
+    static inline T w_NDArray_get2(T)(const w_NDArray(T) * this, int64_t i, int64_t j) \
+    {                                                                                  \
+        w_check(this != NULL && this->shapeSize == 2);                                 \
+        w_checkIndex(i >= 0 && i < this->shape[0]);                                    \
+        w_checkIndex(j >= 0 && j < this->shape[1]);                                    \
+        return this->elementData[i * this->strides[0] + j];                            \
+    }
+
+// 二维数组设置元素
+#define w_NDArray_set2(T) w_concat(w_NDArray(T), _set2)
+#define w_NDArray_set2_define_(T)                                                            \
+    /**                                                                                      \
+     * 二维数组设置元素（不经过可变参数）                                   \
+     * @param this 多维数组（shapeSize 必须为 2）                                   \
+     * @param i 第 0 维索引                                                              \
+     * @param j 第 1 维索引                                                              \
+     * @param value 值                                                                      \
+     * @return void                                                                          \
+     */                                                                                      \
+    static inline void w_NDArray_set2(T)(w_NDArray(T) * this, int64_t i, int64_t j, T value) \
+    {                                                                                        \
+        w_check(this != NULL && this->shapeSize == 2);                                       \
+        w_checkIndex(i >= 0 && i < this->shape[0]);                                          \
+        w_checkIndex(j >= 0 && j < this->shape[1]);                                          \
+        this->elementData[i * this->strides[0] + j] = value;                                 \
+    }
+
+// 二维数组获取元素（不检查）
+#define w_NDArray_get2Unchecked(T) w_concat(w_NDArray(T), _get2Unchecked)
+#define w_NDArray_get2Unchecked_define_(T)                                                      \
+    /**                                                                                         \
+     * 二维数组获取元素，不受检查级别影响，始终不做任何检查           \
+     * @param this 多维数组（调用者保证 shapeSize 为 2）                            \
+     * @param i 第 0 维索引（调用者保证不越界）                                   \
+     * @param j 第 1 维索引（调用者保证不越界）                                   \
+     * @return T 元素                                                                         \
+     */                                                                                         \
+    static inline T w_NDArray_get2Unchecked(T)(const w_NDArray(T) * this, int64_t i, int64_t j) \
+    {                                                                                           \
+        return this->elementData[i * this->strides[0] + j];                                     \
+    }
+
+// 二维数组设置元素（不检查）
+#define w_NDArray_set2Unchecked(T) w_concat(w_NDArray(T), _set2Unchecked)
+#define w_NDArray_set2Unchecked_define_(T)                                                            \
+    /**                                                                                               \
+     * 二维数组设置元素，不受检查级别影响，始终不做任何检查                 \
+     * @param this 多维数组（调用者保证 shapeSize 为 2）                                  \
+     * @param i 第 0 维索引（调用者保证不越界）                                         \
+     * @param j 第 1 维索引（调用者保证不越界）                                         \
+     * @param value 值                                                                               \
+     * @return void                                                                                   \
+     */                                                                                               \
+    static inline void w_NDArray_set2Unchecked(T)(w_NDArray(T) * this, int64_t i, int64_t j, T value) \
+    {                                                                                                 \
+        this->elementData[i * this->strides[0] + j] = value;                                          \
+    }
+
+// 三维数组获取元素
+#define w_NDArray_get3(T) w_concat(w_NDArray(T), _get3)
+#define w_NDArray_get3_define_(T)                                                                 \
+    /**                                                                                           \
+     * 三维数组获取元素（不经过可变参数）                                        \
+     * @param this 多维数组（shapeSize 必须为 3）                                        \
+     * @param i 第 0 维索引                                                                   \
+     * @param j 第 1 维索引                                                                   \
+     * @param k 第 2 维索引                                                                   \
+     * @return T 元素                                                                           \
+     */                                                                                           \
+    static inline T w_NDArray_get3(T)(const w_NDArray(T) * this, int64_t i, int64_t j, int64_t k) \
+    {                                                                                             \
+        w_check(this != NULL && this->shapeSize == 3);                                            \
+        w_checkIndex(i >= 0 && i < this->shape[0]);                                               \
+        w_checkIndex(j >= 0 && j < this->shape[1]);                                               \
+        w_checkIndex(k >= 0 && k < this->shape[2]);                                               \
+        return this->elementData[i * this->strides[0] + j * this->strides[1] + k];                \
+    }
+
+// 三维数组设置元素
+#define w_NDArray_set3(T) w_concat(w_NDArray(T), _set3)
+#define w_NDArray_set3_define_(T)                                                                       \
+    /**                                                                                                 \
+     * 三维数组设置元素（不经过可变参数）                                              \
+     * @param this 多维数组（shapeSize 必须为 3）                                              \
+     * @param i 第 0 维索引                                                                         \
+     * @param j 第 1 维索引                                                                         \
+     * @param k 第 2 维索引                                                                         \
+     * @param value 值                                                                                 \
+     * @return void                                                                                     \
+     */                                                                                                 \
+    static inline void w_NDArray_set3(T)(w_NDArray(T) * this, int64_t i, int64_t j, int64_t k, T value) \
+    {                                                                                                   \
+        w_check(this != NULL && this->shapeSize == 3);                                                  \
+        w_checkIndex(i >= 0 && i < this->shape[0]);                                                     \
+        w_checkIndex(j >= 0 && j < this->shape[1]);                                                     \
+        w_checkIndex(k >= 0 && k < this->shape[2]);                                                     \
+        this->elementData[i * this->strides[0] + j * this->strides[1] + k] = value;                     \
+    }
+
+// 四维数组获取元素
+#define w_NDArray_get4(T) w_concat(w_NDArray(T), _get4)
+#define w_NDArray_get4_define_(T)                                                                            \
+    /**                                                                                                      \
+     * 四维数组获取元素（不经过可变参数）                                                   \
+     * @param this 多维数组（shapeSize 必须为 4）                                                   \
+     * @param i 第 0 维索引                                                                              \
+     * @param j 第 1 维索引                                                                              \
+     * @param k 第 2 维索引                                                                              \
+     * @param l 第 3 维索引                                                                              \
+     * @return T 元素                                                                                      \
+     */                                                                                                      \
+    static inline T w_NDArray_get4(T)(const w_NDArray(T) * this, int64_t i, int64_t j, int64_t k, int64_t l) \
+    {                                                                                                        \
+        w_check(this != NULL && this->shapeSize == 4);                                                       \
+        w_checkIndex(i >= 0 && i < this->shape[0]);                                                          \
+        w_checkIndex(j >= 0 && j < this->shape[1]);                                                          \
+        w_checkIndex(k >= 0 && k < this->shape[2]);                                                          \
+        w_checkIndex(l >= 0 && l < this->shape[3]);                                                          \
+        return this->elementData[i * this->strides[0] + j * this->strides[1] + k * this->strides[2] + l];    \
+    }
+
+// 四维数组设置元素
+#define w_NDArray_set4(T) w_concat(w_NDArray(T), _set4)
+#define w_NDArray_set4_define_(T)                                                                                  \
+    /**                                                                                                            \
+     * 四维数组设置元素（不经过可变参数）                                                         \
+     * @param this 多维数组（shapeSize 必须为 4）                                                         \
+     * @param i 第 0 维索引                                                                                    \
+     * @param j 第 1 维索引                                                                                    \
+     * @param k 第 2 维索引                                                                                    \
+     * @param l 第 3 维索引                                                                                    \
+     * @param value 值                                                                                            \
+     * @return void                                                                                                \
+     */                                                                                                            \
+    static inline void w_NDArray_set4(T)(w_NDArray(T) * this, int64_t i, int64_t j, int64_t k, int64_t l, T value) \
+    {                                                                                                              \
+        w_check(this != NULL && this->shapeSize == 4);                                                             \
+        w_checkIndex(i >= 0 && i < this->shape[0]);                                                                \
+        w_checkIndex(j >= 0 && j < this->shape[1]);                                                                \
+        w_checkIndex(k >= 0 && k < this->shape[2]);                                                                \
+        w_checkIndex(l >= 0 && l < this->shape[3]);                                                                \
+        this->elementData[i * this->strides[0] + j * this->strides[1] + k * this->strides[2] + l] = value;         \
+    }
+
+// 多维数组获取形状
+#define w_NDArray_shape(T) w_concat(w_NDArray(T), _shape)
+#define w_NDArray_shape_define_(T)                                 \
+    /**                                                            \
+     * 多维数组获取形状                                    \
+     * @param this 多维数组                                    \
+     * @return int64_t * 形状                                    \
+     */                                                            \
+    static inline int64_t *w_NDArray_shape(T)(w_NDArray(T) * this) \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->shape != NULL);                              \
+        w_check(this->shapeSize > 0);                              \
+        w_check(this->elementData != NULL);                        \
+        return this->shape;                                        \
+    }
+
+// 多维数组获取步长
+#define w_NDArray_strides(T) w_concat(w_NDArray(T), _strides)
+#define w_NDArray_strides_define_(T)                                 \
+    /**                                                              \
+     * 多维数组获取步长                                      \
+     * @param this 多维数组                                      \
+     * @return int64_t * 步长（以元素为单位）              \
+     */                                                              \
+    static inline int64_t *w_NDArray_strides(T)(w_NDArray(T) * this) \
+    {                                                                \
+        w_check(this != NULL);                                       \
+        w_check(this->strides != NULL);                              \
+        return this->strides;                                        \
+    }
+
+// 多维数组获取形状大小
+#define w_NDArray_shapeSize(T) w_concat(w_NDArray(T), _shapeSize)
+#define w_NDArray_shapeSize_define_(T)                                \
+    /**                                                               \
+     * 多维数组获取形状大小                                 \
+     * @param this 多维数组                                       \
+     * @return int64_t 形状大小                                   \
+     */                                                               \
+    static inline int64_t w_NDArray_shapeSize(T)(w_NDArray(T) * this) \
+    {                                                                 \
+        w_check(this != NULL);                                        \
+        w_check(this->shape != NULL);                                 \
+        w_check(this->shapeSize > 0);                                 \
+        w_check(this->elementData != NULL);                           \
+        return this->shapeSize;                                       \
+    }
+
+// 多维数组获取元素总数
+#define w_NDArray_size(T) w_concat(w_NDArray(T), _size)
+#define w_NDArray_size_define_(T)                                \
+    /**                                                          \
+     * 多维数组获取元素总数                            \
+     * @param this 多维数组                                  \
+     * @return int64_t 元素总数                              \
+     */                                                          \
+    static inline int64_t w_NDArray_size(T)(w_NDArray(T) * this) \
+    {                                                            \
+        w_check(this != NULL);                                   \
+        return this->size;                                       \
+    }
+
+// 多维数组定义
+#define w_NDArray_define(T)                   \
+    w_NDArray_type_define_(T);                \
+    w_NDArray_allocShape_define_(T);          \
+    w_NDArray_initLayout_define_(T);          \
+    w_NDArray_initVa_define_(T);              \
+    w_NDArray_init_define_(T);                \
+    w_NDArray_initWithPolicy_define_(T);      \
+    w_NDArray_initShapeWithPolicy_define_(T); \
+    w_NDArray_initShape_define_(T);           \
+    w_NDArray_deinit_define_(T);              \
+    w_NDArray_map_define_(T);                 \
+    w_NDArray_get_define_(T);                 \
+    w_NDArray_set_define_(T);                 \
+    w_NDArray_ptr_define_(T);                 \
+    w_NDArray_ptrUnchecked_define_(T);        \
+    w_NDArray_get2_define_(T);                \
+    w_NDArray_set2_define_(T);                \
+    w_NDArray_get2Unchecked_define_(T);       \
+    w_NDArray_set2Unchecked_define_(T);       \
+    w_NDArray_get3_define_(T);                \
+    w_NDArray_set3_define_(T);                \
+    w_NDArray_get4_define_(T);                \
+    w_NDArray_set4_define_(T);                \
+    w_NDArray_shape_define_(T);               \
+    w_NDArray_strides_define_(T);             \
+    w_NDArray_shapeSize_define_(T);           \
+    w_NDArray_size_define_(T);
+
+// ========================================================================================================================================================
+//  多维数组视图
+// ========================================================================================================================================================
+
+// 多维数组视图支持的最大维数
+#ifndef w_NDARRAY_MAX_RANK
+#define w_NDARRAY_MAX_RANK 8
+#endif
+
+// 分块复制的块大小（元素数量）
+#define w_NDARRAY_COPY_BLOCK_ 32
+
+// 多维数组视图类型（不持有内存，按值传递）
+#define w_NDArrayView(T) w_concat(w_NDArrayView_, T)
+
+// 多维数组视图类型定义
+#define w_NDArrayView_type_define_(T)                                                      \
+    typedef struct                                                                         \
+    {                                                                                      \
+        T *elementData;                        /* 父数组的元素数据 */                      \
+        int64_t offset;                        /* 起始偏移（以元素为单位） */              \
+        int64_t shape[w_NDARRAY_MAX_RANK];     /* 形状 */                                  \
+        int64_t strides[w_NDARRAY_MAX_RANK];   /* 步长（以元素为单位，可以为 0 或负数） */ \
+        int64_t shapeSize;                                                                 \
+    } w_NDArrayView(T);
+
+// 从内存创建多维数组视图
+#define w_NDArrayView_of(T) w_concat(w_NDArrayView(T), _of)
+#define w_NDArrayView_of_define_(T)                                                                       \
+    /**                                                                                                   \
+     * 从按 C 顺序存放的内存创建多维数组视图                                             \
+     * @param data 数据                                                                                 \
+     * @param shape 形状数组                                                                          \
+     * @param shapeSize 形状大小                                                                      \
+     * @return w_NDArrayView(T) 视图                                                                    \
+     */                                                                                                   \
+    static inline w_NDArrayView(T) w_NDArrayView_of(T)(T * data, const int64_t *shape, int64_t shapeSize) \
+    {                                                                                                     \
+        w_check(shape != NULL);                                                                           \
+        w_check(shapeSize > 0 && shapeSize <= w_NDARRAY_MAX_RANK);                                        \
+        w_NDArrayView(T) view;                                                                            \
+        view.elementData = data;                                                                          \
+        view.offset = 0;                                                                                  \
+        view.shapeSize = shapeSize;                                                                       \
+        int64_t stride = 1;                                                                               \
+        for (int64_t i = shapeSize - 1; i >= 0; i--)                                                      \
+        {                                                                                                 \
+            w_check(shape[i] >= 0);                                                                       \
+            view.shape[i] = shape[i];                                                                     \
+            view.strides[i] = stride;                                                                     \
+            stride *= shape[i];                                                                           \
+        }                                                                                                 \
+        w_check(data != NULL || stride == 0);                                                             \
+        return view;                                                                                      \
+    }
+
+// 多维数组创建视图
+#define w_NDArray_view(T) w_concat(w_NDArray(T), _view)
+#define w_NDArray_view_define_(T)                                               \
+    /**                                                                         \
+     * 多维数组创建视图（数组销毁后失效）                      \
+     * @param this 多维数组                                                 \
+     * @return w_NDArrayView(T) 视图                                          \
+     */                                                                         \
+    static inline w_NDArrayView(T) w_NDArray_view(T)(w_NDArray(T) * this)       \
+    {                                                                           \
+        w_check(this != NULL);                                                  \
+        w_check(this->shapeSize <= w_NDARRAY_MAX_RANK);                         \
+        w_NDArrayView(T) view;                                                  \
+        view.elementData = this->elementData;                                   \
+        view.offset = 0;                                                        \
+        view.shapeSize = this->shapeSize;                                       \
+        memcpy(view.shape, this->shape, sizeof(int64_t) * this->shapeSize);     \
+        memcpy(view.strides, this->strides, sizeof(int64_t) * this->shapeSize); \
+        return view;                                                            \
+    }
+
+// 多维数组视图元素总数
+#define w_NDArrayView_size(T) w_concat(w_NDArrayView(T), _size)
+#define w_NDArrayView_size_define_(T)                                  \
+    /**                                                                \
+     * 多维数组视图元素总数                                  \
+     * @param view 视图                                              \
+     * @return int64_t 元素总数                                    \
+     */                                                                \
+    static inline int64_t w_NDArrayView_size(T)(w_NDArrayView(T) view) \
+    {                                                                  \
+        int64_t size = 1;                                              \
+        for (int64_t i = 0; i < view.shapeSize; i++)                   \
+        {                                                              \
+            size *= view.shape[i];                                     \
+        }                                                              \
+        return size;                                                   \
+    }
+
+// 多维数组视图获取元素指针
+#define w_NDArrayView_ptr(T) w_concat(w_NDArrayView(T), _ptr)
+#define w_NDArrayView_ptr_define_(T)                                                     \
+    /**                                                                                  \
+     * 多维数组视图获取元素指针                                              \
+     * @param view 视图                                                                \
+     * @param indices 索引数组（长度为 shapeSize）                              \
+     * @return T * 元素指针                                                          \
+     */                                                                                  \
+    static inline T *w_NDArrayView_ptr(T)(w_NDArrayView(T) view, const int64_t *indices) \
+    {                                                                                    \
+        w_check(indices != NULL);                                                        \
+        int64_t index = view.offset;                                                     \
+        for (int64_t i = 0; i < view.shapeSize; i++)                                     \
+        {                                                                                \
+            w_checkIndex(indices[i] >= 0 && indices[i] < view.shape[i]);                 \
+            index += indices[i] * view.strides[i];                                       \
+        }                                                                                \
+        return view.elementData + index;                                                 \
+    }
+
+// 多维数组视图获取元素
+#define w_NDArrayView_get(T) w_concat(w_NDArrayView(T), _get)
+#define w_NDArrayView_get_define_(T)                                                    \
+    /**                                                                                 \
+     * 多维数组视图获取元素                                                   \
+     * @param view 视图                                                               \
+     * @param indices 索引数组（长度为 shapeSize）                             \
+     * @return T 元素                                                                 \
+     */                                                                                 \
+    static inline T w_NDArrayView_get(T)(w_NDArrayView(T) view, const int64_t *indices) \
+    {                                                                                   \
+        return *w_NDArrayView_ptr(T)(view, indices);                                    \
+    }
+
+// 多维数组视图设置元素
+#define w_NDArrayView_set(T) w_concat(w_NDArrayView(T), _set)
+#define w_NDArrayView_set_define_(T)                                                                \
+    /**                                                                                             \
+     * 多维数组视图设置元素（广播出的维度共享同一个元素）                  \
+     * @param view 视图                                                                           \
+     * @param indices 索引数组（长度为 shapeSize）                                         \
+     * @param value 值                                                                             \
+     * @return void                                                                                 \
+     */                                                                                             \
+    static inline void w_NDArrayView_set(T)(w_NDArrayView(T) view, const int64_t *indices, T value) \
+    {                                                                                               \
+        *w_NDArrayView_ptr(T)(view, indices) = value;                                               \
+    }
+
+// 多维数组视图切片
+#define w_NDArrayView_slice(T) w_concat(w_NDArrayView(T), _slice)
+#define w_NDArrayView_slice_define_(T)                                                                                                    \
+    /**                                                                                                                                   \
+     * 多维数组视图在一个维度上切片 [start, stop)，不复制数据                                                         \
+     * @param view 视图                                                                                                                 \
+     * @param axis 维度                                                                                                                 \
+     * @param start 起始索引（包含）                                                                                              \
+     * @param stop 结束索引（不包含，step 为负数时可以为 -1）                                                            \
+     * @param step 步长（不能为 0，负数表示反向）                                                                           \
+     * @return w_NDArrayView(T) 切片视图                                                                                              \
+     */                                                                                                                                   \
+    static inline w_NDArrayView(T) w_NDArrayView_slice(T)(w_NDArrayView(T) view, int64_t axis, int64_t start, int64_t stop, int64_t step) \
+    {                                                                                                                                     \
+        w_check(axis >= 0 && axis < view.shapeSize);                                                                                      \
+        w_check(step != 0);                                                                                                               \
+        int64_t length;                                                                                                                   \
+        if (step > 0)                                                                                                                     \
+        {                                                                                                                                 \
+            w_checkIndex(start >= 0 && start <= stop && stop <= view.shape[axis]);                                                        \
+            length = (stop - start + step - 1) / step;                                                                                    \
+        }                                                                                                                                 \
+        else                                                                                                                              \
+        {                                                                                                                                 \
+            w_checkIndex(stop >= -1 && stop <= start && start < view.shape[axis]);                                                        \
+            length = (start - stop - step - 1) / -step;                                                                                   \
+        }                                                                                                                                 \
+        if (length > 0)                                                                                                                   \
+        {                                                                                                                                 \
+            view.offset += start * view.strides[axis];                                                                                    \
+        }                                                                                                                                 \
+        view.shape[axis] = length;                                                                                                        \
+        view.strides[axis] *= step;                                                                                                       \
+        return view;                                                                                                                      \
+    }
+
+// 多维数组视图选取
+#define w_NDArrayView_select(T) w_concat(w_NDArrayView(T), _select)
+#define w_NDArrayView_select_define_(T)                                                                        \
+    /**                                                                                                        \
+     * 多维数组视图固定一个维度的索引，结果少一维，不复制数据                       \
+     * @param view 视图（shapeSize 必须大于 1）                                                        \
+     * @param axis 维度                                                                                      \
+     * @param index 索引                                                                                     \
+     * @return w_NDArrayView(T) 降维后的视图                                                             \
+     */                                                                                                        \
+    static inline w_NDArrayView(T) w_NDArrayView_select(T)(w_NDArrayView(T) view, int64_t axis, int64_t index) \
+    {                                                                                                          \
+        w_check(view.shapeSize > 1);                                                                           \
+        w_check(axis >= 0 && axis < view.shapeSize);                                                           \
+        w_checkIndex(index >= 0 && index < view.shape[axis]);                                                  \
+        view.offset += index * view.strides[axis];                                                             \
+        for (int64_t i = axis; i < view.shapeSize - 1; i++)                                                    \
+        {                                                                                                      \
+            view.shape[i] = view.shape[i + 1];                                                                 \
+            view.strides[i] = view.strides[i + 1];                                                             \
+        }                                                                                                      \
+        view.shapeSize--;                                                                                      \
+        return view;                                                                                           \
+    }
+
+// 多维数组视图维度重排
+#define w_NDArrayView_permute(T) w_concat(w_NDArrayView(T), _permute)
+#define w_NDArrayView_permute_define_(T)                                                                \
+    /**                                                                                                 \
+     * 多维数组视图维度重排，不复制数据                                                 \
+     * @param view 视图                                                                               \
+     * @param axes 新维度顺序（长度为 shapeSize，第 i 维取原来的第 axes[i] 维）      \
+     * @return w_NDArrayView(T) 重排后的视图                                                      \
+     */                                                                                                 \
+    static inline w_NDArrayView(T) w_NDArrayView_permute(T)(w_NDArrayView(T) view, const int64_t *axes) \
+    {                                                                                                   \
+        w_check(axes != NULL);                                                                          \
+        w_NDArrayView(T) result = view;                                                                 \
+        uint64_t seen = 0;                                                                              \
+        for (int64_t i = 0; i < view.shapeSize; i++)                                                    \
+        {                                                                                               \
+            w_check(axes[i] >= 0 && axes[i] < view.shapeSize);                                          \
+            w_check((seen & ((uint64_t)1 << axes[i])) == 0);                                            \
+            seen |= (uint64_t)1 << axes[i];                                                             \
+            result.shape[i] = view.shape[axes[i]];                                                      \
+            result.strides[i] = view.strides[axes[i]];                                                  \
+        }                                                                                               \
+        return result;                                                                                  \
+    }
+
+// 多维数组视图转置
+#define w_NDArrayView_transpose(T) w_concat(w_NDArrayView(T), _transpose)
+#define w_NDArrayView_transpose_define_(T)                                           \
+    /**                                                                              \
+     * 多维数组视图转置（反转所有维度），不复制数据            \
+     * @param view 视图                                                            \
+     * @return w_NDArrayView(T) 转置后的视图                                   \
+     */                                                                              \
+    static inline w_NDArrayView(T) w_NDArrayView_transpose(T)(w_NDArrayView(T) view) \
+    {                                                                                \
+        w_NDArrayView(T) result = view;                                              \
+        for (int64_t i = 0; i < view.shapeSize; i++)                                 \
+        {                                                                            \
+            result.shape[i] = view.shape[view.shapeSize - 1 - i];                    \
+            result.strides[i] = view.strides[view.shapeSize - 1 - i];                \
+        }                                                                            \
+        return result;                                                               \
+    }
+
+// 多维数组视图是否连续
+#define w_NDArrayView_isContiguous(T) w_concat(w_NDArrayView(T), _isContiguous)
+#define w_NDArrayView_isContiguous_define_(T)                               \
+    /**                                                                     \
+     * 多维数组视图是否按 C 顺序连续存放                     \
+     * @param view 视图                                                   \
+     * @return bool 是否连续                                            \
+     */                                                                     \
+    static inline bool w_NDArrayView_isContiguous(T)(w_NDArrayView(T) view) \
+    {                                                                       \
+        int64_t stride = 1;                                                 \
+        for (int64_t i = view.shapeSize - 1; i >= 0; i--)                   \
+        {                                                                   \
+            if (view.shape[i] == 0)                                         \
+            {                                                               \
+                return true;                                                \
+            }                                                               \
+            /* 长度为 1 的维度不影响布局 */                                 \
+            if (view.shape[i] != 1 && view.strides[i] != stride)            \
+            {                                                               \
+                return false;                                               \
+            }                                                               \
+            stride *= view.shape[i];                                        \
+        }                                                                   \
+        return true;                                                        \
+    }
+
+// 多维数组视图改变形状
+#define w_NDArrayView_reshape(T) w_concat(w_NDArrayView(T), _reshape)
+#define w_NDArrayView_reshape_define_(T)                                                                                    \
+    /**                                                                                                                     \
+     * 多维数组视图改变形状，不复制数据                                                                     \
+     * @param view 视图（必须连续，否则先调用 contiguous）                                                    \
+     * @param shape 新形状数组（元素总数必须不变）                                                           \
+     * @param shapeSize 新形状大小                                                                                     \
+     * @return w_NDArrayView(T) 新形状的视图                                                                          \
+     */                                                                                                                     \
+    static inline w_NDArrayView(T) w_NDArrayView_reshape(T)(w_NDArrayView(T) view, const int64_t *shape, int64_t shapeSize) \
+    {                                                                                                                       \
+        w_check(w_NDArrayView_isContiguous(T)(view));                                                                       \
+        w_check(shape != NULL);                                                                                             \
+        w_check(shapeSize > 0 && shapeSize <= w_NDARRAY_MAX_RANK);                                                          \
+        w_NDArrayView(T) result = view;                                                                                     \
+        result.shapeSize = shapeSize;                                                                                       \
+        int64_t stride = 1;                                                                                                 \
+        for (int64_t i = shapeSize - 1; i >= 0; i--)                                                                        \
+        {                                                                                                                   \
+            w_check(shape[i] >= 0);                                                                                         \
+            result.shape[i] = shape[i];                                                                                     \
+            result.strides[i] = stride;                                                                                     \
+            stride *= shape[i];                                                                                             \
+        }                                                                                                                   \
+        w_check(stride == w_NDArrayView_size(T)(view));                                                                     \
+        return result;                                                                                                      \
+    }
+
+// 多维数组视图广播
+#define w_NDArrayView_broadcast(T) w_concat(w_NDArrayView(T), _broadcast)
+#define w_NDArrayView_broadcast_define_(T)                                                                                     \
+    /**                                                                                                                        \
+     * 多维数组视图广播到指定形状（从最后一维对齐，长度为 1 的维度步长置 0），不复制数据 \
+     * @param view 视图                                                                                                      \
+     * @param shape 目标形状数组                                                                                         \
+     * @param shapeSize 目标形状大小（不能小于视图的维数）                                                    \
+     * @return w_NDArrayView(T) 广播后的视图                                                                             \
+     */                                                                                                                        \
+    static inline w_NDArrayView(T) w_NDArrayView_broadcast(T)(w_NDArrayView(T) view, const int64_t *shape, int64_t shapeSize)  \
+    {                                                                                                                          \
+        w_check(shape != NULL);                                                                                                \
+        w_check(shapeSize >= view.shapeSize && shapeSize <= w_NDARRAY_MAX_RANK);                                               \
+        w_NDArrayView(T) result = view;                                                                                        \
+        result.shapeSize = shapeSize;                                                                                          \
+        for (int64_t i = shapeSize - 1; i >= 0; i--)                                                                           \
+        {                                                                                                                      \
+            int64_t axis = i - (shapeSize - view.shapeSize);                                                                   \
+            result.shape[i] = shape[i];                                                                                        \
+            if (axis >= 0 && view.shape[axis] == shape[i])                                                                     \
+            {                                                                                                                  \
+                result.strides[i] = view.strides[axis];                                                                        \
+            }                                                                                                                  \
+            else                                                                                                               \
+            {                                                                                                                  \
+                w_check(axis < 0 || view.shape[axis] == 1);                                                                    \
+                result.strides[i] = 0;                                                                                         \
+            }                                                                                                                  \
+        }                                                                                                                      \
+        return result;                                                                                                         \
+    }
+
+// 多维数组视图复制到连续内存
+#define w_NDArrayView_copyTo_(T) w_concat(w_NDArrayView(T), _copyTo_)
+#define w_NDArrayView_copyTo_define_(T)                                                                         \
+    /**                                                                                                         \
+     * 多维数组视图按 C 顺序复制到连续内存                                                      \
+     * 最后两维分块复制，转置等列步长不为 1 的视图读写都能留在缓存中               \
+     * @param view 视图                                                                                       \
+     * @param data 目标内存（至少 size 个元素）                                                      \
+     * @return void                                                                                             \
+     */                                                                                                         \
+    static inline void w_NDArrayView_copyTo_(T)(w_NDArrayView(T) view, T * data)                                \
+    {                                                                                                           \
+        int64_t rank = view.shapeSize;                                                                          \
+        int64_t rows = rank >= 2 ? view.shape[rank - 2] : 1;                                                    \
+        int64_t rowStride = rank >= 2 ? view.strides[rank - 2] : 0;                                             \
+        int64_t cols = view.shape[rank - 1];                                                                    \
+        int64_t colStride = view.strides[rank - 1];                                                             \
+        int64_t outer = 1;                                                                                      \
+        for (int64_t i = 0; i < rank - 2; i++)                                                                  \
+        {                                                                                                       \
+            outer *= view.shape[i];                                                                             \
+        }                                                                                                       \
+        if (outer == 0 || rows == 0 || cols == 0)                                                               \
+        {                                                                                                       \
+            return;                                                                                             \
+        }                                                                                                       \
+                                                                                                                \
+        int64_t indices[w_NDARRAY_MAX_RANK] = {0};                                                              \
+        for (int64_t n = 0; n < outer; n++)                                                                     \
+        {                                                                                                       \
+            const T *source = view.elementData + view.offset;                                                   \
+            for (int64_t i = 0; i < rank - 2; i++)                                                              \
+            {                                                                                                   \
+                source += indices[i] * view.strides[i];                                                         \
+            }                                                                                                   \
+                                                                                                                \
+            if (colStride == 1)                                                                                 \
+            { /* 行内连续，逐行复制 */                                                                          \
+                for (int64_t r = 0; r < rows; r++)                                                              \
+                {                                                                                               \
+                    memcpy(data + r * cols, source + r * rowStride, sizeof(T) * cols);                          \
+                }                                                                                               \
+            }                                                                                                   \
+            else                                                                                                \
+            { /* 分块复制 */                                                                                    \
+                for (int64_t rb = 0; rb < rows; rb += w_NDARRAY_COPY_BLOCK_)                                    \
+                {                                                                                               \
+                    int64_t rowEnd = rb + w_NDARRAY_COPY_BLOCK_ < rows ? rb + w_NDARRAY_COPY_BLOCK_ : rows;     \
+                    for (int64_t cb = 0; cb < cols; cb += w_NDARRAY_COPY_BLOCK_)                                \
+                    {                                                                                           \
+                        int64_t colEnd = cb + w_NDARRAY_COPY_BLOCK_ < cols ? cb + w_NDARRAY_COPY_BLOCK_ : cols; \
+                        for (int64_t r = rb; r < rowEnd; r++)                                                   \
+                        {                                                                                       \
+                            for (int64_t c = cb; c < colEnd; c++)                                               \
+                            {                                                                                   \
+                                data[r * cols + c] = source[r * rowStride + c * colStride];                     \
+                            }                                                                                   \
+                        }                                                                                       \
+                    }                                                                                           \
+                }                                                                                               \
+            }                                                                                                   \
+            data += rows * cols;                                                                                \
+                                                                                                                \
+            /* 前面的维度进位 */                                                                                \
+            for (int64_t i = rank - 3; i >= 0; i--)                                                             \
+            {                                                                                                   \
+                if (++indices[i] < view.shape[i])                                                               \
+                {                                                                                               \
+                    break;                                                                                      \
+                }                                                                                               \
+                indices[i] = 0;                                                                                 \
+            }                                                                                                   \
+        }                                                                                                       \
+    }
+
+// 多维数组视图复制为连续的多维数组
+#define w_NDArrayView_contiguous(T) w_concat(w_NDArrayView(T), _contiguous)
+#define w_NDArrayView_contiguous_define_(T)                                                     \
+    /**                                                                                         \
+     * 多维数组视图复制为新的连续多维数组                                      \
+     * @param view 视图                                                                       \
+     * @param array 未初始化的多维数组（使用后需要调用 w_NDArray_deinit）     \
+     * @return void                                                                             \
+     */                                                                                         \
+    static inline void w_NDArrayView_contiguous(T)(w_NDArrayView(T) view, w_NDArray(T) * array) \
+    {                                                                                           \
+        w_check(array != NULL);                                                                 \
+        w_NDArray_initShape(T)(array, view.shape, view.shapeSize);                              \
+        w_NDArrayView_copyTo_(T)(view, array->elementData);                                     \
+    }
+
+// 多维数组视图定义（需要先定义 w_NDArray_define）
+#define w_NDArrayView_define(T)            \
+    w_NDArrayView_type_define_(T);         \
+    w_NDArrayView_of_define_(T);           \
+    w_NDArray_view_define_(T);             \
+    w_NDArrayView_size_define_(T);         \
+    w_NDArrayView_ptr_define_(T);          \
+    w_NDArrayView_get_define_(T);          \
+    w_NDArrayView_set_define_(T);          \
+    w_NDArrayView_slice_define_(T);        \
+    w_NDArrayView_select_define_(T);       \
+    w_NDArrayView_permute_define_(T);      \
+    w_NDArrayView_transpose_define_(T);    \
+    w_NDArrayView_isContiguous_define_(T); \
+    w_NDArrayView_reshape_define_(T);      \
+    w_NDArrayView_broadcast_define_(T);    \
+    w_NDArrayView_copyTo_define_(T);       \
+    w_NDArrayView_contiguous_define_(T);
+
+// ========================================================================================================================================================
+//  多维数组文件
+// ========================================================================================================================================================
+
+// NPY 文件魔数
+#define w_NPY_MAGIC_ "\x93NUMPY"
+
+// NPY 文件魔数和版本号的字节数
+#define w_NPY_MAGIC_SIZE_ 8
+
+// NPY 文件头部对齐字节数（元素数据从该字节数的倍数开始）
+#define w_NPY_ALIGNMENT_ 64
+
+// NPY 文件头部字典的最小字节数（"{}\n"）
+#define w_NPY_MIN_HEADER_ 3
+
+// NPY 文件头部字典的最大字节数
+#define w_NPY_MAX_HEADER_ ((int64_t)1 << 20)
+
+// NPY 文件读写的分块字节数（按页对齐，不经过 stdio 缓冲区）
+#define w_NPY_CHUNK_ ((int64_t)8 * 1024 * 1024)
+
+// NPY 元素类型
+typedef struct
+{
+    char byteOrder;   /* 字节序：'<' 小端 '>' 大端 '|' 单字节 */
+    char kind;        /* 类别：'f' 浮点数 'i' 有符号整数 'u' 无符号整数 */
+    int64_t itemSize; /* 元素字节数 */
+} w_NpyDtype_;
+
+/**
+ * 本机字节序
+ * @return char '<' 小端 '>' 大端
+ */
+static inline char w_npyByteOrder_(void)
+{
+    uint16_t value = 1;
+    return *(uint8_t *)&value == 1 ? '<' : '>';
+}
+
+/**
+ * 解析 NPY 文件的魔数、版本号和头部字典长度
+ * @param prefix 文件开头的字节
+ * @param available prefix 的字节数
+ * @param dictOffset 头部字典的起始位置（输出）
+ * @param dictSize 头部字典的字节数（输出）
+ * @return bool 是否为支持的 NPY 文件（版本 1.0 ~ 3.0）
+ */
+static inline bool w_npyParsePrefix_(const uint8_t *prefix, int64_t available, int64_t *dictOffset, int64_t *dictSize)
+{
+    if (available < w_NPY_MAGIC_SIZE_ + 4 || memcmp(prefix, w_NPY_MAGIC_, 6) != 0)
+    {
+        return false;
+    }
+    /* 版本 1.0 的长度为 2 字节，版本 2.0 和 3.0 为 4 字节，都是小端 */
+    if (prefix[6] == 1)
+    {
+        *dictOffset = w_NPY_MAGIC_SIZE_ + 2;
+        *dictSize = prefix[8] | (int64_t)prefix[9] << 8;
+    }
+    else if (prefix[6] == 2 || prefix[6] == 3)
+    {
+        *dictOffset = w_NPY_MAGIC_SIZE_ + 4;
+        *dictSize = prefix[8] | (int64_t)prefix[9] << 8 | (int64_t)prefix[10] << 16 | (int64_t)prefix[11] << 24;
+    }
+    else
+    {
+        return false;
+    }
+    /* 读取前缀时已经预读了字典的前几个字节，字典不能比它们更短 */
+    return *dictSize >= w_NPY_MIN_HEADER_ && *dictSize >= w_NPY_MAGIC_SIZE_ + 4 - *dictOffset && *dictSize <= w_NPY_MAX_HEADER_;
+}
+
+/**
+ * 查找 NPY 头部字典中的键，返回值的起始位置
+ * @param dict 头部字典（以 '\0' 结尾）
+ * @param key 键
+ * @return const char * 值的起始位置（跳过冒号和空白），找不到时返回 NULL
+ */
+static inline const char *w_npyFindKey_(const char *dict, const char *key)
+{
+    const char *position = strstr(dict, key);
+    if (position == NULL)
+    {
+        return NULL;
+    }
+    position += strlen(key);
+    while (*position == '\'' || *position == '"' || *position == ' ')
+    {
+        position++;
+    }
+    if (*position++ != ':')
+    {
+        return NULL;
+    }
+    while (*position == ' ')
+    {
+        position++;
+    }
+    return position;
+}
+
+/**
+ * 解析 NPY 头部字典
+ * @param dict 头部字典
+ * @param dictSize 头部字典的字节数
+ * @param dtype 元素类型（输出）
+ * @param fortranOrder 是否为 Fortran 顺序（输出）
+ * @param shape 形状（输出，最多 w_NDARRAY_MAX_RANK 维）
+ * @param shapeSize 形状大小（输出，0 表示标量）
+ * @return bool 是否解析成功
+ */
+static inline bool w_npyParseHeader_(const uint8_t *dict, int64_t dictSize, w_NpyDtype_ *dtype, bool *fortranOrder, int64_t *shape, int64_t *shapeSize)
+{
+    char *text = w_malloc(dictSize + 1);
+    w_assert(text != NULL);
+    memcpy(text, dict, dictSize);
+    text[dictSize] = '\0';
+    bool success = false;
+    const char *value;
+    char *end;
+
+    /* 'descr': '<f8' */
+    value = w_npyFindKey_(text, "descr");
+    if (value == NULL || (*value != '\'' && *value != '"'))
+    {
+        goto done;
+    }
+    dtype->byteOrder = value[1] == '=' ? w_npyByteOrder_() : value[1];
+    dtype->kind = value[2];
+    dtype->itemSize = strtoll(value + 3, &end, 10);
+    if (strchr("<>|", dtype->byteOrder) == NULL || strchr("biuf", dtype->kind) == NULL || end == value + 3 || *end != value[0])
+    {
+        goto done;
+    }
+
+    /* 'fortran_order': False */
+    value = w_npyFindKey_(text, "fortran_order");
+    if (value == NULL || (strncmp(value, "True", 4) != 0 && strncmp(value, "False", 5) != 0))
+    {
+        goto done;
+    }
+    *fortranOrder = *value == 'T';
+
+    /* 'shape': (3, 4) */
+    value = w_npyFindKey_(text, "shape");
+    if (value == NULL || *value++ != '(')
+    {
+        goto done;
+    }
+    *shapeSize = 0;
+    while (true)
+    {
+        while (*value == ' ' || *value == ',')
+        {
+            value++;
+        }
+        if (*value == ')')
+        {
+            break;
+        }
+        int64_t length = strtoll(value, &end, 10);
+        if (end == value || length < 0 || *shapeSize >= w_NDARRAY_MAX_RANK)
+        {
+            goto done;
+        }
+        shape[(*shapeSize)++] = length;
+        value = end;
+    }
+    success = true;
+done:
+    w_free(text);
+    return success;
+}
+
+/**
+ * 生成 NPY 文件头部（魔数、版本号和头部字典，总长度按 w_NPY_ALIGNMENT_ 对齐）
+ * @param dtype 元素类型
+ * @param shape 形状
+ * @param shapeSize 形状大小
+ * @param headerSize 头部字节数（输出）
+ * @return uint8_t * 头部（需要使用 w_free 释放）
+ */
+static inline uint8_t *w_npyFormatHeader_(w_NpyDtype_ dtype, const int64_t *shape, int64_t shapeSize, int64_t *headerSize)
+{
+    /* 每一维最多 20 位数字和 ", " */
+    int64_t capacity = 128 + shapeSize * 22 + w_NPY_ALIGNMENT_;
+    uint8_t *header = w_malloc(capacity);
+    w_assert(header != NULL);
+    char *dict = (char *)header + w_NPY_MAGIC_SIZE_ + 4;
+    int64_t dictSize = sprintf(dict, "{'descr': '%c%c%lld', 'fortran_order': False, 'shape': (",
+                               dtype.byteOrder, dtype.kind, (long long)dtype.itemSize);
+    for (int64_t i = 0; i < shapeSize; i++)
+    {
+        dictSize += sprintf(dict + dictSize, i == 0 ? "%lld" : ", %lld", (long long)shape[i]);
+    }
+    dictSize += sprintf(dict + dictSize, shapeSize == 1 ? ",), }" : "), }");
+
+    /* 版本 1.0 的头部长度不超过 65535 字节，否则使用版本 2.0 */
+    int64_t dictOffset = w_NPY_MAGIC_SIZE_ + 2;
+    int64_t total = (dictOffset + dictSize + 1 + w_NPY_ALIGNMENT_ - 1) / w_NPY_ALIGNMENT_ * w_NPY_ALIGNMENT_;
+    if (total - dictOffset > 65535)
+    {
+        dictOffset += 2;
+        total = (dictOffset + dictSize + 1 + w_NPY_ALIGNMENT_ - 1) / w_NPY_ALIGNMENT_ * w_NPY_ALIGNMENT_;
+    }
+    memmove(header + dictOffset, dict, dictSize);
+    memset(header + dictOffset + dictSize, ' ', total - dictOffset - dictSize - 1);
+    header[total - 1] = '\n';
+
+    memcpy(header, w_NPY_MAGIC_, 6);
+    header[6] = dictOffset == w_NPY_MAGIC_SIZE_ + 2 ? 1 : 2;
+    header[7] = 0;
+    int64_t length = total - dictOffset;
+    for (int64_t i = 0; i < dictOffset - w_NPY_MAGIC_SIZE_; i++)
+    {
+        header[w_NPY_MAGIC_SIZE_ + i] = (uint8_t)(length >> (8 * i));
+    }
+    *headerSize = total;
+    return header;
+}
+
+/**
+ * 反转每个元素的字节序
+ * @param data 数据
+ * @param count 元素数量
+ * @param itemSize 元素字节数
+ * @return void
+ */
+static inline void w_npySwapBytes_(void *data, int64_t count, int64_t itemSize)
+{
+    uint8_t *bytes = data;
+    for (int64_t i = 0; i < count; i++, bytes += itemSize)
+    {
+        for (int64_t low = 0, high = itemSize - 1; low < high; low++, high--)
+        {
+            uint8_t byte = bytes[low];
+            bytes[low] = bytes[high];
+            bytes[high] = byte;
+        }
+    }
+}
+
+/**
+ * 计算元素数量，检查溢出
+ * @param shape 形状
+ * @param shapeSize 形状大小
+ * @param itemSize 元素字节数
+ * @param count 元素数量（输出）
+ * @return bool 总字节数是否可以用 int64_t 表示
+ */
+static inline bool w_npyCount_(const int64_t *shape, int64_t shapeSize, int64_t itemSize, int64_t *count)
+{
+    *count = 1;
+    for (int64_t i = 0; i < shapeSize; i++)
+    {
+        if (shape[i] != 0 && *count > INT64_MAX / itemSize / shape[i])
+        {
+            return false;
+        }
+        *count *= shape[i];
+    }
+    return true;
+}
+
+// 多维数组的 NPY 元素类型
+#define w_NDArray_npyDtype_(T) w_concat(w_NDArray(T), _npyDtype_)
+#define w_NDArray_npyDtype_define_(T)                                                                             \
+    /**                                                                                                           \
+     * 多维数组的 NPY 元素类型（按 T 是否为 bool、浮点数、是否有符号和字节数推断） \
+     * @return w_NpyDtype_ 元素类型                                                                           \
+     */                                                                                                           \
+    static inline w_NpyDtype_ w_NDArray_npyDtype_(T)(void)                                                        \
+    {                                                                                                             \
+        w_NpyDtype_ dtype;                                                                                        \
+        dtype.byteOrder = sizeof(T) == 1 ? '|' : w_npyByteOrder_();                                               \
+        /* bool 只有 0 和 1 两个值，(T)2 == (T)1 */                                                               \
+        dtype.kind = (T)2 == (T)1 ? 'b' : (T)0.5 != 0 ? 'f' : (T)-1 > (T)0 ? 'u' : 'i';                           \
+        dtype.itemSize = sizeof(T);                                                                               \
+        return dtype;                                                                                             \
+    }
+
+// 多维数组保存为 NPY 文件
+#define w_NDArray_saveNpy(T) w_concat(w_NDArray(T), _saveNpy)
+#define w_NDArray_saveNpy_define_(T)                                                                                      \
+    /**                                                                                                                   \
+     * 多维数组保存为 NPY 文件（C 顺序，本机字节序），元素数据按 w_NPY_CHUNK_ 分块直接写入 \
+     * @param this 多维数组                                                                                           \
+     * @param path 文件路径（已有的文件会被覆盖）                                                          \
+     * @return bool 是否成功                                                                                          \
+     */                                                                                                                   \
+    static inline bool w_NDArray_saveNpy(T)(w_NDArray(T) * this, const char *path)                                        \
+    {                                                                                                                     \
+        w_check(this != NULL && path != NULL);                                                                            \
+        FILE *file = fopen(path, "wb");                                                                                   \
+        if (file == NULL)                                                                                                 \
+        {                                                                                                                 \
+            return false;                                                                                                 \
+        }                                                                                                                 \
+        /* 大块直接写入，不需要 stdio 缓冲区 */                                                                           \
+        setvbuf(file, NULL, _IONBF, 0);                                                                                   \
+        int64_t headerSize;                                                                                               \
+        uint8_t *header = w_npyFormatHeader_(w_NDArray_npyDtype_(T)(), this->shape, this->shapeSize, &headerSize);        \
+        bool success = fwrite(header, 1, headerSize, file) == (size_t)headerSize;                                         \
+        w_free(header);                                                                                                   \
+        const uint8_t *data = (const uint8_t *)this->elementData;                                                         \
+        int64_t remaining = this->size * sizeof(T);                                                                       \
+        while (success && remaining > 0)                                                                                  \
+        {                                                                                                                 \
+            int64_t chunk = remaining < w_NPY_CHUNK_ ? remaining : w_NPY_CHUNK_;                                          \
+            success = fwrite(data, 1, chunk, file) == (size_t)chunk;                                                      \
+            data += chunk;                                                                                                \
+            remaining -= chunk;                                                                                           \
+        }                                                                                                                 \
+        return fclose(file) == 0 && success;                                                                              \
+    }
+
+// 多维数组从 NPY 文件读取
+#define w_NDArray_loadNpy(T) w_concat(w_NDArray(T), _loadNpy)
+#define w_NDArray_loadNpy_define_(T)                                                                                                                          \
+    /**                                                                                                                                                       \
+     * 多维数组从 NPY 文件读取并初始化，元素数据按 w_NPY_CHUNK_ 分块直接读入数组                                                   \
+     * 元素类型的类别和字节数必须与 T 相同；字节序不同时自动转换，Fortran 顺序时转换为 C 顺序，标量读取为形状 (1) \
+     * @param this 多维数组                                                                                                                               \
+     * @param path 文件路径                                                                                                                               \
+     * @return bool 是否成功（文件不存在、格式或元素类型不符时返回 false，this 不会被初始化）                                  \
+     */                                                                                                                                                       \
+    static inline bool w_NDArray_loadNpy(T)(w_NDArray(T) * this, const char *path)                                                                            \
+    {                                                                                                                                                         \
+        w_check(this != NULL && path != NULL);                                                                                                                \
+        FILE *file = fopen(path, "rb");                                                                                                                       \
+        if (file == NULL)                                                                                                                                     \
+        {                                                                                                                                                     \
+            return false;                                                                                                                                     \
+        }                                                                                                                                                     \
+        setvbuf(file, NULL, _IONBF, 0);                                                                                                                       \
+                                                                                                                                                              \
+        /* 解析头部 */                                                                                                                                        \
+        uint8_t prefix[w_NPY_MAGIC_SIZE_ + 4];                                                                                                                \
+        int64_t dictOffset, dictSize;                                                                                                                         \
+        if (fread(prefix, 1, sizeof(prefix), file) != sizeof(prefix) || !w_npyParsePrefix_(prefix, sizeof(prefix), &dictOffset, &dictSize))                   \
+        {                                                                                                                                                     \
+            fclose(file);                                                                                                                                     \
+            return false;                                                                                                                                     \
+        }                                                                                                                                                     \
+        uint8_t *dict = w_malloc(dictSize);                                                                                                                   \
+        w_assert(dict != NULL);                                                                                                                               \
+        int64_t prefetched = sizeof(prefix) - dictOffset;                                                                                                     \
+        memcpy(dict, prefix + dictOffset, prefetched);                                                                                                        \
+        w_NpyDtype_ dtype, expected = w_NDArray_npyDtype_(T)();                                                                                               \
+        bool fortranOrder;                                                                                                                                    \
+        int64_t shape[w_NDARRAY_MAX_RANK], shapeSize, count;                                                                                                  \
+        bool success = fread(dict + prefetched, 1, dictSize - prefetched, file) == (size_t)(dictSize - prefetched) &&                                         \
+                       w_npyParseHeader_(dict, dictSize, &dtype, &fortranOrder, shape, &shapeSize) &&                                                         \
+                       dtype.kind == expected.kind && dtype.itemSize == expected.itemSize &&                                                                  \
+                       w_npyCount_(shape, shapeSize, sizeof(T), &count);                                                                                      \
+        w_free(dict);                                                                                                                                         \
+        if (!success)                                                                                                                                         \
+        {                                                                                                                                                     \
+            fclose(file);                                                                                                                                     \
+            return false;                                                                                                                                     \
+        }                                                                                                                                                     \
+                                                                                                                                                              \
+        /* Fortran 顺序按反转的形状读入，再转换为 C 顺序 */                                                                                                   \
+        w_NDArray(T) array;                                                                                                                                   \
+        w_NDArray_allocShape_(T)(&array, shapeSize > 0 ? shapeSize : 1);                                                                                      \
+        array.shape[0] = 1;                                                                                                                                   \
+        for (int64_t i = 0; i < shapeSize; i++)                                                                                                               \
+        {                                                                                                                                                     \
+            array.shape[i] = shape[fortranOrder ? shapeSize - 1 - i : i];                                                                                     \
+        }                                                                                                                                                     \
+        w_NDArray_initLayout_(T)(&array, w_AllocPolicy_default());                                                                                            \
+        uint8_t *data = (uint8_t *)array.elementData;                                                                                                         \
+        int64_t remaining = count * sizeof(T);                                                                                                                \
+        while (success && remaining > 0)                                                                                                                      \
+        {                                                                                                                                                     \
+            int64_t chunk = remaining < w_NPY_CHUNK_ ? remaining : w_NPY_CHUNK_;                                                                              \
+            success = fread(data, 1, chunk, file) == (size_t)chunk;                                                                                           \
+            data += chunk;                                                                                                                                    \
+            remaining -= chunk;                                                                                                                               \
+        }                                                                                                                                                     \
+        fclose(file);                                                                                                                                         \
+        if (!success)                                                                                                                                         \
+        {                                                                                                                                                     \
+            w_NDArray_deinit(T)(&array);                                                                                                                      \
+            return false;                                                                                                                                     \
+        }                                                                                                                                                     \
+        if (dtype.byteOrder != expected.byteOrder && sizeof(T) > 1)                                                                                           \
+        {                                                                                                                                                     \
+            w_npySwapBytes_(array.elementData, count, sizeof(T));                                                                                             \
+        }                                                                                                                                                     \
+        if (fortranOrder && shapeSize > 1)                                                                                                                    \
+        {                                                                                                                                                     \
+            int64_t axes[w_NDARRAY_MAX_RANK];                                                                                                                 \
+            for (int64_t i = 0; i < shapeSize; i++)                                                                                                           \
+            {                                                                                                                                                 \
+                axes[i] = shapeSize - 1 - i;                                                                                                                  \
+            }                                                                                                                                                 \
+            w_NDArrayView_contiguous(T)(w_NDArrayView_permute(T)(w_NDArray_view(T)(&array), axes), this);                                                     \
+            w_NDArray_deinit(T)(&array);                                                                                                                      \
+            return true;                                                                                                                                      \
+        }                                                                                                                                                     \
+        *this = array;                                                                                                                                        \
+        return true;                                                                                                                                          \
+    }
+
+// 多维数组映射 NPY 文件
+#define w_NDArray_mapNpy(T) w_concat(w_NDArray(T), _mapNpy)
+#define w_NDArray_mapNpy_define_(T)                                                                                                                              \
+    /**                                                                                                                                                          \
+     * 多维数组映射 NPY 文件初始化，元素直接使用文件的映射，不复制数据，耗时与文件大小无关                                \
+     * 文件必须是 C 顺序、本机字节序，元素类型与 T 相同，头部长度是 sizeof(T) 的倍数（NumPy 写出的文件按 64 字节对齐） \
+     * @param this 多维数组                                                                                                                                  \
+     * @param path 文件路径                                                                                                                                  \
+     * @param mode 映射模式 w_MAPPED_READONLY / w_MAPPED_PRIVATE / w_MAPPED_SHARED（修改写回文件）                                                   \
+     * @return bool 是否成功（文件不存在、映射失败、格式或元素类型不符时返回 false，this 不会被初始化）                      \
+     */                                                                                                                                                          \
+    static inline bool w_NDArray_mapNpy(T)(w_NDArray(T) * this, const char *path, int mode)                                                                      \
+    {                                                                                                                                                            \
+        w_check(this != NULL && path != NULL);                                                                                                                   \
+        w_AllocPolicy policy = w_AllocPolicy_default();                                                                                                          \
+        void *mapped = NULL;                                                                                                                                     \
+        int64_t bytes = 0;                                                                                                                                       \
+        if (!w_AllocPolicy_mapFile_(&policy, path, mode, -1, 1, &mapped, &bytes))                                                                                \
+        {                                                                                                                                                        \
+            return false;                                                                                                                                        \
+        }                                                                                                                                                        \
+        const uint8_t *file = mapped;                                                                                                                            \
+        int64_t dictOffset, dictSize, count;                                                                                                                     \
+        w_NpyDtype_ dtype, expected = w_NDArray_npyDtype_(T)();                                                                                                  \
+        bool fortranOrder;                                                                                                                                       \
+        int64_t shape[w_NDARRAY_MAX_RANK], shapeSize;                                                                                                            \
+        bool success = w_npyParsePrefix_(file, bytes, &dictOffset, &dictSize) && dictOffset + dictSize <= bytes &&                                               \
+                       w_npyParseHeader_(file + dictOffset, dictSize, &dtype, &fortranOrder, shape, &shapeSize) &&                                               \
+                       dtype.kind == expected.kind && dtype.itemSize == expected.itemSize &&                                                                     \
+                       (dtype.byteOrder == expected.byteOrder || sizeof(T) == 1) &&                                                                              \
+                       (!fortranOrder || shapeSize <= 1) && (dictOffset + dictSize) % sizeof(T) == 0 &&                                                          \
+                       w_npyCount_(shape, shapeSize, sizeof(T), &count) && count * (int64_t)sizeof(T) <= bytes - dictOffset - dictSize;                          \
+        if (!success)                                                                                                                                            \
+        {                                                                                                                                                        \
+            w_AllocPolicy_free_(&policy, mapped, bytes);                                                                                                         \
+            return false;                                                                                                                                        \
+        }                                                                                                                                                        \
+                                                                                                                                                                 \
+        w_NDArray_allocShape_(T)(this, shapeSize > 0 ? shapeSize : 1);                                                                                           \
+        this->shape[0] = 1;                                                                                                                                      \
+        memcpy(this->shape, shape, sizeof(int64_t) * shapeSize);                                                                                                 \
+        int64_t stride = 1;                                                                                                                                      \
+        for (int64_t i = this->shapeSize - 1; i >= 0; i--)                                                                                                       \
+        {                                                                                                                                                        \
+            this->strides[i] = stride;                                                                                                                           \
+            stride *= this->shape[i];                                                                                                                            \
+        }                                                                                                                                                        \
+        this->size = count;                                                                                                                                      \
+        if (count == 0)                                                                                                                                          \
+        { /* 没有元素时不保留映射 */                                                                                                                             \
+            w_AllocPolicy_free_(&policy, mapped, bytes);                                                                                                         \
+            this->policy = w_AllocPolicy_default();                                                                                                              \
+            this->elementData = w_AllocPolicy_malloc_(&this->policy, 0);                                                                                         \
+            w_assert(this->elementData != NULL);                                                                                                                 \
+            return true;                                                                                                                                         \
+        }                                                                                                                                                        \
+        /* 只保留元素数据所在的页，释放时按页对齐解除映射 */                                                                                                     \
+        this->elementData = (T *)(file + dictOffset + dictSize);                                                                                                 \
+        w_AllocPolicy_trimMapping_(mapped, bytes, this->elementData, count * sizeof(T));                                                                         \
+        this->policy = policy;                                                                                                                                   \
+        return true;                                                                                                                                             \
+    }
+
+// 多维数组文件定义（需要先定义 w_NDArray_define 和 w_NDArrayView_define，T 必须是整数或浮点数类型）
+#define w_NDArray_npy_define(T)    \
+    w_NDArray_npyDtype_define_(T); \
+    w_NDArray_saveNpy_define_(T);  \
+    w_NDArray_loadNpy_define_(T);  \
+    w_NDArray_mapNpy_define_(T);
+
+// ========================================================================================================================================================
+//  分块多维数组
+// ========================================================================================================================================================
+
+// 分块布局：正方形（立方体）块按行优先排列，块内按行优先排列
+#define w_LAYOUT_TILED 1
+
+// 分块布局：块按行优先排列，块内按 Z 序（Morton 序）排列，相邻的元素在各个方向上都相邻存放
+#define w_LAYOUT_MORTON 2
+
+// 二维数组默认的块大小（2^5 = 32，块大小为 32 x 32）
+#define w_TILED_SHIFT_2D_ 5
+
+// 三维数组默认的块大小（2^3 = 8，块大小为 8 x 8 x 8）
+#define w_TILED_SHIFT_3D_ 3
+
+/**
+ * 二维 Morton 编码：把 16 位整数的各位分散到偶数位
+ * @param x 整数
+ * @return uint64_t 分散后的整数
+ */
+static inline uint64_t w_mortonSpread2_(uint64_t x)
+{
+    x &= 0xFFFF;
+    x = (x | x << 8) & 0x00FF00FF;
+    x = (x | x << 4) & 0x0F0F0F0F;
+    x = (x | x << 2) & 0x33333333;
+    x = (x | x << 1) & 0x55555555;
+    return x;
+}
+
+/**
+ * 三维 Morton 编码：把 10 位整数的各位分散到 3 的倍数位
+ * @param x 整数
+ * @return uint64_t 分散后的整数
+ */
+static inline uint64_t w_mortonSpread3_(uint64_t x)
+{
+    x &= 0x3FF;
+    x = (x | x << 16) & 0x030000FF;
+    x = (x | x << 8) & 0x0300F00F;
+    x = (x | x << 4) & 0x030C30C3;
+    x = (x | x << 2) & 0x09249249;
+    return x;
+}
+
+/**
+ * 块内偏移
+ * @param layout 分块布局 w_LAYOUT_*
+ * @param shift 块大小的位数
+ * @param rank 维数（2 或 3）
+ * @param i 第 0 维块内索引（二维时为 0）
+ * @param j 第 1 维块内索引
+ * @param k 第 2 维块内索引
+ * @return int64_t 块内偏移
+ */
+static inline int64_t w_tiledInner_(int32_t layout, int32_t shift, int64_t rank, int64_t i, int64_t j, int64_t k)
+{
+    if (layout == w_LAYOUT_MORTON)
+    {
+        return rank == 2 ? (int64_t)(w_mortonSpread2_(j) << 1 | w_mortonSpread2_(k))
+                         : (int64_t)(w_mortonSpread3_(i) << 2 | w_mortonSpread3_(j) << 1 | w_mortonSpread3_(k));
+    }
+    return (i << (2 * shift)) | (j << shift) | k;
+}
+
+// 分块多维数组类型
+#define w_TiledArray(T) w_concat(w_TiledArray_, T)
+
+// 分块多维数组类型定义
+#define w_TiledArray_type_define_(T)                                             \
+    typedef struct                                                               \
+    {                                                                            \
+        T *elementData;       /* 元素数据（按块存放，边缘的块补齐为完整的块） */ \
+        int64_t shape[3];     /* 形状（二维时 shape[0] 为 1） */                 \
+        int64_t tiles[3];     /* 各维的块数 */                                   \
+        int64_t shapeSize;    /* 维数（2 或 3） */                               \
+        int64_t size;         /* 元素总数 */                                     \
+        int64_t capacity;     /* 存放的元素总数（包括补齐的部分） */             \
+        int32_t layout;       /* 分块布局 w_LAYOUT_* */                          \
+        int32_t tileShift;    /* 块大小的位数（块大小为 2^tileShift） */         \
+        w_AllocPolicy policy; /* 内存分配策略 */                                 \
+    } w_TiledArray(T);
+
+// 分块多维数组按内存分配策略初始化
+#define w_TiledArray_initWithPolicy(T) w_concat(w_TiledArray(T), _initWithPolicy)
+#define w_TiledArray_initWithPolicy_define_(T)                                                                                         \
+    /**                                                                                                                                \
+     * 分块多维数组按内存分配策略初始化（元素初始化为 0）                                                      \
+     * @param this 分块多维数组                                                                                                  \
+     * @param policy 内存分配策略                                                                                                \
+     * @param layout 分块布局 w_LAYOUT_TILED / w_LAYOUT_MORTON                                                                     \
+     * @param tileShift 块大小的位数（<= 0 时使用默认值：二维 32 x 32，三维 8 x 8 x 8）                            \
+     * @param shape 形状                                                                                                             \
+     * @param shapeSize 形状大小（2 或 3）                                                                                      \
+     * @return void                                                                                                                    \
+     */                                                                                                                                \
+    static inline void w_TiledArray_initWithPolicy(T)(w_TiledArray(T) * this, w_AllocPolicy policy, int32_t layout, int32_t tileShift, \
+                                                      const int64_t *shape, int64_t shapeSize)                                         \
+    {                                                                                                                                  \
+        w_check(this != NULL && shape != NULL);                                                                                        \
+        w_check(layout == w_LAYOUT_TILED || layout == w_LAYOUT_MORTON);                                                                \
+        w_check(shapeSize == 2 || shapeSize == 3);                                                                                     \
+        if (tileShift <= 0)                                                                                                            \
+        {                                                                                                                              \
+            tileShift = shapeSize == 2 ? w_TILED_SHIFT_2D_ : w_TILED_SHIFT_3D_;                                                        \
+        }                                                                                                                              \
+        /* Morton 编码每一维最多 16 位（二维）或 10 位（三维） */                                                                      \
+        w_check(tileShift <= (shapeSize == 2 ? 15 : 10));                                                                              \
+        this->shapeSize = shapeSize;                                                                                                   \
+        this->layout = layout;                                                                                                         \
+        this->tileShift = tileShift;                                                                                                   \
+        this->size = 1;                                                                                                                \
+        this->capacity = 1;                                                                                                            \
+        for (int64_t i = 0; i < 3; i++)                                                                                                \
+        {                                                                                                                              \
+            int64_t length = i < 3 - shapeSize ? 1 : shape[i - (3 - shapeSize)];                                                       \
+            w_check(length >= 0);                                                                                                      \
+            this->shape[i] = length;                                                                                                   \
+            this->tiles[i] = i < 3 - shapeSize ? 1 : (length + ((int64_t)1 << tileShift) - 1) >> tileShift;                            \
+            this->size *= length;                                                                                                      \
+            this->capacity *= i < 3 - shapeSize ? 1 : this->tiles[i] << tileShift;                                                     \
+        }                                                                                                                              \
+        this->policy = policy;                                                                                                         \
+        this->elementData = w_AllocPolicy_malloc_(&this->policy, sizeof(T) * this->capacity);                                          \
+        w_assert(this->elementData != NULL);                                                                                           \
+        memset(this->elementData, 0, sizeof(T) * this->capacity);                                                                      \
+    }
+
+// 分块多维数组初始化
+#define w_TiledArray_init(T) w_concat(w_TiledArray(T), _init)
+#define w_TiledArray_init_define_(T)                                                                                                            \
+    /**                                                                                                                                         \
+     * 分块多维数组初始化（元素初始化为 0）                                                                                    \
+     * @param this 分块多维数组                                                                                                           \
+     * @param layout 分块布局 w_LAYOUT_TILED / w_LAYOUT_MORTON                                                                              \
+     * @param tileShift 块大小的位数（<= 0 时使用默认值）                                                                         \
+     * @param shape 形状                                                                                                                      \
+     * @param shapeSize 形状大小（2 或 3）                                                                                               \
+     * @return void                                                                                                                             \
+     */                                                                                                                                         \
+    static inline void w_TiledArray_init(T)(w_TiledArray(T) * this, int32_t layout, int32_t tileShift, const int64_t *shape, int64_t shapeSize) \
+    {                                                                                                                                           \
+        w_TiledArray_initWithPolicy(T)(this, w_AllocPolicy_default(), layout, tileShift, shape, shapeSize);                                     \
+    }
+
+// 分块多维数组销毁
+#define w_TiledArray_deinit(T) w_concat(w_TiledArray(T), _deinit)
+#define w_TiledArray_deinit_define_(T)                                                     \
+    /**                                                                                    \
+     * 分块多维数组销毁                                                            \
+     * @param this 分块多维数组                                                      \
+     * @return void                                                                        \
+     */                                                                                    \
+    static inline void w_TiledArray_deinit(T)(w_TiledArray(T) * this)                      \
+    {                                                                                      \
+        w_check(this != NULL);                                                             \
+        w_check(this->elementData != NULL);                                                \
+        w_AllocPolicy_free_(&this->policy, this->elementData, this->capacity * sizeof(T)); \
+        memset(this, 0, sizeof(w_TiledArray(T)));                                          \
+    }
+
+// 分块多维数组计算偏移
+#define w_TiledArray_offset_(T) w_concat(w_TiledArray(T), _offset_)
+#define w_TiledArray_offset_define_(T)                                                                                                  \
+    /**                                                                                                                                 \
+     * 分块多维数组计算元素的偏移（二维时 i 为 0）                                                                   \
+     * @param this 分块多维数组                                                                                                   \
+     * @param i 第 0 维索引                                                                                                         \
+     * @param j 第 1 维索引                                                                                                         \
+     * @param k 第 2 维索引                                                                                                         \
+     * @return int64_t 偏移                                                                                                           \
+     */                                                                                                                                 \
+    static inline int64_t w_TiledArray_offset_(T)(const w_TiledArray(T) * this, int64_t i, int64_t j, int64_t k)                        \
+    {                                                                                                                                   \
+        int32_t shift = this->tileShift;                                                                                                \
+        int64_t mask = ((int64_t)1 << shift) - 1;                                                                                       \
+        int64_t tile = ((i >> shift) * this->tiles[1] + (j >> shift)) * this->tiles[2] + (k >> shift);                                  \
+        return (tile << (this->shapeSize * shift)) + w_tiledInner_(this->layout, shift, this->shapeSize, i & mask, j & mask, k & mask); \
+    }
+
+// 分块多维数组获取元素指针
+#define w_TiledArray_ptr(T) w_concat(w_TiledArray(T), _ptr)
+#define w_TiledArray_ptr_define_(T)                                                             \
+    /**                                                                                         \
+     * 分块多维数组获取元素指针                                                     \
+     * @param this 分块多维数组                                                           \
+     * @param indices 索引数组（长度为 shapeSize）                                     \
+     * @return T * 元素指针                                                                 \
+     */                                                                                         \
+    static inline T *w_TiledArray_ptr(T)(w_TiledArray(T) * this, const int64_t *indices)        \
+    {                                                                                           \
+        w_check(this != NULL);                                                                  \
+        w_check(indices != NULL);                                                               \
+        int64_t index[3] = {0, 0, 0};                                                           \
+        for (int64_t i = 0; i < this->shapeSize; i++)                                           \
+        {                                                                                       \
+            index[3 - this->shapeSize + i] = indices[i];                                        \
+            w_checkIndex(indices[i] >= 0 && indices[i] < this->shape[3 - this->shapeSize + i]); \
+        }                                                                                       \
+        return this->elementData + w_TiledArray_offset_(T)(this, index[0], index[1], index[2]); \
+    }
+
+// 分块多维数组获取元素
+#define w_TiledArray_get(T) w_concat(w_TiledArray(T), _get)
+#define w_TiledArray_get_define_(T)                                       \
+    /**                                                                   \
+     * 分块多维数组获取元素                                     \
+     * @param this 分块多维数组                                     \
+     * @param ... 索引（必须传入 int64 类型，否则会报错） \
+     * @return T 元素                                                   \
+     */                                                                   \
+    static inline T w_TiledArray_get(T)(w_TiledArray(T) * this, ...)      \
+    {                                                                     \
+        int64_t indices[3];                                               \
+        va_list arguments;                                                \
+        va_start(arguments, this);                                        \
+        for (int64_t i = 0; i < this->shapeSize; i++)                     \
+        {                                                                 \
+            indices[i] = va_arg(arguments, int64_t);                      \
+        }                                                                 \
+        va_end(arguments);                                                \
+        return *w_TiledArray_ptr(T)(this, indices);                       \
+    }
+
+// 分块多维数组设置元素
+#define w_TiledArray_set(T) w_concat(w_TiledArray(T), _set)
+#define w_TiledArray_set_define_(T)                                              \
+    /**                                                                          \
+     * 分块多维数组设置元素                                            \
+     * @param this 分块多维数组                                            \
+     * @param value 值                                                          \
+     * @param ... 索引（必须传入 int64 类型，否则会报错）        \
+     * @return void                                                              \
+     */                                                                          \
+    static inline void w_TiledArray_set(T)(w_TiledArray(T) * this, T value, ...) \
+    {                                                                            \
+        int64_t indices[3];                                                      \
+        va_list arguments;                                                       \
+        va_start(arguments, value);                                              \
+        for (int64_t i = 0; i < this->shapeSize; i++)                            \
+        {                                                                        \
+            indices[i] = va_arg(arguments, int64_t);                             \
+        }                                                                        \
+        va_end(arguments);                                                       \
+        *w_TiledArray_ptr(T)(this, indices) = value;                             \
+    }
+
+// 二维分块数组获取元素
+#define w_TiledArray_get2(T) w_concat(w_TiledArray(T), _get2)
+#define w_TiledArray_get2_define_(T)                                                         \
+    /**                                                                                      \
+     * 二维分块数组获取元素（不经过可变参数）                             \
+     * @param this 分块多维数组（shapeSize 必须为 2）                             \
+     * @param i 第 0 维索引                                                              \
+     * @param j 第 1 维索引                                                              \
+     * @return T 元素                                                                      \
+     */                                                                                      \
+    static inline T w_TiledArray_get2(T)(const w_TiledArray(T) * this, int64_t i, int64_t j) \
+    {                                                                                        \
+        w_check(this != NULL && this->shapeSize == 2);                                       \
+        w_checkIndex(i >= 0 && i < this->shape[1]);                                          \
+        w_checkIndex(j >= 0 && j < this->shape[2]);                                          \
+        return this->elementData[w_TiledArray_offset_(T)(this, 0, i, j)];                    \
+    }
+
+// 二维分块数组设置元素
+#define w_TiledArray_set2(T) w_concat(w_TiledArray(T), _set2)
+#define w_TiledArray_set2_define_(T)                                                               \
+    /**                                                                                            \
+     * 二维分块数组设置元素（不经过可变参数）                                   \
+     * @param this 分块多维数组（shapeSize 必须为 2）                                   \
+     * @param i 第 0 维索引                                                                    \
+     * @param j 第 1 维索引                                                                    \
+     * @param value 值                                                                            \
+     * @return void                                                                                \
+     */                                                                                            \
+    static inline void w_TiledArray_set2(T)(w_TiledArray(T) * this, int64_t i, int64_t j, T value) \
+    {                                                                                              \
+        w_check(this != NULL && this->shapeSize == 2);                                             \
+        w_checkIndex(i >= 0 && i < this->shape[1]);                                                \
+        w_checkIndex(j >= 0 && j < this->shape[2]);                                                \
+        this->elementData[w_TiledArray_offset_(T)(this, 0, i, j)] = value;                         \
+    }
+
+// 三维分块数组获取元素
+#define w_TiledArray_get3(T) w_concat(w_TiledArray(T), _get3)
+#define w_TiledArray_get3_define_(T)                                                                    \
+    /**                                                                                                 \
+     * 三维分块数组获取元素（不经过可变参数）                                        \
+     * @param this 分块多维数组（shapeSize 必须为 3）                                        \
+     * @param i 第 0 维索引                                                                         \
+     * @param j 第 1 维索引                                                                         \
+     * @param k 第 2 维索引                                                                         \
+     * @return T 元素                                                                                 \
+     */                                                                                                 \
+    static inline T w_TiledArray_get3(T)(const w_TiledArray(T) * this, int64_t i, int64_t j, int64_t k) \
+    {                                                                                                   \
+        w_check(this != NULL && this->shapeSize == 3);                                                  \
+        w_checkIndex(i >= 0 && i < this->shape[0]);                                                     \
+        w_checkIndex(j >= 0 && j < this->shape[1]);                                                     \
+        w_checkIndex(k >= 0 && k < this->shape[2]);                                                     \
+        return this->elementData[w_TiledArray_offset_(T)(this, i, j, k)];                               \
+    }
+
+// 三维分块数组设置元素
+#define w_TiledArray_set3(T) w_concat(w_TiledArray(T), _set3)
+#define w_TiledArray_set3_define_(T)                                                                          \
+    /**                                                                                                       \
+     * 三维分块数组设置元素（不经过可变参数）                                              \
+     * @param this 分块多维数组（shapeSize 必须为 3）                                              \
+     * @param i 第 0 维索引                                                                               \
+     * @param j 第 1 维索引                                                                               \
+     * @param k 第 2 维索引                                                                               \
+     * @param value 值                                                                                       \
+     * @return void                                                                                           \
+     */                                                                                                       \
+    static inline void w_TiledArray_set3(T)(w_TiledArray(T) * this, int64_t i, int64_t j, int64_t k, T value) \
+    {                                                                                                         \
+        w_check(this != NULL && this->shapeSize == 3);                                                        \
+        w_checkIndex(i >= 0 && i < this->shape[0]);                                                           \
+        w_checkIndex(j >= 0 && j < this->shape[1]);                                                           \
+        w_checkIndex(k >= 0 && k < this->shape[2]);                                                           \
+        this->elementData[w_TiledArray_offset_(T)(this, i, j, k)] = value;                                    \
+    }
+
+// 分块多维数组获取形状
+#define w_TiledArray_shape(T) w_concat(w_TiledArray(T), _shape)
+#define w_TiledArray_shape_define_(T)                                                \
+    /**                                                                              \
+     * 分块多维数组获取形状                                                \
+     * @param this 分块多维数组                                                \
+     * @return const int64_t * 形状（长度为 shapeSize）                       \
+     */                                                                              \
+    static inline const int64_t *w_TiledArray_shape(T)(const w_TiledArray(T) * this) \
+    {                                                                                \
+        w_check(this != NULL);                                                       \
+        return this->shape + 3 - this->shapeSize;                                    \
+    }
+
+// 分块多维数组获取块
+#define w_TiledArray_tile(T) w_concat(w_TiledArray(T), _tile)
+#define w_TiledArray_tile_define_(T)                                                                                                                    \
+    /**                                                                                                                                                 \
+     * 分块多维数组获取一个块的视图（只用于 w_LAYOUT_TILED，块内按行优先连续存放，边缘的块只包含有效的部分） \
+     * @param this 分块多维数组                                                                                                                   \
+     * @param tileIndices 块索引数组（长度为 shapeSize，第 d 维的取值范围为 [0, ceil(shape[d] / 2^tileShift))）                      \
+     * @return w_NDArrayView(T) 块的视图                                                                                                            \
+     */                                                                                                                                                 \
+    static inline w_NDArrayView(T) w_TiledArray_tile(T)(w_TiledArray(T) * this, const int64_t *tileIndices)                                             \
+    {                                                                                                                                                   \
+        w_check(this != NULL && tileIndices != NULL);                                                                                                   \
+        w_check(this->layout == w_LAYOUT_TILED);                                                                                                        \
+        int64_t tileSize = (int64_t)1 << this->tileShift;                                                                                               \
+        int64_t first[3] = {0, 0, 0};                                                                                                                   \
+        w_NDArrayView(T) view;                                                                                                                          \
+        view.elementData = this->elementData;                                                                                                           \
+        view.shapeSize = this->shapeSize;                                                                                                               \
+        for (int64_t d = 0; d < this->shapeSize; d++)                                                                                                   \
+        {                                                                                                                                               \
+            int64_t axis = 3 - this->shapeSize + d;                                                                                                     \
+            w_checkIndex(tileIndices[d] >= 0 && tileIndices[d] < this->tiles[axis]);                                                                    \
+            first[axis] = tileIndices[d] << this->tileShift;                                                                                            \
+            view.shape[d] = this->shape[axis] - first[axis] < tileSize ? this->shape[axis] - first[axis] : tileSize;                                    \
+            view.strides[d] = (int64_t)1 << ((this->shapeSize - 1 - d) * this->tileShift);                                                              \
+        }                                                                                                                                               \
+        view.offset = w_TiledArray_offset_(T)(this, first[0], first[1], first[2]);                                                                      \
+        return view;                                                                                                                                    \
+    }
+
+// 分块多维数组与视图之间复制
+#define w_TiledArray_transfer_(T) w_concat(w_TiledArray(T), _transfer_)
+#define w_TiledArray_transfer_define_(T)                                                                                                 \
+    /**                                                                                                                                  \
+     * 分块多维数组与视图之间复制，按存储顺序逐块处理                                                             \
+     * @param this 分块多维数组                                                                                                    \
+     * @param view 视图（形状与 this 相同）                                                                                     \
+     * @param toView true:从 this 复制到视图 false:从视图复制到 this                                                         \
+     * @return void                                                                                                                      \
+     */                                                                                                                                  \
+    static inline void w_TiledArray_transfer_(T)(w_TiledArray(T) * this, w_NDArrayView(T) view, bool toView)                             \
+    {                                                                                                                                    \
+        w_check(view.shapeSize == this->shapeSize);                                                                                      \
+        int64_t strides[3] = {0, 0, 0};                                                                                                  \
+        for (int64_t d = 0; d < this->shapeSize; d++)                                                                                    \
+        {                                                                                                                                \
+            w_check(view.shape[d] == this->shape[3 - this->shapeSize + d]);                                                              \
+            strides[3 - this->shapeSize + d] = view.strides[d];                                                                          \
+        }                                                                                                                                \
+        int32_t shift = this->tileShift;                                                                                                 \
+        int64_t tileSize = (int64_t)1 << shift;                                                                                          \
+        int64_t depth = this->shapeSize == 3 ? tileSize : 1;                                                                             \
+        T *tile = this->elementData;                                                                                                     \
+        for (int64_t ti = 0; ti < this->tiles[0]; ti++)                                                                                  \
+        {                                                                                                                                \
+            for (int64_t tj = 0; tj < this->tiles[1]; tj++)                                                                              \
+            {                                                                                                                            \
+                for (int64_t tk = 0; tk < this->tiles[2]; tk++, tile += (int64_t)1 << (this->shapeSize * shift))                         \
+                {                                                                                                                        \
+                    /* 块的有效范围 */                                                                                                   \
+                    int64_t i0 = ti << shift, j0 = tj << shift, k0 = tk << shift;                                                        \
+                    int64_t rowsI = this->shape[0] - i0 < depth ? this->shape[0] - i0 : depth;                                           \
+                    int64_t rowsJ = this->shape[1] - j0 < tileSize ? this->shape[1] - j0 : tileSize;                                     \
+                    int64_t cols = this->shape[2] - k0 < tileSize ? this->shape[2] - k0 : tileSize;                                      \
+                    for (int64_t i = 0; i < rowsI; i++)                                                                                  \
+                    {                                                                                                                    \
+                        for (int64_t j = 0; j < rowsJ; j++)                                                                              \
+                        {                                                                                                                \
+                            T *other = view.elementData + view.offset + (i0 + i) * strides[0] + (j0 + j) * strides[1] + k0 * strides[2]; \
+                            if (this->layout == w_LAYOUT_TILED)                                                                          \
+                            { /* 块内的一行是连续的 */                                                                                   \
+                                T *row = tile + w_tiledInner_(w_LAYOUT_TILED, shift, this->shapeSize, i, j, 0);                          \
+                                for (int64_t k = 0; k < cols; k++)                                                                       \
+                                {                                                                                                        \
+                                    if (toView)                                                                                          \
+                                    {                                                                                                    \
+                                        other[k * strides[2]] = row[k];                                                                  \
+                                    }                                                                                                    \
+                                    else                                                                                                 \
+                                    {                                                                                                    \
+                                        row[k] = other[k * strides[2]];                                                                  \
+                                    }                                                                                                    \
+                                }                                                                                                        \
+                                continue;                                                                                                \
+                            }                                                                                                            \
+                            for (int64_t k = 0; k < cols; k++)                                                                           \
+                            {                                                                                                            \
+                                T *element = tile + w_tiledInner_(w_LAYOUT_MORTON, shift, this->shapeSize, i, j, k);                     \
+                                if (toView)                                                                                              \
+                                {                                                                                                        \
+                                    other[k * strides[2]] = *element;                                                                    \
+                                }                                                                                                        \
+                                else                                                                                                     \
+                                {                                                                                                        \
+                                    *element = other[k * strides[2]];                                                                    \
+                                }                                                                                                        \
+                            }                                                                                                            \
+                        }                                                                                                                \
+                    }                                                                                                                    \
+                }                                                                                                                        \
+            }                                                                                                                            \
+        }                                                                                                                                \
+    }
+
+// 分块多维数组从视图初始化
+#define w_TiledArray_initFromView(T) w_concat(w_TiledArray(T), _initFromView)
+#define w_TiledArray_initFromView_define_(T)                                                                                          \
+    /**                                                                                                                               \
+     * 分块多维数组从视图初始化（如从行优先的多维数组转换）                                                 \
+     * @param this 分块多维数组                                                                                                 \
+     * @param layout 分块布局 w_LAYOUT_TILED / w_LAYOUT_MORTON                                                                    \
+     * @param tileShift 块大小的位数（<= 0 时使用默认值）                                                               \
+     * @param view 二维或三维视图                                                                                              \
+     * @return void                                                                                                                   \
+     */                                                                                                                               \
+    static inline void w_TiledArray_initFromView(T)(w_TiledArray(T) * this, int32_t layout, int32_t tileShift, w_NDArrayView(T) view) \
+    {                                                                                                                                 \
+        w_TiledArray_init(T)(this, layout, tileShift, view.shape, view.shapeSize);                                                    \
+        w_TiledArray_transfer_(T)(this, view, false);                                                                                 \
+    }
+
+// 分块多维数组复制到视图
+#define w_TiledArray_copyTo(T) w_concat(w_TiledArray(T), _copyTo)
+#define w_TiledArray_copyTo_define_(T)                                                       \
+    /**                                                                                      \
+     * 分块多维数组复制到视图（如转换为行优先的多维数组）           \
+     * @param this 分块多维数组                                                        \
+     * @param view 视图（形状与 this 相同）                                         \
+     * @return void                                                                          \
+     */                                                                                      \
+    static inline void w_TiledArray_copyTo(T)(w_TiledArray(T) * this, w_NDArrayView(T) view) \
+    {                                                                                        \
+        w_check(this != NULL);                                                               \
+        w_TiledArray_transfer_(T)(this, view, true);                                         \
+    }
+
+// 分块多维数组转换为多维数组
+#define w_TiledArray_toNDArray(T) w_concat(w_TiledArray(T), _toNDArray)
+#define w_TiledArray_toNDArray_define_(T)                                                    \
+    /**                                                                                      \
+     * 分块多维数组转换为行优先的多维数组                                   \
+     * @param this 分块多维数组                                                        \
+     * @param out 多维数组（未初始化，由调用者销毁）                        \
+     * @return void                                                                          \
+     */                                                                                      \
+    static inline void w_TiledArray_toNDArray(T)(w_TiledArray(T) * this, w_NDArray(T) * out) \
+    {                                                                                        \
+        w_check(this != NULL && out != NULL);                                                \
+        w_NDArray_initShape(T)(out, w_TiledArray_shape(T)(this), this->shapeSize);           \
+        w_TiledArray_transfer_(T)(this, w_NDArray_view(T)(out), true);                       \
+    }
+
+// 分块多维数组从其他布局初始化
+#define w_TiledArray_initFrom(T) w_concat(w_TiledArray(T), _initFrom)
+#define w_TiledArray_initFrom_define_(T)                                                                                                                 \
+    /**                                                                                                                                                  \
+     * 分块多维数组从另一个分块多维数组初始化（转换布局或块大小）                                                           \
+     * @param this 分块多维数组                                                                                                                    \
+     * @param layout 分块布局 w_LAYOUT_TILED / w_LAYOUT_MORTON                                                                                       \
+     * @param tileShift 块大小的位数（<= 0 时使用默认值）                                                                                  \
+     * @param other 另一个分块多维数组                                                                                                          \
+     * @return void                                                                                                                                      \
+     */                                                                                                                                                  \
+    static inline void w_TiledArray_initFrom(T)(w_TiledArray(T) * this, int32_t layout, int32_t tileShift, const w_TiledArray(T) * other)                \
+    {                                                                                                                                                    \
+        w_check(this != NULL && other != NULL && this != other);                                                                                         \
+        w_TiledArray_init(T)(this, layout, tileShift, other->shape + 3 - other->shapeSize, other->shapeSize);                                            \
+        if (this->layout == other->layout && this->tileShift == other->tileShift)                                                                        \
+        {                                                                                                                                                \
+            memcpy(this->elementData, other->elementData, sizeof(T) * this->capacity);                                                                   \
+            return;                                                                                                                                      \
+        }                                                                                                                                                \
+        /* 按目标的存储顺序逐块从源读取 */                                                                                                               \
+        int64_t tileSize = (int64_t)1 << this->tileShift;                                                                                                \
+        int64_t depth = this->shapeSize == 3 ? tileSize : 1;                                                                                             \
+        for (int64_t i0 = 0; i0 < this->shape[0]; i0 += depth)                                                                                           \
+        {                                                                                                                                                \
+            for (int64_t j0 = 0; j0 < this->shape[1]; j0 += tileSize)                                                                                    \
+            {                                                                                                                                            \
+                for (int64_t k0 = 0; k0 < this->shape[2]; k0 += tileSize)                                                                                \
+                {                                                                                                                                        \
+                    int64_t iEnd = i0 + depth < this->shape[0] ? i0 + depth : this->shape[0];                                                            \
+                    int64_t jEnd = j0 + tileSize < this->shape[1] ? j0 + tileSize : this->shape[1];                                                      \
+                    int64_t kEnd = k0 + tileSize < this->shape[2] ? k0 + tileSize : this->shape[2];                                                      \
+                    for (int64_t i = i0; i < iEnd; i++)                                                                                                  \
+                    {                                                                                                                                    \
+                        for (int64_t j = j0; j < jEnd; j++)                                                                                              \
+                        {                                                                                                                                \
+                            for (int64_t k = k0; k < kEnd; k++)                                                                                          \
+                            {                                                                                                                            \
+                                this->elementData[w_TiledArray_offset_(T)(this, i, j, k)] = other->elementData[w_TiledArray_offset_(T)(other, i, j, k)]; \
+                            }                                                                                                                            \
+                        }                                                                                                                                \
+                    }                                                                                                                                    \
+                }                                                                                                                                        \
+            }                                                                                                                                            \
+        }                                                                                                                                                \
+    }
+
+// 分块多维数组定义（需要先定义 w_NDArray_define 和 w_NDArrayView_define）
+#define w_TiledArray_define(T)              \
+    w_TiledArray_type_define_(T);           \
+    w_TiledArray_initWithPolicy_define_(T); \
+    w_TiledArray_init_define_(T);           \
+    w_TiledArray_deinit_define_(T);         \
+    w_TiledArray_offset_define_(T);         \
+    w_TiledArray_ptr_define_(T);            \
+    w_TiledArray_get_define_(T);            \
+    w_TiledArray_set_define_(T);            \
+    w_TiledArray_get2_define_(T);           \
+    w_TiledArray_set2_define_(T);           \
+    w_TiledArray_get3_define_(T);           \
+    w_TiledArray_set3_define_(T);           \
+    w_TiledArray_shape_define_(T);          \
+    w_TiledArray_tile_define_(T);           \
+    w_TiledArray_transfer_define_(T);       \
+    w_TiledArray_initFromView_define_(T);   \
+    w_TiledArray_copyTo_define_(T);         \
+    w_TiledArray_toNDArray_define_(T);      \
+    w_TiledArray_initFrom_define_(T);
+
+// ========================================================================================================================================================
+//  列表
+// ========================================================================================================================================================
+
+// 列表类型
+#define w_List(T) w_concat(w_List_, T)
+
+// 列表类型定义
+#define w_List_type_define_(T)                   \
+    typedef struct                               \
+    {                                            \
+        T *elementData;                          \
+        int64_t size;         /* 大小 */         \
+        int64_t capacity;     /* 容量 */         \
+        w_AllocPolicy policy; /* 内存分配策略 */ \
+    } w_List(T);
+
+// 列表按内存分配策略初始化
+#define w_List_initWithPolicy(T) w_concat(w_List(T), _initWithPolicy)
+#define w_List_initWithPolicy_define_(T)                                                                      \
+    /**                                                                                                       \
+     * 列表按内存分配策略初始化（之后扩容也使用该策略）                               \
+     * @param this 列表                                                                                     \
+     * @param initCapacity 初始容量                                                                       \
+     * @param policy 内存分配策略（对齐、大页、NUMA）                                           \
+     * @return void                                                                                           \
+     */                                                                                                       \
+    static inline void w_List_initWithPolicy(T)(w_List(T) * this, int64_t initCapacity, w_AllocPolicy policy) \
+    {                                                                                                         \
+        w_check(this != NULL);                                                                                \
+        w_check(initCapacity >= 0);                                                                           \
+        this->policy = policy;                                                                                \
+        /* 容量为 0 时延迟到第一次添加元素时再申请内存 */                                                     \
+        this->elementData = NULL;                                                                             \
+        if (initCapacity > 0)                                                                                 \
+        {                                                                                                     \
+            this->elementData = w_AllocPolicy_malloc_(&this->policy, sizeof(T) * initCapacity);               \
+            w_assert(this->elementData != NULL);                                                              \
+        }                                                                                                     \
+        this->size = 0;                                                                                       \
+        this->capacity = initCapacity;                                                                        \
+    }
+
+// 列表初始化
+#define w_List_initWithCapacity(T) w_concat(w_List(T), _initWithCapacity)
+#define w_List_initWithCapacity_define_(T)                                                \
+    /**                                                                                   \
+     * 列表初始化                                                                    \
+     * @param this 列表                                                                 \
+     * @param initCapacity 初始容量                                                   \
+     * @return void                                                                       \
+     */                                                                                   \
+    static inline void w_List_initWithCapacity(T)(w_List(T) * this, int64_t initCapacity) \
+    {                                                                                     \
+        w_List_initWithPolicy(T)(this, initCapacity, w_AllocPolicy_default());            \
+    }
+
+// 列表初始化
+#define w_List_init(T) w_concat(w_List(T), _init)
+#define w_List_init_define_(T)                                                  \
+    /**                                                                         \
+     * 列表初始化（不申请内存，第一次添加元素时再申请） \
+     * @param this 列表                                                       \
+     */                                                                         \
+    static inline void w_List_init(T)(w_List(T) * this)                         \
+    {                                                                           \
+        w_List_initWithCapacity(T)(this, 0);                                    \
+    }
+
+// 列表映射文件初始化
+#define w_List_openMapped(T) w_concat(w_List(T), _openMapped)
+#define w_List_openMapped_define_(T)                                                                                                 \
+    /**                                                                                                                              \
+     * 列表映射文件初始化，元素直接存放在文件的映射中                                                         \
+     * 共享可写模式下文件不存在时创建空文件，扩容时扩大文件，销毁时把文件截断到 size * sizeof(T) \
+     * 私有模式下第一次扩容时把元素转移到堆内存；只读模式下不能修改或扩容                           \
+     * @param this 列表                                                                                                            \
+     * @param path 文件路径                                                                                                      \
+     * @param mode 映射模式 w_MAPPED_READONLY / w_MAPPED_PRIVATE / w_MAPPED_SHARED                                               \
+     * @return bool 是否成功（文件打开或映射失败时返回 false，this 不会被初始化）                           \
+     */                                                                                                                              \
+    static inline bool w_List_openMapped(T)(w_List(T) * this, const char *path, int mode)                                            \
+    {                                                                                                                                \
+        w_check(this != NULL);                                                                                                       \
+        void *data;                                                                                                                  \
+        int64_t bytes;                                                                                                               \
+        if (!w_AllocPolicy_mapFile_(&this->policy, path, mode, -1, sizeof(T), &data, &bytes))                                        \
+        {                                                                                                                            \
+            return false;                                                                                                            \
+        }                                                                                                                            \
+        this->elementData = data;                                                                                                    \
+        this->size = bytes / sizeof(T);                                                                                              \
+        this->capacity = this->size;                                                                                                 \
+        return true;                                                                                                                 \
+    }
+
+// 列表访问模式提示
+#define w_List_advise(T) w_concat(w_List(T), _advise)
+#define w_List_advise_define_(T)                                            \
+    /**                                                                     \
+     * 列表访问模式提示（主要用于映射文件的列表）      \
+     * @param this 列表                                                   \
+     * @param advice 访问模式 w_ADVICE_*                                \
+     * @return void                                                         \
+     */                                                                     \
+    static inline void w_List_advise(T)(w_List(T) * this, int advice)       \
+    {                                                                       \
+        w_check(this != NULL);                                              \
+        w_adviseMemory_(this->elementData, this->size * sizeof(T), advice); \
+    }
+
+// 列表写回文件
+#define w_List_sync(T) w_concat(w_List(T), _sync)
+#define w_List_sync_define_(T)                                                                 \
+    /**                                                                                        \
+     * 列表写回文件（只对共享可写的映射有效，其他情况什么都不做） \
+     * @param this 列表                                                                      \
+     * @return void                                                                            \
+     */                                                                                        \
+    static inline void w_List_sync(T)(w_List(T) * this)                                        \
+    {                                                                                          \
+        w_check(this != NULL);                                                                 \
+        w_AllocPolicy_sync_(&this->policy, this->elementData, this->capacity * sizeof(T));     \
+    }
+
+// 列表销毁
+#define w_List_deinit(T) w_concat(w_List(T), _deinit)
+#define w_List_deinit_define_(T)                                                           \
+    /**                                                                                    \
+     * 列表销毁                                                                        \
+     * @param this 列表                                                                  \
+     * @return void                                                                        \
+     */                                                                                    \
+    static inline void w_List_deinit(T)(w_List(T) * this)                                  \
+    {                                                                                      \
+        w_check(this != NULL);                                                             \
+        w_check(this->elementData != NULL || this->capacity == 0);                         \
+        w_AllocPolicy_truncate_(&this->policy, this->size * sizeof(T));                    \
+        w_AllocPolicy_free_(&this->policy, this->elementData, this->capacity * sizeof(T)); \
+        memset(this, 0, sizeof(w_List(T)));                                                \
+    }
+
+// 列表获取大小
+#define w_List_size(T) w_concat(w_List(T), _size)
+#define w_List_size_define_(T)                                     \
+    /**                                                            \
+     * 列表获取大小                                          \
+     * @param this 列表                                          \
+     * @return int64_t 大小                                      \
+     */                                                            \
+    static inline int64_t w_List_size(T)(w_List(T) * this)         \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        return this->size;                                         \
+    }
+
+// 列表获取容量
+#define w_List_capacity(T) w_concat(w_List(T), _capacity)
+#define w_List_capacity_define_(T)                                 \
+    /**                                                            \
+     * 列表获取容量                                          \
+     * @param this 列表                                          \
+     * @return int64_t 容量                                      \
+     */                                                            \
+    static inline int64_t w_List_capacity(T)(w_List(T) * this)     \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        return this->capacity;                                     \
+    }
+
+// 列表获取元素
+#define w_List_get(T) w_concat(w_List(T), _get)
+#define w_List_get_define_(T)                                      \
+    /**                                                            \
+     * 列表获取元素                                          \
+     * @param this 列表                                          \
+     * @param index 索引                                         \
+     * @return T 元素                                            \
+     */                                                            \
+    static inline T w_List_get(T)(w_List(T) * this, int64_t index) \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        w_checkIndex(index >= 0 && index < this->size);            \
+        return this->elementData[index];                           \
+    }
+
+// 列表设置元素
+#define w_List_set(T) w_concat(w_List(T), _set)
+#define w_List_set_define_(T)                                                    \
+    /**                                                                          \
+     * 列表设置元素                                                        \
+     * @param this 列表                                                        \
+     * @param index 索引                                                       \
+     * @param element 元素                                                     \
+     * @return void                                                              \
+     */                                                                          \
+    static inline void w_List_set(T)(w_List(T) * this, int64_t index, T element) \
+    {                                                                            \
+        w_check(this != NULL);                                                   \
+        w_check(this->elementData != NULL || this->capacity == 0);               \
+        w_checkIndex(index >= 0 && index < this->size);                          \
+        this->elementData[index] = element;                                      \
+    }
+
+// 列表获取元素（不检查）
+#define w_List_getUnchecked(T) w_concat(w_List(T), _getUnchecked)
+#define w_List_getUnchecked_define_(T)                                          \
+    /**                                                                         \
+     * 列表获取元素，不受检查级别影响，始终不做任何检查 \
+     * @param this 列表                                                       \
+     * @param index 索引（调用者保证在 [0, size) 内）                \
+     * @return T 元素                                                         \
+     */                                                                         \
+    static inline T w_List_getUnchecked(T)(w_List(T) * this, int64_t index)     \
+    {                                                                           \
+        return this->elementData[index];                                        \
+    }
+
+// 列表设置元素（不检查）
+#define w_List_setUnchecked(T) w_concat(w_List(T), _setUnchecked)
+#define w_List_setUnchecked_define_(T)                                                    \
+    /**                                                                                   \
+     * 列表设置元素，不受检查级别影响，始终不做任何检查           \
+     * @param this 列表                                                                 \
+     * @param index 索引（调用者保证在 [0, size) 内）                          \
+     * @param element 元素                                                              \
+     * @return void                                                                       \
+     */                                                                                   \
+    static inline void w_List_setUnchecked(T)(w_List(T) * this, int64_t index, T element) \
+    {                                                                                     \
+        this->elementData[index] = element;                                               \
+    }
+
+// 列表添加元素
+#define w_List_add(T) w_concat(w_List(T), _add)
+#define w_List_add_define_(T)                                                                                                                                          \
+    /**                                                                                                                                                                \
+     * 列表添加元素                                                                                                                                              \
+     * @param this 列表                                                                                                                                              \
+     * @param index 索引（插入到这个位置）                                                                                                                  \
+     * @param element 元素                                                                                                                                           \
+     */                                                                                                                                                                \
+    static inline void w_List_add(T)(w_List(T) * this, int64_t index, T element)                                                                                       \
+    {                                                                                                                                                                  \
+        /* 断言 */                                                                                                                                                     \
+        w_check(this != NULL);                                                                                                                                         \
+        w_check(this->elementData != NULL || this->capacity == 0);                                                                                                     \
+        w_checkIndex(index >= 0 && index <= this->size);                                                                                                               \
+                                                                                                                                                                       \
+        /* 扩容 */                                                                                                                                                     \
+        if (this->size >= this->capacity)                                                                                                                              \
+        {                                                                                                                                                              \
+            int64_t newCapacity = this->capacity > 0 ? this->capacity * 2 : 16;                                                                                        \
+            this->elementData = w_AllocPolicy_realloc_(&this->policy, this->elementData, this->capacity * sizeof(T), this->size * sizeof(T), newCapacity * sizeof(T)); \
+            this->capacity = newCapacity;                                                                                                                              \
+        }                                                                                                                                                              \
+                                                                                                                                                                       \
+        /* 添加元素 */                                                                                                                                                 \
+        for (int64_t i = this->size; i > index; i--)                                                                                                                   \
+        {                                                                                                                                                              \
+            this->elementData[i] = this->elementData[i - 1];                                                                                                           \
+        }                                                                                                                                                              \
+        this->elementData[index] = element;                                                                                                                            \
+        this->size++;                                                                                                                                                  \
+    }
+
+// 列表删除元素
+#define w_List_remove(T) w_concat(w_List(T), _remove)
+#define w_List_remove_define_(T)                                      \
+    /**                                                               \
+     * 列表删除元素                                             \
+     * @param this 列表                                             \
+     * @param index 索引                                            \
+     * @return T 删除的元素                                      \
+     */                                                               \
+    static inline T w_List_remove(T)(w_List(T) * this, int64_t index) \
+    {                                                                 \
+        /* 断言 */                                                    \
+        w_check(this != NULL);                                        \
+        w_check(this->elementData != NULL || this->capacity == 0);    \
+        w_checkIndex(index >= 0 && index < this->size);               \
+                                                                      \
+        /* 删除元素 */                                                \
+        T element = this->elementData[index];                         \
+        for (int64_t i = index; i < this->size - 1; i++)              \
+        {                                                             \
+            this->elementData[i] = this->elementData[i + 1];          \
+        }                                                             \
+        this->size--;                                                 \
+        return element;                                               \
+    }
+
+// 列表是否为空
+#define w_List_isEmpty(T) w_concat(w_List(T), _isEmpty)
+#define w_List_isEmpty_define_(T)                                  \
+    /**                                                            \
+     * 列表是否为空                                          \
+     * @param this 列表                                          \
+     * @return bool true:为空 false:不为空                    \
+     */                                                            \
+    static inline bool w_List_isEmpty(T)(w_List(T) * this)         \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        return this->size == 0;                                    \
+    }
+
+// 列表插入元素到头部
+#define w_List_addFirst(T) w_concat(w_List(T), _addFirst)
+#define w_List_addFirst_define_(T)                                     \
+    /**                                                                \
+     * 列表插入元素到头部                                     \
+     * @param this 列表                                              \
+     * @param element 元素                                           \
+     */                                                                \
+    static inline void w_List_addFirst(T)(w_List(T) * this, T element) \
+    {                                                                  \
+        w_List_add(T)(this, 0, element);                               \
+    }
+
+// 列表插入元素到尾部
+#define w_List_addLast(T) w_concat(w_List(T), _addLast)
+#define w_List_addLast_define_(T)                                     \
+    /**                                                               \
+     * 列表插入元素到尾部                                    \
+     * @param this 列表                                             \
+     * @param element 元素                                          \
+     */                                                               \
+    static inline void w_List_addLast(T)(w_List(T) * this, T element) \
+    {                                                                 \
+        w_List_add(T)(this, this->size, element);                     \
+    }
+
+// 列表删除头部元素
+#define w_List_removeFirst(T) w_concat(w_List(T), _removeFirst)
+#define w_List_removeFirst_define_(T)                       \
+    /**                                                     \
+     * 列表删除头部元素                             \
+     * @param this 列表                                   \
+     * @return T 删除的元素                            \
+     */                                                     \
+    static inline T w_List_removeFirst(T)(w_List(T) * this) \
+    {                                                       \
+        return w_List_remove(T)(this, 0);                   \
+    }
+
+// 列表删除尾部元素
+#define w_List_removeLast(T) w_concat(w_List(T), _removeLast)
+#define w_List_removeLast_define_(T)                       \
+    /**                                                    \
+     * 列表删除尾部元素                            \
+     * @param this 列表                                  \
+     * @return T 删除的元素                           \
+     */                                                    \
+    static inline T w_List_removeLast(T)(w_List(T) * this) \
+    {                                                      \
+        return w_List_remove(T)(this, this->size - 1);     \
+    }
+
+// 列表获取数据指针
+#define w_List_data(T) w_concat(w_List(T), _data)
+#define w_List_data_define_(T)                                                        \
+    /**                                                                               \
+     * 列表获取数据指针                                                       \
+     * @param this 列表                                                             \
+     * @return T * 数据指针（慎用，如果扩容会导致该指针被释放） \
+     */                                                                               \
+    static inline T *w_List_data(T)(w_List(T) * this)                                 \
+    {                                                                                 \
+        w_check(this != NULL);                                                        \
+        w_check(this->elementData != NULL || this->capacity == 0);                    \
+        return this->elementData;                                                     \
+    }
+
+// 列表预留容量
+#define w_List_reserve(T) w_concat(w_List(T), _reserve)
+#define w_List_reserve_define_(T)                                                                                                                               \
+    /**                                                                                                                                                         \
+     * 列表预留容量（容量不足时扩容到至少 capacity）                                                                                          \
+     * @param this 列表                                                                                                                                       \
+     * @param capacity 容量                                                                                                                                   \
+     * @return void                                                                                                                                             \
+     */                                                                                                                                                         \
+    static inline void w_List_reserve(T)(w_List(T) * this, int64_t capacity)                                                                                    \
+    {                                                                                                                                                           \
+        w_check(this != NULL);                                                                                                                                  \
+        w_check(this->elementData != NULL || this->capacity == 0);                                                                                              \
+        w_check(capacity >= 0);                                                                                                                                 \
+        if (capacity <= this->capacity)                                                                                                                         \
+        {                                                                                                                                                       \
+            return;                                                                                                                                             \
+        }                                                                                                                                                       \
+        this->elementData = w_AllocPolicy_realloc_(&this->policy, this->elementData, this->capacity * sizeof(T), this->size * sizeof(T), capacity * sizeof(T)); \
+        this->capacity = capacity;                                                                                                                              \
+    }
+
+// 列表定义
+#define w_List_define(T)                \
+    w_List_type_define_(T);             \
+    w_List_initWithPolicy_define_(T);   \
+    w_List_initWithCapacity_define_(T); \
+    w_List_init_define_(T);             \
+    w_List_openMapped_define_(T);       \
+    w_List_advise_define_(T);           \
+    w_List_sync_define_(T);             \
+    w_List_deinit_define_(T);           \
+    w_List_size_define_(T);             \
+    w_List_capacity_define_(T);         \
+    w_List_get_define_(T);              \
+    w_List_set_define_(T);              \
+    w_List_getUnchecked_define_(T);     \
+    w_List_setUnchecked_define_(T);     \
+    w_List_add_define_(T);              \
+    w_List_remove_define_(T);           \
+    w_List_isEmpty_define_(T);          \
+    w_List_addFirst_define_(T);         \
+    w_List_addLast_define_(T);          \
+    w_List_removeFirst_define_(T);      \
+    w_List_removeLast_define_(T);       \
+    w_List_data_define_(T);             \
+    w_List_reserve_define_(T);
+
+// ========================================================================================================================================================
+//  小列表
+// ========================================================================================================================================================
+
+// 小列表类型
+// 前 N 个元素存放在结构体内部，超过 N 个元素时才申请堆内存
+#define w_SmallList(T, N) w_concat(w_concat(w_concat(w_SmallList_, T), _), N)
+
+// 小列表类型定义
+#define w_SmallList_type_define_(T, N)                          \
+    typedef struct                                              \
+    {                                                           \
+        T *heapData;      /* 堆数据（容量超过 N 时使用） */     \
+        int64_t size;     /* 大小 */                            \
+        int64_t capacity; /* 容量 */                            \
+        T inlineData[N];  /* 内联数据（容量不超过 N 时使用） */ \
+    } w_SmallList(T, N);
+
+// 小列表获取当前数据
+#define w_SmallList_elementData_(T, N) w_concat(w_SmallList(T, N), _elementData_)
+#define w_SmallList_elementData_define_(T, N)                                 \
+    /**                                                                       \
+     * 小列表获取当前数据（内联数据或堆数据）              \
+     * @param this 小列表                                                  \
+     * @return T * 数据指针                                               \
+     */                                                                       \
+    static inline T *w_SmallList_elementData_(T, N)(w_SmallList(T, N) * this) \
+    {                                                                         \
+        return this->capacity > N ? this->heapData : this->inlineData;        \
+    }
+
+// 小列表初始化
+#define w_SmallList_init(T, N) w_concat(w_SmallList(T, N), _init)
+#define w_SmallList_init_define_(T, N)                                  \
+    /**                                                                 \
+     * 小列表初始化（不申请内存）                          \
+     * @param this 小列表                                            \
+     * @return void                                                     \
+     */                                                                 \
+    static inline void w_SmallList_init(T, N)(w_SmallList(T, N) * this) \
+    {                                                                   \
+        w_check(this != NULL);                                          \
+        this->heapData = NULL;                                          \
+        this->size = 0;                                                 \
+        this->capacity = N;                                             \
+    }
+
+// 小列表销毁
+#define w_SmallList_deinit(T, N) w_concat(w_SmallList(T, N), _deinit)
+#define w_SmallList_deinit_define_(T, N)                                  \
+    /**                                                                   \
+     * 小列表销毁                                                    \
+     * @param this 小列表                                              \
+     * @return void                                                       \
+     */                                                                   \
+    static inline void w_SmallList_deinit(T, N)(w_SmallList(T, N) * this) \
+    {                                                                     \
+        w_check(this != NULL);                                            \
+        w_free(this->heapData);                                           \
+        memset(this, 0, sizeof(w_SmallList(T, N)));                       \
+    }
+
+// 小列表获取大小
+#define w_SmallList_size(T, N) w_concat(w_SmallList(T, N), _size)
+#define w_SmallList_size_define_(T, N)                                     \
+    /**                                                                    \
+     * 小列表获取大小                                               \
+     * @param this 小列表                                               \
+     * @return int64_t 大小                                              \
+     */                                                                    \
+    static inline int64_t w_SmallList_size(T, N)(w_SmallList(T, N) * this) \
+    {                                                                      \
+        w_check(this != NULL);                                             \
+        return this->size;                                                 \
+    }
+
+// 小列表获取容量
+#define w_SmallList_capacity(T, N) w_concat(w_SmallList(T, N), _capacity)
+#define w_SmallList_capacity_define_(T, N)                                     \
+    /**                                                                        \
+     * 小列表获取容量                                                   \
+     * @param this 小列表                                                   \
+     * @return int64_t 容量                                                  \
+     */                                                                        \
+    static inline int64_t w_SmallList_capacity(T, N)(w_SmallList(T, N) * this) \
+    {                                                                          \
+        w_check(this != NULL);                                                 \
+        return this->capacity;                                                 \
+    }
+
+// 小列表获取元素
+#define w_SmallList_get(T, N) w_concat(w_SmallList(T, N), _get)
+#define w_SmallList_get_define_(T, N)                                              \
+    /**                                                                            \
+     * 小列表获取元素                                                       \
+     * @param this 小列表                                                       \
+     * @param index 索引                                                         \
+     * @return T 元素                                                            \
+     */                                                                            \
+    static inline T w_SmallList_get(T, N)(w_SmallList(T, N) * this, int64_t index) \
+    {                                                                              \
+        w_check(this != NULL);                                                     \
+        w_checkIndex(index >= 0 && index < this->size);                            \
+        return w_SmallList_elementData_(T, N)(this)[index];                        \
+    }
+
+// 小列表设置元素
+#define w_SmallList_set(T, N) w_concat(w_SmallList(T, N), _set)
+#define w_SmallList_set_define_(T, N)                                                            \
+    /**                                                                                          \
+     * 小列表设置元素                                                                     \
+     * @param this 小列表                                                                     \
+     * @param index 索引                                                                       \
+     * @param element 元素                                                                     \
+     * @return void                                                                              \
+     */                                                                                          \
+    static inline void w_SmallList_set(T, N)(w_SmallList(T, N) * this, int64_t index, T element) \
+    {                                                                                            \
+        w_check(this != NULL);                                                                   \
+        w_checkIndex(index >= 0 && index < this->size);                                          \
+        w_SmallList_elementData_(T, N)(this)[index] = element;                                   \
+    }
+
+// 小列表添加元素
+#define w_SmallList_add(T, N) w_concat(w_SmallList(T, N), _add)
+#define w_SmallList_add_define_(T, N)                                                            \
+    /**                                                                                          \
+     * 小列表添加元素，超过内联容量时转移到堆内存                           \
+     * @param this 小列表                                                                     \
+     * @param index 索引（插入到这个位置）                                            \
+     * @param element 元素                                                                     \
+     * @return void                                                                              \
+     */                                                                                          \
+    static inline void w_SmallList_add(T, N)(w_SmallList(T, N) * this, int64_t index, T element) \
+    {                                                                                            \
+        /* 断言 */                                                                               \
+        w_check(this != NULL);                                                                   \
+        w_checkIndex(index >= 0 && index <= this->size);                                         \
+                                                                                                 \
+        /* 扩容 */                                                                               \
+        if (this->size >= this->capacity)                                                        \
+        {                                                                                        \
+            int64_t newCapacity = this->capacity > 0 ? this->capacity * 2 : 1;                   \
+            T *newHeapData = w_malloc(newCapacity * sizeof(T));                                  \
+            w_assert(newHeapData != NULL);                                                       \
+            memcpy(newHeapData, w_SmallList_elementData_(T, N)(this), this->size * sizeof(T));   \
+            w_free(this->heapData);                                                              \
+            this->heapData = newHeapData;                                                        \
+            this->capacity = newCapacity;                                                        \
+        }                                                                                        \
+                                                                                                 \
+        /* 添加元素 */                                                                           \
+        T *elementData = w_SmallList_elementData_(T, N)(this);                                   \
+        memmove(elementData + index + 1, elementData + index, (this->size - index) * sizeof(T)); \
+        elementData[index] = element;                                                            \
+        this->size++;                                                                            \
+    }
+
+// 小列表删除元素
+#define w_SmallList_remove(T, N) w_concat(w_SmallList(T, N), _remove)
+#define w_SmallList_remove_define_(T, N)                                                             \
+    /**                                                                                              \
+     * 小列表删除元素                                                                         \
+     * @param this 小列表                                                                         \
+     * @param index 索引                                                                           \
+     * @return T 删除的元素                                                                     \
+     */                                                                                              \
+    static inline T w_SmallList_remove(T, N)(w_SmallList(T, N) * this, int64_t index)                \
+    {                                                                                                \
+        w_check(this != NULL);                                                                       \
+        w_checkIndex(index >= 0 && index < this->size);                                              \
+        T *elementData = w_SmallList_elementData_(T, N)(this);                                       \
+        T element = elementData[index];                                                              \
+        memmove(elementData + index, elementData + index + 1, (this->size - index - 1) * sizeof(T)); \
+        this->size--;                                                                                \
+        return element;                                                                              \
+    }
+
+// 小列表是否为空
+#define w_SmallList_isEmpty(T, N) w_concat(w_SmallList(T, N), _isEmpty)
+#define w_SmallList_isEmpty_define_(T, N)                                  \
+    /**                                                                    \
+     * 小列表是否为空                                               \
+     * @param this 小列表                                               \
+     * @return bool true:为空 false:不为空                            \
+     */                                                                    \
+    static inline bool w_SmallList_isEmpty(T, N)(w_SmallList(T, N) * this) \
+    {                                                                      \
+        w_check(this != NULL);                                             \
+        return this->size == 0;                                            \
+    }
+
+// 小列表插入元素到头部
+#define w_SmallList_addFirst(T, N) w_concat(w_SmallList(T, N), _addFirst)
+#define w_SmallList_addFirst_define_(T, N)                                             \
+    /**                                                                                \
+     * 小列表插入元素到头部                                                  \
+     * @param this 小列表                                                           \
+     * @param element 元素                                                           \
+     */                                                                                \
+    static inline void w_SmallList_addFirst(T, N)(w_SmallList(T, N) * this, T element) \
+    {                                                                                  \
+        w_SmallList_add(T, N)(this, 0, element);                                       \
+    }
+
+// 小列表插入元素到尾部
+#define w_SmallList_addLast(T, N) w_concat(w_SmallList(T, N), _addLast)
+#define w_SmallList_addLast_define_(T, N)                                             \
+    /**                                                                               \
+     * 小列表插入元素到尾部                                                 \
+     * @param this 小列表                                                          \
+     * @param element 元素                                                          \
+     */                                                                               \
+    static inline void w_SmallList_addLast(T, N)(w_SmallList(T, N) * this, T element) \
+    {                                                                                 \
+        w_SmallList_add(T, N)(this, this->size, element);                             \
+    }
+
+// 小列表删除头部元素
+#define w_SmallList_removeFirst(T, N) w_concat(w_SmallList(T, N), _removeFirst)
+#define w_SmallList_removeFirst_define_(T, N)                               \
+    /**                                                                     \
+     * 小列表删除头部元素                                          \
+     * @param this 小列表                                                \
+     * @return T 删除的元素                                            \
+     */                                                                     \
+    static inline T w_SmallList_removeFirst(T, N)(w_SmallList(T, N) * this) \
+    {                                                                       \
+        return w_SmallList_remove(T, N)(this, 0);                           \
+    }
+
+// 小列表删除尾部元素
+#define w_SmallList_removeLast(T, N) w_concat(w_SmallList(T, N), _removeLast)
+#define w_SmallList_removeLast_define_(T, N)                               \
+    /**                                                                    \
+     * 小列表删除尾部元素                                         \
+     * @param this 小列表                                               \
+     * @return T 删除的元素                                           \
+     */                                                                    \
+    static inline T w_SmallList_removeLast(T, N)(w_SmallList(T, N) * this) \
+    {                                                                      \
+        return w_SmallList_remove(T, N)(this, this->size - 1);             \
+    }
+
+// 小列表获取数据指针
+#define w_SmallList_data(T, N) w_concat(w_SmallList(T, N), _data)
+#define w_SmallList_data_define_(T, N)                                                         \
+    /**                                                                                        \
+     * 小列表获取数据指针                                                             \
+     * @param this 小列表                                                                   \
+     * @return T * 数据指针（慎用，扩容或移动结构体会导致该指针失效） \
+     */                                                                                        \
+    static inline T *w_SmallList_data(T, N)(w_SmallList(T, N) * this)                          \
+    {                                                                                          \
+        w_check(this != NULL);                                                                 \
+        return w_SmallList_elementData_(T, N)(this);                                           \
+    }
+
+// 小列表定义
+// N 为内联存储的元素数量，必须是正整数字面量
+#define w_SmallList_define(T, N)           \
+    w_SmallList_type_define_(T, N);        \
+    w_SmallList_elementData_define_(T, N); \
+    w_SmallList_init_define_(T, N);        \
+    w_SmallList_deinit_define_(T, N);      \
+    w_SmallList_size_define_(T, N);        \
+    w_SmallList_capacity_define_(T, N);    \
+    w_SmallList_get_define_(T, N);         \
+    w_SmallList_set_define_(T, N);         \
+    w_SmallList_add_define_(T, N);         \
+    w_SmallList_remove_define_(T, N);      \
+    w_SmallList_isEmpty_define_(T, N);     \
+    w_SmallList_addFirst_define_(T, N);    \
+    w_SmallList_addLast_define_(T, N);     \
+    w_SmallList_removeFirst_define_(T, N); \
+    w_SmallList_removeLast_define_(T, N);  \
+    w_SmallList_data_define_(T, N);
+
+// ========================================================================================================================================================
+//  分段列表
+// ========================================================================================================================================================
+
+// 分段列表第一块的元素数量的对数（之后每块的大小翻倍）
+#define w_SEGMENTED_LIST_FIRST_CHUNK_SHIFT_ 4
+
+// 分段列表最大块数
+#define w_SEGMENTED_LIST_MAX_CHUNKS_ (63 - w_SEGMENTED_LIST_FIRST_CHUNK_SHIFT_)
+
+/**
+ * 分段列表索引所在的块
+ * 第 k 块包含 2^(k + FIRST_CHUNK_SHIFT) 个元素，之前的块共有 2^(k + FIRST_CHUNK_SHIFT) - 2^FIRST_CHUNK_SHIFT 个元素
+ * @param index 索引
+ * @return int64_t 块索引
+ */
+static inline int64_t w_SegmentedList_chunkOf_(int64_t index)
+{
+    return (63 - __builtin_clzll(index + (1 << w_SEGMENTED_LIST_FIRST_CHUNK_SHIFT_))) - w_SEGMENTED_LIST_FIRST_CHUNK_SHIFT_;
+}
+
+/**
+ * 分段列表块的起始索引
+ * @param chunk 块索引
+ * @return int64_t 块中第一个元素的索引
+ */
+static inline int64_t w_SegmentedList_chunkBegin_(int64_t chunk)
+{
+    return ((int64_t)1 << (chunk + w_SEGMENTED_LIST_FIRST_CHUNK_SHIFT_)) - (1 << w_SEGMENTED_LIST_FIRST_CHUNK_SHIFT_);
+}
+
+// 分段列表类型
+#define w_SegmentedList(T) w_concat(w_SegmentedList_, T)
+
+// 分段列表类型定义
+#define w_SegmentedList_type_define_(T)                               \
+    typedef struct                                                    \
+    {                                                                 \
+        T *chunks[w_SEGMENTED_LIST_MAX_CHUNKS_]; /* 块目录 */         \
+        int64_t chunkCount;                      /* 已申请的块数量 */ \
+        int64_t size;                            /* 大小 */           \
+    } w_SegmentedList(T);
+
+// 分段列表初始化
+#define w_SegmentedList_init(T) w_concat(w_SegmentedList(T), _init)
+#define w_SegmentedList_init_define_(T)                                   \
+    /**                                                                   \
+     * 分段列表初始化（不申请内存）                         \
+     * @param this 分段列表                                           \
+     * @return void                                                       \
+     */                                                                   \
+    static inline void w_SegmentedList_init(T)(w_SegmentedList(T) * this) \
+    {                                                                     \
+        w_check(this != NULL);                                            \
+        memset(this, 0, sizeof(w_SegmentedList(T)));                      \
+    }
+
+// 分段列表销毁
+#define w_SegmentedList_deinit(T) w_concat(w_SegmentedList(T), _deinit)
+#define w_SegmentedList_deinit_define_(T)                                   \
+    /**                                                                     \
+     * 分段列表销毁                                                   \
+     * @param this 分段列表                                             \
+     * @return void                                                         \
+     */                                                                     \
+    static inline void w_SegmentedList_deinit(T)(w_SegmentedList(T) * this) \
+    {                                                                       \
+        w_check(this != NULL);                                              \
+        for (int64_t i = 0; i < this->chunkCount; i++)                      \
+        {                                                                   \
+            w_free(this->chunks[i]);                                        \
+        }                                                                   \
+        memset(this, 0, sizeof(w_SegmentedList(T)));                        \
+    }
+
+// 分段列表获取大小
+#define w_SegmentedList_size(T) w_concat(w_SegmentedList(T), _size)
+#define w_SegmentedList_size_define_(T)                                      \
+    /**                                                                      \
+     * 分段列表获取大小                                              \
+     * @param this 分段列表                                              \
+     * @return int64_t 大小                                                \
+     */                                                                      \
+    static inline int64_t w_SegmentedList_size(T)(w_SegmentedList(T) * this) \
+    {                                                                        \
+        w_check(this != NULL);                                               \
+        return this->size;                                                   \
+    }
+
+// 分段列表是否为空
+#define w_SegmentedList_isEmpty(T) w_concat(w_SegmentedList(T), _isEmpty)
+#define w_SegmentedList_isEmpty_define_(T)                                   \
+    /**                                                                      \
+     * 分段列表是否为空                                              \
+     * @param this 分段列表                                              \
+     * @return bool true:为空 false:不为空                              \
+     */                                                                      \
+    static inline bool w_SegmentedList_isEmpty(T)(w_SegmentedList(T) * this) \
+    {                                                                        \
+        w_check(this != NULL);                                               \
+        return this->size == 0;                                              \
+    }
+
+// 分段列表获取元素指针
+#define w_SegmentedList_ptr(T) w_concat(w_SegmentedList(T), _ptr)
+#define w_SegmentedList_ptr_define_(T)                                                         \
+    /**                                                                                        \
+     * 分段列表获取元素指针                                                          \
+     * @param this 分段列表                                                                \
+     * @param index 索引                                                                     \
+     * @return T * 元素指针（添加元素不会使其失效，删除该元素后失效） \
+     */                                                                                        \
+    static inline T *w_SegmentedList_ptr(T)(w_SegmentedList(T) * this, int64_t index)          \
+    {                                                                                          \
+        w_check(this != NULL);                                                                 \
+        w_checkIndex(index >= 0 && index < this->size);                                        \
+        int64_t chunk = w_SegmentedList_chunkOf_(index);                                       \
+        return this->chunks[chunk] + (index - w_SegmentedList_chunkBegin_(chunk));             \
+    }
+
+// 分段列表获取元素
+#define w_SegmentedList_get(T) w_concat(w_SegmentedList(T), _get)
+#define w_SegmentedList_get_define_(T)                                               \
+    /**                                                                              \
+     * 分段列表获取元素                                                      \
+     * @param this 分段列表                                                      \
+     * @param index 索引                                                           \
+     * @return T 元素                                                              \
+     */                                                                              \
+    static inline T w_SegmentedList_get(T)(w_SegmentedList(T) * this, int64_t index) \
+    {                                                                                \
+        return *w_SegmentedList_ptr(T)(this, index);                                 \
+    }
+
+// 分段列表设置元素
+#define w_SegmentedList_set(T) w_concat(w_SegmentedList(T), _set)
+#define w_SegmentedList_set_define_(T)                                                             \
+    /**                                                                                            \
+     * 分段列表设置元素                                                                    \
+     * @param this 分段列表                                                                    \
+     * @param index 索引                                                                         \
+     * @param element 元素                                                                       \
+     * @return void                                                                                \
+     */                                                                                            \
+    static inline void w_SegmentedList_set(T)(w_SegmentedList(T) * this, int64_t index, T element) \
+    {                                                                                              \
+        *w_SegmentedList_ptr(T)(this, index) = element;                                            \
+    }
+
+// 分段列表插入元素到尾部
+#define w_SegmentedList_addLast(T) w_concat(w_SegmentedList(T), _addLast)
+#define w_SegmentedList_addLast_define_(T)                                                              \
+    /**                                                                                                 \
+     * 分段列表插入元素到尾部，容量不足时申请新的块，已有元素不会移动    \
+     * @param this 分段列表                                                                         \
+     * @param element 元素                                                                            \
+     * @return void                                                                                     \
+     */                                                                                                 \
+    static inline void w_SegmentedList_addLast(T)(w_SegmentedList(T) * this, T element)                 \
+    {                                                                                                   \
+        w_check(this != NULL);                                                                          \
+        int64_t chunk = w_SegmentedList_chunkOf_(this->size);                                           \
+        if (chunk >= this->chunkCount)                                                                  \
+        {                                                                                               \
+            w_assert(chunk < w_SEGMENTED_LIST_MAX_CHUNKS_);                                             \
+            this->chunks[chunk] = w_malloc(sizeof(T) << (chunk + w_SEGMENTED_LIST_FIRST_CHUNK_SHIFT_)); \
+            w_assert(this->chunks[chunk] != NULL);                                                      \
+            this->chunkCount++;                                                                         \
+        }                                                                                               \
+        this->chunks[chunk][this->size - w_SegmentedList_chunkBegin_(chunk)] = element;                 \
+        this->size++;                                                                                   \
+    }
+
+// 分段列表删除尾部元素
+#define w_SegmentedList_removeLast(T) w_concat(w_SegmentedList(T), _removeLast)
+#define w_SegmentedList_removeLast_define_(T)                                \
+    /**                                                                      \
+     * 分段列表删除尾部元素（不释放块）                      \
+     * @param this 分段列表                                              \
+     * @return T 删除的元素                                             \
+     */                                                                      \
+    static inline T w_SegmentedList_removeLast(T)(w_SegmentedList(T) * this) \
+    {                                                                        \
+        T element = w_SegmentedList_get(T)(this, this->size - 1);            \
+        this->size--;                                                        \
+        return element;                                                      \
+    }
+
+// 分段列表块数量
+#define w_SegmentedList_chunkCount(T) w_concat(w_SegmentedList(T), _chunkCount)
+#define w_SegmentedList_chunkCount_define_(T)                                      \
+    /**                                                                            \
+     * 分段列表中包含元素的块数量                                     \
+     * @param this 分段列表                                                    \
+     * @return int64_t 块数量                                                   \
+     */                                                                            \
+    static inline int64_t w_SegmentedList_chunkCount(T)(w_SegmentedList(T) * this) \
+    {                                                                              \
+        w_check(this != NULL);                                                     \
+        return this->size == 0 ? 0 : w_SegmentedList_chunkOf_(this->size - 1) + 1; \
+    }
+
+// 分段列表获取块
+#define w_SegmentedList_chunk(T) w_concat(w_SegmentedList(T), _chunk)
+#define w_SegmentedList_chunk_define_(T)                                                               \
+    /**                                                                                                \
+     * 分段列表获取块，用于按块遍历（块内元素连续存放）                        \
+     * @param this 分段列表                                                                        \
+     * @param chunk 块索引                                                                          \
+     * @param size 块中的元素数量（输出）                                                   \
+     * @return T * 块数据                                                                           \
+     */                                                                                                \
+    static inline T *w_SegmentedList_chunk(T)(w_SegmentedList(T) * this, int64_t chunk, int64_t *size) \
+    {                                                                                                  \
+        w_check(this != NULL);                                                                         \
+        w_check(size != NULL);                                                                         \
+        w_checkIndex(chunk >= 0 && chunk < w_SegmentedList_chunkCount(T)(this));                       \
+        int64_t begin = w_SegmentedList_chunkBegin_(chunk);                                            \
+        int64_t end = w_SegmentedList_chunkBegin_(chunk + 1);                                          \
+        *size = (end < this->size ? end : this->size) - begin;                                         \
+        return this->chunks[chunk];                                                                    \
+    }
+
+// 分段列表定义
+#define w_SegmentedList_define(T)          \
+    w_SegmentedList_type_define_(T);       \
+    w_SegmentedList_init_define_(T);       \
+    w_SegmentedList_deinit_define_(T);     \
+    w_SegmentedList_size_define_(T);       \
+    w_SegmentedList_isEmpty_define_(T);    \
+    w_SegmentedList_ptr_define_(T);        \
+    w_SegmentedList_get_define_(T);        \
+    w_SegmentedList_set_define_(T);        \
+    w_SegmentedList_addLast_define_(T);    \
+    w_SegmentedList_removeLast_define_(T); \
+    w_SegmentedList_chunkCount_define_(T); \
+    w_SegmentedList_chunk_define_(T);
+
+// ========================================================================================================================================================
+//  无锁队列
+// ========================================================================================================================================================
+
+// 缓存行大小
+#define w_CACHE_LINE_ 64
+
+// 阻塞等待前的自旋次数
+#define w_QUEUE_SPIN_COUNT_ 128
+
+/**
+ * 等待 *address 不再等于 expected（Linux 上使用 futex，其他平台让出 CPU）
+ * @param address 地址
+ * @param expected 期望值
+ * @return void
+ */
+static inline void w_futexWait_(uint32_t *address, uint32_t expected)
+{
+#if w_LINUX_SYSCALL_ENABLED_
+    syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#elif w_THREAD_ENABLED_
+    (void)address;
+    (void)expected;
+    sched_yield();
+#else
+    (void)address;
+    (void)expected;
+#endif
+}
+
+/**
+ * 唤醒所有在 address 上等待的线程
+ * @param address 地址
+ * @return void
+ */
+static inline void w_futexWake_(uint32_t *address)
+{
+#if w_LINUX_SYSCALL_ENABLED_
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT32_MAX, NULL, NULL, 0);
+#else
+    (void)address;
+#endif
+}
+
+// 等待事件
+typedef struct
+{
+    uint32_t sequence; /* 事件序号，每次通知加一 */
+    uint32_t waiters;  /* 等待者数量 */
+} w_WaitEvent_;
+
+/**
+ * 等待事件通知（有等待者时才进行系统调用）
+ * 调用前需要保证状态的修改已经写入（release）
+ * @param this 等待事件
+ * @return void
+ */
+static inline void w_WaitEvent_notify_(w_WaitEvent_ *this)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&this->waiters, __ATOMIC_RELAXED) > 0)
+    {
+        __atomic_add_fetch(&this->sequence, 1, __ATOMIC_SEQ_CST);
+        w_futexWake_(&this->sequence);
+    }
+}
+
+/**
+ * 准备等待，返回当前事件序号；之后需要重新检查条件，再调用 w_WaitEvent_wait_
+ * @param this 等待事件
+ * @return uint32_t 事件序号
+ */
+static inline uint32_t w_WaitEvent_prepare_(w_WaitEvent_ *this)
+{
+    __atomic_add_fetch(&this->waiters, 1, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&this->sequence, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * 等待事件序号发生变化，然后结束等待
+ * @param this 等待事件
+ * @param sequence w_WaitEvent_prepare_ 返回的事件序号
+ * @param wait 是否真的等待（重新检查条件已满足时为 false）
+ * @return void
+ */
+static inline void w_WaitEvent_wait_(w_WaitEvent_ *this, uint32_t sequence, bool wait)
+{
+    if (wait)
+    {
+        w_futexWait_(&this->sequence, sequence);
+    }
+    __atomic_sub_fetch(&this->waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * 自旋等待时降低 CPU 占用
+ * @return void
+ */
+static inline void w_spinPause_(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * 向上取整到 2 的幂
+ * @param value 值（大于 0）
+ * @return int64_t 不小于 value 的最小的 2 的幂
+ */
+static inline int64_t w_roundUpPowerOfTwo_(int64_t value)
+{
+    return value <= 1 ? 1 : (int64_t)1 << (64 - __builtin_clzll(value - 1));
+}
+
+// 单生产者单消费者队列类型
+#define w_SpscQueue(T) w_concat(w_SpscQueue_, T)
+
+// 单生产者单消费者队列类型定义
+// 生产者和消费者的字段分别放在不同的缓存行中，避免伪共享
+#define w_SpscQueue_type_define_(T)                                   \
+    typedef struct                                                    \
+    {                                                                 \
+        uint64_t tail;      /* 写入位置（生产者） */                  \
+        uint64_t headCache; /* 读取位置的缓存（生产者） */            \
+        char producerPadding_[w_CACHE_LINE_ - 2 * sizeof(uint64_t)];  \
+        uint64_t head;      /* 读取位置（消费者） */                  \
+        uint64_t tailCache; /* 写入位置的缓存（消费者） */            \
+        char consumerPadding_[w_CACHE_LINE_ - 2 * sizeof(uint64_t)];  \
+        w_WaitEvent_ notEmpty; /* 非空事件 */                         \
+        w_WaitEvent_ notFull;  /* 非满事件 */                         \
+        char eventPadding_[w_CACHE_LINE_ - 2 * sizeof(w_WaitEvent_)]; \
+        T *elementData;   /* 元素数据 */                              \
+        uint64_t mask;    /* 容量 - 1 */                              \
+        bool blocking;    /* 是否支持阻塞等待 */                      \
+    } w_SpscQueue(T);
+
+// 单生产者单消费者队列初始化
+#define w_SpscQueue_init(T) w_concat(w_SpscQueue(T), _init)
+#define w_SpscQueue_init_define_(T)                                                                                  \
+    /**                                                                                                              \
+     * 单生产者单消费者队列初始化                                                                       \
+     * @param this 队列                                                                                            \
+     * @param capacity 容量（向上取整到 2 的幂）                                                          \
+     * @param blocking 是否支持阻塞的 push/pop（开启后每次操作会检查是否需要唤醒等待者） \
+     * @return void                                                                                                  \
+     */                                                                                                              \
+    static inline void w_SpscQueue_init(T)(w_SpscQueue(T) * this, int64_t capacity, bool blocking)                   \
+    {                                                                                                                \
+        w_check(this != NULL);                                                                                       \
+        w_check(capacity > 0);                                                                                       \
+        memset(this, 0, sizeof(w_SpscQueue(T)));                                                                     \
+        capacity = w_roundUpPowerOfTwo_(capacity);                                                                   \
+        this->elementData = w_malloc(sizeof(T) * capacity);                                                          \
+        w_assert(this->elementData != NULL);                                                                         \
+        this->mask = capacity - 1;                                                                                   \
+        this->blocking = blocking;                                                                                   \
+    }
+
+// 单生产者单消费者队列销毁
+#define w_SpscQueue_deinit(T) w_concat(w_SpscQueue(T), _deinit)
+#define w_SpscQueue_deinit_define_(T)                               \
+    /**                                                             \
+     * 单生产者单消费者队列销毁                         \
+     * @param this 队列                                           \
+     * @return void                                                 \
+     */                                                             \
+    static inline void w_SpscQueue_deinit(T)(w_SpscQueue(T) * this) \
+    {                                                               \
+        w_check(this != NULL);                                      \
+        w_check(this->elementData != NULL);                         \
+        w_free(this->elementData);                                  \
+        memset(this, 0, sizeof(w_SpscQueue(T)));                    \
+    }
+
+// 单生产者单消费者队列容量
+#define w_SpscQueue_capacity(T) w_concat(w_SpscQueue(T), _capacity)
+#define w_SpscQueue_capacity_define_(T)                                  \
+    /**                                                                  \
+     * 单生产者单消费者队列容量                              \
+     * @param this 队列                                                \
+     * @return int64_t 容量                                            \
+     */                                                                  \
+    static inline int64_t w_SpscQueue_capacity(T)(w_SpscQueue(T) * this) \
+    {                                                                    \
+        w_check(this != NULL);                                           \
+        return this->mask + 1;                                           \
+    }
+
+// 单生产者单消费者队列大小
+#define w_SpscQueue_size(T) w_concat(w_SpscQueue(T), _size)
+#define w_SpscQueue_size_define_(T)                                             \
+    /**                                                                         \
+     * 单生产者单消费者队列大小（并发修改时仅为近似值） \
+     * @param this 队列                                                       \
+     * @return int64_t 大小                                                   \
+     */                                                                         \
+    static inline int64_t w_SpscQueue_size(T)(w_SpscQueue(T) * this)            \
+    {                                                                           \
+        w_check(this != NULL);                                                  \
+        uint64_t head = __atomic_load_n(&this->head, __ATOMIC_ACQUIRE);         \
+        uint64_t tail = __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE);         \
+        return (int64_t)(tail - head);                                          \
+    }
+
+// 单生产者单消费者队列批量入队
+#define w_SpscQueue_tryPushBatch(T) w_concat(w_SpscQueue(T), _tryPushBatch)
+#define w_SpscQueue_tryPushBatch_define_(T)                                                                    \
+    /**                                                                                                        \
+     * 单生产者单消费者队列批量入队（仅生产者线程调用，不阻塞）                    \
+     * @param this 队列                                                                                      \
+     * @param elements 元素                                                                                  \
+     * @param count 元素数量                                                                               \
+     * @return int64_t 实际入队的元素数量                                                             \
+     */                                                                                                        \
+    static inline int64_t w_SpscQueue_tryPushBatch(T)(w_SpscQueue(T) * this, const T *elements, int64_t count) \
+    {                                                                                                          \
+        w_check(this != NULL);                                                                                 \
+        w_check(elements != NULL || count == 0);                                                               \
+        w_check(count >= 0);                                                                                   \
+        uint64_t capacity = this->mask + 1;                                                                    \
+        uint64_t tail = this->tail;                                                                            \
+        uint64_t free = capacity - (tail - this->headCache);                                                   \
+        if (free < (uint64_t)count)                                                                            \
+        {                                                                                                      \
+            this->headCache = __atomic_load_n(&this->head, __ATOMIC_ACQUIRE);                                  \
+            free = capacity - (tail - this->headCache);                                                        \
+        }                                                                                                      \
+        int64_t pushed = free < (uint64_t)count ? (int64_t)free : count;                                       \
+        if (pushed == 0)                                                                                       \
+        {                                                                                                      \
+            return 0;                                                                                          \
+        }                                                                                                      \
+        /* 最多分两段拷贝 */                                                                                   \
+        uint64_t offset = tail & this->mask;                                                                   \
+        int64_t first = (int64_t)(capacity - offset) < pushed ? (int64_t)(capacity - offset) : pushed;         \
+        memcpy(this->elementData + offset, elements, first * sizeof(T));                                       \
+        memcpy(this->elementData, elements + first, (pushed - first) * sizeof(T));                             \
+        __atomic_store_n(&this->tail, tail + pushed, __ATOMIC_RELEASE);                                        \
+        if (this->blocking)                                                                                    \
+        {                                                                                                      \
+            w_WaitEvent_notify_(&this->notEmpty);                                                              \
+        }                                                                                                      \
+        return pushed;                                                                                         \
+    }
+
+// 单生产者单消费者队列批量出队
+#define w_SpscQueue_tryPopBatch(T) w_concat(w_SpscQueue(T), _tryPopBatch)
+#define w_SpscQueue_tryPopBatch_define_(T)                                                                  \
+    /**                                                                                                     \
+     * 单生产者单消费者队列批量出队（仅消费者线程调用，不阻塞）                 \
+     * @param this 队列                                                                                   \
+     * @param elements 出队的元素（输出）                                                          \
+     * @param maxCount 最多出队的元素数量                                                          \
+     * @return int64_t 实际出队的元素数量                                                          \
+     */                                                                                                     \
+    static inline int64_t w_SpscQueue_tryPopBatch(T)(w_SpscQueue(T) * this, T * elements, int64_t maxCount) \
+    {                                                                                                       \
+        w_check(this != NULL);                                                                              \
+        w_check(elements != NULL || maxCount == 0);                                                         \
+        w_check(maxCount >= 0);                                                                             \
+        uint64_t capacity = this->mask + 1;                                                                 \
+        uint64_t head = this->head;                                                                         \
+        uint64_t available = this->tailCache - head;                                                        \
+        if (available < (uint64_t)maxCount)                                                                 \
+        {                                                                                                   \
+            this->tailCache = __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE);                               \
+            available = this->tailCache - head;                                                             \
+        }                                                                                                   \
+        int64_t popped = available < (uint64_t)maxCount ? (int64_t)available : maxCount;                    \
+        if (popped == 0)                                                                                    \
+        {                                                                                                   \
+            return 0;                                                                                       \
+        }                                                                                                   \
+        uint64_t offset = head & this->mask;                                                                \
+        int64_t first = (int64_t)(capacity - offset) < popped ? (int64_t)(capacity - offset) : popped;      \
+        memcpy(elements, this->elementData + offset, first * sizeof(T));                                    \
+        memcpy(elements + first, this->elementData, (popped - first) * sizeof(T));                          \
+        __atomic_store_n(&this->head, head + popped, __ATOMIC_RELEASE);                                     \
+        if (this->blocking)                                                                                 \
+        {                                                                                                   \
+            w_WaitEvent_notify_(&this->notFull);                                                            \
+        }                                                                                                   \
+        return popped;                                                                                      \
+    }
+
+// 单生产者单消费者队列入队
+#define w_SpscQueue_tryPush(T) w_concat(w_SpscQueue(T), _tryPush)
+#define w_SpscQueue_tryPush_define_(T)                                                \
+    /**                                                                               \
+     * 单生产者单消费者队列入队（仅生产者线程调用，不阻塞） \
+     * @param this 队列                                                             \
+     * @param element 元素                                                          \
+     * @return bool 是否成功（队列已满时失败）                           \
+     */                                                                               \
+    static inline bool w_SpscQueue_tryPush(T)(w_SpscQueue(T) * this, T element)       \
+    {                                                                                 \
+        w_check(this != NULL);                                                        \
+        uint64_t tail = this->tail;                                                   \
+        if (tail - this->headCache > this->mask)                                      \
+        {                                                                             \
+            this->headCache = __atomic_load_n(&this->head, __ATOMIC_ACQUIRE);         \
+            if (tail - this->headCache > this->mask)                                  \
+            {                                                                         \
+                return false;                                                         \
+            }                                                                         \
+        }                                                                             \
+        this->elementData[tail & this->mask] = element;                               \
+        __atomic_store_n(&this->tail, tail + 1, __ATOMIC_RELEASE);                    \
+        if (this->blocking)                                                           \
+        {                                                                             \
+            w_WaitEvent_notify_(&this->notEmpty);                                     \
+        }                                                                             \
+        return true;                                                                  \
+    }
+
+// 单生产者单消费者队列出队
+#define w_SpscQueue_tryPop(T) w_concat(w_SpscQueue(T), _tryPop)
+#define w_SpscQueue_tryPop_define_(T)                                                 \
+    /**                                                                               \
+     * 单生产者单消费者队列出队（仅消费者线程调用，不阻塞） \
+     * @param this 队列                                                             \
+     * @param element 出队的元素（输出）                                     \
+     * @return bool 是否成功（队列为空时失败）                           \
+     */                                                                               \
+    static inline bool w_SpscQueue_tryPop(T)(w_SpscQueue(T) * this, T * element)      \
+    {                                                                                 \
+        w_check(this != NULL);                                                        \
+        w_check(element != NULL);                                                     \
+        uint64_t head = this->head;                                                   \
+        if (head == this->tailCache)                                                  \
+        {                                                                             \
+            this->tailCache = __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE);         \
+            if (head == this->tailCache)                                              \
+            {                                                                         \
+                return false;                                                         \
+            }                                                                         \
+        }                                                                             \
+        *element = this->elementData[head & this->mask];                              \
+        __atomic_store_n(&this->head, head + 1, __ATOMIC_RELEASE);                    \
+        if (this->blocking)                                                           \
+        {                                                                             \
+            w_WaitEvent_notify_(&this->notFull);                                      \
+        }                                                                             \
+        return true;                                                                  \
+    }
+
+// 单生产者单消费者队列阻塞入队
+#define w_SpscQueue_push(T) w_concat(w_SpscQueue(T), _push)
+#define w_SpscQueue_push_define_(T)                                                                         \
+    /**                                                                                                     \
+     * 单生产者单消费者队列入队，队列已满时阻塞（需要以 blocking 方式初始化） \
+     * @param this 队列                                                                                   \
+     * @param element 元素                                                                                \
+     * @return void                                                                                         \
+     */                                                                                                     \
+    static inline void w_SpscQueue_push(T)(w_SpscQueue(T) * this, T element)                                \
+    {                                                                                                       \
+        w_check(this != NULL);                                                                              \
+        w_check(this->blocking);                                                                            \
+        for (int spin = 0; !w_SpscQueue_tryPush(T)(this, element); spin++)                                  \
+        {                                                                                                   \
+            if (spin < w_QUEUE_SPIN_COUNT_)                                                                 \
+            {                                                                                               \
+                w_spinPause_();                                                                             \
+                continue;                                                                                   \
+            }                                                                                               \
+            uint32_t sequence = w_WaitEvent_prepare_(&this->notFull);                                       \
+            bool full = this->tail - __atomic_load_n(&this->head, __ATOMIC_SEQ_CST) > this->mask;           \
+            w_WaitEvent_wait_(&this->notFull, sequence, full);                                              \
+        }                                                                                                   \
+    }
+
+// 单生产者单消费者队列阻塞出队
+#define w_SpscQueue_pop(T) w_concat(w_SpscQueue(T), _pop)
+#define w_SpscQueue_pop_define_(T)                                                                          \
+    /**                                                                                                     \
+     * 单生产者单消费者队列出队，队列为空时阻塞（需要以 blocking 方式初始化） \
+     * @param this 队列                                                                                   \
+     * @return T 出队的元素                                                                            \
+     */                                                                                                     \
+    static inline T w_SpscQueue_pop(T)(w_SpscQueue(T) * this)                                               \
+    {                                                                                                       \
+        w_check(this != NULL);                                                                              \
+        w_check(this->blocking);                                                                            \
+        T element;                                                                                          \
+        for (int spin = 0; !w_SpscQueue_tryPop(T)(this, &element); spin++)                                  \
+        {                                                                                                   \
+            if (spin < w_QUEUE_SPIN_COUNT_)                                                                 \
+            {                                                                                               \
+                w_spinPause_();                                                                             \
+                continue;                                                                                   \
+            }                                                                                               \
+            uint32_t sequence = w_WaitEvent_prepare_(&this->notEmpty);                                      \
+            bool empty = this->head == __atomic_load_n(&this->tail, __ATOMIC_SEQ_CST);                      \
+            w_WaitEvent_wait_(&this->notEmpty, sequence, empty);                                            \
+        }                                                                                                   \
+        return element;                                                                                     \
+    }
+
+// 单生产者单消费者队列定义
+#define w_SpscQueue_define(T)            \
+    w_SpscQueue_type_define_(T);         \
+    w_SpscQueue_init_define_(T);         \
+    w_SpscQueue_deinit_define_(T);       \
+    w_SpscQueue_capacity_define_(T);     \
+    w_SpscQueue_size_define_(T);         \
+    w_SpscQueue_tryPushBatch_define_(T); \
+    w_SpscQueue_tryPopBatch_define_(T);  \
+    w_SpscQueue_tryPush_define_(T);      \
+    w_SpscQueue_tryPop_define_(T);       \
+    w_SpscQueue_push_define_(T);         \
+    w_SpscQueue_pop_define_(T);
+
+// 多生产者多消费者队列单元
+#define w_MpmcQueue_Cell_(T) w_concat(w_concat(w_MpmcQueue_Cell_, T), _)
+#define w_MpmcQueue_Cell_type_define_(T)  \
+    typedef struct                        \
+    {                                     \
+        uint64_t sequence; /* 单元序号 */ \
+        T element;         /* 元素 */     \
+    } w_MpmcQueue_Cell_(T);
+
+// 多生产者多消费者队列类型
+#define w_MpmcQueue(T) w_concat(w_MpmcQueue_, T)
+
+// 多生产者多消费者队列类型定义（Vyukov 有界队列）
+#define w_MpmcQueue_type_define_(T)                                   \
+    typedef struct                                                    \
+    {                                                                 \
+        uint64_t enqueuePosition; /* 入队位置 */                      \
+        char enqueuePadding_[w_CACHE_LINE_ - sizeof(uint64_t)];       \
+        uint64_t dequeuePosition; /* 出队位置 */                      \
+        char dequeuePadding_[w_CACHE_LINE_ - sizeof(uint64_t)];       \
+        w_WaitEvent_ notEmpty; /* 非空事件 */                         \
+        w_WaitEvent_ notFull;  /* 非满事件 */                         \
+        char eventPadding_[w_CACHE_LINE_ - 2 * sizeof(w_WaitEvent_)]; \
+        w_MpmcQueue_Cell_(T) * cells; /* 单元 */                      \
+        uint64_t mask;                /* 容量 - 1 */                  \
+        bool blocking;                /* 是否支持阻塞等待 */          \
+    } w_MpmcQueue(T);
+
+// 多生产者多消费者队列初始化
+#define w_MpmcQueue_init(T) w_concat(w_MpmcQueue(T), _init)
+#define w_MpmcQueue_init_define_(T)                                                                                  \
+    /**                                                                                                              \
+     * 多生产者多消费者队列初始化                                                                       \
+     * @param this 队列                                                                                            \
+     * @param capacity 容量（向上取整到 2 的幂，至少为 2）                                            \
+     * @param blocking 是否支持阻塞的 push/pop（开启后每次操作会检查是否需要唤醒等待者） \
+     * @return void                                                                                                  \
+     */                                                                                                              \
+    static inline void w_MpmcQueue_init(T)(w_MpmcQueue(T) * this, int64_t capacity, bool blocking)                   \
+    {                                                                                                                \
+        w_check(this != NULL);                                                                                       \
+        w_check(capacity > 0);                                                                                       \
+        memset(this, 0, sizeof(w_MpmcQueue(T)));                                                                     \
+        capacity = w_roundUpPowerOfTwo_(capacity < 2 ? 2 : capacity);                                                \
+        this->cells = w_malloc(sizeof(w_MpmcQueue_Cell_(T)) * capacity);                                             \
+        w_assert(this->cells != NULL);                                                                               \
+        for (int64_t i = 0; i < capacity; i++)                                                                       \
+        {                                                                                                            \
+            this->cells[i].sequence = i;                                                                             \
+        }                                                                                                            \
+        this->mask = capacity - 1;                                                                                   \
+        this->blocking = blocking;                                                                                   \
+    }
+
+// 多生产者多消费者队列销毁
+#define w_MpmcQueue_deinit(T) w_concat(w_MpmcQueue(T), _deinit)
+#define w_MpmcQueue_deinit_define_(T)                               \
+    /**                                                             \
+     * 多生产者多消费者队列销毁                         \
+     * @param this 队列                                           \
+     * @return void                                                 \
+     */                                                             \
+    static inline void w_MpmcQueue_deinit(T)(w_MpmcQueue(T) * this) \
+    {                                                               \
+        w_check(this != NULL);                                      \
+        w_check(this->cells != NULL);                               \
+        w_free(this->cells);                                        \
+        memset(this, 0, sizeof(w_MpmcQueue(T)));                    \
+    }
+
+// 多生产者多消费者队列容量
+#define w_MpmcQueue_capacity(T) w_concat(w_MpmcQueue(T), _capacity)
+#define w_MpmcQueue_capacity_define_(T)                                  \
+    /**                                                                  \
+     * 多生产者多消费者队列容量                              \
+     * @param this 队列                                                \
+     * @return int64_t 容量                                            \
+     */                                                                  \
+    static inline int64_t w_MpmcQueue_capacity(T)(w_MpmcQueue(T) * this) \
+    {                                                                    \
+        w_check(this != NULL);                                           \
+        return this->mask + 1;                                           \
+    }
+
+// 多生产者多消费者队列大小
+#define w_MpmcQueue_size(T) w_concat(w_MpmcQueue(T), _size)
+#define w_MpmcQueue_size_define_(T)                                                           \
+    /**                                                                                       \
+     * 多生产者多消费者队列大小（并发修改时仅为近似值）               \
+     * @param this 队列                                                                     \
+     * @return int64_t 大小                                                                 \
+     */                                                                                       \
+    static inline int64_t w_MpmcQueue_size(T)(w_MpmcQueue(T) * this)                          \
+    {                                                                                         \
+        w_check(this != NULL);                                                                \
+        uint64_t dequeuePosition = __atomic_load_n(&this->dequeuePosition, __ATOMIC_ACQUIRE); \
+        uint64_t enqueuePosition = __atomic_load_n(&this->enqueuePosition, __ATOMIC_ACQUIRE); \
+        int64_t size = (int64_t)(enqueuePosition - dequeuePosition);                          \
+        return size < 0 ? 0 : size;                                                           \
+    }
+
+// 多生产者多消费者队列入队
+#define w_MpmcQueue_tryPush(T) w_concat(w_MpmcQueue(T), _tryPush)
+#define w_MpmcQueue_tryPush_define_(T)                                                                                                      \
+    /**                                                                                                                                     \
+     * 多生产者多消费者队列入队（不阻塞）                                                                                  \
+     * @param this 队列                                                                                                                   \
+     * @param element 元素                                                                                                                \
+     * @return bool 是否成功（队列已满时失败）                                                                                 \
+     */                                                                                                                                     \
+    static inline bool w_MpmcQueue_tryPush(T)(w_MpmcQueue(T) * this, T element)                                                             \
+    {                                                                                                                                       \
+        w_check(this != NULL);                                                                                                              \
+        uint64_t position = __atomic_load_n(&this->enqueuePosition, __ATOMIC_RELAXED);                                                      \
+        w_MpmcQueue_Cell_(T) * cell;                                                                                                        \
+        while (true)                                                                                                                        \
+        {                                                                                                                                   \
+            cell = &this->cells[position & this->mask];                                                                                     \
+            uint64_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);                                                         \
+            int64_t diff = (int64_t)(sequence - position);                                                                                  \
+            if (diff == 0)                                                                                                                  \
+            {                                                                                                                               \
+                /* 单元空闲，尝试占用 */                                                                                                    \
+                if (__atomic_compare_exchange_n(&this->enqueuePosition, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) \
+                {                                                                                                                           \
+                    break;                                                                                                                  \
+                }                                                                                                                           \
+            }                                                                                                                               \
+            else if (diff < 0)                                                                                                              \
+            {                                                                                                                               \
+                /* 队列已满 */                                                                                                              \
+                return false;                                                                                                               \
+            }                                                                                                                               \
+            else                                                                                                                            \
+            {                                                                                                                               \
+                position = __atomic_load_n(&this->enqueuePosition, __ATOMIC_RELAXED);                                                       \
+            }                                                                                                                               \
+        }                                                                                                                                   \
+        cell->element = element;                                                                                                            \
+        __atomic_store_n(&cell->sequence, position + 1, __ATOMIC_RELEASE);                                                                  \
+        if (this->blocking)                                                                                                                 \
+        {                                                                                                                                   \
+            w_WaitEvent_notify_(&this->notEmpty);                                                                                           \
+        }                                                                                                                                   \
+        return true;                                                                                                                        \
+    }
+
+// 多生产者多消费者队列出队
+#define w_MpmcQueue_tryPop(T) w_concat(w_MpmcQueue(T), _tryPop)
+#define w_MpmcQueue_tryPop_define_(T)                                                                                                       \
+    /**                                                                                                                                     \
+     * 多生产者多消费者队列出队（不阻塞）                                                                                  \
+     * @param this 队列                                                                                                                   \
+     * @param element 出队的元素（输出）                                                                                           \
+     * @return bool 是否成功（队列为空时失败）                                                                                 \
+     */                                                                                                                                     \
+    static inline bool w_MpmcQueue_tryPop(T)(w_MpmcQueue(T) * this, T * element)                                                            \
+    {                                                                                                                                       \
+        w_check(this != NULL);                                                                                                              \
+        w_check(element != NULL);                                                                                                           \
+        uint64_t position = __atomic_load_n(&this->dequeuePosition, __ATOMIC_RELAXED);                                                      \
+        w_MpmcQueue_Cell_(T) * cell;                                                                                                        \
+        while (true)                                                                                                                        \
+        {                                                                                                                                   \
+            cell = &this->cells[position & this->mask];                                                                                     \
+            uint64_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);                                                         \
+            int64_t diff = (int64_t)(sequence - (position + 1));                                                                            \
+            if (diff == 0)                                                                                                                  \
+            {                                                                                                                               \
+                /* 单元已写入，尝试占用 */                                                                                                  \
+                if (__atomic_compare_exchange_n(&this->dequeuePosition, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) \
+                {                                                                                                                           \
+                    break;                                                                                                                  \
+                }                                                                                                                           \
+            }                                                                                                                               \
+            else if (diff < 0)                                                                                                              \
+            {                                                                                                                               \
+                /* 队列为空 */                                                                                                              \
+                return false;                                                                                                               \
+            }                                                                                                                               \
+            else                                                                                                                            \
+            {                                                                                                                               \
+                position = __atomic_load_n(&this->dequeuePosition, __ATOMIC_RELAXED);                                                       \
+            }                                                                                                                               \
+        }                                                                                                                                   \
+        *element = cell->element;                                                                                                           \
+        __atomic_store_n(&cell->sequence, position + this->mask + 1, __ATOMIC_RELEASE);                                                     \
+        if (this->blocking)                                                                                                                 \
+        {                                                                                                                                   \
+            w_WaitEvent_notify_(&this->notFull);                                                                                            \
+        }                                                                                                                                   \
+        return true;                                                                                                                        \
+    }
+
+// 多生产者多消费者队列批量入队
+#define w_MpmcQueue_tryPushBatch(T) w_concat(w_MpmcQueue(T), _tryPushBatch)
+#define w_MpmcQueue_tryPushBatch_define_(T)                                                                                     \
+    /**                                                                                                                         \
+     * 多生产者多消费者队列批量入队（不阻塞，元素逐个入队，可能与其他生产者的元素交错） \
+     * @param this 队列                                                                                                       \
+     * @param elements 元素                                                                                                   \
+     * @param count 元素数量                                                                                                \
+     * @return int64_t 实际入队的元素数量                                                                              \
+     */                                                                                                                         \
+    static inline int64_t w_MpmcQueue_tryPushBatch(T)(w_MpmcQueue(T) * this, const T *elements, int64_t count)                  \
+    {                                                                                                                           \
+        w_check(elements != NULL || count == 0);                                                                                \
+        w_check(count >= 0);                                                                                                    \
+        int64_t pushed = 0;                                                                                                     \
+        while (pushed < count && w_MpmcQueue_tryPush(T)(this, elements[pushed]))                                                \
+        {                                                                                                                       \
+            pushed++;                                                                                                           \
+        }                                                                                                                       \
+        return pushed;                                                                                                          \
+    }
+
+// 多生产者多消费者队列批量出队
+#define w_MpmcQueue_tryPopBatch(T) w_concat(w_MpmcQueue(T), _tryPopBatch)
+#define w_MpmcQueue_tryPopBatch_define_(T)                                                                  \
+    /**                                                                                                     \
+     * 多生产者多消费者队列批量出队（不阻塞）                                            \
+     * @param this 队列                                                                                   \
+     * @param elements 出队的元素（输出）                                                          \
+     * @param maxCount 最多出队的元素数量                                                          \
+     * @return int64_t 实际出队的元素数量                                                          \
+     */                                                                                                     \
+    static inline int64_t w_MpmcQueue_tryPopBatch(T)(w_MpmcQueue(T) * this, T * elements, int64_t maxCount) \
+    {                                                                                                       \
+        w_check(elements != NULL || maxCount == 0);                                                         \
+        w_check(maxCount >= 0);                                                                             \
+        int64_t popped = 0;                                                                                 \
+        while (popped < maxCount && w_MpmcQueue_tryPop(T)(this, &elements[popped]))                         \
+        {                                                                                                   \
+            popped++;                                                                                       \
+        }                                                                                                   \
+        return popped;                                                                                      \
+    }
+
+// 多生产者多消费者队列阻塞入队
+#define w_MpmcQueue_push(T) w_concat(w_MpmcQueue(T), _push)
+#define w_MpmcQueue_push_define_(T)                                                                                  \
+    /**                                                                                                              \
+     * 多生产者多消费者队列入队，队列已满时阻塞（需要以 blocking 方式初始化）          \
+     * @param this 队列                                                                                            \
+     * @param element 元素                                                                                         \
+     * @return void                                                                                                  \
+     */                                                                                                              \
+    static inline void w_MpmcQueue_push(T)(w_MpmcQueue(T) * this, T element)                                         \
+    {                                                                                                                \
+        w_check(this != NULL);                                                                                       \
+        w_check(this->blocking);                                                                                     \
+        for (int spin = 0; !w_MpmcQueue_tryPush(T)(this, element); spin++)                                           \
+        {                                                                                                            \
+            if (spin < w_QUEUE_SPIN_COUNT_)                                                                          \
+            {                                                                                                        \
+                w_spinPause_();                                                                                      \
+                continue;                                                                                            \
+            }                                                                                                        \
+            uint32_t sequence = w_WaitEvent_prepare_(&this->notFull);                                                \
+            uint64_t position = __atomic_load_n(&this->enqueuePosition, __ATOMIC_SEQ_CST);                           \
+            uint64_t cellSequence = __atomic_load_n(&this->cells[position & this->mask].sequence, __ATOMIC_SEQ_CST); \
+            w_WaitEvent_wait_(&this->notFull, sequence, (int64_t)(cellSequence - position) < 0);                     \
+        }                                                                                                            \
+    }
+
+// 多生产者多消费者队列阻塞出队
+#define w_MpmcQueue_pop(T) w_concat(w_MpmcQueue(T), _pop)
+#define w_MpmcQueue_pop_define_(T)                                                                                   \
+    /**                                                                                                              \
+     * 多生产者多消费者队列出队，队列为空时阻塞（需要以 blocking 方式初始化）          \
+     * @param this 队列                                                                                            \
+     * @return T 出队的元素                                                                                     \
+     */                                                                                                              \
+    static inline T w_MpmcQueue_pop(T)(w_MpmcQueue(T) * this)                                                        \
+    {                                                                                                                \
+        w_check(this != NULL);                                                                                       \
+        w_check(this->blocking);                                                                                     \
+        T element;                                                                                                   \
+        for (int spin = 0; !w_MpmcQueue_tryPop(T)(this, &element); spin++)                                           \
+        {                                                                                                            \
+            if (spin < w_QUEUE_SPIN_COUNT_)                                                                          \
+            {                                                                                                        \
+                w_spinPause_();                                                                                      \
+                continue;                                                                                            \
+            }                                                                                                        \
+            uint32_t sequence = w_WaitEvent_prepare_(&this->notEmpty);                                               \
+            uint64_t position = __atomic_load_n(&this->dequeuePosition, __ATOMIC_SEQ_CST);                           \
+            uint64_t cellSequence = __atomic_load_n(&this->cells[position & this->mask].sequence, __ATOMIC_SEQ_CST); \
+            w_WaitEvent_wait_(&this->notEmpty, sequence, (int64_t)(cellSequence - (position + 1)) < 0);              \
+        }                                                                                                            \
+        return element;                                                                                              \
+    }
+
+// 多生产者多消费者队列定义
+#define w_MpmcQueue_define(T)            \
+    w_MpmcQueue_Cell_type_define_(T);    \
+    w_MpmcQueue_type_define_(T);         \
+    w_MpmcQueue_init_define_(T);         \
+    w_MpmcQueue_deinit_define_(T);       \
+    w_MpmcQueue_capacity_define_(T);     \
+    w_MpmcQueue_size_define_(T);         \
+    w_MpmcQueue_tryPush_define_(T);      \
+    w_MpmcQueue_tryPop_define_(T);       \
+    w_MpmcQueue_tryPushBatch_define_(T); \
+    w_MpmcQueue_tryPopBatch_define_(T);  \
+    w_MpmcQueue_push_define_(T);         \
+    w_MpmcQueue_pop_define_(T);
+
+// ========================================================================================================================================================
+//  排序和查找
+// ========================================================================================================================================================
+
+// 插入排序阈值
+#define w_SORT_INSERTION_THRESHOLD_ 32
+
+// 并行排序阈值，元素数量低于该值时使用串行排序
+#ifndef w_PARALLEL_SORT_CUTOFF
+#define w_PARALLEL_SORT_CUTOFF 65536
+#endif
+
+// 插入排序
+#define w_insertionSort_(T) w_concat(w_concat(w_insertionSort_, T), _)
+#define w_insertionSort_define_(T)                                    \
+    /**                                                               \
+     * 插入排序（稳定）                                       \
+     * @param data 数据                                             \
+     * @param size 元素数量                                       \
+     * @return void                                                   \
+     */                                                               \
+    static inline void w_insertionSort_(T)(T * data, int64_t size)    \
+    {                                                                 \
+        for (int64_t i = 1; i < size; i++)                            \
+        {                                                             \
+            T element = data[i];                                      \
+            int64_t j = i;                                            \
+            while (j > 0 && w_compare(T)(&data[j - 1], &element) > 0) \
+            {                                                         \
+                data[j] = data[j - 1];                                \
+                j--;                                                  \
+            }                                                         \
+            data[j] = element;                                        \
+        }                                                             \
+    }
+
+// 归并两个有序序列
+#define w_mergeRuns_(T) w_concat(w_concat(w_mergeRuns_, T), _)
+#define w_mergeRuns_define_(T)                                                                       \
+    /**                                                                                              \
+     * 归并两个有序序列（稳定，相等时 a 在前）                                     \
+     * @param a 有序序列 a                                                                       \
+     * @param aSize a 的元素数量                                                                \
+     * @param b 有序序列 b                                                                       \
+     * @param bSize b 的元素数量                                                                \
+     * @param out 输出（不能与 a、b 重叠）                                                 \
+     * @return void                                                                                  \
+     */                                                                                              \
+    static inline void w_mergeRuns_(T)(const T *a, int64_t aSize, const T *b, int64_t bSize, T *out) \
+    {                                                                                                \
+        int64_t i = 0, j = 0, k = 0;                                                                 \
+        while (i < aSize && j < bSize)                                                               \
+        {                                                                                            \
+            if (w_compare(T)((T *)&b[j], (T *)&a[i]) < 0)                                            \
+            {                                                                                        \
+                out[k++] = b[j++];                                                                   \
+            }                                                                                        \
+            else                                                                                     \
+            {                                                                                        \
+                out[k++] = a[i++];                                                                   \
+            }                                                                                        \
+        }                                                                                            \
+        memcpy(out + k, a + i, (aSize - i) * sizeof(T));                                             \
+        k += aSize - i;                                                                              \
+        memcpy(out + k, b + j, (bSize - j) * sizeof(T));                                             \
+    }
+
+// 使用缓冲区归并排序
+#define w_mergeSort_(T) w_concat(w_concat(w_mergeSort_, T), _)
+#define w_mergeSort_define_(T)                                                                                   \
+    /**                                                                                                          \
+     * 自底向上归并排序（稳定）                                                                      \
+     * @param data 数据                                                                                        \
+     * @param size 元素数量                                                                                  \
+     * @param buffer 缓冲区（至少 size 个元素）                                                        \
+     * @return void                                                                                              \
+     */                                                                                                          \
+    static inline void w_mergeSort_(T)(T * data, int64_t size, T * buffer)                                       \
+    {                                                                                                            \
+        /* 小块插入排序 */                                                                                       \
+        for (int64_t i = 0; i < size; i += w_SORT_INSERTION_THRESHOLD_)                                          \
+        {                                                                                                        \
+            int64_t blockSize = size - i < w_SORT_INSERTION_THRESHOLD_ ? size - i : w_SORT_INSERTION_THRESHOLD_; \
+            w_insertionSort_(T)(data + i, blockSize);                                                            \
+        }                                                                                                        \
+                                                                                                                 \
+        /* 逐层归并，在 data 和 buffer 之间交替 */                                                               \
+        T *src = data, *dst = buffer;                                                                            \
+        for (int64_t width = w_SORT_INSERTION_THRESHOLD_; width < size; width *= 2)                              \
+        {                                                                                                        \
+            for (int64_t i = 0; i < size; i += 2 * width)                                                        \
+            {                                                                                                    \
+                int64_t mid = i + width < size ? i + width : size;                                               \
+                int64_t end = i + 2 * width < size ? i + 2 * width : size;                                       \
+                w_mergeRuns_(T)(src + i, mid - i, src + mid, end - mid, dst + i);                                \
+            }                                                                                                    \
+            T *temp = src;                                                                                       \
+            src = dst;                                                                                           \
+            dst = temp;                                                                                          \
+        }                                                                                                        \
+        if (src != data)                                                                                         \
+        {                                                                                                        \
+            memcpy(data, src, size * sizeof(T));                                                                 \
+        }                                                                                                        \
+    }
+
+// 排序
+#define w_sort(T) w_concat(w_sort_, T)
+#define w_sort_define_(T)                                       \
+    /**                                                         \
+     * 排序（稳定，升序，使用 w_compare(T) 比较） \
+     * @param data 数据                                       \
+     * @param size 元素数量                                 \
+     * @return void                                             \
+     */                                                         \
+    static inline void w_sort(T)(T * data, int64_t size)        \
+    {                                                           \
+        w_check(data != NULL || size == 0);                     \
+        w_check(size >= 0);                                     \
+        if (size <= w_SORT_INSERTION_THRESHOLD_)                \
+        {                                                       \
+            w_insertionSort_(T)(data, size);                    \
+            return;                                             \
+        }                                                       \
+        T *buffer = w_malloc(sizeof(T) * size);                 \
+        w_assert(buffer != NULL);                               \
+        w_mergeSort_(T)(data, size, buffer);                    \
+        w_free(buffer);                                         \
+    }
+
+// 归并路径划分
+#define w_mergeSplit_(T) w_concat(w_concat(w_mergeSplit_, T), _)
+#define w_mergeSplit_define_(T)                                                                                    \
+    /**                                                                                                            \
+     * 归并路径划分：求归并结果的前 diagonal 个元素中来自 a 的数量                          \
+     * @param a 有序序列 a                                                                                     \
+     * @param aSize a 的元素数量                                                                              \
+     * @param b 有序序列 b                                                                                     \
+     * @param bSize b 的元素数量                                                                              \
+     * @param diagonal 归并结果中的位置                                                                    \
+     * @return int64_t 来自 a 的元素数量                                                                    \
+     */                                                                                                            \
+    static inline int64_t w_mergeSplit_(T)(const T *a, int64_t aSize, const T *b, int64_t bSize, int64_t diagonal) \
+    {                                                                                                              \
+        int64_t low = diagonal > bSize ? diagonal - bSize : 0;                                                     \
+        int64_t high = diagonal < aSize ? diagonal : aSize;                                                        \
+        while (low < high)                                                                                         \
+        {                                                                                                          \
+            int64_t mid = low + (high - low) / 2;                                                                  \
+            if (w_compare(T)((T *)&a[mid], (T *)&b[diagonal - mid - 1]) <= 0)                                      \
+            {                                                                                                      \
+                low = mid + 1;                                                                                     \
+            }                                                                                                      \
+            else                                                                                                   \
+            {                                                                                                      \
+                high = mid;                                                                                        \
+            }                                                                                                      \
+        }                                                                                                          \
+        return low;                                                                                                \
+    }
+
+// 并行归并上下文
+#define w_ParallelMergeContext_(T) w_concat(w_concat(w_ParallelMergeContext_, T), _)
+#define w_ParallelMergeContext_type_define_(T) \
+    typedef struct                             \
+    {                                          \
+        const T *a;    /* 有序序列 a */        \
+        int64_t aSize; /* a 的元素数量 */      \
+        const T *b;    /* 有序序列 b */        \
+        int64_t bSize; /* b 的元素数量 */      \
+        T *out;        /* 输出 */              \
+        int64_t parts; /* 分段数量 */          \
+    } w_ParallelMergeContext_(T);
+
+// 并行归并任务
+#define w_parallelMergeTask_(T) w_concat(w_concat(w_parallelMergeTask_, T), _)
+#define w_parallelMergeTask_define_(T)                                                                      \
+    /**                                                                                                     \
+     * 并行归并任务，每一段按归并路径划分后独立归并                                   \
+     * @param context 上下文                                                                             \
+     * @param begin 起始段                                                                               \
+     * @param end 结束段                                                                                 \
+     * @return void                                                                                         \
+     */                                                                                                     \
+    static inline void w_parallelMergeTask_(T)(void *context, int64_t begin, int64_t end)                   \
+    {                                                                                                       \
+        w_ParallelMergeContext_(T) *mergeContext = context;                                                 \
+        const T *a = mergeContext->a, *b = mergeContext->b;                                                 \
+        int64_t aSize = mergeContext->aSize, bSize = mergeContext->bSize;                                   \
+        int64_t total = aSize + bSize;                                                                      \
+        for (int64_t part = begin; part < end; part++)                                                      \
+        {                                                                                                   \
+            int64_t d0 = total * part / mergeContext->parts;                                                \
+            int64_t d1 = total * (part + 1) / mergeContext->parts;                                          \
+            int64_t i0 = w_mergeSplit_(T)(a, aSize, b, bSize, d0);                                          \
+            int64_t i1 = w_mergeSplit_(T)(a, aSize, b, bSize, d1);                                          \
+            w_mergeRuns_(T)(a + i0, i1 - i0, b + (d0 - i0), (d1 - i1) - (d0 - i0), mergeContext->out + d0); \
+        }                                                                                                   \
+    }
+
+// 归并有序序列
+#define w_mergeSorted(T) w_concat(w_mergeSorted_, T)
+#define w_mergeSorted_define_(T)                                                                                                   \
+    /**                                                                                                                            \
+     * 并行归并两个有序序列（稳定，相等时 a 在前），元素数量低于 w_PARALLEL_SORT_CUTOFF 时串行归并 \
+     * @param a 有序序列 a                                                                                                     \
+     * @param aSize a 的元素数量                                                                                              \
+     * @param b 有序序列 b                                                                                                     \
+     * @param bSize b 的元素数量                                                                                              \
+     * @param out 输出（至少 aSize + bSize 个元素，不能与 a、b 重叠）                                              \
+     * @param threadCount 线程数（<= 0 时使用默认线程数）                                                             \
+     * @return void                                                                                                                \
+     */                                                                                                                            \
+    static inline void w_mergeSorted(T)(const T *a, int64_t aSize, const T *b, int64_t bSize, T *out, int threadCount)             \
+    {                                                                                                                              \
+        w_check(a != NULL || aSize == 0);                                                                                          \
+        w_check(b != NULL || bSize == 0);                                                                                          \
+        w_check(out != NULL || aSize + bSize == 0);                                                                                \
+        w_check(aSize >= 0 && bSize >= 0);                                                                                         \
+        if (threadCount <= 0)                                                                                                      \
+        {                                                                                                                          \
+            threadCount = w_defaultThreadCount();                                                                                  \
+        }                                                                                                                          \
+        if (aSize + bSize < w_PARALLEL_SORT_CUTOFF || threadCount <= 1)                                                            \
+        {                                                                                                                          \
+            w_mergeRuns_(T)(a, aSize, b, bSize, out);                                                                              \
+            return;                                                                                                                \
+        }                                                                                                                          \
+        w_ParallelMergeContext_(T) context = {a, aSize, b, bSize, out, threadCount};                                               \
+        w_parallelFor_(threadCount, threadCount, w_parallelMergeTask_(T), &context);                                               \
+    }
+
+// 并行排序上下文
+#define w_ParallelSortContext_(T) w_concat(w_concat(w_ParallelSortContext_, T), _)
+#define w_ParallelSortContext_type_define_(T) \
+    typedef struct                            \
+    {                                         \
+        T *data;        /* 数据 */            \
+        T *buffer;      /* 缓冲区 */          \
+        int64_t size;   /* 元素数量 */        \
+        int64_t chunks; /* 分块数量 */        \
+    } w_ParallelSortContext_(T);
+
+// 并行排序分块任务
+#define w_parallelSortTask_(T) w_concat(w_concat(w_parallelSortTask_, T), _)
+#define w_parallelSortTask_define_(T)                                                        \
+    /**                                                                                      \
+     * 并行排序分块任务，每一块独立串行排序                                \
+     * @param context 上下文                                                              \
+     * @param begin 起始块                                                                \
+     * @param end 结束块                                                                  \
+     * @return void                                                                          \
+     */                                                                                      \
+    static inline void w_parallelSortTask_(T)(void *context, int64_t begin, int64_t end)     \
+    {                                                                                        \
+        w_ParallelSortContext_(T) *sortContext = context;                                    \
+        for (int64_t chunk = begin; chunk < end; chunk++)                                    \
+        {                                                                                    \
+            int64_t low = sortContext->size * chunk / sortContext->chunks;                   \
+            int64_t high = sortContext->size * (chunk + 1) / sortContext->chunks;            \
+            w_mergeSort_(T)(sortContext->data + low, high - low, sortContext->buffer + low); \
+        }                                                                                    \
+    }
+
+// 并行排序
+#define w_parallelSort(T) w_concat(w_parallelSort_, T)
+#define w_parallelSort_define_(T)                                                                                      \
+    /**                                                                                                                \
+     * 并行排序（稳定，升序，使用 w_compare(T) 比较）                                                  \
+     * 先分块并行排序，再逐轮并行归并；元素数量低于 w_PARALLEL_SORT_CUTOFF 时使用串行排序 \
+     * @param data 数据                                                                                              \
+     * @param size 元素数量                                                                                        \
+     * @param threadCount 线程数（<= 0 时使用默认线程数）                                                 \
+     * @return void                                                                                                    \
+     */                                                                                                                \
+    static inline void w_parallelSort(T)(T * data, int64_t size, int threadCount)                                      \
+    {                                                                                                                  \
+        w_check(data != NULL || size == 0);                                                                            \
+        w_check(size >= 0);                                                                                            \
+        if (threadCount <= 0)                                                                                          \
+        {                                                                                                              \
+            threadCount = w_defaultThreadCount();                                                                      \
+        }                                                                                                              \
+        if (size < w_PARALLEL_SORT_CUTOFF || threadCount <= 1)                                                         \
+        {                                                                                                              \
+            w_sort(T)(data, size);                                                                                     \
+            return;                                                                                                    \
+        }                                                                                                              \
+                                                                                                                       \
+        /* 分块并行排序 */                                                                                             \
+        T *buffer = w_malloc(sizeof(T) * size);                                                                        \
+        w_assert(buffer != NULL);                                                                                      \
+        int64_t chunks = threadCount;                                                                                  \
+        w_ParallelSortContext_(T) context = {data, buffer, size, chunks};                                              \
+        w_parallelFor_(chunks, threadCount, w_parallelSortTask_(T), &context);                                         \
+                                                                                                                       \
+        /* 逐轮归并相邻的有序块，在 data 和 buffer 之间交替 */                                                         \
+        T *src = data, *dst = buffer;                                                                                  \
+        for (int64_t width = 1; width < chunks; width *= 2)                                                            \
+        {                                                                                                              \
+            for (int64_t chunk = 0; chunk < chunks; chunk += 2 * width)                                                \
+            {                                                                                                          \
+                int64_t low = size * chunk / chunks;                                                                   \
+                int64_t mid = chunk + width < chunks ? size * (chunk + width) / chunks : size;                         \
+                int64_t high = chunk + 2 * width < chunks ? size * (chunk + 2 * width) / chunks : size;                \
+                w_mergeSorted(T)(src + low, mid - low, src + mid, high - mid, dst + low, threadCount);                 \
+            }                                                                                                          \
+            T *temp = src;                                                                                             \
+            src = dst;                                                                                                 \
+            dst = temp;                                                                                                \
+        }                                                                                                              \
+        if (src != data)                                                                                               \
+        {                                                                                                              \
+            w_parallelCopy_(data, src, size * sizeof(T), threadCount);                                                 \
+        }                                                                                                              \
+        w_free(buffer);                                                                                                \
+    }
+
+// 下界
+#define w_lowerBound(T) w_concat(w_lowerBound_, T)
+#define w_lowerBound_define_(T)                                                                     \
+    /**                                                                                             \
+     * 下界：有序序列中第一个不小于 key 的元素的索引（无分支二分查找） \
+     * @param data 有序数据                                                                     \
+     * @param size 元素数量                                                                     \
+     * @param key 键                                                                               \
+     * @return int64_t 索引，所有元素都小于 key 时返回 size                            \
+     */                                                                                             \
+    static inline int64_t w_lowerBound(T)(const T *data, int64_t size, T key)                       \
+    {                                                                                               \
+        w_check(data != NULL || size == 0);                                                         \
+        w_check(size >= 0);                                                                         \
+        if (size == 0)                                                                              \
+        {                                                                                           \
+            return 0;                                                                               \
+        }                                                                                           \
+        const T *base = data;                                                                       \
+        int64_t length = size;                                                                      \
+        while (length > 1)                                                                          \
+        {                                                                                           \
+            int64_t half = length / 2;                                                              \
+            /* 预取下一步的两个候选位置 */                                                          \
+            __builtin_prefetch(base + half / 2);                                                    \
+            __builtin_prefetch(base + half + half / 2);                                             \
+            base = w_compare(T)((T *)&base[half], &key) < 0 ? base + half : base;                   \
+            length -= half;                                                                         \
+        }                                                                                           \
+        return (base - data) + (w_compare(T)((T *)base, &key) < 0);                                 \
+    }
+
+// 上界
+#define w_upperBound(T) w_concat(w_upperBound_, T)
+#define w_upperBound_define_(T)                                                                  \
+    /**                                                                                          \
+     * 上界：有序序列中第一个大于 key 的元素的索引（无分支二分查找） \
+     * @param data 有序数据                                                                  \
+     * @param size 元素数量                                                                  \
+     * @param key 键                                                                            \
+     * @return int64_t 索引，所有元素都不大于 key 时返回 size                      \
+     */                                                                                          \
+    static inline int64_t w_upperBound(T)(const T *data, int64_t size, T key)                    \
+    {                                                                                            \
+        w_check(data != NULL || size == 0);                                                      \
+        w_check(size >= 0);                                                                      \
+        if (size == 0)                                                                           \
+        {                                                                                        \
+            return 0;                                                                            \
+        }                                                                                        \
+        const T *base = data;                                                                    \
+        int64_t length = size;                                                                   \
+        while (length > 1)                                                                       \
+        {                                                                                        \
+            int64_t half = length / 2;                                                           \
+            __builtin_prefetch(base + half / 2);                                                 \
+            __builtin_prefetch(base + half + half / 2);                                          \
+            base = w_compare(T)((T *)&base[half], &key) <= 0 ? base + half : base;               \
+            length -= half;                                                                      \
+        }                                                                                        \
+        return (base - data) + (w_compare(T)((T *)base, &key) <= 0);                             \
+    }
+
+// 相等区间
+#define w_equalRange(T) w_concat(w_equalRange_, T)
+#define w_equalRange_define_(T)                                                                          \
+    /**                                                                                                  \
+     * 相等区间：有序序列中等于 key 的元素的索引区间 [begin, end)                    \
+     * @param data 有序数据                                                                          \
+     * @param size 元素数量                                                                          \
+     * @param key 键                                                                                    \
+     * @param begin 区间起始索引（输出）                                                       \
+     * @param end 区间结束索引（输出）                                                         \
+     * @return void                                                                                      \
+     */                                                                                                  \
+    static inline void w_equalRange(T)(const T *data, int64_t size, T key, int64_t *begin, int64_t *end) \
+    {                                                                                                    \
+        w_check(begin != NULL && end != NULL);                                                           \
+        *begin = w_lowerBound(T)(data, size, key);                                                       \
+        *end = *begin + w_upperBound(T)(data + *begin, size - *begin, key);                              \
+    }
+
+// 二分查找
+#define w_binarySearch(T) w_concat(w_binarySearch_, T)
+#define w_binarySearch_define_(T)                                                  \
+    /**                                                                            \
+     * 二分查找                                                                \
+     * @param data 有序数据                                                    \
+     * @param size 元素数量                                                    \
+     * @param key 键                                                              \
+     * @return int64_t 第一个等于 key 的元素的索引，未找到返回 -1 \
+     */                                                                            \
+    static inline int64_t w_binarySearch(T)(const T *data, int64_t size, T key)    \
+    {                                                                              \
+        int64_t index = w_lowerBound(T)(data, size, key);                          \
+        if (index < size && w_compare(T)((T *)&data[index], &key) == 0)            \
+        {                                                                          \
+            return index;                                                          \
+        }                                                                          \
+        return -1;                                                                 \
+    }
+
+// 排序和查找定义
+// 需要定义 T 的 w_compare 函数
+#define w_algorithm_define(T)               \
+    w_insertionSort_define_(T);             \
+    w_mergeRuns_define_(T);                 \
+    w_mergeSort_define_(T);                 \
+    w_sort_define_(T);                      \
+    w_mergeSplit_define_(T);                \
+    w_ParallelMergeContext_type_define_(T); \
+    w_parallelMergeTask_define_(T);         \
+    w_mergeSorted_define_(T);               \
+    w_ParallelSortContext_type_define_(T);  \
+    w_parallelSortTask_define_(T);          \
+    w_parallelSort_define_(T);              \
+    w_lowerBound_define_(T);                \
+    w_upperBound_define_(T);                \
+    w_equalRange_define_(T);                \
+    w_binarySearch_define_(T);
+
+// ========================================================================================================================================================
+//  列表算法
+// ========================================================================================================================================================
+
+// 列表排序
+#define w_List_sort(T) w_concat(w_List(T), _sort)
+#define w_List_sort_define_(T)                                     \
+    /**                                                            \
+     * 列表排序（稳定，升序）                           \
+     * @param this 列表                                          \
+     * @return void                                                \
+     */                                                            \
+    static inline void w_List_sort(T)(w_List(T) * this)            \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        w_sort(T)(this->elementData, this->size);                  \
+    }
+
+// 列表并行排序
+#define w_List_parallelSort(T) w_concat(w_List(T), _parallelSort)
+#define w_List_parallelSort_define_(T)                                                                           \
+    /**                                                                                                          \
+     * 列表并行排序（稳定，升序），元素数量低于 w_PARALLEL_SORT_CUTOFF 时使用串行排序 \
+     * @param this 列表                                                                                        \
+     * @param threadCount 线程数（<= 0 时使用默认线程数）                                           \
+     * @return void                                                                                              \
+     */                                                                                                          \
+    static inline void w_List_parallelSort(T)(w_List(T) * this, int threadCount)                                 \
+    {                                                                                                            \
+        w_check(this != NULL);                                                                                   \
+        w_check(this->elementData != NULL || this->capacity == 0);                                               \
+        w_parallelSort(T)(this->elementData, this->size, threadCount);                                           \
+    }
+
+// 列表归并
+#define w_List_mergeSorted(T) w_concat(w_List(T), _mergeSorted)
+#define w_List_mergeSorted_define_(T)                                                                         \
+    /**                                                                                                       \
+     * 并行归并两个有序列表，结果覆盖 this 原有内容                                        \
+     * @param this 结果列表（不能是 a 或 b）                                                        \
+     * @param a 有序列表 a                                                                                \
+     * @param b 有序列表 b                                                                                \
+     * @param threadCount 线程数（<= 0 时使用默认线程数）                                        \
+     * @return void                                                                                           \
+     */                                                                                                       \
+    static inline void w_List_mergeSorted(T)(w_List(T) * this, w_List(T) * a, w_List(T) * b, int threadCount) \
+    {                                                                                                         \
+        w_check(this != NULL && a != NULL && b != NULL);                                                      \
+        w_check(this != a && this != b);                                                                      \
+        w_check(a->elementData != NULL || a->capacity == 0);                                                  \
+        w_check(b->elementData != NULL || b->capacity == 0);                                                  \
+        w_List_reserve(T)(this, a->size + b->size);                                                           \
+        w_mergeSorted(T)(a->elementData, a->size, b->elementData, b->size, this->elementData, threadCount);   \
+        this->size = a->size + b->size;                                                                       \
+    }
+
+// 列表下界
+#define w_List_lowerBound(T) w_concat(w_List(T), _lowerBound)
+#define w_List_lowerBound_define_(T)                                                       \
+    /**                                                                                    \
+     * 有序列表下界                                                                  \
+     * @param this 有序列表                                                            \
+     * @param key 键                                                                      \
+     * @return int64_t 第一个不小于 key 的元素的索引，不存在时返回 size \
+     */                                                                                    \
+    static inline int64_t w_List_lowerBound(T)(w_List(T) * this, T key)                    \
+    {                                                                                      \
+        w_check(this != NULL);                                                             \
+        w_check(this->elementData != NULL || this->capacity == 0);                         \
+        return w_lowerBound(T)(this->elementData, this->size, key);                        \
+    }
+
+// 列表上界
+#define w_List_upperBound(T) w_concat(w_List(T), _upperBound)
+#define w_List_upperBound_define_(T)                                                    \
+    /**                                                                                 \
+     * 有序列表上界                                                               \
+     * @param this 有序列表                                                         \
+     * @param key 键                                                                   \
+     * @return int64_t 第一个大于 key 的元素的索引，不存在时返回 size \
+     */                                                                                 \
+    static inline int64_t w_List_upperBound(T)(w_List(T) * this, T key)                 \
+    {                                                                                   \
+        w_check(this != NULL);                                                          \
+        w_check(this->elementData != NULL || this->capacity == 0);                      \
+        return w_upperBound(T)(this->elementData, this->size, key);                     \
+    }
+
+// 列表相等区间
+#define w_List_equalRange(T) w_concat(w_List(T), _equalRange)
+#define w_List_equalRange_define_(T)                                                               \
+    /**                                                                                            \
+     * 有序列表相等区间 [begin, end)                                                       \
+     * @param this 有序列表                                                                    \
+     * @param key 键                                                                              \
+     * @param begin 区间起始索引（输出）                                                 \
+     * @param end 区间结束索引（输出）                                                   \
+     * @return void                                                                                \
+     */                                                                                            \
+    static inline void w_List_equalRange(T)(w_List(T) * this, T key, int64_t *begin, int64_t *end) \
+    {                                                                                              \
+        w_check(this != NULL);                                                                     \
+        w_check(this->elementData != NULL || this->capacity == 0);                                 \
+        w_equalRange(T)(this->elementData, this->size, key, begin, end);                           \
+    }
+
+// 列表二分查找
+#define w_List_binarySearch(T) w_concat(w_List(T), _binarySearch)
+#define w_List_binarySearch_define_(T)                                             \
+    /**                                                                            \
+     * 有序列表二分查找                                                    \
+     * @param this 有序列表                                                    \
+     * @param key 键                                                              \
+     * @return int64_t 第一个等于 key 的元素的索引，未找到返回 -1 \
+     */                                                                            \
+    static inline int64_t w_List_binarySearch(T)(w_List(T) * this, T key)          \
+    {                                                                              \
+        w_check(this != NULL);                                                     \
+        w_check(this->elementData != NULL || this->capacity == 0);                 \
+        return w_binarySearch(T)(this->elementData, this->size, key);              \
+    }
+
+// 列表算法定义
+// 需要先定义 w_List_define(T) 和 w_algorithm_define(T)
+#define w_List_algorithm_define(T)  \
+    w_List_sort_define_(T);         \
+    w_List_parallelSort_define_(T); \
+    w_List_mergeSorted_define_(T);  \
+    w_List_lowerBound_define_(T);   \
+    w_List_upperBound_define_(T);   \
+    w_List_equalRange_define_(T);   \
+    w_List_binarySearch_define_(T);
+
+// ========================================================================================================================================================
+//  有序索引（Eytzinger 布局）
+// ========================================================================================================================================================
+
+// 批量查找时同时进行的查询数量
+#define w_SORTED_INDEX_BATCH_ 16
+
+/**
+ * Eytzinger 布局中以 node 为根的子树的节点数量
+ * @param node 节点（下标从 1 开始）
+ * @param size 节点总数
+ * @return int64_t 子树节点数量
+ */
+static inline int64_t w_eytzingerSubtreeSize_(int64_t node, int64_t size)
+{
+    if (node > size)
+    {
+        return 0;
+    }
+    /* node 下方的层数 */
+    int height = (63 - __builtin_clzll(size)) - (63 - __builtin_clzll(node));
+    int64_t first = node << height;
+    int64_t lastLevel = size - first + 1;
+    if (lastLevel < 0)
+    {
+        lastLevel = 0;
+    }
+    else if (lastLevel > ((int64_t)1 << height))
+    {
+        lastLevel = (int64_t)1 << height;
+    }
+    return ((int64_t)1 << height) - 1 + lastLevel;
+}
+
+/**
+ * Eytzinger 布局中节点在有序序列中的排名
+ * @param node 节点（下标从 1 开始，0 表示末尾）
+ * @param size 节点总数
+ * @return int64_t 排名（即有序序列中的索引）
+ */
+static inline int64_t w_eytzingerRank_(int64_t node, int64_t size)
+{
+    if (node == 0)
+    {
+        return size;
+    }
+    /* 从根沿路径向下，每次走右子树时累加左子树和父节点 */
+    int64_t rank = 0;
+    int64_t current = 1;
+    for (int bit = 62 - __builtin_clzll(node); bit >= 0; bit--)
+    {
+        if ((node >> bit) & 1)
+        {
+            rank += w_eytzingerSubtreeSize_(2 * current, size) + 1;
+            current = 2 * current + 1;
+        }
+        else
+        {
+            current = 2 * current;
+        }
+    }
+    return rank + w_eytzingerSubtreeSize_(2 * current, size);
+}
+
+// 有序索引类型
+#define w_SortedIndex(T) w_concat(w_SortedIndex_, T)
+
+// 有序索引类型定义
+#define w_SortedIndex_type_define_(T)                                   \
+    typedef struct                                                      \
+    {                                                                   \
+        T *elementData; /* 元素数据（Eytzinger 顺序，下标从 1 开始） */ \
+        int64_t size;   /* 元素数量 */                                  \
+    } w_SortedIndex(T);
+
+// 有序索引预取步长（一个缓存行中的元素数量）
+#define w_SortedIndex_prefetchStride_(T) (sizeof(T) < 64 ? 64 / sizeof(T) : 1)
+
+// 有序索引构建
+#define w_SortedIndex_build_(T) w_concat(w_SortedIndex(T), _build_)
+#define w_SortedIndex_build_define_(T)                                                                                \
+    /**                                                                                                               \
+     * 按中序遍历将有序数据放入 Eytzinger 布局                                                          \
+     * @param this 有序索引                                                                                       \
+     * @param sorted 有序数据                                                                                     \
+     * @param next 下一个要放置的有序数据索引                                                            \
+     * @param node 当前节点                                                                                       \
+     * @return void                                                                                                   \
+     */                                                                                                               \
+    static inline void w_SortedIndex_build_(T)(w_SortedIndex(T) * this, const T *sorted, int64_t *next, int64_t node) \
+    {                                                                                                                 \
+        if (node > this->size)                                                                                        \
+        {                                                                                                             \
+            return;                                                                                                   \
+        }                                                                                                             \
+        w_SortedIndex_build_(T)(this, sorted, next, 2 * node);                                                        \
+        this->elementData[node] = sorted[(*next)++];                                                                  \
+        w_SortedIndex_build_(T)(this, sorted, next, 2 * node + 1);                                                    \
+    }
+
+// 有序索引初始化
+#define w_SortedIndex_init(T) w_concat(w_SortedIndex(T), _init)
+#define w_SortedIndex_init_define_(T)                                                                \
+    /**                                                                                              \
+     * 有序索引初始化，将有序数据复制为 Eytzinger（BFS）布局                     \
+     * @param this 有序索引                                                                      \
+     * @param sorted 有序数据（升序）                                                        \
+     * @param size 元素数量                                                                      \
+     * @return void                                                                                  \
+     */                                                                                              \
+    static inline void w_SortedIndex_init(T)(w_SortedIndex(T) * this, const T *sorted, int64_t size) \
+    {                                                                                                \
+        w_check(this != NULL);                                                                       \
+        w_check(sorted != NULL || size == 0);                                                        \
+        w_check(size >= 0);                                                                          \
+        this->elementData = w_malloc(sizeof(T) * (size + 1));                                        \
+        w_assert(this->elementData != NULL);                                                         \
+        this->size = size;                                                                           \
+        int64_t next = 0;                                                                            \
+        w_SortedIndex_build_(T)(this, sorted, &next, 1);                                             \
+    }
+
+// 有序索引销毁
+#define w_SortedIndex_deinit(T) w_concat(w_SortedIndex(T), _deinit)
+#define w_SortedIndex_deinit_define_(T)                                 \
+    /**                                                                 \
+     * 有序索引销毁                                               \
+     * @param this 有序索引                                         \
+     * @return void                                                     \
+     */                                                                 \
+    static inline void w_SortedIndex_deinit(T)(w_SortedIndex(T) * this) \
+    {                                                                   \
+        w_check(this != NULL);                                          \
+        w_check(this->elementData != NULL);                             \
+        w_free(this->elementData);                                      \
+        memset(this, 0, sizeof(w_SortedIndex(T)));                      \
+    }
+
+// 有序索引大小
+#define w_SortedIndex_size(T) w_concat(w_SortedIndex(T), _size)
+#define w_SortedIndex_size_define_(T)                                    \
+    /**                                                                  \
+     * 有序索引大小                                                \
+     * @param this 有序索引                                          \
+     * @return int64_t 元素数量                                      \
+     */                                                                  \
+    static inline int64_t w_SortedIndex_size(T)(w_SortedIndex(T) * this) \
+    {                                                                    \
+        w_check(this != NULL);                                           \
+        return this->size;                                               \
+    }
+
+// 有序索引查找节点
+#define w_SortedIndex_search_(T) w_concat(w_SortedIndex(T), _search_)
+#define w_SortedIndex_search_define_(T)                                                                       \
+    /**                                                                                                       \
+     * 有序索引查找节点                                                                               \
+     * @param this 有序索引                                                                               \
+     * @param key 键                                                                                         \
+     * @param inclusive true:查找第一个不小于 key 的节点 false:查找第一个大于 key 的节点 \
+     * @return int64_t 节点，不存在时返回 0                                                          \
+     */                                                                                                       \
+    static inline int64_t w_SortedIndex_search_(T)(w_SortedIndex(T) * this, T key, bool inclusive)            \
+    {                                                                                                         \
+        const T *data = this->elementData;                                                                    \
+        int64_t size = this->size;                                                                            \
+        int64_t threshold = inclusive ? 0 : 1;                                                                \
+        int64_t node = 1;                                                                                     \
+        while (node <= size)                                                                                  \
+        {                                                                                                     \
+            __builtin_prefetch(data + node * w_SortedIndex_prefetchStride_(T));                               \
+            node = 2 * node + (w_compare(T)((T *)&data[node], &key) < threshold);                             \
+        }                                                                                                     \
+        /* 去掉末尾连续的右转和最后一次左转 */                                                                \
+        return node >> __builtin_ffsll(~node);                                                                \
+    }
+
+// 有序索引下界
+#define w_SortedIndex_lowerBound(T) w_concat(w_SortedIndex(T), _lowerBound)
+#define w_SortedIndex_lowerBound_define_(T)                                                                  \
+    /**                                                                                                      \
+     * 有序索引下界                                                                                    \
+     * @param this 有序索引                                                                              \
+     * @param key 键                                                                                        \
+     * @return int64_t 原有序数据中第一个不小于 key 的元素的索引，不存在时返回 size \
+     */                                                                                                      \
+    static inline int64_t w_SortedIndex_lowerBound(T)(w_SortedIndex(T) * this, T key)                        \
+    {                                                                                                        \
+        w_check(this != NULL);                                                                               \
+        w_check(this->elementData != NULL);                                                                  \
+        return w_eytzingerRank_(w_SortedIndex_search_(T)(this, key, true), this->size);                      \
+    }
+
+// 有序索引上界
+#define w_SortedIndex_upperBound(T) w_concat(w_SortedIndex(T), _upperBound)
+#define w_SortedIndex_upperBound_define_(T)                                                               \
+    /**                                                                                                   \
+     * 有序索引上界                                                                                 \
+     * @param this 有序索引                                                                           \
+     * @param key 键                                                                                     \
+     * @return int64_t 原有序数据中第一个大于 key 的元素的索引，不存在时返回 size \
+     */                                                                                                   \
+    static inline int64_t w_SortedIndex_upperBound(T)(w_SortedIndex(T) * this, T key)                     \
+    {                                                                                                     \
+        w_check(this != NULL);                                                                            \
+        w_check(this->elementData != NULL);                                                               \
+        return w_eytzingerRank_(w_SortedIndex_search_(T)(this, key, false), this->size);                  \
+    }
+
+// 有序索引是否包含
+#define w_SortedIndex_contains(T) w_concat(w_SortedIndex(T), _contains)
+#define w_SortedIndex_contains_define_(T)                                        \
+    /**                                                                          \
+     * 有序索引是否包含 key                                              \
+     * @param this 有序索引                                                  \
+     * @param key 键                                                            \
+     * @return bool 是否包含                                                 \
+     */                                                                          \
+    static inline bool w_SortedIndex_contains(T)(w_SortedIndex(T) * this, T key) \
+    {                                                                            \
+        w_check(this != NULL);                                                   \
+        w_check(this->elementData != NULL);                                      \
+        int64_t node = w_SortedIndex_search_(T)(this, key, true);                \
+        return node != 0 && w_compare(T)(&this->elementData[node], &key) == 0;   \
+    }
+
+// 有序索引批量下界
+#define w_SortedIndex_lowerBoundBatch(T) w_concat(w_SortedIndex(T), _lowerBoundBatch)
+#define w_SortedIndex_lowerBoundBatch_define_(T)                                                                                \
+    /**                                                                                                                         \
+     * 有序索引批量下界，多个查询交错推进以隐藏访存延迟                                                 \
+     * @param this 有序索引                                                                                                 \
+     * @param keys 键                                                                                                          \
+     * @param count 键的数量                                                                                                \
+     * @param result 每个键的下界（输出，至少 count 个元素）                                                    \
+     * @return void                                                                                                             \
+     */                                                                                                                         \
+    static inline void w_SortedIndex_lowerBoundBatch(T)(w_SortedIndex(T) * this, const T *keys, int64_t count, int64_t *result) \
+    {                                                                                                                           \
+        w_check(this != NULL);                                                                                                  \
+        w_check(this->elementData != NULL);                                                                                     \
+        w_check(keys != NULL || count == 0);                                                                                    \
+        w_check(result != NULL || count == 0);                                                                                  \
+        const T *data = this->elementData;                                                                                      \
+        int64_t size = this->size;                                                                                              \
+        int levels = size > 0 ? 64 - __builtin_clzll(size) : 0;                                                                 \
+        for (int64_t start = 0; start < count; start += w_SORTED_INDEX_BATCH_)                                                  \
+        {                                                                                                                       \
+            int batch = count - start < w_SORTED_INDEX_BATCH_ ? (int)(count - start) : w_SORTED_INDEX_BATCH_;                   \
+            int64_t nodes[w_SORTED_INDEX_BATCH_];                                                                               \
+            for (int i = 0; i < batch; i++)                                                                                     \
+            {                                                                                                                   \
+                nodes[i] = 1;                                                                                                   \
+            }                                                                                                                   \
+            /* 所有查询同步下降一层 */                                                                                          \
+            for (int level = 0; level < levels; level++)                                                                        \
+            {                                                                                                                   \
+                for (int i = 0; i < batch; i++)                                                                                 \
+                {                                                                                                               \
+                    int64_t node = nodes[i];                                                                                    \
+                    if (node <= size)                                                                                           \
+                    {                                                                                                           \
+                        __builtin_prefetch(data + node * w_SortedIndex_prefetchStride_(T));                                     \
+                        nodes[i] = 2 * node + (w_compare(T)((T *)&data[node], (T *)&keys[start + i]) < 0);                      \
+                    }                                                                                                           \
+                }                                                                                                               \
+            }                                                                                                                   \
+            for (int i = 0; i < batch; i++)                                                                                     \
+            {                                                                                                                   \
+                result[start + i] = w_eytzingerRank_(nodes[i] >> __builtin_ffsll(~nodes[i]), size);                             \
+            }                                                                                                                   \
+        }                                                                                                                       \
+    }
+
+// 有序索引定义
+// 需要定义 T 的 w_compare 函数
+#define w_SortedIndex_define(T)          \
+    w_SortedIndex_type_define_(T);       \
+    w_SortedIndex_build_define_(T);      \
+    w_SortedIndex_init_define_(T);       \
+    w_SortedIndex_deinit_define_(T);     \
+    w_SortedIndex_size_define_(T);       \
+    w_SortedIndex_search_define_(T);     \
+    w_SortedIndex_lowerBound_define_(T); \
+    w_SortedIndex_upperBound_define_(T); \
+    w_SortedIndex_contains_define_(T);   \
+    w_SortedIndex_lowerBoundBatch_define_(T);
+
+// ========================================================================================================================================================
+//  视图
+// ========================================================================================================================================================
+
+// 视图类型（不持有内存的指针 + 长度，按值传递）
+#define w_Span(T) w_concat(w_Span_, T)
+
+// 只读视图类型
+#define w_ConstSpan(T) w_concat(w_ConstSpan_, T)
+
+// 视图类型定义
+#define w_Span_type_define_(T)        \
+    typedef struct                    \
+    {                                 \
+        T *data;      /* 数据 */      \
+        int64_t size; /* 元素数量 */  \
+    } w_Span(T);                      \
+    typedef struct                    \
+    {                                 \
+        const T *data; /* 数据 */     \
+        int64_t size;  /* 元素数量 */ \
+    } w_ConstSpan(T);
+
+// 视图创建
+#define w_Span_of(T) w_concat(w_Span(T), _of)
+#define w_Span_of_define_(T)                                     \
+    /**                                                          \
+     * 从内存创建视图                                     \
+     * @param data 数据                                        \
+     * @param size 元素数量                                  \
+     * @return w_Span(T) 视图                                  \
+     */                                                          \
+    static inline w_Span(T) w_Span_of(T)(T * data, int64_t size) \
+    {                                                            \
+        w_check(data != NULL || size == 0);                      \
+        w_check(size >= 0);                                      \
+        w_Span(T) span = {data, size};                           \
+        return span;                                             \
+    }
+
+// 只读视图创建
+#define w_ConstSpan_of(T) w_concat(w_ConstSpan(T), _of)
+#define w_ConstSpan_of_define_(T)                                               \
+    /**                                                                         \
+     * 从内存创建只读视图                                              \
+     * @param data 数据                                                       \
+     * @param size 元素数量                                                 \
+     * @return w_ConstSpan(T) 只读视图                                      \
+     */                                                                         \
+    static inline w_ConstSpan(T) w_ConstSpan_of(T)(const T *data, int64_t size) \
+    {                                                                           \
+        w_check(data != NULL || size == 0);                                     \
+        w_check(size >= 0);                                                     \
+        w_ConstSpan(T) span = {data, size};                                     \
+        return span;                                                            \
+    }
+
+// 视图转换为只读视图
+#define w_Span_asConst(T) w_concat(w_Span(T), _asConst)
+#define w_Span_asConst_define_(T)                                  \
+    /**                                                            \
+     * 视图转换为只读视图                                 \
+     * @param span 视图                                          \
+     * @return w_ConstSpan(T) 只读视图                         \
+     */                                                            \
+    static inline w_ConstSpan(T) w_Span_asConst(T)(w_Span(T) span) \
+    {                                                              \
+        w_ConstSpan(T) constSpan = {span.data, span.size};         \
+        return constSpan;                                          \
+    }
+
+// 视图获取元素
+#define w_Span_get(T) w_concat(w_Span(T), _get)
+#define w_Span_get_define_(T)                                    \
+    /**                                                          \
+     * 视图获取元素                                        \
+     * @param span 视图                                        \
+     * @param index 索引                                       \
+     * @return T 元素                                          \
+     */                                                          \
+    static inline T w_Span_get(T)(w_Span(T) span, int64_t index) \
+    {                                                            \
+        w_checkIndex(index >= 0 && index < span.size);           \
+        return span.data[index];                                 \
+    }
+
+// 视图设置元素
+#define w_Span_set(T) w_concat(w_Span(T), _set)
+#define w_Span_set_define_(T)                                                  \
+    /**                                                                        \
+     * 视图设置元素                                                      \
+     * @param span 视图                                                      \
+     * @param index 索引                                                     \
+     * @param element 元素                                                   \
+     * @return void                                                            \
+     */                                                                        \
+    static inline void w_Span_set(T)(w_Span(T) span, int64_t index, T element) \
+    {                                                                          \
+        w_checkIndex(index >= 0 && index < span.size);                         \
+        span.data[index] = element;                                            \
+    }
+
+// 只读视图获取元素
+#define w_ConstSpan_get(T) w_concat(w_ConstSpan(T), _get)
+#define w_ConstSpan_get_define_(T)                                         \
+    /**                                                                    \
+     * 只读视图获取元素                                            \
+     * @param span 只读视图                                            \
+     * @param index 索引                                                 \
+     * @return T 元素                                                    \
+     */                                                                    \
+    static inline T w_ConstSpan_get(T)(w_ConstSpan(T) span, int64_t index) \
+    {                                                                      \
+        w_checkIndex(index >= 0 && index < span.size);                     \
+        return span.data[index];                                           \
+    }
+
+// 视图子视图
+#define w_Span_subspan(T) w_concat(w_Span(T), _subspan)
+#define w_Span_subspan_define_(T)                                                            \
+    /**                                                                                      \
+     * 视图子视图 [offset, offset + count)                                              \
+     * @param span 视图                                                                    \
+     * @param offset 起始索引                                                            \
+     * @param count 元素数量                                                             \
+     * @return w_Span(T) 子视图                                                           \
+     */                                                                                      \
+    static inline w_Span(T) w_Span_subspan(T)(w_Span(T) span, int64_t offset, int64_t count) \
+    {                                                                                        \
+        w_checkIndex(offset >= 0 && count >= 0 && offset + count <= span.size);              \
+        w_Span(T) subspan = {span.data + offset, count};                                     \
+        return subspan;                                                                      \
+    }
+
+// 视图切片
+#define w_Span_slice(T) w_concat(w_Span(T), _slice)
+#define w_Span_slice_define_(T)                                                         \
+    /**                                                                                 \
+     * 视图切片 [begin, end)                                                        \
+     * @param span 视图                                                               \
+     * @param begin 起始索引                                                        \
+     * @param end 结束索引（不包含）                                           \
+     * @return w_Span(T) 子视图                                                      \
+     */                                                                                 \
+    static inline w_Span(T) w_Span_slice(T)(w_Span(T) span, int64_t begin, int64_t end) \
+    {                                                                                   \
+        return w_Span_subspan(T)(span, begin, end - begin);                             \
+    }
+
+// 只读视图子视图
+#define w_ConstSpan_subspan(T) w_concat(w_ConstSpan(T), _subspan)
+#define w_ConstSpan_subspan_define_(T)                                                                      \
+    /**                                                                                                     \
+     * 只读视图子视图 [offset, offset + count)                                                       \
+     * @param span 只读视图                                                                             \
+     * @param offset 起始索引                                                                           \
+     * @param count 元素数量                                                                            \
+     * @return w_ConstSpan(T) 子视图                                                                     \
+     */                                                                                                     \
+    static inline w_ConstSpan(T) w_ConstSpan_subspan(T)(w_ConstSpan(T) span, int64_t offset, int64_t count) \
+    {                                                                                                       \
+        w_checkIndex(offset >= 0 && count >= 0 && offset + count <= span.size);                             \
+        w_ConstSpan(T) subspan = {span.data + offset, count};                                               \
+        return subspan;                                                                                     \
+    }
+
+// 只读视图切片
+#define w_ConstSpan_slice(T) w_concat(w_ConstSpan(T), _slice)
+#define w_ConstSpan_slice_define_(T)                                                                   \
+    /**                                                                                                \
+     * 只读视图切片 [begin, end)                                                                 \
+     * @param span 只读视图                                                                        \
+     * @param begin 起始索引                                                                       \
+     * @param end 结束索引（不包含）                                                          \
+     * @return w_ConstSpan(T) 子视图                                                                \
+     */                                                                                                \
+    static inline w_ConstSpan(T) w_ConstSpan_slice(T)(w_ConstSpan(T) span, int64_t begin, int64_t end) \
+    {                                                                                                  \
+        return w_ConstSpan_subspan(T)(span, begin, end - begin);                                       \
+    }
+
+// 视图遍历
+// 用法：w_Span_forEach(T, span, element) { ... }，element 为 T * 类型的元素指针
+#define w_Span_forEach(T, span, element) \
+    for (T *element = (span).data, *w_concat(element, End_) = (span).data + (span).size; element < w_concat(element, End_); element++)
+
+// 只读视图遍历
+// 用法：w_ConstSpan_forEach(T, span, element) { ... }，element 为 const T * 类型的元素指针
+#define w_ConstSpan_forEach(T, span, element) \
+    for (const T *element = (span).data, *w_concat(element, End_) = (span).data + (span).size; element < w_concat(element, End_); element++)
+
+// 视图定义
+#define w_Span_define(T)            \
+    w_Span_type_define_(T);         \
+    w_Span_of_define_(T);           \
+    w_ConstSpan_of_define_(T);      \
+    w_Span_asConst_define_(T);      \
+    w_Span_get_define_(T);          \
+    w_Span_set_define_(T);          \
+    w_ConstSpan_get_define_(T);     \
+    w_Span_subspan_define_(T);      \
+    w_Span_slice_define_(T);        \
+    w_ConstSpan_subspan_define_(T); \
+    w_ConstSpan_slice_define_(T);
+
+// 数组视图
+#define w_Array_span(T) w_concat(w_Array(T), _span)
+#define w_Array_span_define_(T)                                \
+    /**                                                        \
+     * 数组视图（数组销毁后失效）                 \
+     * @param this 数组                                      \
+     * @return w_Span(T) 视图                                \
+     */                                                        \
+    static inline w_Span(T) w_Array_span(T)(w_Array(T) * this) \
+    {                                                          \
+        w_check(this != NULL);                                 \
+        return w_Span_of(T)(this->elementData, this->size);    \
+    }
+
+// 数组只读视图
+#define w_Array_constSpan(T) w_concat(w_Array(T), _constSpan)
+#define w_Array_constSpan_define_(T)                                     \
+    /**                                                                  \
+     * 数组只读视图（数组销毁后失效）                     \
+     * @param this 数组                                                \
+     * @return w_ConstSpan(T) 只读视图                               \
+     */                                                                  \
+    static inline w_ConstSpan(T) w_Array_constSpan(T)(w_Array(T) * this) \
+    {                                                                    \
+        w_check(this != NULL);                                           \
+        return w_ConstSpan_of(T)(this->elementData, this->size);         \
+    }
+
+// 数组视图定义（需要先定义 w_Array_define 和 w_Span_define）
+#define w_Array_span_define(T) \
+    w_Array_span_define_(T);   \
+    w_Array_constSpan_define_(T);
+
+// 列表视图
+#define w_List_span(T) w_concat(w_List(T), _span)
+#define w_List_span_define_(T)                                     \
+    /**                                                            \
+     * 列表视图（列表扩容或销毁后失效）            \
+     * @param this 列表                                          \
+     * @return w_Span(T) 视图                                    \
+     */                                                            \
+    static inline w_Span(T) w_List_span(T)(w_List(T) * this)       \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        return w_Span_of(T)(this->elementData, this->size);        \
+    }
+
+// 列表只读视图
+#define w_List_constSpan(T) w_concat(w_List(T), _constSpan)
+#define w_List_constSpan_define_(T)                                    \
+    /**                                                                \
+     * 列表只读视图（列表扩容或销毁后失效）          \
+     * @param this 列表                                              \
+     * @return w_ConstSpan(T) 只读视图                             \
+     */                                                                \
+    static inline w_ConstSpan(T) w_List_constSpan(T)(w_List(T) * this) \
+    {                                                                  \
+        w_check(this != NULL);                                         \
+        w_check(this->elementData != NULL || this->capacity == 0);     \
+        return w_ConstSpan_of(T)(this->elementData, this->size);       \
+    }
+
+// 列表视图定义（需要先定义 w_List_define 和 w_Span_define）
+#define w_List_span_define(T) \
+    w_List_span_define_(T);   \
+    w_List_constSpan_define_(T);
+
+// 视图排序
+#define w_Span_sort(T) w_concat(w_Span(T), _sort)
+#define w_Span_sort_define_(T)                        \
+    /**                                               \
+     * 视图排序（稳定，升序）              \
+     * @param span 视图                             \
+     * @return void                                   \
+     */                                               \
+    static inline void w_Span_sort(T)(w_Span(T) span) \
+    {                                                 \
+        w_sort(T)(span.data, span.size);              \
+    }
+
+// 视图并行排序
+#define w_Span_parallelSort(T) w_concat(w_Span(T), _parallelSort)
+#define w_Span_parallelSort_define_(T)                                         \
+    /**                                                                        \
+     * 视图并行排序（稳定，升序）                                 \
+     * @param span 视图                                                      \
+     * @param threadCount 线程数（<= 0 时使用默认线程数）         \
+     * @return void                                                            \
+     */                                                                        \
+    static inline void w_Span_parallelSort(T)(w_Span(T) span, int threadCount) \
+    {                                                                          \
+        w_parallelSort(T)(span.data, span.size, threadCount);                  \
+    }
+
+// 只读视图下界
+#define w_ConstSpan_lowerBound(T) w_concat(w_ConstSpan(T), _lowerBound)
+#define w_ConstSpan_lowerBound_define_(T)                                                  \
+    /**                                                                                    \
+     * 有序只读视图下界                                                            \
+     * @param span 有序只读视图                                                      \
+     * @param key 键                                                                      \
+     * @return int64_t 第一个不小于 key 的元素的索引，不存在时返回 size \
+     */                                                                                    \
+    static inline int64_t w_ConstSpan_lowerBound(T)(w_ConstSpan(T) span, T key)            \
+    {                                                                                      \
+        return w_lowerBound(T)(span.data, span.size, key);                                 \
+    }
+
+// 只读视图上界
+#define w_ConstSpan_upperBound(T) w_concat(w_ConstSpan(T), _upperBound)
+#define w_ConstSpan_upperBound_define_(T)                                               \
+    /**                                                                                 \
+     * 有序只读视图上界                                                         \
+     * @param span 有序只读视图                                                   \
+     * @param key 键                                                                   \
+     * @return int64_t 第一个大于 key 的元素的索引，不存在时返回 size \
+     */                                                                                 \
+    static inline int64_t w_ConstSpan_upperBound(T)(w_ConstSpan(T) span, T key)         \
+    {                                                                                   \
+        return w_upperBound(T)(span.data, span.size, key);                              \
+    }
+
+// 只读视图相等区间
+#define w_ConstSpan_equalRange(T) w_concat(w_ConstSpan(T), _equalRange)
+#define w_ConstSpan_equalRange_define_(T)                                                                  \
+    /**                                                                                                    \
+     * 有序只读视图相等区间 [begin, end)                                                         \
+     * @param span 有序只读视图                                                                      \
+     * @param key 键                                                                                      \
+     * @param begin 区间起始索引（输出）                                                         \
+     * @param end 区间结束索引（输出）                                                           \
+     * @return void                                                                                        \
+     */                                                                                                    \
+    static inline void w_ConstSpan_equalRange(T)(w_ConstSpan(T) span, T key, int64_t *begin, int64_t *end) \
+    {                                                                                                      \
+        w_equalRange(T)(span.data, span.size, key, begin, end);                                            \
+    }
+
+// 只读视图二分查找
+#define w_ConstSpan_binarySearch(T) w_concat(w_ConstSpan(T), _binarySearch)
+#define w_ConstSpan_binarySearch_define_(T)                                        \
+    /**                                                                            \
+     * 有序只读视图二分查找                                              \
+     * @param span 有序只读视图                                              \
+     * @param key 键                                                              \
+     * @return int64_t 第一个等于 key 的元素的索引，未找到返回 -1 \
+     */                                                                            \
+    static inline int64_t w_ConstSpan_binarySearch(T)(w_ConstSpan(T) span, T key)  \
+    {                                                                              \
+        return w_binarySearch(T)(span.data, span.size, key);                       \
+    }
+
+// 只读视图哈希
+#define w_ConstSpan_hash(T) w_concat(w_ConstSpan(T), _hash)
+#define w_ConstSpan_hash_define_(T)                                     \
+    /**                                                                 \
+     * 只读视图哈希（组合每个元素的 w_hash(T)）          \
+     * @param span 只读视图                                         \
+     * @return int64_t 哈希值                                        \
+     */                                                                 \
+    static inline int64_t w_ConstSpan_hash(T)(w_ConstSpan(T) span)      \
+    {                                                                   \
+        uint64_t hash = 0;                                              \
+        for (int64_t i = 0; i < span.size; i++)                         \
+        {                                                               \
+            hash = hash * 31 + (uint64_t)w_hash(T)((T *)&span.data[i]); \
+        }                                                               \
+        return (int64_t)hash;                                           \
+    }
+
+// 只读视图判断是否相等
+#define w_ConstSpan_equals(T) w_concat(w_ConstSpan(T), _equals)
+#define w_ConstSpan_equals_define_(T)                                                   \
+    /**                                                                                 \
+     * 只读视图判断是否相等（长度相同且每个元素 w_equals(T)）      \
+     * @param span 只读视图                                                         \
+     * @param other 另一个只读视图                                               \
+     * @return bool true:相等 false:不相等                                         \
+     */                                                                                 \
+    static inline bool w_ConstSpan_equals(T)(w_ConstSpan(T) span, w_ConstSpan(T) other) \
+    {                                                                                   \
+        if (span.size != other.size)                                                    \
+        {                                                                               \
+            return false;                                                               \
+        }                                                                               \
+        for (int64_t i = 0; i < span.size; i++)                                         \
+        {                                                                               \
+            if (!w_equals(T)((T *)&span.data[i], (T *)&other.data[i]))                  \
+            {                                                                           \
+                return false;                                                           \
+            }                                                                           \
+        }                                                                               \
+        return true;                                                                    \
+    }
+
+// 视图算法定义（需要先定义 w_Span_define、w_algorithm_define，以及 w_hash(T) 和 w_equals(T)）
+#define w_Span_algorithm_define(T)       \
+    w_Span_sort_define_(T);              \
+    w_Span_parallelSort_define_(T);      \
+    w_ConstSpan_lowerBound_define_(T);   \
+    w_ConstSpan_upperBound_define_(T);   \
+    w_ConstSpan_equalRange_define_(T);   \
+    w_ConstSpan_binarySearch_define_(T); \
+    w_ConstSpan_hash_define_(T);         \
+    w_ConstSpan_equals_define_(T);
+
+// ========================================================================================================================================================
+//  优先队列
+// ========================================================================================================================================================
+
+// 堆的分叉数（4 叉堆的一个节点的孩子位于同一个缓存行中，树高只有二叉堆的一半）
+#define w_PRIORITY_QUEUE_ARITY_ 4
+
+// 优先队列类型（w_compare(T) 最小的元素位于堆顶）
+#define w_PriorityQueue(T) w_concat(w_PriorityQueue_, T)
+
+// 优先队列类型定义
+#define w_PriorityQueue_type_define_(T)                                  \
+    typedef struct                                                       \
+    {                                                                    \
+        T *elementData;   /* 元素数据（隐式 4 叉堆） */                  \
+        int64_t size;     /* 大小 */                                     \
+        int64_t capacity; /* 容量 */                                     \
+        int64_t limit;    /* Top-K 模式下保留的元素数量，0 表示不限制 */ \
+    } w_PriorityQueue(T);
+
+// 优先队列上浮
+#define w_PriorityQueue_siftUp_(T) w_concat(w_PriorityQueue(T), _siftUp_)
+#define w_PriorityQueue_siftUp_define_(T)                                         \
+    /**                                                                           \
+     * 优先队列上浮                                                         \
+     * @param elementData 堆数据                                               \
+     * @param index 需要上浮的元素索引                                   \
+     * @return void                                                               \
+     */                                                                           \
+    static inline void w_PriorityQueue_siftUp_(T)(T * elementData, int64_t index) \
+    {                                                                             \
+        T element = elementData[index];                                           \
+        while (index > 0)                                                         \
+        {                                                                         \
+            int64_t parent = (index - 1) / w_PRIORITY_QUEUE_ARITY_;               \
+            if (w_compare(T)(&element, &elementData[parent]) >= 0)                \
+            {                                                                     \
+                break;                                                            \
+            }                                                                     \
+            elementData[index] = elementData[parent];                             \
+            index = parent;                                                       \
+        }                                                                         \
+        elementData[index] = element;                                             \
+    }
+
+// 优先队列下沉
+#define w_PriorityQueue_siftDown_(T) w_concat(w_PriorityQueue(T), _siftDown_)
+#define w_PriorityQueue_siftDown_define_(T)                                                                 \
+    /**                                                                                                     \
+     * 优先队列下沉                                                                                   \
+     * @param elementData 堆数据                                                                         \
+     * @param size 堆大小                                                                                \
+     * @param index 需要下沉的元素索引                                                             \
+     * @return void                                                                                         \
+     */                                                                                                     \
+    static inline void w_PriorityQueue_siftDown_(T)(T * elementData, int64_t size, int64_t index)           \
+    {                                                                                                       \
+        T element = elementData[index];                                                                     \
+        while (true)                                                                                        \
+        {                                                                                                   \
+            int64_t first = index * w_PRIORITY_QUEUE_ARITY_ + 1;                                            \
+            if (first >= size)                                                                              \
+            {                                                                                               \
+                break;                                                                                      \
+            }                                                                                               \
+            /* 找到最小的孩子 */                                                                            \
+            int64_t last = first + w_PRIORITY_QUEUE_ARITY_ < size ? first + w_PRIORITY_QUEUE_ARITY_ : size; \
+            int64_t child = first;                                                                          \
+            for (int64_t i = first + 1; i < last; i++)                                                      \
+            {                                                                                               \
+                child = w_compare(T)(&elementData[i], &elementData[child]) < 0 ? i : child;                 \
+            }                                                                                               \
+            if (w_compare(T)(&elementData[child], &element) >= 0)                                           \
+            {                                                                                               \
+                break;                                                                                      \
+            }                                                                                               \
+            elementData[index] = elementData[child];                                                        \
+            index = child;                                                                                  \
+        }                                                                                                   \
+        elementData[index] = element;                                                                       \
+    }
+
+// 优先队列建堆
+#define w_PriorityQueue_build_(T) w_concat(w_PriorityQueue(T), _build_)
+#define w_PriorityQueue_build_define_(T)                                                \
+    /**                                                                                 \
+     * 优先队列建堆（自底向上，O(n)）                                      \
+     * @param elementData 数据                                                        \
+     * @param size 大小                                                               \
+     * @return void                                                                     \
+     */                                                                                 \
+    static inline void w_PriorityQueue_build_(T)(T * elementData, int64_t size)         \
+    {                                                                                   \
+        for (int64_t i = (size - 2) / w_PRIORITY_QUEUE_ARITY_; size > 1 && i >= 0; i--) \
+        {                                                                               \
+            w_PriorityQueue_siftDown_(T)(elementData, size, i);                         \
+        }                                                                               \
+    }
+
+// 优先队列初始化
+#define w_PriorityQueue_init(T) w_concat(w_PriorityQueue(T), _init)
+#define w_PriorityQueue_init_define_(T)                                   \
+    /**                                                                   \
+     * 优先队列初始化（不申请内存）                         \
+     * @param this 优先队列                                           \
+     * @return void                                                       \
+     */                                                                   \
+    static inline void w_PriorityQueue_init(T)(w_PriorityQueue(T) * this) \
+    {                                                                     \
+        w_check(this != NULL);                                            \
+        this->elementData = NULL;                                         \
+        this->size = 0;                                                   \
+        this->capacity = 0;                                               \
+        this->limit = 0;                                                  \
+    }
+
+// 优先队列初始化为 Top-K 模式
+#define w_PriorityQueue_initTopK(T) w_concat(w_PriorityQueue(T), _initTopK)
+#define w_PriorityQueue_initTopK_define_(T)                                                                                  \
+    /**                                                                                                                      \
+     * 优先队列初始化为 Top-K 模式：只保留 w_compare(T) 最大的 k 个元素，堆顶为其中最小的元素 \
+     * @param this 优先队列                                                                                              \
+     * @param k 保留的元素数量                                                                                        \
+     * @return void                                                                                                          \
+     */                                                                                                                      \
+    static inline void w_PriorityQueue_initTopK(T)(w_PriorityQueue(T) * this, int64_t k)                                     \
+    {                                                                                                                        \
+        w_check(this != NULL);                                                                                               \
+        w_check(k > 0);                                                                                                      \
+        this->elementData = w_malloc(k * sizeof(T));                                                                         \
+        w_assert(this->elementData != NULL);                                                                                 \
+        this->size = 0;                                                                                                      \
+        this->capacity = k;                                                                                                  \
+        this->limit = k;                                                                                                     \
+    }
+
+// 优先队列销毁
+#define w_PriorityQueue_deinit(T) w_concat(w_PriorityQueue(T), _deinit)
+#define w_PriorityQueue_deinit_define_(T)                                   \
+    /**                                                                     \
+     * 优先队列销毁                                                   \
+     * @param this 优先队列                                             \
+     * @return void                                                         \
+     */                                                                     \
+    static inline void w_PriorityQueue_deinit(T)(w_PriorityQueue(T) * this) \
+    {                                                                       \
+        w_check(this != NULL);                                              \
+        w_free(this->elementData);                                          \
+        memset(this, 0, sizeof(w_PriorityQueue(T)));                        \
+    }
+
+// 优先队列获取大小
+#define w_PriorityQueue_size(T) w_concat(w_PriorityQueue(T), _size)
+#define w_PriorityQueue_size_define_(T)                                      \
+    /**                                                                      \
+     * 优先队列获取大小                                              \
+     * @param this 优先队列                                              \
+     * @return int64_t 大小                                                \
+     */                                                                      \
+    static inline int64_t w_PriorityQueue_size(T)(w_PriorityQueue(T) * this) \
+    {                                                                        \
+        w_check(this != NULL);                                               \
+        return this->size;                                                   \
+    }
+
+// 优先队列是否为空
+#define w_PriorityQueue_isEmpty(T) w_concat(w_PriorityQueue(T), _isEmpty)
+#define w_PriorityQueue_isEmpty_define_(T)                                   \
+    /**                                                                      \
+     * 优先队列是否为空                                              \
+     * @param this 优先队列                                              \
+     * @return bool true:为空 false:不为空                              \
+     */                                                                      \
+    static inline bool w_PriorityQueue_isEmpty(T)(w_PriorityQueue(T) * this) \
+    {                                                                        \
+        w_check(this != NULL);                                               \
+        return this->size == 0;                                              \
+    }
+
+// 优先队列清空
+#define w_PriorityQueue_clear(T) w_concat(w_PriorityQueue(T), _clear)
+#define w_PriorityQueue_clear_define_(T)                                   \
+    /**                                                                    \
+     * 优先队列清空（不释放内存）                             \
+     * @param this 优先队列                                            \
+     * @return void                                                        \
+     */                                                                    \
+    static inline void w_PriorityQueue_clear(T)(w_PriorityQueue(T) * this) \
+    {                                                                      \
+        w_check(this != NULL);                                             \
+        this->size = 0;                                                    \
+    }
+
+// 优先队列扩容
+#define w_PriorityQueue_reserve(T) w_concat(w_PriorityQueue(T), _reserve)
+#define w_PriorityQueue_reserve_define_(T)                                                     \
+    /**                                                                                        \
+     * 优先队列扩容，保证容量不小于 capacity                                     \
+     * @param this 优先队列                                                                \
+     * @param capacity 容量                                                                  \
+     * @return void                                                                            \
+     */                                                                                        \
+    static inline void w_PriorityQueue_reserve(T)(w_PriorityQueue(T) * this, int64_t capacity) \
+    {                                                                                          \
+        w_check(this != NULL);                                                                 \
+        if (capacity <= this->capacity)                                                        \
+        {                                                                                      \
+            return;                                                                            \
+        }                                                                                      \
+        int64_t newCapacity = this->capacity > 0 ? this->capacity * 2 : 16;                    \
+        newCapacity = newCapacity < capacity ? capacity : newCapacity;                         \
+        T *newElementData = w_malloc(newCapacity * sizeof(T));                                 \
+        w_assert(newElementData != NULL);                                                      \
+        if (this->size > 0)                                                                    \
+        {                                                                                      \
+            memcpy(newElementData, this->elementData, this->size * sizeof(T));                 \
+        }                                                                                      \
+        w_free(this->elementData);                                                             \
+        this->elementData = newElementData;                                                    \
+        this->capacity = newCapacity;                                                          \
+    }
+
+// 优先队列查看堆顶元素
+#define w_PriorityQueue_peek(T) w_concat(w_PriorityQueue(T), _peek)
+#define w_PriorityQueue_peek_define_(T)                                \
+    /**                                                                \
+     * 优先队列查看堆顶元素                                  \
+     * @param this 优先队列                                        \
+     * @return T 堆顶元素（w_compare(T) 最小的元素）        \
+     */                                                                \
+    static inline T w_PriorityQueue_peek(T)(w_PriorityQueue(T) * this) \
+    {                                                                  \
+        w_check(this != NULL);                                         \
+        w_checkIndex(this->size > 0);                                  \
+        return this->elementData[0];                                   \
+    }
+
+// 优先队列插入元素
+#define w_PriorityQueue_push(T) w_concat(w_PriorityQueue(T), _push)
+#define w_PriorityQueue_push_define_(T)                                                     \
+    /**                                                                                     \
+     * 优先队列插入元素                                                             \
+     * Top-K 模式下队列已满时，元素大于堆顶才会替换堆顶，否则丢弃 \
+     * @param this 优先队列                                                             \
+     * @param element 元素                                                                \
+     * @return void                                                                         \
+     */                                                                                     \
+    static inline void w_PriorityQueue_push(T)(w_PriorityQueue(T) * this, T element)        \
+    {                                                                                       \
+        w_check(this != NULL);                                                              \
+        if (this->limit > 0 && this->size == this->limit)                                   \
+        {                                                                                   \
+            if (w_compare(T)(&element, &this->elementData[0]) > 0)                          \
+            {                                                                               \
+                this->elementData[0] = element;                                             \
+                w_PriorityQueue_siftDown_(T)(this->elementData, this->size, 0);             \
+            }                                                                               \
+            return;                                                                         \
+        }                                                                                   \
+        w_PriorityQueue_reserve(T)(this, this->size + 1);                                   \
+        this->elementData[this->size] = element;                                            \
+        w_PriorityQueue_siftUp_(T)(this->elementData, this->size);                          \
+        this->size++;                                                                       \
+    }
+
+// 优先队列批量插入元素
+#define w_PriorityQueue_pushBatch(T) w_concat(w_PriorityQueue(T), _pushBatch)
+#define w_PriorityQueue_pushBatch_define_(T)                                                                     \
+    /**                                                                                                          \
+     * 优先队列批量插入元素                                                                            \
+     * 新元素多于已有元素时整体重新建堆（O(n)），否则逐个上浮                           \
+     * @param this 优先队列                                                                                  \
+     * @param elements 元素                                                                                    \
+     * @param count 元素数量                                                                                 \
+     * @return void                                                                                              \
+     */                                                                                                          \
+    static inline void w_PriorityQueue_pushBatch(T)(w_PriorityQueue(T) * this, const T *elements, int64_t count) \
+    {                                                                                                            \
+        w_check(this != NULL);                                                                                   \
+        w_check(elements != NULL || count == 0);                                                                 \
+        w_check(count >= 0);                                                                                     \
+        /* 直接追加的元素数量（Top-K 模式下不超过剩余空间） */                                                   \
+        int64_t append = count;                                                                                  \
+        if (this->limit > 0 && append > this->limit - this->size)                                                \
+        {                                                                                                        \
+            append = this->limit - this->size;                                                                   \
+        }                                                                                                        \
+        if (append > 0)                                                                                          \
+        {                                                                                                        \
+            w_PriorityQueue_reserve(T)(this, this->size + append);                                               \
+            memcpy(this->elementData + this->size, elements, append * sizeof(T));                                \
+            if (append > this->size)                                                                             \
+            {                                                                                                    \
+                this->size += append;                                                                            \
+                w_PriorityQueue_build_(T)(this->elementData, this->size);                                        \
+            }                                                                                                    \
+            else                                                                                                 \
+            {                                                                                                    \
+                for (int64_t i = 0; i < append; i++)                                                             \
+                {                                                                                                \
+                    w_PriorityQueue_siftUp_(T)(this->elementData, this->size);                                   \
+                    this->size++;                                                                                \
+                }                                                                                                \
+            }                                                                                                    \
+        }                                                                                                        \
+        /* 剩余的元素只可能替换堆顶 */                                                                           \
+        for (int64_t i = append; i < count; i++)                                                                 \
+        {                                                                                                        \
+            w_PriorityQueue_push(T)(this, elements[i]);                                                          \
+        }                                                                                                        \
+    }
+
+// 优先队列从数组建堆
+#define w_PriorityQueue_heapify(T) w_concat(w_PriorityQueue(T), _heapify)
+#define w_PriorityQueue_heapify_define_(T)                                                                     \
+    /**                                                                                                        \
+     * 优先队列从数组建堆（替换原有元素，O(n)）                                              \
+     * @param this 优先队列                                                                                \
+     * @param elements 元素                                                                                  \
+     * @param count 元素数量                                                                               \
+     * @return void                                                                                            \
+     */                                                                                                        \
+    static inline void w_PriorityQueue_heapify(T)(w_PriorityQueue(T) * this, const T *elements, int64_t count) \
+    {                                                                                                          \
+        w_PriorityQueue_clear(T)(this);                                                                        \
+        w_PriorityQueue_pushBatch(T)(this, elements, count);                                                   \
+    }
+
+// 优先队列删除堆顶元素
+#define w_PriorityQueue_pop(T) w_concat(w_PriorityQueue(T), _pop)
+#define w_PriorityQueue_pop_define_(T)                                      \
+    /**                                                                     \
+     * 优先队列删除堆顶元素                                       \
+     * @param this 优先队列                                             \
+     * @return T 删除的元素（w_compare(T) 最小的元素）          \
+     */                                                                     \
+    static inline T w_PriorityQueue_pop(T)(w_PriorityQueue(T) * this)       \
+    {                                                                       \
+        w_check(this != NULL);                                              \
+        w_checkIndex(this->size > 0);                                       \
+        T element = this->elementData[0];                                   \
+        this->size--;                                                       \
+        if (this->size > 0)                                                 \
+        {                                                                   \
+            this->elementData[0] = this->elementData[this->size];           \
+            w_PriorityQueue_siftDown_(T)(this->elementData, this->size, 0); \
+        }                                                                   \
+        return element;                                                     \
+    }
+
+// 优先队列获取数据指针
+#define w_PriorityQueue_data(T) w_concat(w_PriorityQueue(T), _data)
+#define w_PriorityQueue_data_define_(T)                                 \
+    /**                                                                 \
+     * 优先队列获取数据指针（堆顺序，不是有序的）  \
+     * @param this 优先队列                                         \
+     * @return T * 数据指针                                         \
+     */                                                                 \
+    static inline T *w_PriorityQueue_data(T)(w_PriorityQueue(T) * this) \
+    {                                                                   \
+        w_check(this != NULL);                                          \
+        return this->elementData;                                       \
+    }
+
+// 优先队列定义（需要先定义 w_compare(T)）
+#define w_PriorityQueue_define(T)         \
+    w_PriorityQueue_type_define_(T);      \
+    w_PriorityQueue_siftUp_define_(T);    \
+    w_PriorityQueue_siftDown_define_(T);  \
+    w_PriorityQueue_build_define_(T);     \
+    w_PriorityQueue_init_define_(T);      \
+    w_PriorityQueue_initTopK_define_(T);  \
+    w_PriorityQueue_deinit_define_(T);    \
+    w_PriorityQueue_size_define_(T);      \
+    w_PriorityQueue_isEmpty_define_(T);   \
+    w_PriorityQueue_clear_define_(T);     \
+    w_PriorityQueue_reserve_define_(T);   \
+    w_PriorityQueue_peek_define_(T);      \
+    w_PriorityQueue_push_define_(T);      \
+    w_PriorityQueue_pushBatch_define_(T); \
+    w_PriorityQueue_heapify_define_(T);   \
+    w_PriorityQueue_pop_define_(T);       \
+    w_PriorityQueue_data_define_(T);
+
+// 索引优先队列类型
+// 元素由 [0, capacity) 中的整数 id 标识，支持修改已有元素的键（如 Dijkstra 中的 decrease-key）
+#define w_IndexedPriorityQueue(T) w_concat(w_IndexedPriorityQueue_, T)
+
+// 索引优先队列类型定义
+#define w_IndexedPriorityQueue_type_define_(T)                       \
+    typedef struct                                                   \
+    {                                                                \
+        int64_t *heap;      /* 堆中的 id（隐式 4 叉堆） */           \
+        int64_t *positions; /* id 在堆中的位置，-1 表示不在队列中 */ \
+        T *keys;            /* id 对应的键 */                        \
+        int64_t size;       /* 大小 */                               \
+        int64_t capacity;   /* id 上限 */                            \
+    } w_IndexedPriorityQueue(T);
+
+// 索引优先队列上浮
+#define w_IndexedPriorityQueue_siftUp_(T) w_concat(w_IndexedPriorityQueue(T), _siftUp_)
+#define w_IndexedPriorityQueue_siftUp_define_(T)                                                          \
+    /**                                                                                                   \
+     * 索引优先队列上浮                                                                           \
+     * @param this 索引优先队列                                                                     \
+     * @param index 需要上浮的位置                                                                 \
+     * @return void                                                                                       \
+     */                                                                                                   \
+    static inline void w_IndexedPriorityQueue_siftUp_(T)(w_IndexedPriorityQueue(T) * this, int64_t index) \
+    {                                                                                                     \
+        int64_t id = this->heap[index];                                                                   \
+        while (index > 0)                                                                                 \
+        {                                                                                                 \
+            int64_t parent = (index - 1) / w_PRIORITY_QUEUE_ARITY_;                                       \
+            if (w_compare(T)(&this->keys[id], &this->keys[this->heap[parent]]) >= 0)                      \
+            {                                                                                             \
+                break;                                                                                    \
+            }                                                                                             \
+            this->heap[index] = this->heap[parent];                                                       \
+            this->positions[this->heap[index]] = index;                                                   \
+            index = parent;                                                                               \
+        }                                                                                                 \
+        this->heap[index] = id;                                                                           \
+        this->positions[id] = index;                                                                      \
+    }
+
+// 索引优先队列下沉
+#define w_IndexedPriorityQueue_siftDown_(T) w_concat(w_IndexedPriorityQueue(T), _siftDown_)
+#define w_IndexedPriorityQueue_siftDown_define_(T)                                                                      \
+    /**                                                                                                                 \
+     * 索引优先队列下沉                                                                                         \
+     * @param this 索引优先队列                                                                                   \
+     * @param index 需要下沉的位置                                                                               \
+     * @return void                                                                                                     \
+     */                                                                                                                 \
+    static inline void w_IndexedPriorityQueue_siftDown_(T)(w_IndexedPriorityQueue(T) * this, int64_t index)             \
+    {                                                                                                                   \
+        int64_t id = this->heap[index];                                                                                 \
+        while (true)                                                                                                    \
+        {                                                                                                               \
+            int64_t first = index * w_PRIORITY_QUEUE_ARITY_ + 1;                                                        \
+            if (first >= this->size)                                                                                    \
+            {                                                                                                           \
+                break;                                                                                                  \
+            }                                                                                                           \
+            int64_t last = first + w_PRIORITY_QUEUE_ARITY_ < this->size ? first + w_PRIORITY_QUEUE_ARITY_ : this->size; \
+            int64_t child = first;                                                                                      \
+            for (int64_t i = first + 1; i < last; i++)                                                                  \
+            {                                                                                                           \
+                child = w_compare(T)(&this->keys[this->heap[i]], &this->keys[this->heap[child]]) < 0 ? i : child;       \
+            }                                                                                                           \
+            if (w_compare(T)(&this->keys[this->heap[child]], &this->keys[id]) >= 0)                                     \
+            {                                                                                                           \
+                break;                                                                                                  \
+            }                                                                                                           \
+            this->heap[index] = this->heap[child];                                                                      \
+            this->positions[this->heap[index]] = index;                                                                 \
+            index = child;                                                                                              \
+        }                                                                                                               \
+        this->heap[index] = id;                                                                                         \
+        this->positions[id] = index;                                                                                    \
+    }
+
+// 索引优先队列初始化
+#define w_IndexedPriorityQueue_init(T) w_concat(w_IndexedPriorityQueue(T), _init)
+#define w_IndexedPriorityQueue_init_define_(T)                                                            \
+    /**                                                                                                   \
+     * 索引优先队列初始化                                                                        \
+     * @param this 索引优先队列                                                                     \
+     * @param capacity id 上限（id 的取值范围为 [0, capacity)）                                 \
+     * @return void                                                                                       \
+     */                                                                                                   \
+    static inline void w_IndexedPriorityQueue_init(T)(w_IndexedPriorityQueue(T) * this, int64_t capacity) \
+    {                                                                                                     \
+        w_check(this != NULL);                                                                            \
+        w_check(capacity > 0);                                                                            \
+        this->heap = w_malloc(capacity * sizeof(int64_t));                                                \
+        this->positions = w_malloc(capacity * sizeof(int64_t));                                           \
+        this->keys = w_malloc(capacity * sizeof(T));                                                      \
+        w_assert(this->heap != NULL && this->positions != NULL && this->keys != NULL);                    \
+        memset(this->positions, 0xff, capacity * sizeof(int64_t));                                        \
+        this->size = 0;                                                                                   \
+        this->capacity = capacity;                                                                        \
+    }
+
+// 索引优先队列销毁
+#define w_IndexedPriorityQueue_deinit(T) w_concat(w_IndexedPriorityQueue(T), _deinit)
+#define w_IndexedPriorityQueue_deinit_define_(T)                                          \
+    /**                                                                                   \
+     * 索引优先队列销毁                                                           \
+     * @param this 索引优先队列                                                     \
+     * @return void                                                                       \
+     */                                                                                   \
+    static inline void w_IndexedPriorityQueue_deinit(T)(w_IndexedPriorityQueue(T) * this) \
+    {                                                                                     \
+        w_check(this != NULL);                                                            \
+        w_free(this->heap);                                                               \
+        w_free(this->positions);                                                          \
+        w_free(this->keys);                                                               \
+        memset(this, 0, sizeof(w_IndexedPriorityQueue(T)));                               \
+    }
+
+// 索引优先队列获取大小
+#define w_IndexedPriorityQueue_size(T) w_concat(w_IndexedPriorityQueue(T), _size)
+#define w_IndexedPriorityQueue_size_define_(T)                                             \
+    /**                                                                                    \
+     * 索引优先队列获取大小                                                      \
+     * @param this 索引优先队列                                                      \
+     * @return int64_t 大小                                                              \
+     */                                                                                    \
+    static inline int64_t w_IndexedPriorityQueue_size(T)(w_IndexedPriorityQueue(T) * this) \
+    {                                                                                      \
+        w_check(this != NULL);                                                             \
+        return this->size;                                                                 \
+    }
+
+// 索引优先队列是否为空
+#define w_IndexedPriorityQueue_isEmpty(T) w_concat(w_IndexedPriorityQueue(T), _isEmpty)
+#define w_IndexedPriorityQueue_isEmpty_define_(T)                                          \
+    /**                                                                                    \
+     * 索引优先队列是否为空                                                      \
+     * @param this 索引优先队列                                                      \
+     * @return bool true:为空 false:不为空                                            \
+     */                                                                                    \
+    static inline bool w_IndexedPriorityQueue_isEmpty(T)(w_IndexedPriorityQueue(T) * this) \
+    {                                                                                      \
+        w_check(this != NULL);                                                             \
+        return this->size == 0;                                                            \
+    }
+
+// 索引优先队列是否包含 id
+#define w_IndexedPriorityQueue_contains(T) w_concat(w_IndexedPriorityQueue(T), _contains)
+#define w_IndexedPriorityQueue_contains_define_(T)                                                      \
+    /**                                                                                                 \
+     * 索引优先队列是否包含 id                                                                \
+     * @param this 索引优先队列                                                                   \
+     * @param id id                                                                                     \
+     * @return bool true:包含 false:不包含                                                         \
+     */                                                                                                 \
+    static inline bool w_IndexedPriorityQueue_contains(T)(w_IndexedPriorityQueue(T) * this, int64_t id) \
+    {                                                                                                   \
+        w_check(this != NULL);                                                                          \
+        w_checkIndex(id >= 0 && id < this->capacity);                                                   \
+        return this->positions[id] >= 0;                                                                \
+    }
+
+// 索引优先队列获取 id 的键
+#define w_IndexedPriorityQueue_keyOf(T) w_concat(w_IndexedPriorityQueue(T), _keyOf)
+#define w_IndexedPriorityQueue_keyOf_define_(T)                                                   \
+    /**                                                                                           \
+     * 索引优先队列获取 id 的键                                                         \
+     * @param this 索引优先队列                                                             \
+     * @param id id（必须在队列中）                                                       \
+     * @return T 键                                                                              \
+     */                                                                                           \
+    static inline T w_IndexedPriorityQueue_keyOf(T)(w_IndexedPriorityQueue(T) * this, int64_t id) \
+    {                                                                                             \
+        w_check(w_IndexedPriorityQueue_contains(T)(this, id));                                    \
+        return this->keys[id];                                                                    \
+    }
+
+// 索引优先队列插入元素
+#define w_IndexedPriorityQueue_push(T) w_concat(w_IndexedPriorityQueue(T), _push)
+#define w_IndexedPriorityQueue_push_define_(T)                                                             \
+    /**                                                                                                    \
+     * 索引优先队列插入元素                                                                      \
+     * @param this 索引优先队列                                                                      \
+     * @param id id（不能已在队列中）                                                             \
+     * @param key 键                                                                                      \
+     * @return void                                                                                        \
+     */                                                                                                    \
+    static inline void w_IndexedPriorityQueue_push(T)(w_IndexedPriorityQueue(T) * this, int64_t id, T key) \
+    {                                                                                                      \
+        w_check(!w_IndexedPriorityQueue_contains(T)(this, id));                                            \
+        this->keys[id] = key;                                                                              \
+        this->heap[this->size] = id;                                                                       \
+        this->size++;                                                                                      \
+        w_IndexedPriorityQueue_siftUp_(T)(this, this->size - 1);                                           \
+    }
+
+// 索引优先队列查看堆顶 id
+#define w_IndexedPriorityQueue_peek(T) w_concat(w_IndexedPriorityQueue(T), _peek)
+#define w_IndexedPriorityQueue_peek_define_(T)                                             \
+    /**                                                                                    \
+     * 索引优先队列查看堆顶 id                                                   \
+     * @param this 索引优先队列                                                      \
+     * @return int64_t 键最小的 id                                                     \
+     */                                                                                    \
+    static inline int64_t w_IndexedPriorityQueue_peek(T)(w_IndexedPriorityQueue(T) * this) \
+    {                                                                                      \
+        w_check(this != NULL);                                                             \
+        w_checkIndex(this->size > 0);                                                      \
+        return this->heap[0];                                                              \
+    }
+
+// 索引优先队列删除 id
+#define w_IndexedPriorityQueue_remove(T) w_concat(w_IndexedPriorityQueue(T), _remove)
+#define w_IndexedPriorityQueue_remove_define_(T)                                                   \
+    /**                                                                                            \
+     * 索引优先队列删除 id                                                                 \
+     * @param this 索引优先队列                                                              \
+     * @param id id（必须在队列中）                                                        \
+     * @return T 删除的键                                                                      \
+     */                                                                                            \
+    static inline T w_IndexedPriorityQueue_remove(T)(w_IndexedPriorityQueue(T) * this, int64_t id) \
+    {                                                                                              \
+        w_check(w_IndexedPriorityQueue_contains(T)(this, id));                                     \
+        int64_t index = this->positions[id];                                                       \
+        this->positions[id] = -1;                                                                  \
+        this->size--;                                                                              \
+        if (index < this->size)                                                                    \
+        {                                                                                          \
+            /* 用最后一个元素填补空位，它可能需要上浮或下沉 */                                     \
+            this->heap[index] = this->heap[this->size];                                            \
+            w_IndexedPriorityQueue_siftUp_(T)(this, index);                                        \
+            w_IndexedPriorityQueue_siftDown_(T)(this, this->positions[this->heap[this->size]]);    \
+        }                                                                                          \
+        return this->keys[id];                                                                     \
+    }
+
+// 索引优先队列删除堆顶元素
+#define w_IndexedPriorityQueue_pop(T) w_concat(w_IndexedPriorityQueue(T), _pop)
+#define w_IndexedPriorityQueue_pop_define_(T)                                                      \
+    /**                                                                                            \
+     * 索引优先队列删除堆顶元素                                                        \
+     * @param this 索引优先队列                                                              \
+     * @param key 删除的键（输出，可以为 NULL）                                        \
+     * @return int64_t 删除的 id                                                                \
+     */                                                                                            \
+    static inline int64_t w_IndexedPriorityQueue_pop(T)(w_IndexedPriorityQueue(T) * this, T * key) \
+    {                                                                                              \
+        int64_t id = w_IndexedPriorityQueue_peek(T)(this);                                         \
+        T removed = w_IndexedPriorityQueue_remove(T)(this, id);                                    \
+        if (key != NULL)                                                                           \
+        {                                                                                          \
+            *key = removed;                                                                        \
+        }                                                                                          \
+        return id;                                                                                 \
+    }
+
+// 索引优先队列修改键
+#define w_IndexedPriorityQueue_update(T) w_concat(w_IndexedPriorityQueue(T), _update)
+#define w_IndexedPriorityQueue_update_define_(T)                                                             \
+    /**                                                                                                      \
+     * 索引优先队列修改键（可以增大或减小），id 不在队列中时插入                  \
+     * @param this 索引优先队列                                                                        \
+     * @param id id                                                                                          \
+     * @param key 新的键                                                                                  \
+     * @return void                                                                                          \
+     */                                                                                                      \
+    static inline void w_IndexedPriorityQueue_update(T)(w_IndexedPriorityQueue(T) * this, int64_t id, T key) \
+    {                                                                                                        \
+        if (!w_IndexedPriorityQueue_contains(T)(this, id))                                                   \
+        {                                                                                                    \
+            w_IndexedPriorityQueue_push(T)(this, id, key);                                                   \
+            return;                                                                                          \
+        }                                                                                                    \
+        int64_t order = w_compare(T)(&key, &this->keys[id]);                                                 \
+        this->keys[id] = key;                                                                                \
+        if (order < 0)                                                                                       \
+        {                                                                                                    \
+            w_IndexedPriorityQueue_siftUp_(T)(this, this->positions[id]);                                    \
+        }                                                                                                    \
+        else if (order > 0)                                                                                  \
+        {                                                                                                    \
+            w_IndexedPriorityQueue_siftDown_(T)(this, this->positions[id]);                                  \
+        }                                                                                                    \
+    }
+
+// 索引优先队列减小键
+#define w_IndexedPriorityQueue_decreaseKey(T) w_concat(w_IndexedPriorityQueue(T), _decreaseKey)
+#define w_IndexedPriorityQueue_decreaseKey_define_(T)                                                             \
+    /**                                                                                                           \
+     * 索引优先队列减小键（新的键不小于原有的键时不做修改）                             \
+     * @param this 索引优先队列                                                                             \
+     * @param id id（必须在队列中）                                                                       \
+     * @param key 新的键                                                                                       \
+     * @return bool 是否修改                                                                                  \
+     */                                                                                                           \
+    static inline bool w_IndexedPriorityQueue_decreaseKey(T)(w_IndexedPriorityQueue(T) * this, int64_t id, T key) \
+    {                                                                                                             \
+        w_check(w_IndexedPriorityQueue_contains(T)(this, id));                                                    \
+        if (w_compare(T)(&key, &this->keys[id]) >= 0)                                                             \
+        {                                                                                                         \
+            return false;                                                                                         \
+        }                                                                                                         \
+        this->keys[id] = key;                                                                                     \
+        w_IndexedPriorityQueue_siftUp_(T)(this, this->positions[id]);                                             \
+        return true;                                                                                              \
+    }
+
+// 索引优先队列定义（需要先定义 w_compare(T)）
+#define w_IndexedPriorityQueue_define(T)        \
+    w_IndexedPriorityQueue_type_define_(T);     \
+    w_IndexedPriorityQueue_siftUp_define_(T);   \
+    w_IndexedPriorityQueue_siftDown_define_(T); \
+    w_IndexedPriorityQueue_init_define_(T);     \
+    w_IndexedPriorityQueue_deinit_define_(T);   \
+    w_IndexedPriorityQueue_size_define_(T);     \
+    w_IndexedPriorityQueue_isEmpty_define_(T);  \
+    w_IndexedPriorityQueue_contains_define_(T); \
+    w_IndexedPriorityQueue_keyOf_define_(T);    \
+    w_IndexedPriorityQueue_push_define_(T);     \
+    w_IndexedPriorityQueue_peek_define_(T);     \
+    w_IndexedPriorityQueue_remove_define_(T);   \
+    w_IndexedPriorityQueue_pop_define_(T);      \
+    w_IndexedPriorityQueue_update_define_(T);   \
+    w_IndexedPriorityQueue_decreaseKey_define_(T);
+
+// ========================================================================================================================================================
+//  Map
+// ========================================================================================================================================================
+
+// MapEntry 类型
+#define w_Map_Entry(K, V) w_concat(w_concat(w_concat(w_Map_Entry_, K), _), V)
+
+// MapEntry 定义
+#define w_Map_Entry_type_define_(K, V)   \
+    typedef struct w_Map_Entry(K, V)     \
+    {                                    \
+        K key;                           \
+        V value;                         \
+        struct w_Map_Entry(K, V) * next; \
+    } w_Map_Entry(K, V);
+
+// Map 类型
+#define w_Map(K, V) w_concat(w_concat(w_concat(w_Map_, K), _), V)
+
+// Map 类型定义
+#define w_Map_type_define_(K, V)        \
+    typedef struct w_Map(K, V)          \
+    {                                   \
+        w_Map_Entry(K, V) * *entryData; \
+        int64_t entryDataSize;          \
+        int64_t size;                   \
+    } w_Map(K, V);
+
+// Map 初始化
+#define w_Map_init(K, V) w_concat(w_Map(K, V), _init)
+#define w_Map_init_define_(K, V)                                                       \
+    /**                                                                                \
+     * Map 初始化                                                                   \
+     * @param this Map                                                                 \
+     * @return void                                                                    \
+     */                                                                                \
+    static inline void w_Map_init(K, V)(w_Map(K, V) * this)                            \
+    {                                                                                  \
+        this->entryDataSize = 16;                                                      \
+        this->entryData = w_malloc(sizeof(w_Map_Entry(K, V) *) * this->entryDataSize); \
+        w_assert(this->entryData != NULL);                                             \
+        memset(this->entryData, 0, sizeof(w_Map_Entry(K, V) *) * this->entryDataSize); \
+        this->size = 0;                                                                \
+    }
+
+// Map 释放
+#define w_Map_deinit(K, V) w_concat(w_Map(K, V), _deinit)
+#define w_Map_deinit_define_(K, V)                            \
+    /**                                                       \
+     * Map 释放                                             \
+     * @param this Map                                        \
+     * @return void                                           \
+     */                                                       \
+    static inline void w_Map_deinit(K, V)(w_Map(K, V) * this) \
+    {                                                         \
+        /* 遍历链表 */                                        \
+        for (int64_t i = 0; i < this->entryDataSize; i++)     \
+        {                                                     \
+            /* 链表头 */                                      \
+            w_Map_Entry(K, V) *entry = this->entryData[i];    \
+            while (entry != NULL)                             \
+            {                                                 \
+                /* 释放节点 */                                \
+                w_Map_Entry(K, V) *next = entry->next;        \
+                w_free(entry);                                \
+                entry = next;                                 \
+            }                                                 \
+        }                                                     \
+        memset(this, 0, sizeof(w_Map(K, V)));                 \
+    }
+
+// Map 放置 键值对 到 键值对数组
+#define w_Map_putToEntryData_(K, V) w_concat(w_Map(K, V), _putToEntryData_)
+#define w_Map_putToEntryData_define_(K, V)                                                                                \
+    /**                                                                                                                   \
+     * 放置 键值对 到 键值对数组                                                                               \
+     * @param entryData 键值对数组                                                                                   \
+     * @param entryDataSize 键值对数组大小                                                                         \
+     * @param key 键                                                                                                     \
+     * @param value 值                                                                                                   \
+     * @return bool 是否添加新的元素                                                                              \
+     */                                                                                                                   \
+    static inline bool w_Map_putToEntryData_(K, V)(w_Map_Entry(K, V) * *entryData, int64_t entryDataSize, K key, V value) \
+    {                                                                                                                     \
+        w_check(entryData != NULL);                                                                                       \
+        w_check(entryDataSize > 0);                                                                                       \
+        /* 计算索引 */                                                                                                    \
+        int64_t index = w_hash(K)(&key) & (entryDataSize - 1);                                                            \
+                                                                                                                          \
+        /* 链表头 */                                                                                                      \
+        w_Map_Entry(K, V) *entry = entryData[index];                                                                      \
+        while (entry != NULL)                                                                                             \
+        {                                                                                                                 \
+            /* 键相等 */                                                                                                  \
+            if (w_equals(K)(&(entry->key), &key))                                                                         \
+            {                                                                                                             \
+                /* 覆盖值 */                                                                                              \
+                entry->value = value;                                                                                     \
+                return false;                                                                                             \
+            }                                                                                                             \
+            entry = entry->next;                                                                                          \
+        }                                                                                                                 \
+                                                                                                                          \
+        /* 创建节点 */                                                                                                    \
+        entry = w_malloc(sizeof(w_Map_Entry(K, V)));                                                                      \
+        w_assert(entry != NULL);                                                                                          \
+        entry->key = key;                                                                                                 \
+        entry->value = value;                                                                                             \
+        /* 头插法 */                                                                                                      \
+        entry->next = entryData[index];                                                                                   \
+        entryData[index] = entry;                                                                                         \
+        return true;                                                                                                      \
+    }
+
+// Map 扩容
+#define w_Map_realloc_(K, V) w_concat(w_Map(K, V), _realloc_)
+#define w_Map_realloc_define_(K, V)                                                                           \
+    /**                                                                                                       \
+     * Map 扩容                                                                                             \
+     * @param this Map                                                                                        \
+     * @return void                                                                                           \
+     */                                                                                                       \
+    static inline void w_Map_realloc_(K, V)(w_Map(K, V) * this)                                               \
+    {                                                                                                         \
+        /* 申请新的键值对数组 */                                                                              \
+        w_Map_Entry(K, V) **newEntryData = w_malloc(sizeof(w_Map_Entry(K, V) *) * this->entryDataSize * 2);   \
+        w_assert(newEntryData != NULL);                                                                       \
+        memset(newEntryData, 0, sizeof(w_Map_Entry(K, V) *) * this->entryDataSize * 2);                       \
+                                                                                                              \
+        /* 将旧键值对数组中的键值对放置到新键值对数组中 */                                                    \
+        for (int64_t i = 0; i < this->entryDataSize; i++)                                                     \
+        {                                                                                                     \
+            w_Map_Entry(K, V) *entry = this->entryData[i];                                                    \
+            while (entry != NULL)                                                                             \
+            {                                                                                                 \
+                w_Map_putToEntryData_(K, V)(newEntryData, this->entryDataSize * 2, entry->key, entry->value); \
+                w_Map_Entry(K, V) *next = entry->next;                                                        \
+                w_free(entry);                                                                                \
+                entry = next;                                                                                 \
+            }                                                                                                 \
+        }                                                                                                     \
+                                                                                                              \
+        /*  更新 */                                                                                           \
+        w_free(this->entryData);                                                                              \
+        this->entryData = newEntryData;                                                                       \
+        this->entryDataSize *= 2;                                                                             \
+    }
+
+// Map 放置键值对
+#define w_Map_put(K, V) w_concat(w_Map(K, V), _put)
+#define w_Map_put_define_(K, V)                                                            \
+    /**                                                                                    \
+     * Map 放置键值对                                                                 \
+     * @param this Map                                                                     \
+     * @param key 键                                                                      \
+     * @param value 值                                                                    \
+     * @return void                                                                        \
+     */                                                                                    \
+    static inline void w_Map_put(K, V)(w_Map(K, V) * this, K key, V value)                 \
+    {                                                                                      \
+        w_check(this != NULL);                                                             \
+        w_check(this->entryData != NULL);                                                  \
+        w_check(this->entryDataSize > 0);                                                  \
+        w_check(this->size >= 0);                                                          \
+                                                                                           \
+        /* 扩容 */                                                                         \
+        if ((double)this->size / this->entryDataSize >= 0.75)                              \
+        {                                                                                  \
+            w_Map_realloc_(K, V)(this);                                                    \
+        }                                                                                  \
+                                                                                           \
+        /* 添加键值对 */                                                                   \
+        if (w_Map_putToEntryData_(K, V)(this->entryData, this->entryDataSize, key, value)) \
+        {                                                                                  \
+            this->size++;                                                                  \
+        }                                                                                  \
+    }
+
+// Map 获取值
+#define w_Map_get(K, V) w_concat(w_Map(K, V), _get)
+#define w_Map_get_define_(K, V)                                      \
+    /**                                                              \
+     * Map 获取值                                                 \
+     * 如果元素不存在，则报错                             \
+     * @param this Map                                               \
+     * @param key 键                                                \
+     * @return 值                                                   \
+     */                                                              \
+    static inline V w_Map_get(K, V)(w_Map(K, V) * this, K key)       \
+    {                                                                \
+        w_check(this != NULL);                                       \
+        w_check(this->entryData != NULL);                            \
+        w_check(this->entryDataSize > 0);                            \
+        w_check(this->size >= 0);                                    \
+                                                                     \
+        /* 计算索引 */                                               \
+        int64_t index = w_hash(K)(&key) & (this->entryDataSize - 1); \
+                                                                     \
+        /* 查找 */                                                   \
+        w_Map_Entry(K, V) *entry = this->entryData[index];           \
+        while (entry != NULL)                                        \
+        {                                                            \
+            if (w_equals(K)(&(entry->key), &key))                    \
+            {                                                        \
+                return entry->value;                                 \
+            }                                                        \
+            entry = entry->next;                                     \
+        }                                                            \
+                                                                     \
+        /* 未找到 */                                                 \
+        w_assert(false);                                             \
+    }
+
+// Map 删除键值对
+#define w_Map_remove(K, V) w_concat(w_Map(K, V), _remove)
+#define w_Map_remove_define_(K, V)                                   \
+    /**                                                              \
+     * Map 删除键值对                                           \
+     * @param this Map                                               \
+     * @param key 键                                                \
+     * @return void                                                  \
+     */                                                              \
+    static inline void w_Map_remove(K, V)(w_Map(K, V) * this, K key) \
+    {                                                                \
+        w_check(this != NULL);                                       \
+        w_check(this->entryData != NULL);                            \
+        w_check(this->entryDataSize > 0);                            \
+        w_check(this->size >= 0);                                    \
+                                                                     \
+        /* 删除 */                                                   \
+        int64_t index = w_hash(K)(&key) & (this->entryDataSize - 1); \
+        w_Map_Entry(K, V) *entry = this->entryData[index];           \
+        if (entry == NULL)                                           \
+        {                                                            \
+            return;                                                  \
+        }                                                            \
+        /* 头 */                                                     \
+        if (w_equals(K)(&(entry->key), &key))                        \
+        {                                                            \
+            this->entryData[index] = entry->next;                    \
+            w_free(entry);                                           \
+            this->size--;                                            \
+            return;                                                  \
+        }                                                            \
+        /* 中间 */                                                   \
+        while (entry->next != NULL)                                  \
+        {                                                            \
+            if (w_equals(K)(&(entry->next->key), &key))              \
+            {                                                        \
+                w_Map_Entry(K, V) *next = entry->next;               \
+                entry->next = next->next;                            \
+                w_free(next);                                        \
+                this->size--;                                        \
+                return;                                              \
+            }                                                        \
+            entry = entry->next;                                     \
+        }                                                            \
+    }
+
+// Map 大小
+#define w_Map_size(K, V) w_concat(w_Map(K, V), _size)
+#define w_Map_size_define_(K, V)                               \
+    /**                                                        \
+     * Map 大小                                              \
+     * @param this Map                                         \
+     * @return int64_t 键值对数量                         \
+     */                                                        \
+    static inline int64_t w_Map_size(K, V)(w_Map(K, V) * this) \
+    {                                                          \
+        w_check(this != NULL);                                 \
+        w_check(this->entryData != NULL);                      \
+        w_check(this->entryDataSize > 0);                      \
+        w_check(this->size >= 0);                              \
+        return this->size;                                     \
+    }
+
+// Map 是否包含键
+#define w_Map_containsKey(K, V) w_concat(w_Map(K, V), _containsKey)
+#define w_Map_containsKey_define_(K, V)                                   \
+    /**                                                                   \
+     * Map 是否包含键                                                \
+     * @param this Map                                                    \
+     * @param key 键                                                     \
+     * @return bool                                                       \
+     */                                                                   \
+    static inline bool w_Map_containsKey(K, V)(w_Map(K, V) * this, K key) \
+    {                                                                     \
+        w_check(this != NULL);                                            \
+        w_check(this->entryData != NULL);                                 \
+        w_check(this->entryDataSize > 0);                                 \
+        w_check(this->size >= 0);                                         \
+                                                                          \
+        /* 索引 */                                                        \
+        int64_t index = w_hash(K)(&key) & (this->entryDataSize - 1);      \
+        w_Map_Entry(K, V) *entry = this->entryData[index];                \
+        while (entry != NULL)                                             \
+        {                                                                 \
+            if (w_equals(K)(&(entry->key), &key))                         \
+            {                                                             \
+                return true;                                              \
+            }                                                             \
+            entry = entry->next;                                          \
+        }                                                                 \
+        return false;                                                     \
+    }
+
+// Map 迭代器
+#define w_Map_Iterator(K, V) w_concat(w_Map(K, V), _Iterator)
+#define w_Map_Iterator_type_define_(K, V) \
+    typedef struct                        \
+    {                                     \
+        w_Map(K, V) * map;                \
+        int64_t index;                    \
+        w_Map_Entry(K, V) * entry;        \
+    } w_Map_Iterator(K, V);
+
+// Map 获取迭代器
+#define w_Map_iterator(K, V) w_concat(w_Map(K, V), _iterator)
+#define w_Map_iterator_define_(K, V)                                                                               \
+    /**                                                                                                            \
+     * Map 获取迭代器                                                                                         \
+     * 使用完毕后不需要释放，使用期间不允许修改 Map，Map 修改后需要重新获取迭代器 \
+     * @param this Map                                                                                             \
+     * @return w_Map_Iterator 返回一个新的迭代器                                                          \
+     */                                                                                                            \
+    static inline w_Map_Iterator(K, V) w_Map_iterator(K, V)(w_Map(K, V) * this)                                    \
+    {                                                                                                              \
+        w_check(this != NULL);                                                                                     \
+        w_check(this->entryData != NULL);                                                                          \
+        w_check(this->entryDataSize > 0);                                                                          \
+        return (w_Map_Iterator(K, V)){this, 0, this->entryData[0]};                                                \
+    }
+
+// Map 迭代器获取下一个
+#define w_Map_Iterator_next(K, V) w_concat(w_Map(K, V), _Iterator_next)
+#define w_Map_Iterator_next_define_(K, V)                                                                 \
+    /**                                                                                                   \
+     * 迭代器获取下一个键值对（可以修改值，但不能修改键，会同步到 Map 中） \
+     * @param this 迭代器                                                                              \
+     * @return w_Map_Entry 键值对，如果为 NULL 则迭代结束                                     \
+     */                                                                                                   \
+    static inline w_Map_Entry(K, V) * w_Map_Iterator_next(K, V)(w_Map_Iterator(K, V) * this)              \
+    {                                                                                                     \
+        w_check(this != NULL);                                                                            \
+        w_check(this->map != NULL);                                                                       \
+        w_check(this->map->entryData != NULL);                                                            \
+        w_check(this->map->entryDataSize > 0);                                                            \
+                                                                                                          \
+        /* 移动到下一个索引 */                                                                            \
+        while (this->entry == NULL)                                                                       \
+        {                                                                                                 \
+            this->index++;                                                                                \
+            this->entry = this->map->entryData[this->index];                                              \
+            if (this->index >= this->map->entryDataSize)                                                  \
+            {                                                                                             \
+                return NULL;                                                                              \
+            }                                                                                             \
+        }                                                                                                 \
+                                                                                                          \
+        /* 返回并移动到下一个位置 */                                                                      \
+        w_Map_Entry(K, V) *entry = this->entry;                                                           \
+        this->entry = this->entry->next;                                                                  \
+        return entry;                                                                                     \
+    }
+
+// Map 定义
+// 定义 Map 需要定义 K 的 w_hash 和 w_equals 函数
+#define w_Map_define(K, V)              \
+    w_Map_Entry_type_define_(K, V);     \
+    w_Map_type_define_(K, V);           \
+    w_Map_init_define_(K, V);           \
+    w_Map_deinit_define_(K, V);         \
+    w_Map_putToEntryData_define_(K, V); \
+    w_Map_realloc_define_(K, V);        \
+    w_Map_put_define_(K, V);            \
+    w_Map_get_define_(K, V);            \
+    w_Map_remove_define_(K, V);         \
+    w_Map_size_define_(K, V);           \
+    w_Map_containsKey_define_(K, V);    \
+    w_Map_Iterator_type_define_(K, V);  \
+    w_Map_iterator_define_(K, V);       \
+    w_Map_Iterator_next_define_(K, V);
+
+// ========================================================================================================================================================
+//  Set
+// ========================================================================================================================================================
+
+// Set 类型
+#define w_Set(T) w_concat(w_Set_, T)
+
+// Set Map 值类型
+typedef struct
+{
+} w_Set_MapValueType_;
+
+// Set 类型定义
+#define w_Set_type_define_(T)              \
+    w_Map_define(T, w_Set_MapValueType_);  \
+    typedef struct                         \
+    {                                      \
+        w_Map(T, w_Set_MapValueType_) map; \
+    } w_Set(T);
+
+// Set 初始化
+#define w_Set_init(T) w_concat(w_Set(T), _init)
+#define w_Set_init_define_(T)                           \
+    /**                                                 \
+     * Set 初始化                                    \
+     * @param this Set                                  \
+     * @return void                                     \
+     */                                                 \
+    static inline void w_Set_init(T)(w_Set(T) * this)   \
+    {                                                   \
+        w_check(this != NULL);                          \
+        w_Map_init(T, w_Set_MapValueType_)(&this->map); \
+    }
+
+// Set 销毁
+#define w_Set_deinit(T) w_concat(w_Set(T), _deinit)
+#define w_Set_deinit_define_(T)                           \
+    /**                                                   \
+     * Set 销毁                                         \
+     * @param this Set                                    \
+     * @return void                                       \
+     */                                                   \
+    static inline void w_Set_deinit(T)(w_Set(T) * this)   \
+    {                                                     \
+        w_check(this != NULL);                            \
+        w_Map_deinit(T, w_Set_MapValueType_)(&this->map); \
+    }
+
+// Set 添加
+#define w_Set_add(T) w_concat(w_Set(T), _add)
+#define w_Set_add_define_(T)                                                           \
+    /**                                                                                \
+     * Set 添加                                                                      \
+     * @param this Set                                                                 \
+     * @param value 值                                                                \
+     * @return void                                                                    \
+     */                                                                                \
+    static inline void w_Set_add(T)(w_Set(T) * this, T value)                          \
+    {                                                                                  \
+        w_check(this != NULL);                                                         \
+        w_Map_put(T, w_Set_MapValueType_)(&this->map, value, (w_Set_MapValueType_){}); \
+    }
+
+// Set 移除
+#define w_Set_remove(T) w_concat(w_Set(T), _remove)
+#define w_Set_remove_define_(T)                                  \
+    /**                                                          \
+     * Set 移除                                                \
+     * @param this Set                                           \
+     * @param value 值                                          \
+     * @return void                                              \
+     */                                                          \
+    static inline void w_Set_remove(T)(w_Set(T) * this, T value) \
+    {                                                            \
+        w_check(this != NULL);                                   \
+        w_Map_remove(T, w_Set_MapValueType_)(&this->map, value); \
+    }
+
+// Set 包含
+#define w_Set_contains(T) w_concat(w_Set(T), _contains)
+#define w_Set_contains_define_(T)                                            \
+    /**                                                                      \
+     * Set 包含                                                            \
+     * @param this Set                                                       \
+     * @param value 值                                                      \
+     * @return bool 是否包含                                             \
+     */                                                                      \
+    static inline bool w_Set_contains(T)(w_Set(T) * this, T value)           \
+    {                                                                        \
+        w_check(this != NULL);                                               \
+        return w_Map_containsKey(T, w_Set_MapValueType_)(&this->map, value); \
+    }
+
+// Set 大小
+#define w_Set_size(T) w_concat(w_Set(T), _size)
+#define w_Set_size_define_(T)                                  \
+    /**                                                        \
+     * Set 大小                                              \
+     * @param this Set                                         \
+     * @return int 大小                                      \
+     */                                                        \
+    static inline int w_Set_size(T)(w_Set(T) * this)           \
+    {                                                          \
+        w_check(this != NULL);                                 \
+        return w_Map_size(T, w_Set_MapValueType_)(&this->map); \
+    }
+
+// Set 迭代器
+#define w_Set_Iterator(T) w_concat(w_Set(T), _Iterator)
+#define w_Set_Iterator_type_define_(T)                      \
+    typedef struct                                          \
+    {                                                       \
+        w_Map_Iterator(T, w_Set_MapValueType_) mapIterator; \
+    } w_Set_Iterator(T);
+
+// Set 获取迭代器
+#define w_Set_iterator(T) w_concat(w_Set(T), _iterator)
+#define w_Set_iterator_define_(T)                                                                                  \
+    /**                                                                                                            \
+     * Set 获取迭代器                                                                                         \
+     * 使用完毕后不需要释放，使用期间不允许修改 Set，Set 修改后需要重新获取迭代器 \
+     * @param this Set                                                                                             \
+     * @return w_Set_Iterator(T) 迭代器                                                                         \
+     */                                                                                                            \
+    static inline w_Set_Iterator(T) w_Set_iterator(T)(w_Set(T) * this)                                             \
+    {                                                                                                              \
+        w_check(this != NULL);                                                                                     \
+        return (w_Set_Iterator(T)){w_Map_iterator(T, w_Set_MapValueType_)(&this->map)};                            \
+    }
+
+// Set 迭代器获取下一个元素
+#define w_Set_Iterator_next(T) w_concat(w_Set(T), _Iterator_next)
+#define w_Set_Iterator_next_define_(T)                                                                                \
+    /**                                                                                                               \
+     * Set 迭代器获取下一个元素                                                                             \
+     * @param this 迭代器                                                                                          \
+     * @param value 将下一个元素放入所指向的地址                                                        \
+     * @return bool 是否有下一个元素                                                                          \
+     */                                                                                                               \
+    static inline bool w_Set_Iterator_next(T)(w_Set_Iterator(T) * this, T * value)                                    \
+    {                                                                                                                 \
+        w_check(this != NULL);                                                                                        \
+        w_Map_Entry(T, w_Set_MapValueType_) *entry = w_Map_Iterator_next(T, w_Set_MapValueType_)(&this->mapIterator); \
+        if (entry)                                                                                                    \
+        {                                                                                                             \
+            *value = entry->key;                                                                                      \
+            return true;                                                                                              \
+        }                                                                                                             \
+        return false;                                                                                                 \
+    }
+
+// Set 定义
+// 定义 Set 需要定义 T 的 w_hash 和 w_equals 函数
+#define w_Set_define(T)             \
+    w_Set_type_define_(T);          \
+    w_Set_init_define_(T);          \
+    w_Set_deinit_define_(T);        \
+    w_Set_add_define_(T);           \
+    w_Set_remove_define_(T);        \
+    w_Set_contains_define_(T);      \
+    w_Set_size_define_(T);          \
+    w_Set_Iterator_type_define_(T); \
+    w_Set_iterator_define_(T);      \
+    w_Set_Iterator_next_define_(T);
+
+// ========================================================================================================================================================
+//  数字类型的哈希和比较操作定义
+// ========================================================================================================================================================
+
+// 数字类型哈希函数
+#define w_number_hash_define_(T)               \
+    static inline int64_t w_hash(T)(T * value) \
+    {                                          \
+        w_check(value != NULL);                \
+        return (int64_t)*value;                \
+    }
+
+// 数字类型比较函数
+#define w_number_equals_define_(T)               \
+    static inline bool w_equals(T)(T * a, T * b) \
+    {                                            \
+        w_check(a != NULL && b != NULL);         \
+        return *a == *b;                         \
+    }
+
+// 数字类型比较函数
+#define w_number_compare_define_(T)                      \
+    static inline int64_t w_compare(T)(T * a, T * b)     \
+    {                                                    \
+        w_check(a != NULL && b != NULL);                 \
+        /* 不能用差值判断，无符号类型和溢出时结果错误 */ \
+        return (*a > *b) - (*a < *b);                    \
+    }
+
+// 数字比较和哈希函数类型定义
+#define w_number_type_hash_and_compare_define_(T) \
+    w_number_hash_define_(T);                     \
+    w_number_equals_define_(T);                   \
+    w_number_compare_define_(T);
+
+// 使用宏定义定义所有数字类型的比较和哈希函数
+w_number_type_hash_and_compare_define_(int8_t);
+w_number_type_hash_and_compare_define_(int16_t);
+w_number_type_hash_and_compare_define_(int32_t);
+w_number_type_hash_and_compare_define_(int64_t);
+w_number_type_hash_and_compare_define_(uint8_t);
+w_number_type_hash_and_compare_define_(uint16_t);
+w_number_type_hash_and_compare_define_(uint32_t);
+w_number_type_hash_and_compare_define_(uint64_t);
+w_number_type_hash_and_compare_define_(bool);
+w_number_type_hash_and_compare_define_(char);
+w_number_type_hash_and_compare_define_(short);
+w_number_type_hash_and_compare_define_(int);
+w_number_type_hash_and_compare_define_(long);
+w_number_type_hash_and_compare_define_(float);
+w_number_type_hash_and_compare_define_(double);
+
+// ========================================================================================================================================================
+//  数值计算
+// ========================================================================================================================================================
+
+// 向量字节数，使用 GCC 向量扩展，编译器按目标指令集拆分（AVX-512、AVX2、SSE、NEON）
+#define w_SIMD_BYTES_ 64
+
+// 运行时按 CPU 选择 AVX-512 / AVX2 / 默认实现
+#if defined(__x86_64__) && defined(__linux__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define w_SIMD_DISPATCH_ __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+#ifndef w_SIMD_DISPATCH_
+#define w_SIMD_DISPATCH_
+#endif
+
+// 掩码按 64 位字访问
+typedef uint64_t w_MaskWords_ __attribute__((vector_size(w_SIMD_BYTES_)));
+
+/**
+ * 掩码是否有任意位被置位
+ * @param mask 掩码（w_SIMD_BYTES_ 字节）
+ * @return bool 是否有任意位被置位
+ */
+#define w_maskAny_(mask)                                                       \
+    ({                                                                         \
+        w_MaskWords_ words_ = (w_MaskWords_)(mask);                            \
+        uint64_t bits_ = 0;                                                    \
+        for (int64_t word_ = 0; word_ < (int64_t)(w_SIMD_BYTES_ / 8); word_++) \
+        {                                                                      \
+            bits_ |= words_[word_];                                            \
+        }                                                                      \
+        bits_ != 0;                                                            \
+    })
+
+// 向量类型
+#define w_Vector_(T) w_concat(w_concat(w_Vector_, T), _)
+
+// 向量元素数量
+#define w_Vector_lanes_(T) ((int64_t)(w_SIMD_BYTES_ / sizeof(T)))
+
+// 求和结果类型
+#define w_SumType_(T) w_concat(w_concat(w_SumType_, T), _)
+
+// 求和向量类型（元素数量与 w_Vector_(T) 相同）
+#define w_SumVector_(T) w_concat(w_concat(w_SumVector_, T), _)
+
+// 数值向量类型定义
+#define w_number_vector_type_define_(T, S)                              \
+    typedef T w_Vector_(T) __attribute__((vector_size(w_SIMD_BYTES_))); \
+    typedef S w_SumType_(T);                                            \
+    typedef S w_SumVector_(T) __attribute__((vector_size(w_SIMD_BYTES_ / sizeof(T) * sizeof(S))));
+
+// 求和
+#define w_sum(T) w_concat(w_sum_, T)
+#define w_sum_define_(T)                                                               \
+    /**                                                                                \
+     * 求和（整数累加到 64 位整数，浮点数累加到 double）            \
+     * @param data 数据                                                              \
+     * @param size 元素数量                                                        \
+     * @return w_SumType_(T) 和                                                       \
+     */                                                                                \
+    static inline w_SIMD_DISPATCH_ w_SumType_(T) w_sum(T)(const T *data, int64_t size) \
+    {                                                                                  \
+        w_check(data != NULL || size == 0);                                            \
+        const int64_t lanes = w_Vector_lanes_(T);                                      \
+        w_SumVector_(T) sum0 = {0}, sum1 = {0};                                        \
+        int64_t i = 0;                                                                 \
+        for (; i + 2 * lanes <= size; i += 2 * lanes)                                  \
+        {                                                                              \
+            w_Vector_(T) v0, v1;                                                       \
+            memcpy(&v0, data + i, sizeof(v0));                                         \
+            memcpy(&v1, data + i + lanes, sizeof(v1));                                 \
+            sum0 += __builtin_convertvector(v0, w_SumVector_(T));                      \
+            sum1 += __builtin_convertvector(v1, w_SumVector_(T));                      \
+        }                                                                              \
+        sum0 += sum1;                                                                  \
+        w_SumType_(T) sum = 0;                                                         \
+        for (int64_t j = 0; j < lanes; j++)                                            \
+        {                                                                              \
+            sum += sum0[j];                                                            \
+        }                                                                              \
+        for (; i < size; i++)                                                          \
+        {                                                                              \
+            sum += data[i];                                                            \
+        }                                                                              \
+        return sum;                                                                    \
+    }
+
+// 最小值
+#define w_min(T) w_concat(w_min_, T)
+#define w_min_define_(T)                                                                                \
+    /**                                                                                                 \
+     * 最小值（浮点数不处理 NaN）                                                            \
+     * @param data 数据                                                                               \
+     * @param size 元素数量（必须大于 0）                                                     \
+     * @return T 最小值                                                                              \
+     */                                                                                                 \
+    static inline w_SIMD_DISPATCH_ T w_min(T)(const T *data, int64_t size)                              \
+    {                                                                                                   \
+        w_check(data != NULL);                                                                          \
+        w_check(size > 0);                                                                              \
+        const int64_t lanes = w_Vector_lanes_(T);                                                       \
+        T result = data[0];                                                                             \
+        int64_t i = 1;                                                                                  \
+        if (size >= lanes)                                                                              \
+        {                                                                                               \
+            w_Vector_(T) best;                                                                          \
+            memcpy(&best, data, sizeof(best));                                                          \
+            for (i = lanes; i + lanes <= size; i += lanes)                                              \
+            {                                                                                           \
+                w_Vector_(T) v;                                                                         \
+                memcpy(&v, data + i, sizeof(v));                                                        \
+                __typeof__(v < best) mask = v < best;                                                   \
+                best = (w_Vector_(T))(((__typeof__(mask))v & mask) | ((__typeof__(mask))best & ~mask)); \
+            }                                                                                           \
+            result = best[0];                                                                           \
+            for (int64_t j = 1; j < lanes; j++)                                                         \
+            {                                                                                           \
+                result = best[j] < result ? best[j] : result;                                           \
+            }                                                                                           \
+        }                                                                                               \
+        for (; i < size; i++)                                                                           \
+        {                                                                                               \
+            result = data[i] < result ? data[i] : result;                                               \
+        }                                                                                               \
+        return result;                                                                                  \
+    }
+
+// 最大值
+#define w_max(T) w_concat(w_max_, T)
+#define w_max_define_(T)                                                                                \
+    /**                                                                                                 \
+     * 最大值（浮点数不处理 NaN）                                                            \
+     * @param data 数据                                                                               \
+     * @param size 元素数量（必须大于 0）                                                     \
+     * @return T 最大值                                                                              \
+     */                                                                                                 \
+    static inline w_SIMD_DISPATCH_ T w_max(T)(const T *data, int64_t size)                              \
+    {                                                                                                   \
+        w_check(data != NULL);                                                                          \
+        w_check(size > 0);                                                                              \
+        const int64_t lanes = w_Vector_lanes_(T);                                                       \
+        T result = data[0];                                                                             \
+        int64_t i = 1;                                                                                  \
+        if (size >= lanes)                                                                              \
+        {                                                                                               \
+            w_Vector_(T) best;                                                                          \
+            memcpy(&best, data, sizeof(best));                                                          \
+            for (i = lanes; i + lanes <= size; i += lanes)                                              \
+            {                                                                                           \
+                w_Vector_(T) v;                                                                         \
+                memcpy(&v, data + i, sizeof(v));                                                        \
+                __typeof__(v > best) mask = v > best;                                                   \
+                best = (w_Vector_(T))(((__typeof__(mask))v & mask) | ((__typeof__(mask))best & ~mask)); \
+            }                                                                                           \
+            result = best[0];                                                                           \
+            for (int64_t j = 1; j < lanes; j++)                                                         \
+            {                                                                                           \
+                result = best[j] > result ? best[j] : result;                                           \
+            }                                                                                           \
+        }                                                                                               \
+        for (; i < size; i++)                                                                           \
+        {                                                                                               \
+            result = data[i] > result ? data[i] : result;                                               \
+        }                                                                                               \
+        return result;                                                                                  \
+    }
+
+// 查找元素
+#define w_indexOf(T) w_concat(w_indexOf_, T)
+#define w_indexOf_define_(T)                                                                  \
+    /**                                                                                       \
+     * 查找第一个等于 value 的元素                                                  \
+     * @param data 数据                                                                     \
+     * @param size 元素数量                                                               \
+     * @param value 要查找的值                                                           \
+     * @return int64_t 索引，未找到返回 -1                                            \
+     */                                                                                       \
+    static inline w_SIMD_DISPATCH_ int64_t w_indexOf(T)(const T *data, int64_t size, T value) \
+    {                                                                                         \
+        w_check(data != NULL || size == 0);                                                   \
+        const int64_t lanes = w_Vector_lanes_(T);                                             \
+        int64_t i = 0;                                                                        \
+        /* 每次检查 4 个向量，命中后再逐个查找 */                                             \
+        for (; i + 4 * lanes <= size; i += 4 * lanes)                                         \
+        {                                                                                     \
+            w_Vector_(T) v0, v1, v2, v3;                                                      \
+            memcpy(&v0, data + i, sizeof(v0));                                                \
+            memcpy(&v1, data + i + lanes, sizeof(v1));                                        \
+            memcpy(&v2, data + i + 2 * lanes, sizeof(v2));                                    \
+            memcpy(&v3, data + i + 3 * lanes, sizeof(v3));                                    \
+            if (w_maskAny_((v0 == value) | (v1 == value) | (v2 == value) | (v3 == value)))    \
+            {                                                                                 \
+                break;                                                                        \
+            }                                                                                 \
+        }                                                                                     \
+        for (; i < size; i++)                                                                 \
+        {                                                                                     \
+            if (data[i] == value)                                                             \
+            {                                                                                 \
+                return i;                                                                     \
+            }                                                                                 \
+        }                                                                                     \
+        return -1;                                                                            \
+    }
+
+// 最小值索引
+#define w_argmin(T) w_concat(w_argmin_, T)
+#define w_argmin_define_(T)                                        \
+    /**                                                            \
+     * 第一个最小值的索引                                 \
+     * @param data 数据                                          \
+     * @param size 元素数量（必须大于 0）                \
+     * @return int64_t 索引                                      \
+     */                                                            \
+    static inline int64_t w_argmin(T)(const T *data, int64_t size) \
+    {                                                              \
+        return w_indexOf(T)(data, size, w_min(T)(data, size));     \
+    }
+
+// 最大值索引
+#define w_argmax(T) w_concat(w_argmax_, T)
+#define w_argmax_define_(T)                                        \
+    /**                                                            \
+     * 第一个最大值的索引                                 \
+     * @param data 数据                                          \
+     * @param size 元素数量（必须大于 0）                \
+     * @return int64_t 索引                                      \
+     */                                                            \
+    static inline int64_t w_argmax(T)(const T *data, int64_t size) \
+    {                                                              \
+        return w_indexOf(T)(data, size, w_max(T)(data, size));     \
+    }
+
+// 计数
+#define w_count(T) w_concat(w_count_, T)
+#define w_count_define_(T)                                                                  \
+    /**                                                                                     \
+     * 统计等于 value 的元素数量                                                   \
+     * @param data 数据                                                                   \
+     * @param size 元素数量                                                             \
+     * @param value 要统计的值                                                         \
+     * @return int64_t 数量                                                               \
+     */                                                                                     \
+    static inline w_SIMD_DISPATCH_ int64_t w_count(T)(const T *data, int64_t size, T value) \
+    {                                                                                       \
+        w_check(data != NULL || size == 0);                                                 \
+        const int64_t lanes = w_Vector_lanes_(T);                                           \
+        int64_t count = 0;                                                                  \
+        int64_t i = 0;                                                                      \
+        while (i + lanes <= size)                                                           \
+        {                                                                                   \
+            /* 比较结果为 -1，按块累加，避免窄整数计数溢出 */                               \
+            w_Vector_(T) v;                                                                 \
+            __typeof__(v == value) counter;                                                 \
+            memset(&counter, 0, sizeof(counter));                                           \
+            for (int64_t block = 0; block < 127 && i + lanes <= size; block++, i += lanes)  \
+            {                                                                               \
+                memcpy(&v, data + i, sizeof(v));                                            \
+                counter -= v == value;                                                      \
+            }                                                                               \
+            for (int64_t j = 0; j < lanes; j++)                                             \
+            {                                                                               \
+                count += counter[j];                                                        \
+            }                                                                               \
+        }                                                                                   \
+        for (; i < size; i++)                                                               \
+        {                                                                                   \
+            count += data[i] == value;                                                      \
+        }                                                                                   \
+        return count;                                                                       \
+    }
+
+// 填充
+#define w_fill(T) w_concat(w_fill_, T)
+#define w_fill_define_(T)                                                          \
+    /**                                                                            \
+     * 填充                                                                      \
+     * @param data 数据                                                          \
+     * @param size 元素数量                                                    \
+     * @param value 要填充的值                                                \
+     * @return void                                                                \
+     */                                                                            \
+    static inline w_SIMD_DISPATCH_ void w_fill(T)(T * data, int64_t size, T value) \
+    {                                                                              \
+        w_check(data != NULL || size == 0);                                        \
+        const int64_t lanes = w_Vector_lanes_(T);                                  \
+        w_Vector_(T) v = (w_Vector_(T)){0} + value;                                \
+        int64_t i = 0;                                                             \
+        for (; i + lanes <= size; i += lanes)                                      \
+        {                                                                          \
+            memcpy(data + i, &v, sizeof(v));                                       \
+        }                                                                          \
+        for (; i < size; i++)                                                      \
+        {                                                                          \
+            data[i] = value;                                                       \
+        }                                                                          \
+    }
+
+// 逐元素加法
+#define w_add(T) w_concat(w_add_, T)
+#define w_add_define_(T)                                                                        \
+    /**                                                                                         \
+     * 逐元素加法 dst[i] = a[i] + b[i]                                                     \
+     * @param dst 结果（可以与 a 或 b 相同）                                          \
+     * @param a 数据 a                                                                        \
+     * @param b 数据 b                                                                        \
+     * @param size 元素数量                                                                 \
+     * @return void                                                                             \
+     */                                                                                         \
+    static inline w_SIMD_DISPATCH_ void w_add(T)(T * dst, const T *a, const T *b, int64_t size) \
+    {                                                                                           \
+        w_check((dst != NULL && a != NULL && b != NULL) || size == 0);                          \
+        const int64_t lanes = w_Vector_lanes_(T);                                               \
+        int64_t i = 0;                                                                          \
+        for (; i + lanes <= size; i += lanes)                                                   \
+        {                                                                                       \
+            w_Vector_(T) va, vb;                                                                \
+            memcpy(&va, a + i, sizeof(va));                                                     \
+            memcpy(&vb, b + i, sizeof(vb));                                                     \
+            va += vb;                                                                           \
+            memcpy(dst + i, &va, sizeof(va));                                                   \
+        }                                                                                       \
+        for (; i < size; i++)                                                                   \
+        {                                                                                       \
+            dst[i] = a[i] + b[i];                                                               \
+        }                                                                                       \
+    }
+
+// 逐元素乘法
+#define w_mul(T) w_concat(w_mul_, T)
+#define w_mul_define_(T)                                                                        \
+    /**                                                                                         \
+     * 逐元素乘法 dst[i] = a[i] * b[i]                                                     \
+     * @param dst 结果（可以与 a 或 b 相同）                                          \
+     * @param a 数据 a                                                                        \
+     * @param b 数据 b                                                                        \
+     * @param size 元素数量                                                                 \
+     * @return void                                                                             \
+     */                                                                                         \
+    static inline w_SIMD_DISPATCH_ void w_mul(T)(T * dst, const T *a, const T *b, int64_t size) \
+    {                                                                                           \
+        w_check((dst != NULL && a != NULL && b != NULL) || size == 0);                          \
+        const int64_t lanes = w_Vector_lanes_(T);                                               \
+        int64_t i = 0;                                                                          \
+        for (; i + lanes <= size; i += lanes)                                                   \
+        {                                                                                       \
+            w_Vector_(T) va, vb;                                                                \
+            memcpy(&va, a + i, sizeof(va));                                                     \
+            memcpy(&vb, b + i, sizeof(vb));                                                     \
+            va *= vb;                                                                           \
+            memcpy(dst + i, &va, sizeof(va));                                                   \
+        }                                                                                       \
+        for (; i < size; i++)                                                                   \
+        {                                                                                       \
+            dst[i] = a[i] * b[i];                                                               \
+        }                                                                                       \
+    }
+
+// 数乘
+#define w_scale(T) w_concat(w_scale_, T)
+#define w_scale_define_(T)                                                                      \
+    /**                                                                                         \
+     * 数乘 dst[i] = a[i] * factor                                                            \
+     * @param dst 结果（可以与 a 相同）                                                \
+     * @param a 数据                                                                          \
+     * @param factor 系数                                                                     \
+     * @param size 元素数量                                                                 \
+     * @return void                                                                             \
+     */                                                                                         \
+    static inline w_SIMD_DISPATCH_ void w_scale(T)(T * dst, const T *a, T factor, int64_t size) \
+    {                                                                                           \
+        w_check((dst != NULL && a != NULL) || size == 0);                                       \
+        const int64_t lanes = w_Vector_lanes_(T);                                               \
+        int64_t i = 0;                                                                          \
+        for (; i + lanes <= size; i += lanes)                                                   \
+        {                                                                                       \
+            w_Vector_(T) va;                                                                    \
+            memcpy(&va, a + i, sizeof(va));                                                     \
+            va *= factor;                                                                       \
+            memcpy(dst + i, &va, sizeof(va));                                                   \
+        }                                                                                       \
+        for (; i < size; i++)                                                                   \
+        {                                                                                       \
+            dst[i] = a[i] * factor;                                                             \
+        }                                                                                       \
+    }
+
+// 数值计算定义
+#define w_number_kernel_define_(T, S)   \
+    w_number_vector_type_define_(T, S); \
+    w_sum_define_(T);                   \
+    w_min_define_(T);                   \
+    w_max_define_(T);                   \
+    w_indexOf_define_(T);               \
+    w_argmin_define_(T);                \
+    w_argmax_define_(T);                \
+    w_count_define_(T);                 \
+    w_fill_define_(T);                  \
+    w_add_define_(T);                   \
+    w_mul_define_(T);                   \
+    w_scale_define_(T);
+
+// 为所有数字类型（bool 除外）定义数值计算
+w_number_kernel_define_(int8_t, int64_t);
+w_number_kernel_define_(int16_t, int64_t);
+w_number_kernel_define_(int32_t, int64_t);
+w_number_kernel_define_(int64_t, int64_t);
+w_number_kernel_define_(uint8_t, uint64_t);
+w_number_kernel_define_(uint16_t, uint64_t);
+w_number_kernel_define_(uint32_t, uint64_t);
+w_number_kernel_define_(uint64_t, uint64_t);
+w_number_kernel_define_(char, int64_t);
+w_number_kernel_define_(short, int64_t);
+w_number_kernel_define_(int, int64_t);
+w_number_kernel_define_(long, int64_t);
+w_number_kernel_define_(float, double);
+w_number_kernel_define_(double, double);
+
+// 数组求和
+#define w_Array_sum(T) w_concat(w_Array(T), _sum)
+#define w_Array_sum_define_(T)                                                    \
+    /**                                                                           \
+     * 数组求和（整数累加到 64 位整数，浮点数累加到 double） \
+     * @param this 数组                                                         \
+     * @return w_SumType_(T) 和                                                  \
+     */                                                                           \
+    static inline w_SumType_(T) w_Array_sum(T)(w_Array(T) * this)                 \
+    {                                                                             \
+        w_check(this != NULL);                                                    \
+        w_check(this->elementData != NULL);                                       \
+        return w_sum(T)(this->elementData, this->size);                           \
+    }
+
+// 数组最小值
+#define w_Array_min(T) w_concat(w_Array(T), _min)
+#define w_Array_min_define_(T)                          \
+    /**                                                 \
+     * 数组最小值（不能为空）                \
+     * @param this 数组                               \
+     * @return T 最小值                              \
+     */                                                 \
+    static inline T w_Array_min(T)(w_Array(T) * this)   \
+    {                                                   \
+        w_check(this != NULL);                          \
+        w_check(this->elementData != NULL);             \
+        return w_min(T)(this->elementData, this->size); \
+    }
+
+// 数组最大值
+#define w_Array_max(T) w_concat(w_Array(T), _max)
+#define w_Array_max_define_(T)                          \
+    /**                                                 \
+     * 数组最大值（不能为空）                \
+     * @param this 数组                               \
+     * @return T 最大值                              \
+     */                                                 \
+    static inline T w_Array_max(T)(w_Array(T) * this)   \
+    {                                                   \
+        w_check(this != NULL);                          \
+        w_check(this->elementData != NULL);             \
+        return w_max(T)(this->elementData, this->size); \
+    }
+
+// 数组最小值索引
+#define w_Array_argmin(T) w_concat(w_Array(T), _argmin)
+#define w_Array_argmin_define_(T)                              \
+    /**                                                        \
+     * 数组第一个最小值的索引（不能为空）     \
+     * @param this 数组                                      \
+     * @return int64_t 索引                                  \
+     */                                                        \
+    static inline int64_t w_Array_argmin(T)(w_Array(T) * this) \
+    {                                                          \
+        w_check(this != NULL);                                 \
+        w_check(this->elementData != NULL);                    \
+        return w_argmin(T)(this->elementData, this->size);     \
+    }
+
+// 数组最大值索引
+#define w_Array_argmax(T) w_concat(w_Array(T), _argmax)
+#define w_Array_argmax_define_(T)                              \
+    /**                                                        \
+     * 数组第一个最大值的索引（不能为空）     \
+     * @param this 数组                                      \
+     * @return int64_t 索引                                  \
+     */                                                        \
+    static inline int64_t w_Array_argmax(T)(w_Array(T) * this) \
+    {                                                          \
+        w_check(this != NULL);                                 \
+        w_check(this->elementData != NULL);                    \
+        return w_argmax(T)(this->elementData, this->size);     \
+    }
+
+// 数组查找元素
+#define w_Array_indexOf(T) w_concat(w_Array(T), _indexOf)
+#define w_Array_indexOf_define_(T)                                       \
+    /**                                                                  \
+     * 数组查找第一个等于 value 的元素                       \
+     * @param this 数组                                                \
+     * @param value 要查找的值                                      \
+     * @return int64_t 索引，未找到返回 -1                       \
+     */                                                                  \
+    static inline int64_t w_Array_indexOf(T)(w_Array(T) * this, T value) \
+    {                                                                    \
+        w_check(this != NULL);                                           \
+        w_check(this->elementData != NULL);                              \
+        return w_indexOf(T)(this->elementData, this->size, value);       \
+    }
+
+// 数组计数
+#define w_Array_count(T) w_concat(w_Array(T), _count)
+#define w_Array_count_define_(T)                                       \
+    /**                                                                \
+     * 数组统计等于 value 的元素数量                        \
+     * @param this 数组                                              \
+     * @param value 要统计的值                                    \
+     * @return int64_t 数量                                          \
+     */                                                                \
+    static inline int64_t w_Array_count(T)(w_Array(T) * this, T value) \
+    {                                                                  \
+        w_check(this != NULL);                                         \
+        w_check(this->elementData != NULL);                            \
+        return w_count(T)(this->elementData, this->size, value);       \
+    }
+
+// 数组填充
+#define w_Array_fill(T) w_concat(w_Array(T), _fill)
+#define w_Array_fill_define_(T)                                    \
+    /**                                                            \
+     * 数组填充所有元素                                    \
+     * @param this 数组                                          \
+     * @param value 要填充的值                                \
+     * @return void                                                \
+     */                                                            \
+    static inline void w_Array_fill(T)(w_Array(T) * this, T value) \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL);                        \
+        w_fill(T)(this->elementData, this->size, value);           \
+    }
+
+// 数组逐元素加法
+#define w_Array_elementwiseAdd(T) w_concat(w_Array(T), _elementwiseAdd)
+#define w_Array_elementwiseAdd_define_(T)                                                           \
+    /**                                                                                             \
+     * 数组逐元素加法 this[i] = a[i] + b[i]（大小必须相同）                          \
+     * @param this 数组                                                                           \
+     * @param a 数组 a                                                                            \
+     * @param b 数组 b                                                                            \
+     * @return void                                                                                 \
+     */                                                                                             \
+    static inline void w_Array_elementwiseAdd(T)(w_Array(T) * this, w_Array(T) * a, w_Array(T) * b) \
+    {                                                                                               \
+        w_check(this != NULL);                                                                      \
+        w_check(this->elementData != NULL);                                                         \
+        w_check(a != NULL && b != NULL);                                                            \
+        w_check(a->size == this->size && b->size == this->size);                                    \
+        w_add(T)(this->elementData, a->elementData, b->elementData, this->size);                    \
+    }
+
+// 数组逐元素乘法
+#define w_Array_elementwiseMul(T) w_concat(w_Array(T), _elementwiseMul)
+#define w_Array_elementwiseMul_define_(T)                                                           \
+    /**                                                                                             \
+     * 数组逐元素乘法 this[i] = a[i] * b[i]（大小必须相同）                          \
+     * @param this 数组                                                                           \
+     * @param a 数组 a                                                                            \
+     * @param b 数组 b                                                                            \
+     * @return void                                                                                 \
+     */                                                                                             \
+    static inline void w_Array_elementwiseMul(T)(w_Array(T) * this, w_Array(T) * a, w_Array(T) * b) \
+    {                                                                                               \
+        w_check(this != NULL);                                                                      \
+        w_check(this->elementData != NULL);                                                         \
+        w_check(a != NULL && b != NULL);                                                            \
+        w_check(a->size == this->size && b->size == this->size);                                    \
+        w_mul(T)(this->elementData, a->elementData, b->elementData, this->size);                    \
+    }
+
+// 数组数乘
+#define w_Array_scale(T) w_concat(w_Array(T), _scale)
+#define w_Array_scale_define_(T)                                              \
+    /**                                                                       \
+     * 数组数乘 this[i] = this[i] * factor                                \
+     * @param this 数组                                                     \
+     * @param factor 系数                                                   \
+     * @return void                                                           \
+     */                                                                       \
+    static inline void w_Array_scale(T)(w_Array(T) * this, T factor)          \
+    {                                                                         \
+        w_check(this != NULL);                                                \
+        w_check(this->elementData != NULL);                                   \
+        w_scale(T)(this->elementData, this->elementData, factor, this->size); \
+    }
+
+// 数组数值计算定义
+// 需要先定义 w_Array_define(T)，T 必须是数字类型（bool 除外）
+#define w_Array_number_define(T)       \
+    w_Array_sum_define_(T);            \
+    w_Array_min_define_(T);            \
+    w_Array_max_define_(T);            \
+    w_Array_argmin_define_(T);         \
+    w_Array_argmax_define_(T);         \
+    w_Array_indexOf_define_(T);        \
+    w_Array_count_define_(T);          \
+    w_Array_fill_define_(T);           \
+    w_Array_elementwiseAdd_define_(T); \
+    w_Array_elementwiseMul_define_(T); \
+    w_Array_scale_define_(T);
+
+// 列表求和
+#define w_List_sum(T) w_concat(w_List(T), _sum)
+#define w_List_sum_define_(T)                                                     \
+    /**                                                                           \
+     * 列表求和（整数累加到 64 位整数，浮点数累加到 double） \
+     * @param this 列表                                                         \
+     * @return w_SumType_(T) 和                                                  \
+     */                                                                           \
+    static inline w_SumType_(T) w_List_sum(T)(w_List(T) * this)                   \
+    {                                                                             \
+        w_check(this != NULL);                                                    \
+        w_check(this->elementData != NULL || this->capacity == 0);                \
+        return w_sum(T)(this->elementData, this->size);                           \
+    }
+
+// 列表最小值
+#define w_List_min(T) w_concat(w_List(T), _min)
+#define w_List_min_define_(T)                                      \
+    /**                                                            \
+     * 列表最小值（不能为空）                           \
+     * @param this 列表                                          \
+     * @return T 最小值                                         \
+     */                                                            \
+    static inline T w_List_min(T)(w_List(T) * this)                \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        return w_min(T)(this->elementData, this->size);            \
+    }
+
+// 列表最大值
+#define w_List_max(T) w_concat(w_List(T), _max)
+#define w_List_max_define_(T)                                      \
+    /**                                                            \
+     * 列表最大值（不能为空）                           \
+     * @param this 列表                                          \
+     * @return T 最大值                                         \
+     */                                                            \
+    static inline T w_List_max(T)(w_List(T) * this)                \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        return w_max(T)(this->elementData, this->size);            \
+    }
+
+// 列表最小值索引
+#define w_List_argmin(T) w_concat(w_List(T), _argmin)
+#define w_List_argmin_define_(T)                                   \
+    /**                                                            \
+     * 列表第一个最小值的索引（不能为空）         \
+     * @param this 列表                                          \
+     * @return int64_t 索引                                      \
+     */                                                            \
+    static inline int64_t w_List_argmin(T)(w_List(T) * this)       \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        return w_argmin(T)(this->elementData, this->size);         \
+    }
+
+// 列表最大值索引
+#define w_List_argmax(T) w_concat(w_List(T), _argmax)
+#define w_List_argmax_define_(T)                                   \
+    /**                                                            \
+     * 列表第一个最大值的索引（不能为空）         \
+     * @param this 列表                                          \
+     * @return int64_t 索引                                      \
+     */                                                            \
+    static inline int64_t w_List_argmax(T)(w_List(T) * this)       \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        return w_argmax(T)(this->elementData, this->size);         \
+    }
+
+// 列表查找元素
+#define w_List_indexOf(T) w_concat(w_List(T), _indexOf)
+#define w_List_indexOf_define_(T)                                      \
+    /**                                                                \
+     * 列表查找第一个等于 value 的元素                     \
+     * @param this 列表                                              \
+     * @param value 要查找的值                                    \
+     * @return int64_t 索引，未找到返回 -1                     \
+     */                                                                \
+    static inline int64_t w_List_indexOf(T)(w_List(T) * this, T value) \
+    {                                                                  \
+        w_check(this != NULL);                                         \
+        w_check(this->elementData != NULL || this->capacity == 0);     \
+        return w_indexOf(T)(this->elementData, this->size, value);     \
+    }
+
+// 列表计数
+#define w_List_count(T) w_concat(w_List(T), _count)
+#define w_List_count_define_(T)                                      \
+    /**                                                              \
+     * 列表统计等于 value 的元素数量                      \
+     * @param this 列表                                            \
+     * @param value 要统计的值                                  \
+     * @return int64_t 数量                                        \
+     */                                                              \
+    static inline int64_t w_List_count(T)(w_List(T) * this, T value) \
+    {                                                                \
+        w_check(this != NULL);                                       \
+        w_check(this->elementData != NULL || this->capacity == 0);   \
+        return w_count(T)(this->elementData, this->size, value);     \
+    }
+
+// 列表填充
+#define w_List_fill(T) w_concat(w_List(T), _fill)
+#define w_List_fill_define_(T)                                     \
+    /**                                                            \
+     * 列表填充所有元素                                    \
+     * @param this 列表                                          \
+     * @param value 要填充的值                                \
+     * @return void                                                \
+     */                                                            \
+    static inline void w_List_fill(T)(w_List(T) * this, T value)   \
+    {                                                              \
+        w_check(this != NULL);                                     \
+        w_check(this->elementData != NULL || this->capacity == 0); \
+        w_fill(T)(this->elementData, this->size, value);           \
+    }
+
+// 列表逐元素加法
+#define w_List_elementwiseAdd(T) w_concat(w_List(T), _elementwiseAdd)
+#define w_List_elementwiseAdd_define_(T)                                                        \
+    /**                                                                                         \
+     * 列表逐元素加法 this[i] = a[i] + b[i]（大小必须相同）                      \
+     * @param this 列表                                                                       \
+     * @param a 列表 a                                                                        \
+     * @param b 列表 b                                                                        \
+     * @return void                                                                             \
+     */                                                                                         \
+    static inline void w_List_elementwiseAdd(T)(w_List(T) * this, w_List(T) * a, w_List(T) * b) \
+    {                                                                                           \
+        w_check(this != NULL);                                                                  \
+        w_check(this->elementData != NULL || this->capacity == 0);                              \
+        w_check(a != NULL && b != NULL);                                                        \
+        w_check(a->size == this->size && b->size == this->size);                                \
+        w_add(T)(this->elementData, a->elementData, b->elementData, this->size);                \
+    }
+
+// 列表逐元素乘法
+#define w_List_elementwiseMul(T) w_concat(w_List(T), _elementwiseMul)
+#define w_List_elementwiseMul_define_(T)                                                        \
+    /**                                                                                         \
+     * 列表逐元素乘法 this[i] = a[i] * b[i]（大小必须相同）                      \
+     * @param this 列表                                                                       \
+     * @param a 列表 a                                                                        \
+     * @param b 列表 b                                                                        \
+     * @return void                                                                             \
+     */                                                                                         \
+    static inline void w_List_elementwiseMul(T)(w_List(T) * this, w_List(T) * a, w_List(T) * b) \
+    {                                                                                           \
+        w_check(this != NULL);                                                                  \
+        w_check(this->elementData != NULL || this->capacity == 0);                              \
+        w_check(a != NULL && b != NULL);                                                        \
+        w_check(a->size == this->size && b->size == this->size);                                \
+        w_mul(T)(this->elementData, a->elementData, b->elementData, this->size);                \
+    }
+
+// 列表数乘
+#define w_List_scale(T) w_concat(w_List(T), _scale)
+#define w_List_scale_define_(T)                                               \
+    /**                                                                       \
+     * 列表数乘 this[i] = this[i] * factor                                \
+     * @param this 列表                                                     \
+     * @param factor 系数                                                   \
+     * @return void                                                           \
+     */                                                                       \
+    static inline void w_List_scale(T)(w_List(T) * this, T factor)            \
+    {                                                                         \
+        w_check(this != NULL);                                                \
+        w_check(this->elementData != NULL || this->capacity == 0);            \
+        w_scale(T)(this->elementData, this->elementData, factor, this->size); \
+    }
+
+// 列表数值计算定义
+// 需要先定义 w_List_define(T)，T 必须是数字类型（bool 除外）
+#define w_List_number_define(T)       \
+    w_List_sum_define_(T);            \
+    w_List_min_define_(T);            \
+    w_List_max_define_(T);            \
+    w_List_argmin_define_(T);         \
+    w_List_argmax_define_(T);         \
+    w_List_indexOf_define_(T);        \
+    w_List_count_define_(T);          \
+    w_List_fill_define_(T);           \
+    w_List_elementwiseAdd_define_(T); \
+    w_List_elementwiseMul_define_(T); \
+    w_List_scale_define_(T);
+
+// 只读视图求和
+#define w_ConstSpan_sum(T) w_concat(w_ConstSpan(T), _sum)
+#define w_ConstSpan_sum_define_(T)                                                      \
+    /**                                                                                 \
+     * 只读视图求和（整数累加到 64 位整数，浮点数累加到 double） \
+     * @param span 只读视图                                                         \
+     * @return w_SumType_(T) 和                                                        \
+     */                                                                                 \
+    static inline w_SumType_(T) w_ConstSpan_sum(T)(w_ConstSpan(T) span)                 \
+    {                                                                                   \
+        return w_sum(T)(span.data, span.size);                                          \
+    }
+
+// 只读视图最小值
+#define w_ConstSpan_min(T) w_concat(w_ConstSpan(T), _min)
+#define w_ConstSpan_min_define_(T)                          \
+    /**                                                     \
+     * 只读视图最小值（不能为空）              \
+     * @param span 只读视图                             \
+     * @return T 最小值                                  \
+     */                                                     \
+    static inline T w_ConstSpan_min(T)(w_ConstSpan(T) span) \
+    {                                                       \
+        return w_min(T)(span.data, span.size);              \
+    }
+
+// 只读视图最大值
+#define w_ConstSpan_max(T) w_concat(w_ConstSpan(T), _max)
+#define w_ConstSpan_max_define_(T)                          \
+    /**                                                     \
+     * 只读视图最大值（不能为空）              \
+     * @param span 只读视图                             \
+     * @return T 最大值                                  \
+     */                                                     \
+    static inline T w_ConstSpan_max(T)(w_ConstSpan(T) span) \
+    {                                                       \
+        return w_max(T)(span.data, span.size);              \
+    }
+
+// 只读视图最小值索引
+#define w_ConstSpan_argmin(T) w_concat(w_ConstSpan(T), _argmin)
+#define w_ConstSpan_argmin_define_(T)                                \
+    /**                                                              \
+     * 只读视图第一个最小值的索引（不能为空）     \
+     * @param span 只读视图                                      \
+     * @return int64_t 索引                                        \
+     */                                                              \
+    static inline int64_t w_ConstSpan_argmin(T)(w_ConstSpan(T) span) \
+    {                                                                \
+        return w_argmin(T)(span.data, span.size);                    \
+    }
+
+// 只读视图最大值索引
+#define w_ConstSpan_argmax(T) w_concat(w_ConstSpan(T), _argmax)
+#define w_ConstSpan_argmax_define_(T)                                \
+    /**                                                              \
+     * 只读视图第一个最大值的索引（不能为空）     \
+     * @param span 只读视图                                      \
+     * @return int64_t 索引                                        \
+     */                                                              \
+    static inline int64_t w_ConstSpan_argmax(T)(w_ConstSpan(T) span) \
+    {                                                                \
+        return w_argmax(T)(span.data, span.size);                    \
+    }
+
+// 只读视图查找元素
+#define w_ConstSpan_indexOf(T) w_concat(w_ConstSpan(T), _indexOf)
+#define w_ConstSpan_indexOf_define_(T)                                               \
+    /**                                                                              \
+     * 只读视图查找元素                                                      \
+     * @param span 只读视图                                                      \
+     * @param value 元素                                                           \
+     * @return int64_t 第一个等于 value 的元素的索引，未找到返回 -1 \
+     */                                                                              \
+    static inline int64_t w_ConstSpan_indexOf(T)(w_ConstSpan(T) span, T value)       \
+    {                                                                                \
+        return w_indexOf(T)(span.data, span.size, value);                            \
+    }
+
+// 只读视图统计元素
+#define w_ConstSpan_count(T) w_concat(w_ConstSpan(T), _count)
+#define w_ConstSpan_count_define_(T)                                         \
+    /**                                                                      \
+     * 只读视图统计等于 value 的元素数量                        \
+     * @param span 只读视图                                              \
+     * @param value 元素                                                   \
+     * @return int64_t 数量                                                \
+     */                                                                      \
+    static inline int64_t w_ConstSpan_count(T)(w_ConstSpan(T) span, T value) \
+    {                                                                        \
+        return w_count(T)(span.data, span.size, value);                      \
+    }
+
+// 视图填充
+#define w_Span_fill(T) w_concat(w_Span(T), _fill)
+#define w_Span_fill_define_(T)                                 \
+    /**                                                        \
+     * 视图填充                                            \
+     * @param span 视图                                      \
+     * @param value 元素                                     \
+     * @return void                                            \
+     */                                                        \
+    static inline void w_Span_fill(T)(w_Span(T) span, T value) \
+    {                                                          \
+        w_fill(T)(span.data, span.size, value);                \
+    }
+
+// 视图逐元素加法
+#define w_Span_add(T) w_concat(w_Span(T), _add)
+#define w_Span_add_define_(T)                                                           \
+    /**                                                                                 \
+     * 视图逐元素加法 dst[i] = a[i] + b[i]（大小必须相同）               \
+     * @param dst 结果视图                                                          \
+     * @param a 只读视图 a                                                          \
+     * @param b 只读视图 b                                                          \
+     * @return void                                                                     \
+     */                                                                                 \
+    static inline void w_Span_add(T)(w_Span(T) dst, w_ConstSpan(T) a, w_ConstSpan(T) b) \
+    {                                                                                   \
+        w_check(a.size == dst.size && b.size == dst.size);                              \
+        w_add(T)(dst.data, a.data, b.data, dst.size);                                   \
+    }
+
+// 视图逐元素乘法
+#define w_Span_mul(T) w_concat(w_Span(T), _mul)
+#define w_Span_mul_define_(T)                                                           \
+    /**                                                                                 \
+     * 视图逐元素乘法 dst[i] = a[i] * b[i]（大小必须相同）               \
+     * @param dst 结果视图                                                          \
+     * @param a 只读视图 a                                                          \
+     * @param b 只读视图 b                                                          \
+     * @return void                                                                     \
+     */                                                                                 \
+    static inline void w_Span_mul(T)(w_Span(T) dst, w_ConstSpan(T) a, w_ConstSpan(T) b) \
+    {                                                                                   \
+        w_check(a.size == dst.size && b.size == dst.size);                              \
+        w_mul(T)(dst.data, a.data, b.data, dst.size);                                   \
+    }
+
+// 视图数乘
+#define w_Span_scale(T) w_concat(w_Span(T), _scale)
+#define w_Span_scale_define_(T)                                                   \
+    /**                                                                           \
+     * 视图数乘 dst[i] = a[i] * factor（大小必须相同）                \
+     * @param dst 结果视图                                                    \
+     * @param a 只读视图                                                      \
+     * @param factor 系数                                                       \
+     * @return void                                                               \
+     */                                                                           \
+    static inline void w_Span_scale(T)(w_Span(T) dst, w_ConstSpan(T) a, T factor) \
+    {                                                                             \
+        w_check(a.size == dst.size);                                              \
+        w_scale(T)(dst.data, a.data, factor, dst.size);                           \
+    }
+
+// 视图数值计算定义（需要先定义 w_Span_define）
+#define w_Span_number_define(T)     \
+    w_ConstSpan_sum_define_(T);     \
+    w_ConstSpan_min_define_(T);     \
+    w_ConstSpan_max_define_(T);     \
+    w_ConstSpan_argmin_define_(T);  \
+    w_ConstSpan_argmax_define_(T);  \
+    w_ConstSpan_indexOf_define_(T); \
+    w_ConstSpan_count_define_(T);   \
+    w_Span_fill_define_(T);         \
+    w_Span_add_define_(T);          \
+    w_Span_mul_define_(T);          \
+    w_Span_scale_define_(T);
+
+// ========================================================================================================================================================
+//  多维数组运算
+// ========================================================================================================================================================
+
+// 一元运算
+#define w_NDOP_NEG 1 // -a
+#define w_NDOP_ABS 2 // |a|
+#define w_NDOP_EXP 3 // e^a（通过 w_NDExpr_exp / w_NDArrayView_exp 使用，只有它们依赖数学库）
+
+// 二元运算（比较运算的结果为 T 类型的 1 / 0 掩码）
+#define w_NDOP_ADD 10 // a + b
+#define w_NDOP_SUB 11 // a - b
+#define w_NDOP_MUL 12 // a * b
+#define w_NDOP_DIV 13 // a / b
+#define w_NDOP_MIN 14 // min(a, b)
+#define w_NDOP_MAX 15 // max(a, b)
+#define w_NDOP_LT 16  // a < b
+#define w_NDOP_LE 17  // a <= b
+#define w_NDOP_GT 18  // a > b
+#define w_NDOP_GE 19  // a >= b
+#define w_NDOP_EQ 20  // a == b
+#define w_NDOP_NE 21  // a != b
+
+// 三元运算
+#define w_NDOP_FMA 30   // a * b + c
+#define w_NDOP_WHERE 31 // a != 0 ? b : c
+
+// 表达式内部指令
+#define w_NDOP_LOAD_ (-1)
+#define w_NDOP_CONSTANT_ (-2)
+
+// 运算的操作数个数
+#define w_NDOP_arity_(op) ((op) < w_NDOP_ADD ? 1 : (op) < w_NDOP_FMA ? 2 : 3)
+
+// 表达式最大指令数
+#define w_NDEXPR_MAX_CODE_ 32
+
+// 表达式最大操作数（视图）数量
+#define w_NDEXPR_MAX_OPERANDS_ 8
+
+// 表达式最大栈深度
+#define w_NDEXPR_MAX_STACK_ 8
+
+// 表达式每次计算的元素数量（栈上的中间结果保持在 L1 缓存中）
+#define w_NDEXPR_CHUNK_ 256
+
+/**
+ * 按掩码选择向量元素
+ * @param mask 比较结果（-1 / 0）
+ * @param a mask 为 -1 时选择的向量
+ * @param b mask 为 0 时选择的向量
+ * @return 向量
+ */
+#define w_vectorSelect_(mask, a, b) \
+    ((__typeof__(a))(((__typeof__(mask))(a) & (mask)) | ((__typeof__(mask))(b) & ~(mask))))
+
+/**
+ * 向量化逐元素循环，表达式中使用 x、y、z 表示三个输入向量
+ * 尾部不足一个向量时输入补 1，避免整数除以 0
+ * @param T 元素类型
+ * @param dst 结果
+ * @param a 输入 x
+ * @param b 输入 y
+ * @param c 输入 z
+ * @param size 元素数量
+ * @param expr 向量表达式
+ */
+#define w_NDExpr_loop_(T, dst, a, b, c, size, expr)                  \
+    do                                                               \
+    {                                                                \
+        const int64_t lanes_ = w_Vector_lanes_(T);                   \
+        w_Vector_(T) x, y, z, result_;                               \
+        int64_t i_ = 0;                                              \
+        for (; i_ + lanes_ <= (size); i_ += lanes_)                  \
+        {                                                            \
+            memcpy(&x, (a) + i_, sizeof(x));                         \
+            memcpy(&y, (b) + i_, sizeof(y));                         \
+            memcpy(&z, (c) + i_, sizeof(z));                         \
+            result_ = (expr);                                        \
+            memcpy((dst) + i_, &result_, sizeof(result_));           \
+        }                                                            \
+        if (i_ < (size))                                             \
+        {                                                            \
+            x = y = z = (w_Vector_(T)){0} + 1;                       \
+            memcpy(&x, (a) + i_, sizeof(T) * ((size) - i_));         \
+            memcpy(&y, (b) + i_, sizeof(T) * ((size) - i_));         \
+            memcpy(&z, (c) + i_, sizeof(T) * ((size) - i_));         \
+            result_ = (expr);                                        \
+            memcpy((dst) + i_, &result_, sizeof(T) * ((size) - i_)); \
+        }                                                            \
+    } while (0)
+
+// 多维数组表达式类型（逆波兰指令序列，不持有内存）
+#define w_NDExpr(T) w_concat(w_NDExpr_, T)
+
+// 多维数组表达式类型定义
+#define w_NDExpr_type_define_(T)                                                          \
+    typedef struct                                                                        \
+    {                                                                                     \
+        int32_t code[w_NDEXPR_MAX_CODE_];                     /* 指令 */                  \
+        int32_t operandIndex[w_NDEXPR_MAX_CODE_];             /* LOAD 指令的操作数编号 */ \
+        T constants[w_NDEXPR_MAX_CODE_];                      /* CONSTANT 指令的常量 */   \
+        w_NDArrayView(T) operands[w_NDEXPR_MAX_OPERANDS_];    /* 操作数 */                \
+        int64_t codeSize;                                                                 \
+        int64_t operandSize;                                                              \
+        int64_t depth;                                        /* 当前栈深度 */            \
+    } w_NDExpr(T);
+
+// 多维数组表达式初始化
+#define w_NDExpr_init(T) w_concat(w_NDExpr(T), _init)
+#define w_NDExpr_init_define_(T)                            \
+    /**                                                     \
+     * 多维数组表达式初始化                       \
+     * @param this 表达式                                \
+     * @return void                                         \
+     */                                                     \
+    static inline void w_NDExpr_init(T)(w_NDExpr(T) * this) \
+    {                                                       \
+        w_check(this != NULL);                              \
+        this->codeSize = 0;                                 \
+        this->operandSize = 0;                              \
+        this->depth = 0;                                    \
+    }
+
+// 多维数组表达式压入操作数
+#define w_NDExpr_load(T) w_concat(w_NDExpr(T), _load)
+#define w_NDExpr_load_define_(T)                                                   \
+    /**                                                                            \
+     * 多维数组表达式压入操作数                                        \
+     * @param this 表达式                                                       \
+     * @param view 操作数视图（计算时广播到结果的形状）          \
+     * @return void                                                                \
+     */                                                                            \
+    static inline void w_NDExpr_load(T)(w_NDExpr(T) * this, w_NDArrayView(T) view) \
+    {                                                                              \
+        w_check(this != NULL);                                                     \
+        w_check(this->codeSize < w_NDEXPR_MAX_CODE_);                              \
+        w_check(this->operandSize < w_NDEXPR_MAX_OPERANDS_);                       \
+        w_check(this->depth < w_NDEXPR_MAX_STACK_);                                \
+        this->code[this->codeSize] = w_NDOP_LOAD_;                                 \
+        this->operandIndex[this->codeSize] = (int32_t)this->operandSize;           \
+        this->codeSize++;                                                          \
+        this->operands[this->operandSize++] = view;                                \
+        this->depth++;                                                             \
+    }
+
+// 多维数组表达式压入常量
+#define w_NDExpr_constant(T) w_concat(w_NDExpr(T), _constant)
+#define w_NDExpr_constant_define_(T)                                     \
+    /**                                                                  \
+     * 多维数组表达式压入常量                                 \
+     * @param this 表达式                                             \
+     * @param value 常量                                               \
+     * @return void                                                      \
+     */                                                                  \
+    static inline void w_NDExpr_constant(T)(w_NDExpr(T) * this, T value) \
+    {                                                                    \
+        w_check(this != NULL);                                           \
+        w_check(this->codeSize < w_NDEXPR_MAX_CODE_);                    \
+        w_check(this->depth < w_NDEXPR_MAX_STACK_);                      \
+        this->code[this->codeSize] = w_NDOP_CONSTANT_;                   \
+        this->constants[this->codeSize] = value;                         \
+        this->codeSize++;                                                \
+        this->depth++;                                                   \
+    }
+
+// 多维数组表达式指数内核（通过函数指针调用，不使用 exp 的程序不需要链接数学库）
+#define w_NDExpr_expFunction_(T) w_concat(w_NDExpr(T), _expFunction_)
+#define w_NDExpr_expKernel_(T) w_concat(w_NDExpr(T), _expKernel_)
+#define w_NDExpr_expKernel_define_(T)                                            \
+    static void (*w_NDExpr_expFunction_(T))(T * dst, const T *a, int64_t size);  \
+    /**                                                                          \
+     * 多维数组表达式指数内核                                         \
+     * @param dst 结果（可以与输入相同）                              \
+     * @param a 输入                                                           \
+     * @param size 元素数量                                                  \
+     * @return void                                                              \
+     */                                                                          \
+    static inline void w_NDExpr_expKernel_(T)(T * dst, const T *a, int64_t size) \
+    {                                                                            \
+        for (int64_t i = 0; i < size; i++)                                       \
+        {                                                                        \
+            dst[i] = (T)exp((double)a[i]);                                       \
+        }                                                                        \
+    }
+
+// 多维数组表达式应用运算
+#define w_NDExpr_apply(T) w_concat(w_NDExpr(T), _apply)
+#define w_NDExpr_apply_define_(T)                                                                             \
+    /**                                                                                                       \
+     * 多维数组表达式应用运算（弹出 1 ~ 3 个值，压入结果）                              \
+     * @param this 表达式                                                                                  \
+     * @param op 运算（w_NDOP_XXX；w_NDOP_EXP 需要先调用一次 w_NDExpr_exp 或 w_NDArrayView_exp） \
+     * @return void                                                                                           \
+     */                                                                                                       \
+    static inline void w_NDExpr_apply(T)(w_NDExpr(T) * this, int32_t op)                                      \
+    {                                                                                                         \
+        w_check(this != NULL);                                                                                \
+        w_check(op > 0 && op <= w_NDOP_WHERE);                                                                \
+        w_check(op != w_NDOP_EXP || w_NDExpr_expFunction_(T) != NULL);                                        \
+        w_check(this->codeSize < w_NDEXPR_MAX_CODE_);                                                         \
+        w_check(this->depth >= w_NDOP_arity_(op));                                                            \
+        this->code[this->codeSize++] = op;                                                                    \
+        this->depth -= w_NDOP_arity_(op) - 1;                                                                 \
+    }
+
+// 多维数组表达式指数
+#define w_NDExpr_exp(T) w_concat(w_NDExpr(T), _exp)
+#define w_NDExpr_exp_define_(T)                                                              \
+    /**                                                                                      \
+     * 多维数组表达式指数（弹出 1 个值，压入 e^a；需要链接数学库） \
+     * @param this 表达式                                                                 \
+     * @return void                                                                          \
+     */                                                                                      \
+    static inline void w_NDExpr_exp(T)(w_NDExpr(T) * this)                                   \
+    {                                                                                        \
+        w_NDExpr_expFunction_(T) = w_NDExpr_expKernel_(T);                                   \
+        w_NDExpr_apply(T)(this, w_NDOP_EXP);                                                 \
+    }
+
+// 多维数组表达式计算内核
+#define w_NDExpr_kernel_(T) w_concat(w_NDExpr(T), _kernel_)
+#define w_NDExpr_kernel_define_(T)                                                                                                 \
+    /**                                                                                                                            \
+     * 多维数组表达式计算内核（连续内存，向量化）                                                             \
+     * @param op 运算                                                                                                            \
+     * @param dst 结果（可以与输入相同）                                                                                \
+     * @param a 输入 a                                                                                                           \
+     * @param b 输入 b（一元运算时不使用）                                                                             \
+     * @param c 输入 c（一元、二元运算时不使用）                                                                    \
+     * @param size 元素数量                                                                                                    \
+     * @return void                                                                                                                \
+     */                                                                                                                            \
+    static inline w_SIMD_DISPATCH_ void w_NDExpr_kernel_(T)(int32_t op, T * dst, const T *a, const T *b, const T *c, int64_t size) \
+    {                                                                                                                              \
+        switch (op)                                                                                                                \
+        {                                                                                                                          \
+        case w_NDOP_NEG:                                                                                                           \
+            w_NDExpr_loop_(T, dst, a, a, a, size, -x);                                                                             \
+            break;                                                                                                                 \
+        case w_NDOP_ABS:                                                                                                           \
+            w_NDExpr_loop_(T, dst, a, a, a, size, w_vectorSelect_(x < 0, -x, x));                                                  \
+            break;                                                                                                                 \
+        case w_NDOP_EXP:                                                                                                           \
+            w_assert(w_NDExpr_expFunction_(T) != NULL);                                                                            \
+            w_NDExpr_expFunction_(T)(dst, a, size);                                                                                \
+            break;                                                                                                                 \
+        case w_NDOP_ADD:                                                                                                           \
+            w_NDExpr_loop_(T, dst, a, b, b, size, x + y);                                                                          \
+            break;                                                                                                                 \
+        case w_NDOP_SUB:                                                                                                           \
+            w_NDExpr_loop_(T, dst, a, b, b, size, x - y);                                                                          \
+            break;                                                                                                                 \
+        case w_NDOP_MUL:                                                                                                           \
+            w_NDExpr_loop_(T, dst, a, b, b, size, x * y);                                                                          \
+            break;                                                                                                                 \
+        case w_NDOP_DIV:                                                                                                           \
+            w_NDExpr_loop_(T, dst, a, b, b, size, x / y);                                                                          \
+            break;                                                                                                                 \
+        case w_NDOP_MIN:                                                                                                           \
+            w_NDExpr_loop_(T, dst, a, b, b, size, w_vectorSelect_(y < x, y, x));                                                   \
+            break;                                                                                                                 \
+        case w_NDOP_MAX:                                                                                                           \
+            w_NDExpr_loop_(T, dst, a, b, b, size, w_vectorSelect_(y > x, y, x));                                                   \
+            break;                                                                                                                 \
+        case w_NDOP_LT:                                                                                                            \
+            w_NDExpr_loop_(T, dst, a, b, b, size, __builtin_convertvector(-(x < y), w_Vector_(T)));                                \
+            break;                                                                                                                 \
+        case w_NDOP_LE:                                                                                                            \
+            w_NDExpr_loop_(T, dst, a, b, b, size, __builtin_convertvector(-(x <= y), w_Vector_(T)));                               \
+            break;                                                                                                                 \
+        case w_NDOP_GT:                                                                                                            \
+            w_NDExpr_loop_(T, dst, a, b, b, size, __builtin_convertvector(-(x > y), w_Vector_(T)));                                \
+            break;                                                                                                                 \
+        case w_NDOP_GE:                                                                                                            \
+            w_NDExpr_loop_(T, dst, a, b, b, size, __builtin_convertvector(-(x >= y), w_Vector_(T)));                               \
+            break;                                                                                                                 \
+        case w_NDOP_EQ:                                                                                                            \
+            w_NDExpr_loop_(T, dst, a, b, b, size, __builtin_convertvector(-(x == y), w_Vector_(T)));                               \
+            break;                                                                                                                 \
+        case w_NDOP_NE:                                                                                                            \
+            w_NDExpr_loop_(T, dst, a, b, b, size, __builtin_convertvector(-(x != y), w_Vector_(T)));                               \
+            break;                                                                                                                 \
+        case w_NDOP_FMA:                                                                                                           \
+            w_NDExpr_loop_(T, dst, a, b, c, size, x * y + z);                                                                      \
+            break;                                                                                                                 \
+        case w_NDOP_WHERE:                                                                                                         \
+            w_NDExpr_loop_(T, dst, a, b, c, size, w_vectorSelect_(x != 0, y, z));                                                  \
+            break;                                                                                                                 \
+        default:                                                                                                                   \
+            w_assert(false);                                                                                                       \
+        }                                                                                                                          \
+    }
+
+// 多维数组表达式计算一段
+#define w_NDExpr_evalChunk_(T) w_concat(w_NDExpr(T), _evalChunk_)
+#define w_NDExpr_evalChunk_define_(T)                                                                                                                       \
+    /**                                                                                                                                                     \
+     * 多维数组表达式计算一段连续的结果                                                                                                     \
+     * @param this 表达式                                                                                                                                \
+     * @param bases 每个操作数本段的起始地址                                                                                                    \
+     * @param strides 每个操作数在最内层维度上的步长                                                                                         \
+     * @param size 元素数量（不超过 w_NDEXPR_CHUNK_）                                                                                              \
+     * @param buffers 中间结果缓冲区                                                                                                                 \
+     * @return const T * 结果                                                                                                                             \
+     */                                                                                                                                                     \
+    static inline const T *w_NDExpr_evalChunk_(T)(w_NDExpr(T) * this, T *const *bases, const int64_t *strides, int64_t size, T (*buffers)[w_NDEXPR_CHUNK_]) \
+    {                                                                                                                                                       \
+        const T *stack[w_NDEXPR_MAX_STACK_];                                                                                                                \
+        int64_t top = 0;                                                                                                                                    \
+        for (int64_t pc = 0; pc < this->codeSize; pc++)                                                                                                     \
+        {                                                                                                                                                   \
+            int32_t op = this->code[pc];                                                                                                                    \
+            if (op == w_NDOP_LOAD_)                                                                                                                         \
+            {                                                                                                                                               \
+                const T *source = bases[this->operandIndex[pc]];                                                                                            \
+                int64_t stride = strides[this->operandIndex[pc]];                                                                                           \
+                if (stride == 1)                                                                                                                            \
+                { /* 连续，直接使用 */                                                                                                                      \
+                    stack[top] = source;                                                                                                                    \
+                }                                                                                                                                           \
+                else if (stride == 0)                                                                                                                       \
+                { /* 广播 */                                                                                                                                \
+                    w_fill(T)(buffers[top], size, *source);                                                                                                 \
+                    stack[top] = buffers[top];                                                                                                              \
+                }                                                                                                                                           \
+                else                                                                                                                                        \
+                { /* 跨步，先收集 */                                                                                                                        \
+                    for (int64_t i = 0; i < size; i++)                                                                                                      \
+                    {                                                                                                                                       \
+                        buffers[top][i] = source[i * stride];                                                                                               \
+                    }                                                                                                                                       \
+                    stack[top] = buffers[top];                                                                                                              \
+                }                                                                                                                                           \
+                top++;                                                                                                                                      \
+            }                                                                                                                                               \
+            else if (op == w_NDOP_CONSTANT_)                                                                                                                \
+            {                                                                                                                                               \
+                w_fill(T)(buffers[top], size, this->constants[pc]);                                                                                         \
+                stack[top] = buffers[top];                                                                                                                  \
+                top++;                                                                                                                                      \
+            }                                                                                                                                               \
+            else                                                                                                                                            \
+            {                                                                                                                                               \
+                int64_t arity = w_NDOP_arity_(op);                                                                                                          \
+                top -= arity;                                                                                                                               \
+                const T *a = stack[top];                                                                                                                    \
+                const T *b = arity > 1 ? stack[top + 1] : a;                                                                                                \
+                const T *c = arity > 2 ? stack[top + 2] : b;                                                                                                \
+                w_NDExpr_kernel_(T)(op, buffers[top], a, b, c, size);                                                                                       \
+                stack[top] = buffers[top];                                                                                                                  \
+                top++;                                                                                                                                      \
+            }                                                                                                                                               \
+        }                                                                                                                                                   \
+        return stack[0];                                                                                                                                    \
+    }
+
+// 多维数组表达式计算
+#define w_NDExpr_eval(T) w_concat(w_NDExpr(T), _eval)
+#define w_NDExpr_eval_define_(T)                                                                                   \
+    /**                                                                                                            \
+     * 多维数组表达式计算，整个表达式按段一次遍历完成，不产生临时数组               \
+     * 操作数按 NumPy 规则广播到结果的形状，相邻的连续维度会被合并                       \
+     * @param this 表达式（栈中必须只剩一个值）                                                      \
+     * @param out 结果视图（可以与操作数相同，实现原地计算；不能与操作数部分重叠） \
+     * @return void                                                                                                \
+     */                                                                                                            \
+    static inline void w_NDExpr_eval(T)(w_NDExpr(T) * this, w_NDArrayView(T) out)                                  \
+    {                                                                                                              \
+        w_check(this != NULL);                                                                                     \
+        w_check(this->depth == 1);                                                                                 \
+        int64_t viewSize = this->operandSize + 1;                                                                  \
+        w_NDArrayView(T) views[w_NDEXPR_MAX_OPERANDS_ + 1];                                                        \
+        views[0] = out;                                                                                            \
+        for (int64_t v = 1; v < viewSize; v++)                                                                     \
+        {                                                                                                          \
+            views[v] = w_NDArrayView_broadcast(T)(this->operands[v - 1], out.shape, out.shapeSize);                \
+        }                                                                                                          \
+                                                                                                                   \
+        /* 合并相邻的连续维度（逆序存放，0 为最内层） */                                                           \
+        int64_t shape[w_NDARRAY_MAX_RANK];                                                                         \
+        int64_t strides[w_NDEXPR_MAX_OPERANDS_ + 1][w_NDARRAY_MAX_RANK];                                           \
+        int64_t rank = 0;                                                                                          \
+        for (int64_t i = out.shapeSize - 1; i >= 0; i--)                                                           \
+        {                                                                                                          \
+            if (out.shape[i] == 0)                                                                                 \
+            {                                                                                                      \
+                return;                                                                                            \
+            }                                                                                                      \
+            if (out.shape[i] == 1)                                                                                 \
+            {                                                                                                      \
+                continue;                                                                                          \
+            }                                                                                                      \
+            bool merge = rank > 0;                                                                                 \
+            for (int64_t v = 0; v < viewSize && merge; v++)                                                        \
+            {                                                                                                      \
+                merge = views[v].strides[i] == strides[v][rank - 1] * shape[rank - 1];                             \
+            }                                                                                                      \
+            if (merge)                                                                                             \
+            {                                                                                                      \
+                shape[rank - 1] *= out.shape[i];                                                                   \
+                continue;                                                                                          \
+            }                                                                                                      \
+            shape[rank] = out.shape[i];                                                                            \
+            for (int64_t v = 0; v < viewSize; v++)                                                                 \
+            {                                                                                                      \
+                strides[v][rank] = views[v].strides[i];                                                            \
+            }                                                                                                      \
+            rank++;                                                                                                \
+        }                                                                                                          \
+        if (rank == 0)                                                                                             \
+        { /* 只有一个元素 */                                                                                       \
+            shape[rank] = 1;                                                                                       \
+            for (int64_t v = 0; v < viewSize; v++)                                                                 \
+            {                                                                                                      \
+                strides[v][rank] = 0;                                                                              \
+            }                                                                                                      \
+            rank++;                                                                                                \
+        }                                                                                                          \
+                                                                                                                   \
+        /* 外层维度逐个遍历，最内层维度按段计算 */                                                                 \
+        T buffers[w_NDEXPR_MAX_STACK_][w_NDEXPR_CHUNK_];                                                           \
+        T *bases[w_NDEXPR_MAX_OPERANDS_ + 1];                                                                      \
+        int64_t innerStrides[w_NDEXPR_MAX_OPERANDS_];                                                              \
+        int64_t indices[w_NDARRAY_MAX_RANK] = {0};                                                                 \
+        for (int64_t v = 1; v < viewSize; v++)                                                                     \
+        {                                                                                                          \
+            innerStrides[v - 1] = strides[v][0];                                                                   \
+        }                                                                                                          \
+        int64_t outStride = strides[0][0];                                                                         \
+        while (true)                                                                                               \
+        {                                                                                                          \
+            for (int64_t v = 0; v < viewSize; v++)                                                                 \
+            {                                                                                                      \
+                bases[v] = views[v].elementData + views[v].offset;                                                 \
+                for (int64_t d = 1; d < rank; d++)                                                                 \
+                {                                                                                                  \
+                    bases[v] += indices[d] * strides[v][d];                                                        \
+                }                                                                                                  \
+            }                                                                                                      \
+            for (int64_t start = 0; start < shape[0]; start += w_NDEXPR_CHUNK_)                                    \
+            {                                                                                                      \
+                int64_t size = shape[0] - start < w_NDEXPR_CHUNK_ ? shape[0] - start : w_NDEXPR_CHUNK_;            \
+                const T *result = w_NDExpr_evalChunk_(T)(this, bases + 1, innerStrides, size, buffers);            \
+                if (outStride == 1)                                                                                \
+                {                                                                                                  \
+                    if (result != bases[0])                                                                        \
+                    {                                                                                              \
+                        memcpy(bases[0], result, sizeof(T) * size);                                                \
+                    }                                                                                              \
+                }                                                                                                  \
+                else                                                                                               \
+                {                                                                                                  \
+                    for (int64_t i = 0; i < size; i++)                                                             \
+                    {                                                                                              \
+                        bases[0][i * outStride] = result[i];                                                       \
+                    }                                                                                              \
+                }                                                                                                  \
+                for (int64_t v = 0; v < viewSize; v++)                                                             \
+                {                                                                                                  \
+                    bases[v] += w_NDEXPR_CHUNK_ * strides[v][0];                                                   \
+                }                                                                                                  \
+            }                                                                                                      \
+                                                                                                                   \
+            /* 外层维度进位 */                                                                                     \
+            int64_t d = 1;                                                                                         \
+            for (; d < rank; d++)                                                                                  \
+            {                                                                                                      \
+                if (++indices[d] < shape[d])                                                                       \
+                {                                                                                                  \
+                    break;                                                                                         \
+                }                                                                                                  \
+                indices[d] = 0;                                                                                    \
+            }                                                                                                      \
+            if (d >= rank)                                                                                         \
+            {                                                                                                      \
+                break;                                                                                             \
+            }                                                                                                      \
+        }                                                                                                          \
+    }
+
+// 多维数组按广播形状初始化
+#define w_NDArray_initBroadcast(T) w_concat(w_NDArray(T), _initBroadcast)
+#define w_NDArray_initBroadcast_define_(T)                                                                     \
+    /**                                                                                                        \
+     * 多维数组按两个视图广播后的形状初始化（用于保存运算结果）                    \
+     * @param this 多维数组                                                                                \
+     * @param a 视图 a                                                                                       \
+     * @param b 视图 b                                                                                       \
+     * @return void                                                                                            \
+     */                                                                                                        \
+    static inline void w_NDArray_initBroadcast(T)(w_NDArray(T) * this, w_NDArrayView(T) a, w_NDArrayView(T) b) \
+    {                                                                                                          \
+        int64_t shapeSize = a.shapeSize > b.shapeSize ? a.shapeSize : b.shapeSize;                             \
+        int64_t shape[w_NDARRAY_MAX_RANK];                                                                     \
+        for (int64_t i = 0; i < shapeSize; i++)                                                                \
+        {                                                                                                      \
+            int64_t axisA = i - (shapeSize - a.shapeSize);                                                     \
+            int64_t axisB = i - (shapeSize - b.shapeSize);                                                     \
+            int64_t sizeA = axisA >= 0 ? a.shape[axisA] : 1;                                                   \
+            int64_t sizeB = axisB >= 0 ? b.shape[axisB] : 1;                                                   \
+            w_check(sizeA == sizeB || sizeA == 1 || sizeB == 1);                                               \
+            shape[i] = sizeA == 1 ? sizeB : sizeA;                                                             \
+        }                                                                                                      \
+        w_NDArray_initShape(T)(this, shape, shapeSize);                                                        \
+    }
+
+// 多维数组视图一元运算
+#define w_NDArrayView_unary(T) w_concat(w_NDArrayView(T), _unary)
+#define w_NDArrayView_unary_define_(T)                                                              \
+    /**                                                                                             \
+     * 多维数组视图一元运算 out = op(a)                                                   \
+     * @param op 运算（w_NDOP_NEG、w_NDOP_ABS；指数使用 w_NDArrayView_exp）               \
+     * @param out 结果视图（可以与 a 相同）                                              \
+     * @param a 视图 a（广播到 out 的形状）                                               \
+     * @return void                                                                                 \
+     */                                                                                             \
+    static inline void w_NDArrayView_unary(T)(int32_t op, w_NDArrayView(T) out, w_NDArrayView(T) a) \
+    {                                                                                               \
+        w_check(w_NDOP_arity_(op) == 1);                                                            \
+        w_NDExpr(T) expr;                                                                           \
+        w_NDExpr_init(T)(&expr);                                                                    \
+        w_NDExpr_load(T)(&expr, a);                                                                 \
+        w_NDExpr_apply(T)(&expr, op);                                                               \
+        w_NDExpr_eval(T)(&expr, out);                                                               \
+    }
+
+// 多维数组视图二元运算
+#define w_NDArrayView_binary(T) w_concat(w_NDArrayView(T), _binary)
+#define w_NDArrayView_binary_define_(T)                                                                                  \
+    /**                                                                                                                  \
+     * 多维数组视图二元运算 out = a op b                                                                       \
+     * @param op 运算（w_NDOP_ADD ~ w_NDOP_NE）                                                                      \
+     * @param out 结果视图（可以与 a 或 b 相同）                                                             \
+     * @param a 视图 a（广播到 out 的形状）                                                                    \
+     * @param b 视图 b（广播到 out 的形状）                                                                    \
+     * @return void                                                                                                      \
+     */                                                                                                                  \
+    static inline void w_NDArrayView_binary(T)(int32_t op, w_NDArrayView(T) out, w_NDArrayView(T) a, w_NDArrayView(T) b) \
+    {                                                                                                                    \
+        w_check(w_NDOP_arity_(op) == 2);                                                                                 \
+        w_NDExpr(T) expr;                                                                                                \
+        w_NDExpr_init(T)(&expr);                                                                                         \
+        w_NDExpr_load(T)(&expr, a);                                                                                      \
+        w_NDExpr_load(T)(&expr, b);                                                                                      \
+        w_NDExpr_apply(T)(&expr, op);                                                                                    \
+        w_NDExpr_eval(T)(&expr, out);                                                                                    \
+    }
+
+// 多维数组视图三元运算
+#define w_NDArrayView_ternary(T) w_concat(w_NDArrayView(T), _ternary)
+#define w_NDArrayView_ternary_define_(T)                                                                                                      \
+    /**                                                                                                                                       \
+     * 多维数组视图三元运算 out = op(a, b, c)                                                                                       \
+     * @param op 运算（w_NDOP_FMA、w_NDOP_WHERE）                                                                                        \
+     * @param out 结果视图（可以与输入相同）                                                                                     \
+     * @param a 视图 a（广播到 out 的形状）                                                                                         \
+     * @param b 视图 b（广播到 out 的形状）                                                                                         \
+     * @param c 视图 c（广播到 out 的形状）                                                                                         \
+     * @return void                                                                                                                           \
+     */                                                                                                                                       \
+    static inline void w_NDArrayView_ternary(T)(int32_t op, w_NDArrayView(T) out, w_NDArrayView(T) a, w_NDArrayView(T) b, w_NDArrayView(T) c) \
+    {                                                                                                                                         \
+        w_check(w_NDOP_arity_(op) == 3);                                                                                                      \
+        w_NDExpr(T) expr;                                                                                                                     \
+        w_NDExpr_init(T)(&expr);                                                                                                              \
+        w_NDExpr_load(T)(&expr, a);                                                                                                           \
+        w_NDExpr_load(T)(&expr, b);                                                                                                           \
+        w_NDExpr_load(T)(&expr, c);                                                                                                           \
+        w_NDExpr_apply(T)(&expr, op);                                                                                                         \
+        w_NDExpr_eval(T)(&expr, out);                                                                                                         \
+    }
+
+// 多维数组视图逐元素加法
+#define w_NDArrayView_add(T) w_concat(w_NDArrayView(T), _add)
+#define w_NDArrayView_add_define_(T)                                                                      \
+    /**                                                                                                   \
+     * 多维数组视图逐元素加法 out = a + b（支持广播）                                    \
+     * @param out 结果视图（可以与 a 或 b 相同）                                              \
+     * @param a 视图 a                                                                                  \
+     * @param b 视图 b                                                                                  \
+     * @return void                                                                                       \
+     */                                                                                                   \
+    static inline void w_NDArrayView_add(T)(w_NDArrayView(T) out, w_NDArrayView(T) a, w_NDArrayView(T) b) \
+    {                                                                                                     \
+        w_NDArrayView_binary(T)(w_NDOP_ADD, out, a, b);                                                   \
+    }
+
+// 多维数组视图逐元素减法
+#define w_NDArrayView_sub(T) w_concat(w_NDArrayView(T), _sub)
+#define w_NDArrayView_sub_define_(T)                                                                      \
+    /**                                                                                                   \
+     * 多维数组视图逐元素减法 out = a - b（支持广播）                                    \
+     * @param out 结果视图（可以与 a 或 b 相同）                                              \
+     * @param a 视图 a                                                                                  \
+     * @param b 视图 b                                                                                  \
+     * @return void                                                                                       \
+     */                                                                                                   \
+    static inline void w_NDArrayView_sub(T)(w_NDArrayView(T) out, w_NDArrayView(T) a, w_NDArrayView(T) b) \
+    {                                                                                                     \
+        w_NDArrayView_binary(T)(w_NDOP_SUB, out, a, b);                                                   \
+    }
+
+// 多维数组视图逐元素乘法
+#define w_NDArrayView_mul(T) w_concat(w_NDArrayView(T), _mul)
+#define w_NDArrayView_mul_define_(T)                                                                      \
+    /**                                                                                                   \
+     * 多维数组视图逐元素乘法 out = a * b（支持广播）                                    \
+     * @param out 结果视图（可以与 a 或 b 相同）                                              \
+     * @param a 视图 a                                                                                  \
+     * @param b 视图 b                                                                                  \
+     * @return void                                                                                       \
+     */                                                                                                   \
+    static inline void w_NDArrayView_mul(T)(w_NDArrayView(T) out, w_NDArrayView(T) a, w_NDArrayView(T) b) \
+    {                                                                                                     \
+        w_NDArrayView_binary(T)(w_NDOP_MUL, out, a, b);                                                   \
+    }
+
+// 多维数组视图逐元素除法
+#define w_NDArrayView_div(T) w_concat(w_NDArrayView(T), _div)
+#define w_NDArrayView_div_define_(T)                                                                      \
+    /**                                                                                                   \
+     * 多维数组视图逐元素除法 out = a / b（支持广播）                                    \
+     * @param out 结果视图（可以与 a 或 b 相同）                                              \
+     * @param a 视图 a                                                                                  \
+     * @param b 视图 b                                                                                  \
+     * @return void                                                                                       \
+     */                                                                                                   \
+    static inline void w_NDArrayView_div(T)(w_NDArrayView(T) out, w_NDArrayView(T) a, w_NDArrayView(T) b) \
+    {                                                                                                     \
+        w_NDArrayView_binary(T)(w_NDOP_DIV, out, a, b);                                                   \
+    }
+
+// 多维数组视图逐元素最小值
+#define w_NDArrayView_minimum(T) w_concat(w_NDArrayView(T), _minimum)
+#define w_NDArrayView_minimum_define_(T)                                                                      \
+    /**                                                                                                       \
+     * 多维数组视图逐元素最小值 out = min(a, b)（支持广播，浮点数不处理 NaN）        \
+     * @param out 结果视图（可以与 a 或 b 相同）                                                  \
+     * @param a 视图 a                                                                                      \
+     * @param b 视图 b                                                                                      \
+     * @return void                                                                                           \
+     */                                                                                                       \
+    static inline void w_NDArrayView_minimum(T)(w_NDArrayView(T) out, w_NDArrayView(T) a, w_NDArrayView(T) b) \
+    {                                                                                                         \
+        w_NDArrayView_binary(T)(w_NDOP_MIN, out, a, b);                                                       \
+    }
+
+// 多维数组视图逐元素最大值
+#define w_NDArrayView_maximum(T) w_concat(w_NDArrayView(T), _maximum)
+#define w_NDArrayView_maximum_define_(T)                                                                      \
+    /**                                                                                                       \
+     * 多维数组视图逐元素最大值 out = max(a, b)（支持广播，浮点数不处理 NaN）        \
+     * @param out 结果视图（可以与 a 或 b 相同）                                                  \
+     * @param a 视图 a                                                                                      \
+     * @param b 视图 b                                                                                      \
+     * @return void                                                                                           \
+     */                                                                                                       \
+    static inline void w_NDArrayView_maximum(T)(w_NDArrayView(T) out, w_NDArrayView(T) a, w_NDArrayView(T) b) \
+    {                                                                                                         \
+        w_NDArrayView_binary(T)(w_NDOP_MAX, out, a, b);                                                       \
+    }
+
+// 多维数组视图逐元素乘加
+#define w_NDArrayView_fma(T) w_concat(w_NDArrayView(T), _fma)
+#define w_NDArrayView_fma_define_(T)                                                                                          \
+    /**                                                                                                                       \
+     * 多维数组视图逐元素乘加 out = a * b + c（支持广播，一次遍历完成）                               \
+     * @param out 结果视图（可以与输入相同）                                                                     \
+     * @param a 视图 a                                                                                                      \
+     * @param b 视图 b                                                                                                      \
+     * @param c 视图 c                                                                                                      \
+     * @return void                                                                                                           \
+     */                                                                                                                       \
+    static inline void w_NDArrayView_fma(T)(w_NDArrayView(T) out, w_NDArrayView(T) a, w_NDArrayView(T) b, w_NDArrayView(T) c) \
+    {                                                                                                                         \
+        w_NDArrayView_ternary(T)(w_NDOP_FMA, out, a, b, c);                                                                   \
+    }
+
+// 多维数组视图逐元素绝对值
+#define w_NDArrayView_abs(T) w_concat(w_NDArrayView(T), _abs)
+#define w_NDArrayView_abs_define_(T)                                                  \
+    /**                                                                               \
+     * 多维数组视图逐元素绝对值 out = |a|                                 \
+     * @param out 结果视图（可以与 a 相同）                                \
+     * @param a 视图 a                                                              \
+     * @return void                                                                   \
+     */                                                                               \
+    static inline void w_NDArrayView_abs(T)(w_NDArrayView(T) out, w_NDArrayView(T) a) \
+    {                                                                                 \
+        w_NDArrayView_unary(T)(w_NDOP_ABS, out, a);                                   \
+    }
+
+// 多维数组视图逐元素指数
+#define w_NDArrayView_exp(T) w_concat(w_NDArrayView(T), _exp)
+#define w_NDArrayView_exp_define_(T)                                                  \
+    /**                                                                               \
+     * 多维数组视图逐元素指数 out = e^a（需要链接数学库）         \
+     * @param out 结果视图（可以与 a 相同）                                \
+     * @param a 视图 a                                                              \
+     * @return void                                                                   \
+     */                                                                               \
+    static inline void w_NDArrayView_exp(T)(w_NDArrayView(T) out, w_NDArrayView(T) a) \
+    {                                                                                 \
+        w_NDExpr_expFunction_(T) = w_NDExpr_expKernel_(T);                            \
+        w_NDArrayView_unary(T)(w_NDOP_EXP, out, a);                                   \
+    }
+
+// 多维数组运算定义
+// 需要先定义 w_NDArray_define(T) 和 w_NDArrayView_define(T)，T 必须是数字类型（bool 除外）
+#define w_NDArray_number_define(T)      \
+    w_NDExpr_type_define_(T);           \
+    w_NDExpr_expKernel_define_(T);      \
+    w_NDExpr_init_define_(T);           \
+    w_NDExpr_load_define_(T);           \
+    w_NDExpr_constant_define_(T);       \
+    w_NDExpr_apply_define_(T);          \
+    w_NDExpr_exp_define_(T);            \
+    w_NDExpr_kernel_define_(T);         \
+    w_NDExpr_evalChunk_define_(T);      \
+    w_NDExpr_eval_define_(T);           \
+    w_NDArray_initBroadcast_define_(T); \
+    w_NDArrayView_unary_define_(T);     \
+    w_NDArrayView_binary_define_(T);    \
+    w_NDArrayView_ternary_define_(T);   \
+    w_NDArrayView_add_define_(T);       \
+    w_NDArrayView_sub_define_(T);       \
+    w_NDArrayView_mul_define_(T);       \
+    w_NDArrayView_div_define_(T);       \
+    w_NDArrayView_minimum_define_(T);   \
+    w_NDArrayView_maximum_define_(T);   \
+    w_NDArrayView_fma_define_(T);       \
+    w_NDArrayView_abs_define_(T);       \
+    w_NDArrayView_exp_define_(T);
+
+// ========================================================================================================================================================
+//  矩阵运算
+// ========================================================================================================================================================
+
+// 运行时按 CPU 选择 AVX-512 / AVX2 + FMA / 默认实现（矩阵乘法内核依赖乘加指令）
+#if defined(__x86_64__) && defined(__linux__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define w_SIMD_DISPATCH_FMA_ __attribute__((target_clones("avx512f", "arch=haswell", "default")))
+#endif
+#endif
+#ifndef w_SIMD_DISPATCH_FMA_
+#define w_SIMD_DISPATCH_FMA_
+#endif
+
+// 矩阵乘法微内核的行数（列数为一个向量的元素数量）
+#define w_GEMM_MR_ 6
+
+// 矩阵乘法 A 分块的行数（L2 缓存）
+#define w_GEMM_MC_ 72
+
+// 矩阵乘法 K 维分块大小（L1 缓存）
+#define w_GEMM_KC_ 256
+
+// 矩阵乘法 B 分块的列数（L3 缓存）
+#define w_GEMM_NC_ 2048
+
+// 矩阵乘法微内核
+#define w_gemmKernel_(T) w_concat(w_gemmKernel_, T)
+#define w_gemmKernel_define_(T)                                                                                                                      \
+    /**                                                                                                                                              \
+     * 矩阵乘法微内核，计算 MR x NR 的小块 C = A * B（或 C += A * B）                                                                \
+     * @param kc K 维长度                                                                                                                         \
+     * @param packA 打包后的 A（kc x MR，按列存放）                                                                                       \
+     * @param packB 打包后的 B（kc x NR，按行存放）                                                                                       \
+     * @param c C 小块的起始地址                                                                                                              \
+     * @param rowStride C 的行步长                                                                                                               \
+     * @param colStride C 的列步长                                                                                                               \
+     * @param rows 有效行数（不超过 MR）                                                                                                    \
+     * @param cols 有效列数（不超过 NR）                                                                                                    \
+     * @param accumulate 是否累加到 C                                                                                                           \
+     * @return void                                                                                                                                  \
+     */                                                                                                                                              \
+    static inline w_SIMD_DISPATCH_FMA_ void w_gemmKernel_(T)(int64_t kc, const T *packA, const T *packB, T *c, int64_t rowStride, int64_t colStride, \
+                                                              int64_t rows, int64_t cols, bool accumulate)                                           \
+    {                                                                                                                                                \
+        const int64_t lanes = w_Vector_lanes_(T);                                                                                                    \
+        w_Vector_(T) sum[w_GEMM_MR_];                                                                                                                \
+        memset(sum, 0, sizeof(sum));                                                                                                                 \
+        for (int64_t k = 0; k < kc; k++)                                                                                                             \
+        {                                                                                                                                            \
+            w_Vector_(T) b;                                                                                                                          \
+            memcpy(&b, packB + k * lanes, sizeof(b));                                                                                                \
+            for (int64_t r = 0; r < w_GEMM_MR_; r++)                                                                                                 \
+            {                                                                                                                                        \
+                sum[r] += packA[k * w_GEMM_MR_ + r] * b;                                                                                             \
+            }                                                                                                                                        \
+        }                                                                                                                                            \
+                                                                                                                                                     \
+        /* 写回 C */                                                                                                                                 \
+        for (int64_t r = 0; r < rows; r++)                                                                                                           \
+        {                                                                                                                                            \
+            T *row = c + r * rowStride;                                                                                                              \
+            if (colStride == 1 && cols == lanes)                                                                                                     \
+            {                                                                                                                                        \
+                if (accumulate)                                                                                                                      \
+                {                                                                                                                                    \
+                    w_Vector_(T) old;                                                                                                                \
+                    memcpy(&old, row, sizeof(old));                                                                                                  \
+                    sum[r] += old;                                                                                                                   \
+                }                                                                                                                                    \
+                memcpy(row, &sum[r], sizeof(sum[r]));                                                                                                \
+            }                                                                                                                                        \
+            else                                                                                                                                     \
+            {                                                                                                                                        \
+                for (int64_t j = 0; j < cols; j++)                                                                                                   \
+                {                                                                                                                                    \
+                    row[j * colStride] = accumulate ? row[j * colStride] + sum[r][j] : sum[r][j];                                                    \
+                }                                                                                                                                    \
+            }                                                                                                                                        \
+        }                                                                                                                                            \
+    }
+
+// 矩阵乘法打包 A
+#define w_gemmPackA_(T) w_concat(w_gemmPackA_, T)
+#define w_gemmPackA_define_(T)                                                                                             \
+    /**                                                                                                                    \
+     * 矩阵乘法打包 A 的一块（每 MR 行一组，组内按列存放，不足 MR 行补 0）                      \
+     * @param pack 目标                                                                                                  \
+     * @param a A 块的起始地址                                                                                       \
+     * @param rowStride A 的行步长                                                                                     \
+     * @param colStride A 的列步长                                                                                     \
+     * @param mc 行数                                                                                                    \
+     * @param kc 列数                                                                                                    \
+     * @return void                                                                                                        \
+     */                                                                                                                    \
+    static inline void w_gemmPackA_(T)(T * pack, const T *a, int64_t rowStride, int64_t colStride, int64_t mc, int64_t kc) \
+    {                                                                                                                      \
+        for (int64_t i = 0; i < mc; i += w_GEMM_MR_)                                                                       \
+        {                                                                                                                  \
+            int64_t rows = mc - i < w_GEMM_MR_ ? mc - i : w_GEMM_MR_;                                                      \
+            for (int64_t k = 0; k < kc; k++)                                                                               \
+            {                                                                                                              \
+                for (int64_t r = 0; r < w_GEMM_MR_; r++)                                                                   \
+                {                                                                                                          \
+                    pack[k * w_GEMM_MR_ + r] = r < rows ? a[(i + r) * rowStride + k * colStride] : 0;                      \
+                }                                                                                                          \
+            }                                                                                                              \
+            pack += kc * w_GEMM_MR_;                                                                                       \
+        }                                                                                                                  \
+    }
+
+// 矩阵乘法打包 B
+#define w_gemmPackB_(T) w_concat(w_gemmPackB_, T)
+#define w_gemmPackB_define_(T)                                                                                             \
+    /**                                                                                                                    \
+     * 矩阵乘法打包 B 的一块（每 NR 列一组，组内按行存放，不足 NR 列补 0）                      \
+     * @param pack 目标                                                                                                  \
+     * @param b B 块的起始地址                                                                                       \
+     * @param rowStride B 的行步长                                                                                     \
+     * @param colStride B 的列步长                                                                                     \
+     * @param kc 行数                                                                                                    \
+     * @param nc 列数                                                                                                    \
+     * @return void                                                                                                        \
+     */                                                                                                                    \
+    static inline void w_gemmPackB_(T)(T * pack, const T *b, int64_t rowStride, int64_t colStride, int64_t kc, int64_t nc) \
+    {                                                                                                                      \
+        const int64_t lanes = w_Vector_lanes_(T);                                                                          \
+        for (int64_t j = 0; j < nc; j += lanes)                                                                            \
+        {                                                                                                                  \
+            int64_t cols = nc - j < lanes ? nc - j : lanes;                                                                \
+            for (int64_t k = 0; k < kc; k++)                                                                               \
+            {                                                                                                              \
+                const T *row = b + k * rowStride + j * colStride;                                                          \
+                if (colStride == 1 && cols == lanes)                                                                       \
+                {                                                                                                          \
+                    memcpy(pack + k * lanes, row, sizeof(T) * lanes);                                                      \
+                    continue;                                                                                              \
+                }                                                                                                          \
+                for (int64_t c = 0; c < lanes; c++)                                                                        \
+                {                                                                                                          \
+                    pack[k * lanes + c] = c < cols ? row[c * colStride] : 0;                                               \
+                }                                                                                                          \
+            }                                                                                                              \
+            pack += kc * lanes;                                                                                            \
+        }                                                                                                                  \
+    }
+
+// 矩阵乘法（单线程）
+#define w_gemm_(T) w_concat(w_gemm_, T)
+#define w_gemm_define_(T)                                                                                                                   \
+    /**                                                                                                                                     \
+     * 矩阵乘法 C = A * B（单线程），按 NC / KC / MC 分块并打包，保证微内核访问的数据留在缓存中             \
+     * @param c C（m x n）                                                                                                                \
+     * @param a A（m x k）                                                                                                                \
+     * @param b B（k x n）                                                                                                                \
+     * @return void                                                                                                                         \
+     */                                                                                                                                     \
+    static inline void w_gemm_(T)(w_NDArrayView(T) c, w_NDArrayView(T) a, w_NDArrayView(T) b)                                               \
+    {                                                                                                                                       \
+        const int64_t lanes = w_Vector_lanes_(T);                                                                                           \
+        int64_t m = a.shape[0], k = a.shape[1], n = b.shape[1];                                                                             \
+        if (m == 0 || n == 0)                                                                                                               \
+        {                                                                                                                                   \
+            return;                                                                                                                         \
+        }                                                                                                                                   \
+        T *cData = c.elementData + c.offset;                                                                                                \
+        const T *aData = a.elementData + a.offset;                                                                                          \
+        const T *bData = b.elementData + b.offset;                                                                                          \
+        if (k == 0)                                                                                                                         \
+        {                                                                                                                                   \
+            for (int64_t i = 0; i < m; i++)                                                                                                 \
+            {                                                                                                                               \
+                for (int64_t j = 0; j < n; j++)                                                                                             \
+                {                                                                                                                           \
+                    cData[i * c.strides[0] + j * c.strides[1]] = 0;                                                                         \
+                }                                                                                                                           \
+            }                                                                                                                               \
+            return;                                                                                                                         \
+        }                                                                                                                                   \
+                                                                                                                                            \
+        /* 打包缓冲区 */                                                                                                                    \
+        int64_t kcMax = k < w_GEMM_KC_ ? k : w_GEMM_KC_;                                                                                    \
+        int64_t mcMax = m < w_GEMM_MC_ ? (m + w_GEMM_MR_ - 1) / w_GEMM_MR_ * w_GEMM_MR_ : w_GEMM_MC_;                                       \
+        int64_t ncMax = n < w_GEMM_NC_ ? (n + lanes - 1) / lanes * lanes : w_GEMM_NC_;                                                      \
+        w_AllocPolicy policy = w_AllocPolicy_aligned(64);                                                                                   \
+        T *packA = w_AllocPolicy_malloc_(&policy, sizeof(T) * mcMax * kcMax);                                                               \
+        w_assert(packA != NULL);                                                                                                            \
+        T *packB = w_AllocPolicy_malloc_(&policy, sizeof(T) * kcMax * ncMax);                                                               \
+        w_assert(packB != NULL);                                                                                                            \
+                                                                                                                                            \
+        for (int64_t jc = 0; jc < n; jc += w_GEMM_NC_)                                                                                      \
+        {                                                                                                                                   \
+            int64_t nc = n - jc < w_GEMM_NC_ ? n - jc : w_GEMM_NC_;                                                                         \
+            for (int64_t pc = 0; pc < k; pc += w_GEMM_KC_)                                                                                  \
+            {                                                                                                                               \
+                int64_t kc = k - pc < w_GEMM_KC_ ? k - pc : w_GEMM_KC_;                                                                     \
+                w_gemmPackB_(T)(packB, bData + pc * b.strides[0] + jc * b.strides[1], b.strides[0], b.strides[1], kc, nc);                  \
+                for (int64_t ic = 0; ic < m; ic += w_GEMM_MC_)                                                                              \
+                {                                                                                                                           \
+                    int64_t mc = m - ic < w_GEMM_MC_ ? m - ic : w_GEMM_MC_;                                                                 \
+                    w_gemmPackA_(T)(packA, aData + ic * a.strides[0] + pc * a.strides[1], a.strides[0], a.strides[1], mc, kc);              \
+                    for (int64_t jr = 0; jr < nc; jr += lanes)                                                                              \
+                    {                                                                                                                       \
+                        int64_t cols = nc - jr < lanes ? nc - jr : lanes;                                                                   \
+                        for (int64_t ir = 0; ir < mc; ir += w_GEMM_MR_)                                                                     \
+                        {                                                                                                                   \
+                            int64_t rows = mc - ir < w_GEMM_MR_ ? mc - ir : w_GEMM_MR_;                                                     \
+                            T *cBlock = cData + (ic + ir) * c.strides[0] + (jc + jr) * c.strides[1];                                        \
+                            w_gemmKernel_(T)(kc, packA + ir * kc, packB + jr * kc, cBlock, c.strides[0], c.strides[1], rows, cols, pc > 0); \
+                        }                                                                                                                   \
+                    }                                                                                                                       \
+                }                                                                                                                           \
+            }                                                                                                                               \
+        }                                                                                                                                   \
+        w_AllocPolicy_free_(&policy, packB, sizeof(T) * kcMax * ncMax);                                                                     \
+        w_AllocPolicy_free_(&policy, packA, sizeof(T) * mcMax * kcMax);                                                                     \
+    }
+
+// 矩阵并行任务上下文
+#define w_MatrixContext_(T) w_concat(w_MatrixContext_, T)
+#define w_MatrixContext_type_define_(T)                    \
+    typedef struct                                         \
+    {                                                      \
+        w_NDArrayView(T) out; /* 结果 */                   \
+        w_NDArrayView(T) a;   /* 输入 a */                 \
+        w_NDArrayView(T) b;   /* 输入 b（转置时不使用） */ \
+    } w_MatrixContext_(T);
+
+// 矩阵乘法并行任务
+#define w_matmulTask_(T) w_concat(w_matmulTask_, T)
+#define w_matmulTask_define_(T)                                                                                                            \
+    /**                                                                                                                                    \
+     * 矩阵乘法并行任务，计算结果的 [begin, end) 行                                                                         \
+     * @param context 上下文                                                                                                            \
+     * @param begin 起始行                                                                                                              \
+     * @param end 结束行（不包含）                                                                                                 \
+     * @return void                                                                                                                        \
+     */                                                                                                                                    \
+    static inline void w_matmulTask_(T)(void *context, int64_t begin, int64_t end)                                                         \
+    {                                                                                                                                      \
+        w_MatrixContext_(T) *matrix = context;                                                                                             \
+        w_gemm_(T)(w_NDArrayView_slice(T)(matrix->out, 0, begin, end, 1), w_NDArrayView_slice(T)(matrix->a, 0, begin, end, 1), matrix->b); \
+    }
+
+// 矩阵乘法
+#define w_NDArrayView_matmul(T) w_concat(w_NDArrayView(T), _matmul)
+#define w_NDArrayView_matmul_define_(T)                                                                                       \
+    /**                                                                                                                       \
+     * 矩阵乘法 out = a * b，结果按行分段并行计算                                                              \
+     * @param out 结果视图（m x n，不能与 a、b 重叠）                                                            \
+     * @param a 视图 a（m x k，可以是转置等任意步长的视图）                                                 \
+     * @param b 视图 b（k x n，可以是转置等任意步长的视图）                                                 \
+     * @param threadCount 线程数（<= 0 时使用默认线程数，1 为单线程）                                       \
+     * @return void                                                                                                           \
+     */                                                                                                                       \
+    static inline void w_NDArrayView_matmul(T)(w_NDArrayView(T) out, w_NDArrayView(T) a, w_NDArrayView(T) b, int threadCount) \
+    {                                                                                                                         \
+        w_check(out.shapeSize == 2 && a.shapeSize == 2 && b.shapeSize == 2);                                                  \
+        w_check(a.shape[1] == b.shape[0]);                                                                                    \
+        w_check(out.shape[0] == a.shape[0] && out.shape[1] == b.shape[1]);                                                    \
+        if (threadCount <= 0)                                                                                                 \
+        {                                                                                                                     \
+            threadCount = w_defaultThreadCount();                                                                             \
+        }                                                                                                                     \
+        /* 计算量小或行数不够分时不值得启动线程 */                                                                            \
+        if ((double)a.shape[0] * a.shape[1] * b.shape[1] < (1 << 21))                                                         \
+        {                                                                                                                     \
+            threadCount = 1;                                                                                                  \
+        }                                                                                                                     \
+        int64_t panels = a.shape[0] / w_GEMM_MR_;                                                                             \
+        if (threadCount > panels)                                                                                             \
+        {                                                                                                                     \
+            threadCount = panels > 1 ? (int)panels : 1;                                                                       \
+        }                                                                                                                     \
+        w_MatrixContext_(T) context = {out, a, b};                                                                            \
+        w_parallelFor_(a.shape[0], threadCount, w_matmulTask_(T), &context);                                                  \
+    }
+
+// 多维数组矩阵乘法
+#define w_NDArray_matmul(T) w_concat(w_NDArray(T), _matmul)
+#define w_NDArray_matmul_define_(T)                                                                                      \
+    /**                                                                                                                  \
+     * 多维数组矩阵乘法 this = a * b                                                                             \
+     * @param this 未初始化的多维数组（使用后需要调用 w_NDArray_deinit）                               \
+     * @param a 视图 a（m x k）                                                                                      \
+     * @param b 视图 b（k x n）                                                                                      \
+     * @param threadCount 线程数（<= 0 时使用默认线程数，1 为单线程）                                  \
+     * @return void                                                                                                      \
+     */                                                                                                                  \
+    static inline void w_NDArray_matmul(T)(w_NDArray(T) * this, w_NDArrayView(T) a, w_NDArrayView(T) b, int threadCount) \
+    {                                                                                                                    \
+        w_check(a.shapeSize == 2 && b.shapeSize == 2);                                                                   \
+        int64_t shape[2] = {a.shape[0], b.shape[1]};                                                                     \
+        w_NDArray_initShape(T)(this, shape, 2);                                                                          \
+        w_NDArrayView_matmul(T)(w_NDArray_view(T)(this), a, b, threadCount);                                             \
+    }
+
+// 矩阵转置并行任务
+#define w_transposeTask_(T) w_concat(w_transposeTask_, T)
+#define w_transposeTask_define_(T)                                                               \
+    /**                                                                                          \
+     * 矩阵转置并行任务，计算结果的 [begin, end) 行                               \
+     * @param context 上下文（out 为连续的结果，a 为已转置的输入视图）      \
+     * @param begin 起始行                                                                    \
+     * @param end 结束行（不包含）                                                       \
+     * @return void                                                                              \
+     */                                                                                          \
+    static inline void w_transposeTask_(T)(void *context, int64_t begin, int64_t end)            \
+    {                                                                                            \
+        w_MatrixContext_(T) *matrix = context;                                                   \
+        T *data = matrix->out.elementData + matrix->out.offset + begin * matrix->out.strides[0]; \
+        w_NDArrayView_copyTo_(T)(w_NDArrayView_slice(T)(matrix->a, 0, begin, end, 1), data);     \
+    }
+
+// 多维数组矩阵转置
+#define w_NDArray_transpose2D(T) w_concat(w_NDArray(T), _transpose2D)
+#define w_NDArray_transpose2D_define_(T)                                                                  \
+    /**                                                                                                   \
+     * 多维数组矩阵转置 this = a^T，分块复制，结果按行分段并行计算                \
+     * @param this 未初始化的多维数组（使用后需要调用 w_NDArray_deinit）                \
+     * @param a 视图 a（m x n）                                                                       \
+     * @param threadCount 线程数（<= 0 时使用默认线程数，1 为单线程）                   \
+     * @return void                                                                                       \
+     */                                                                                                   \
+    static inline void w_NDArray_transpose2D(T)(w_NDArray(T) * this, w_NDArrayView(T) a, int threadCount) \
+    {                                                                                                     \
+        w_check(a.shapeSize == 2);                                                                        \
+        int64_t shape[2] = {a.shape[1], a.shape[0]};                                                      \
+        w_NDArray_initShape(T)(this, shape, 2);                                                           \
+        /* 小矩阵不值得启动线程 */                                                                        \
+        if (this->size < (1 << 16))                                                                       \
+        {                                                                                                 \
+            threadCount = 1;                                                                              \
+        }                                                                                                 \
+        w_MatrixContext_(T) context = {w_NDArray_view(T)(this), w_NDArrayView_transpose(T)(a), a};        \
+        w_parallelFor_(shape[0], threadCount, w_transposeTask_(T), &context);                             \
+    }
+
+// 矩阵运算定义
+// 需要先定义 w_NDArray_define(T) 和 w_NDArrayView_define(T)，T 必须是数字类型（bool 除外），主要用于 float 和 double
+#define w_NDArray_matrix_define(T)   \
+    w_gemmKernel_define_(T);         \
+    w_gemmPackA_define_(T);          \
+    w_gemmPackB_define_(T);          \
+    w_gemm_define_(T);               \
+    w_MatrixContext_type_define_(T); \
+    w_matmulTask_define_(T);         \
+    w_NDArrayView_matmul_define_(T); \
+    w_NDArray_matmul_define_(T);     \
+    w_transposeTask_define_(T);      \
+    w_NDArray_transpose2D_define_(T);
+
+// ========================================================================================================================================================
+//  多维数组归约
+// ========================================================================================================================================================
+
+// 归约运算
+#define w_NDREDUCE_SUM 1    // 求和（扫描时为累加）
+#define w_NDREDUCE_PROD 2   // 求积（扫描时为累乘）
+#define w_NDREDUCE_MIN 3    // 最小值
+#define w_NDREDUCE_MAX 4    // 最大值
+#define w_NDREDUCE_MEAN 5   // 平均值
+#define w_NDREDUCE_VAR 6    // 方差（总体方差）
+#define w_NDREDUCE_ARGMIN 7 // 第一个最小值的索引
+#define w_NDREDUCE_ARGMAX 8 // 第一个最大值的索引
+
+// 归约运算是否需要非空输入
+#define w_NDREDUCE_needsElements_(op) ((op) != w_NDREDUCE_SUM && (op) != w_NDREDUCE_PROD)
+
+// 归约运算是否输出索引
+#define w_NDREDUCE_isArg_(op) ((op) == w_NDREDUCE_ARGMIN || (op) == w_NDREDUCE_ARGMAX)
+
+// 两两求和的叶子大小（叶子内部使用向量化求和）
+#define w_NDREDUCE_PAIRWISE_BLOCK_ 1024
+
+// 按列归约时每次处理的列数（累加器保持在 L1 缓存中）
+#define w_NDREDUCE_CHUNK_ 256
+
+// 元素数量低于该值时不启动线程
+#define w_NDREDUCE_PARALLEL_CUTOFF_ 65536
+
+// 两两求和
+#define w_NDArray_pairwiseSum_(T) w_concat(w_NDArray(T), _pairwiseSum_)
+#define w_NDArray_pairwiseSum_define_(T)                                                                    \
+    /**                                                                                                     \
+     * 两两求和（误差随元素数量对数增长，叶子使用向量化求和）                    \
+     * @param data 数据（连续）                                                                       \
+     * @param size 元素数量                                                                             \
+     * @return w_SumType_(T) 和                                                                            \
+     */                                                                                                     \
+    static inline w_SumType_(T) w_NDArray_pairwiseSum_(T)(const T *data, int64_t size)                      \
+    {                                                                                                       \
+        if (size <= w_NDREDUCE_PAIRWISE_BLOCK_)                                                             \
+        {                                                                                                   \
+            return w_sum(T)(data, size);                                                                    \
+        }                                                                                                   \
+        int64_t half = size / 2;                                                                            \
+        return w_NDArray_pairwiseSum_(T)(data, half) + w_NDArray_pairwiseSum_(T)(data + half, size - half); \
+    }
+
+// 均值和偏差平方和
+#define w_NDArray_moments_(T) w_concat(w_NDArray(T), _moments_)
+#define w_NDArray_moments_define_(T)                                                                    \
+    /**                                                                                                 \
+     * 两遍计算均值和偏差平方和                                                             \
+     * @param data 数据                                                                               \
+     * @param size 元素数量（必须大于 0）                                                     \
+     * @param stride 步长                                                                             \
+     * @param m2 偏差平方和                                                                        \
+     * @return double 均值                                                                            \
+     */                                                                                                 \
+    static inline double w_NDArray_moments_(T)(const T *data, int64_t size, int64_t stride, double *m2) \
+    {                                                                                                   \
+        double mean;                                                                                    \
+        if (stride == 1)                                                                                \
+        {                                                                                               \
+            mean = (double)w_NDArray_pairwiseSum_(T)(data, size) / size;                                \
+        }                                                                                               \
+        else                                                                                            \
+        {                                                                                               \
+            double sum = 0;                                                                             \
+            for (int64_t i = 0; i < size; i++)                                                          \
+            {                                                                                           \
+                sum += (double)data[i * stride];                                                        \
+            }                                                                                           \
+            mean = sum / size;                                                                          \
+        }                                                                                               \
+        double squares = 0;                                                                             \
+        for (int64_t i = 0; i < size; i++)                                                              \
+        {                                                                                               \
+            double deviation = (double)data[i * stride] - mean;                                         \
+            squares += deviation * deviation;                                                           \
+        }                                                                                               \
+        *m2 = squares;                                                                                  \
+        return mean;                                                                                    \
+    }
+
+// 归约一段
+#define w_NDArray_reduceRun_(T) w_concat(w_NDArray(T), _reduceRun_)
+#define w_NDArray_reduceRun_define_(T)                                                                               \
+    /**                                                                                                              \
+     * 归约一段跨步数据（连续时使用向量化内核）                                                  \
+     * @param op 归约运算                                                                                        \
+     * @param data 数据                                                                                            \
+     * @param size 元素数量                                                                                      \
+     * @param stride 步长                                                                                          \
+     * @param index 索引运算的结果                                                                            \
+     * @return T 结果（索引运算时为对应的元素）                                                       \
+     */                                                                                                              \
+    static inline T w_NDArray_reduceRun_(T)(int32_t op, const T *data, int64_t size, int64_t stride, int64_t *index) \
+    {                                                                                                                \
+        switch (op)                                                                                                  \
+        {                                                                                                            \
+        case w_NDREDUCE_SUM:                                                                                         \
+        case w_NDREDUCE_MEAN:                                                                                        \
+        {                                                                                                            \
+            w_SumType_(T) sum = 0;                                                                                   \
+            if (stride == 1)                                                                                         \
+            {                                                                                                        \
+                sum = w_NDArray_pairwiseSum_(T)(data, size);                                                         \
+            }                                                                                                        \
+            else                                                                                                     \
+            {                                                                                                        \
+                for (int64_t i = 0; i < size; i++)                                                                   \
+                {                                                                                                    \
+                    sum += data[i * stride];                                                                         \
+                }                                                                                                    \
+            }                                                                                                        \
+            return op == w_NDREDUCE_SUM ? (T)sum : (T)((double)sum / size);                                          \
+        }                                                                                                            \
+        case w_NDREDUCE_PROD:                                                                                        \
+        {                                                                                                            \
+            w_SumType_(T) product = 1;                                                                               \
+            for (int64_t i = 0; i < size; i++)                                                                       \
+            {                                                                                                        \
+                product *= data[i * stride];                                                                         \
+            }                                                                                                        \
+            return (T)product;                                                                                       \
+        }                                                                                                            \
+        case w_NDREDUCE_VAR:                                                                                         \
+        {                                                                                                            \
+            double m2;                                                                                               \
+            w_NDArray_moments_(T)(data, size, stride, &m2);                                                          \
+            return (T)(m2 / size);                                                                                   \
+        }                                                                                                            \
+        case w_NDREDUCE_MIN:                                                                                         \
+        case w_NDREDUCE_MAX:                                                                                         \
+        case w_NDREDUCE_ARGMIN:                                                                                      \
+        case w_NDREDUCE_ARGMAX:                                                                                      \
+        {                                                                                                            \
+            bool isMin = op == w_NDREDUCE_MIN || op == w_NDREDUCE_ARGMIN;                                            \
+            int64_t best = 0;                                                                                        \
+            if (stride == 1)                                                                                         \
+            {                                                                                                        \
+                if (op == w_NDREDUCE_MIN)                                                                            \
+                {                                                                                                    \
+                    return w_min(T)(data, size);                                                                     \
+                }                                                                                                    \
+                if (op == w_NDREDUCE_MAX)                                                                            \
+                {                                                                                                    \
+                    return w_max(T)(data, size);                                                                     \
+                }                                                                                                    \
+                best = isMin ? w_argmin(T)(data, size) : w_argmax(T)(data, size);                                    \
+            }                                                                                                        \
+            else                                                                                                     \
+            {                                                                                                        \
+                for (int64_t i = 1; i < size; i++)                                                                   \
+                {                                                                                                    \
+                    T value = data[i * stride];                                                                      \
+                    if (isMin ? value < data[best * stride] : value > data[best * stride])                           \
+                    {                                                                                                \
+                        best = i;                                                                                    \
+                    }                                                                                                \
+                }                                                                                                    \
+            }                                                                                                        \
+            *index = best;                                                                                           \
+            return data[best * stride];                                                                              \
+        }                                                                                                            \
+        default:                                                                                                     \
+            w_assert(false);                                                                                         \
+            return 0;                                                                                                \
+        }                                                                                                            \
+    }
+
+// 按列归约
+#define w_NDArray_reduceRows_(T) w_concat(w_NDArray(T), _reduceRows_)
+#define w_NDArray_reduceRows_define_(T)                                                                                                    \
+    /**                                                                                                                                    \
+     * 按列归约多行连续数据（逐行顺序访问内存，浮点数求和使用 Kahan 补偿）                                   \
+     * @param op 归约运算                                                                                                              \
+     * @param data 第一行的起始地址                                                                                                \
+     * @param rows 行数                                                                                                                  \
+     * @param rowStride 行步长                                                                                                          \
+     * @param cols 列数（不超过 w_NDREDUCE_CHUNK_）                                                                                 \
+     * @param out 结果（索引运算时不使用）                                                                                     \
+     * @param outStride 结果步长                                                                                                       \
+     * @param indices 索引运算的结果（连续）                                                                                    \
+     * @return void                                                                                                                        \
+     */                                                                                                                                    \
+    static inline w_SIMD_DISPATCH_ void w_NDArray_reduceRows_(T)(int32_t op, const T *data, int64_t rows, int64_t rowStride, int64_t cols, \
+                                                                 T *out, int64_t outStride, int64_t *indices)                              \
+    {                                                                                                                                      \
+        const int64_t lanes = w_Vector_lanes_(T);                                                                                          \
+        switch (op)                                                                                                                        \
+        {                                                                                                                                  \
+        case w_NDREDUCE_SUM:                                                                                                               \
+        case w_NDREDUCE_MEAN:                                                                                                              \
+        case w_NDREDUCE_VAR:                                                                                                               \
+        {                                                                                                                                  \
+            const bool compensate = (w_SumType_(T))0.5 != 0;                                                                               \
+            w_SumType_(T) sum[w_NDREDUCE_CHUNK_] = {0};                                                                                    \
+            w_SumType_(T) error[w_NDREDUCE_CHUNK_] = {0};                                                                                  \
+            for (int64_t i = 0; i < rows; i++)                                                                                             \
+            {                                                                                                                              \
+                const T *row = data + i * rowStride;                                                                                       \
+                int64_t j = 0;                                                                                                             \
+                for (; j + lanes <= cols; j += lanes)                                                                                      \
+                {                                                                                                                          \
+                    w_Vector_(T) v;                                                                                                        \
+                    w_SumVector_(T) s, e;                                                                                                  \
+                    memcpy(&v, row + j, sizeof(v));                                                                                        \
+                    memcpy(&s, sum + j, sizeof(s));                                                                                        \
+                    w_SumVector_(T) y = __builtin_convertvector(v, w_SumVector_(T));                                                       \
+                    if (compensate)                                                                                                        \
+                    {                                                                                                                      \
+                        memcpy(&e, error + j, sizeof(e));                                                                                  \
+                        y -= e;                                                                                                            \
+                        w_SumVector_(T) t = s + y;                                                                                         \
+                        e = (t - s) - y;                                                                                                   \
+                        s = t;                                                                                                             \
+                        memcpy(error + j, &e, sizeof(e));                                                                                  \
+                    }                                                                                                                      \
+                    else                                                                                                                   \
+                    {                                                                                                                      \
+                        s += y;                                                                                                            \
+                    }                                                                                                                      \
+                    memcpy(sum + j, &s, sizeof(s));                                                                                        \
+                }                                                                                                                          \
+                for (; j < cols; j++)                                                                                                      \
+                {                                                                                                                          \
+                    w_SumType_(T) y = (w_SumType_(T))row[j] - error[j];                                                                    \
+                    w_SumType_(T) t = sum[j] + y;                                                                                          \
+                    error[j] = compensate ? (t - sum[j]) - y : 0;                                                                          \
+                    sum[j] = t;                                                                                                            \
+                }                                                                                                                          \
+            }                                                                                                                              \
+            if (op == w_NDREDUCE_SUM)                                                                                                      \
+            {                                                                                                                              \
+                for (int64_t j = 0; j < cols; j++)                                                                                         \
+                {                                                                                                                          \
+                    out[j * outStride] = (T)sum[j];                                                                                        \
+                }                                                                                                                          \
+                break;                                                                                                                     \
+            }                                                                                                                              \
+            double mean[w_NDREDUCE_CHUNK_];                                                                                                \
+            for (int64_t j = 0; j < cols; j++)                                                                                             \
+            {                                                                                                                              \
+                mean[j] = (double)sum[j] / rows;                                                                                           \
+            }                                                                                                                              \
+            if (op == w_NDREDUCE_MEAN)                                                                                                     \
+            {                                                                                                                              \
+                for (int64_t j = 0; j < cols; j++)                                                                                         \
+                {                                                                                                                          \
+                    out[j * outStride] = (T)mean[j];                                                                                       \
+                }                                                                                                                          \
+                break;                                                                                                                     \
+            }                                                                                                                              \
+            /* 方差：第二遍累加偏差平方 */                                                                                                 \
+            double squares[w_NDREDUCE_CHUNK_] = {0};                                                                                       \
+            for (int64_t i = 0; i < rows; i++)                                                                                             \
+            {                                                                                                                              \
+                const T *row = data + i * rowStride;                                                                                       \
+                for (int64_t j = 0; j < cols; j++)                                                                                         \
+                {                                                                                                                          \
+                    double deviation = (double)row[j] - mean[j];                                                                           \
+                    squares[j] += deviation * deviation;                                                                                   \
+                }                                                                                                                          \
+            }                                                                                                                              \
+            for (int64_t j = 0; j < cols; j++)                                                                                             \
+            {                                                                                                                              \
+                out[j * outStride] = (T)(squares[j] / rows);                                                                               \
+            }                                                                                                                              \
+            break;                                                                                                                         \
+        }                                                                                                                                  \
+        case w_NDREDUCE_PROD:                                                                                                              \
+        {                                                                                                                                  \
+            w_SumType_(T) product[w_NDREDUCE_CHUNK_];                                                                                      \
+            for (int64_t j = 0; j < cols; j++)                                                                                             \
+            {                                                                                                                              \
+                product[j] = 1;                                                                                                            \
+            }                                                                                                                              \
+            for (int64_t i = 0; i < rows; i++)                                                                                             \
+            {                                                                                                                              \
+                const T *row = data + i * rowStride;                                                                                       \
+                for (int64_t j = 0; j < cols; j++)                                                                                         \
+                {                                                                                                                          \
+                    product[j] *= row[j];                                                                                                  \
+                }                                                                                                                          \
+            }                                                                                                                              \
+            for (int64_t j = 0; j < cols; j++)                                                                                             \
+            {                                                                                                                              \
+                out[j * outStride] = (T)product[j];                                                                                        \
+            }                                                                                                                              \
+            break;                                                                                                                         \
+        }                                                                                                                                  \
+        case w_NDREDUCE_MIN:                                                                                                               \
+        case w_NDREDUCE_MAX:                                                                                                               \
+        case w_NDREDUCE_ARGMIN:                                                                                                            \
+        case w_NDREDUCE_ARGMAX:                                                                                                            \
+        {                                                                                                                                  \
+            bool isMin = op == w_NDREDUCE_MIN || op == w_NDREDUCE_ARGMIN;                                                                  \
+            T best[w_NDREDUCE_CHUNK_];                                                                                                     \
+            int64_t bestIndex[w_NDREDUCE_CHUNK_] = {0};                                                                                    \
+            memcpy(best, data, sizeof(T) * cols);                                                                                          \
+            for (int64_t i = 1; i < rows; i++)                                                                                             \
+            {                                                                                                                              \
+                const T *row = data + i * rowStride;                                                                                       \
+                for (int64_t j = 0; j < cols; j++)                                                                                         \
+                {                                                                                                                          \
+                    bool better = isMin ? row[j] < best[j] : row[j] > best[j];                                                             \
+                    best[j] = better ? row[j] : best[j];                                                                                   \
+                    bestIndex[j] = better ? i : bestIndex[j];                                                                              \
+                }                                                                                                                          \
+            }                                                                                                                              \
+            for (int64_t j = 0; j < cols; j++)                                                                                             \
+            {                                                                                                                              \
+                if (w_NDREDUCE_isArg_(op))                                                                                                 \
+                {                                                                                                                          \
+                    indices[j] = bestIndex[j];                                                                                             \
+                }                                                                                                                          \
+                else                                                                                                                       \
+                {                                                                                                                          \
+                    out[j * outStride] = best[j];                                                                                          \
+                }                                                                                                                          \
+            }                                                                                                                              \
+            break;                                                                                                                         \
+        }                                                                                                                                  \
+        default:                                                                                                                           \
+            w_assert(false);                                                                                                               \
+        }                                                                                                                                  \
+    }
+
+// 多维数组归约上下文
+#define w_NDArrayReduceContext_(T) w_concat(w_NDArrayReduceContext_, T)
+#define w_NDArrayReduceContext_type_define_(T)                                               \
+    typedef struct                                                                           \
+    {                                                                                        \
+        int32_t op;                                  /* 归约运算 */                          \
+        const T *data;                               /* 输入起始地址 */                      \
+        T *out;                                      /* 结果起始地址（索引运算时为 NULL） */ \
+        int64_t *indices;                            /* 索引结果（按 C 顺序连续存放） */     \
+        int64_t others;                              /* 保留的维数 */                        \
+        int64_t shape[w_NDARRAY_MAX_RANK];           /* 保留维度的形状 */                    \
+        int64_t strides[w_NDARRAY_MAX_RANK];         /* 保留维度在输入中的步长 */            \
+        int64_t outStrides[w_NDARRAY_MAX_RANK];      /* 保留维度在结果中的步长 */            \
+        int64_t size;                                /* 归约维度的长度 */                    \
+        int64_t stride;                              /* 归约维度的步长 */                    \
+        int64_t cols;                                /* 最内层保留维度的长度 */              \
+        int64_t chunks;                              /* 最内层保留维度的分段数 */            \
+    } w_NDArrayReduceContext_(T);
+
+// 多维数组归约任务
+#define w_NDArray_reduceTask_(T) w_concat(w_NDArray(T), _reduceTask_)
+#define w_NDArray_reduceTask_define_(T)                                                                                        \
+    /**                                                                                                                        \
+     * 多维数组归约任务，每个单元为最内层保留维度的一段                                                \
+     * @param context 上下文                                                                                                \
+     * @param begin 起始单元                                                                                               \
+     * @param end 结束单元（不包含）                                                                                  \
+     * @return void                                                                                                            \
+     */                                                                                                                        \
+    static inline void w_NDArray_reduceTask_(T)(void *context, int64_t begin, int64_t end)                                     \
+    {                                                                                                                          \
+        w_NDArrayReduceContext_(T) *reduce = context;                                                                          \
+        int64_t last = reduce->others - 1;                                                                                     \
+        int64_t colStride = last >= 0 ? reduce->strides[last] : 0;                                                             \
+        int64_t outColStride = last >= 0 ? reduce->outStrides[last] : 0;                                                       \
+        for (int64_t unit = begin; unit < end; unit++)                                                                         \
+        {                                                                                                                      \
+            int64_t outer = unit / reduce->chunks;                                                                             \
+            int64_t col = unit % reduce->chunks * w_NDREDUCE_CHUNK_;                                                           \
+            int64_t cols = reduce->cols - col < w_NDREDUCE_CHUNK_ ? reduce->cols - col : w_NDREDUCE_CHUNK_;                    \
+                                                                                                                               \
+            /* 外层保留维度的位置 */                                                                                           \
+            const T *data = reduce->data + col * colStride;                                                                    \
+            T *out = reduce->out != NULL ? reduce->out + col * outColStride : NULL;                                            \
+            int64_t *indices = reduce->indices != NULL ? reduce->indices + outer * reduce->cols + col : NULL;                  \
+            for (int64_t d = last - 1, rest = outer; d >= 0; d--)                                                              \
+            {                                                                                                                  \
+                int64_t index = rest % reduce->shape[d];                                                                       \
+                rest /= reduce->shape[d];                                                                                      \
+                data += index * reduce->strides[d];                                                                            \
+                out = out != NULL ? out + index * reduce->outStrides[d] : NULL;                                                \
+            }                                                                                                                  \
+                                                                                                                               \
+            if (reduce->stride == 1 || colStride != 1)                                                                         \
+            { /* 归约维度连续（或各维度都不连续），逐段归约 */                                                                 \
+                for (int64_t j = 0; j < cols; j++)                                                                             \
+                {                                                                                                              \
+                    int64_t index = 0;                                                                                         \
+                    T value = w_NDArray_reduceRun_(T)(reduce->op, data + j * colStride, reduce->size, reduce->stride, &index); \
+                    if (indices != NULL)                                                                                       \
+                    {                                                                                                          \
+                        indices[j] = index;                                                                                    \
+                    }                                                                                                          \
+                    else                                                                                                       \
+                    {                                                                                                          \
+                        out[j * outColStride] = value;                                                                         \
+                    }                                                                                                          \
+                }                                                                                                              \
+            }                                                                                                                  \
+            else                                                                                                               \
+            { /* 保留维度连续，逐行按列归约 */                                                                                 \
+                w_NDArray_reduceRows_(T)(reduce->op, data, reduce->size, reduce->stride, cols, out, outColStride, indices);    \
+            }                                                                                                                  \
+        }                                                                                                                      \
+    }
+
+// 多维数组沿维度归约
+#define w_NDArray_reduceAxis_(T) w_concat(w_NDArray(T), _reduceAxis_)
+#define w_NDArray_reduceAxis_define_(T)                                                                                                                \
+    /**                                                                                                                                                \
+     * 多维数组沿维度归约                                                                                                                     \
+     * @param op 归约运算                                                                                                                          \
+     * @param out 结果视图（索引运算时不使用）                                                                                           \
+     * @param indices 索引结果（非索引运算时为 NULL）                                                                                     \
+     * @param a 输入视图                                                                                                                           \
+     * @param axis 归约的维度                                                                                                                     \
+     * @param threadCount 线程数（<= 0 时使用默认线程数，1 为单线程）                                                                \
+     * @return void                                                                                                                                    \
+     */                                                                                                                                                \
+    static inline void w_NDArray_reduceAxis_(T)(int32_t op, w_NDArrayView(T) out, int64_t *indices, w_NDArrayView(T) a, int64_t axis, int threadCount) \
+    {                                                                                                                                                  \
+        w_check(axis >= 0 && axis < a.shapeSize);                                                                                                      \
+        w_check(a.shape[axis] > 0 || !w_NDREDUCE_needsElements_(op));                                                                                  \
+        w_NDArrayReduceContext_(T) context;                                                                                                            \
+        context.op = op;                                                                                                                               \
+        context.data = a.elementData + a.offset;                                                                                                       \
+        context.out = indices == NULL ? out.elementData + out.offset : NULL;                                                                           \
+        context.indices = indices;                                                                                                                     \
+        context.size = a.shape[axis];                                                                                                                  \
+        context.stride = a.strides[axis];                                                                                                              \
+        context.others = 0;                                                                                                                            \
+        for (int64_t d = 0; d < a.shapeSize; d++)                                                                                                      \
+        {                                                                                                                                              \
+            if (d != axis)                                                                                                                             \
+            {                                                                                                                                          \
+                context.shape[context.others] = a.shape[d];                                                                                            \
+                context.strides[context.others] = a.strides[d];                                                                                        \
+                context.others++;                                                                                                                      \
+            }                                                                                                                                          \
+        }                                                                                                                                              \
+        if (indices == NULL)                                                                                                                           \
+        {                                                                                                                                              \
+            /* 一维输入归约为只有一个元素的结果 */                                                                                                     \
+            w_check(out.shapeSize == (context.others > 0 ? context.others : 1));                                                                       \
+            for (int64_t d = 0; d < context.others; d++)                                                                                               \
+            {                                                                                                                                          \
+                w_check(out.shape[d] == context.shape[d]);                                                                                             \
+                context.outStrides[d] = out.strides[d];                                                                                                \
+            }                                                                                                                                          \
+            w_check(context.others > 0 || out.shape[0] == 1);                                                                                          \
+        }                                                                                                                                              \
+                                                                                                                                                       \
+        /* 按最内层保留维度分段，作为并行单元 */                                                                                                       \
+        int64_t outer = 1;                                                                                                                             \
+        for (int64_t d = 0; d < context.others - 1; d++)                                                                                               \
+        {                                                                                                                                              \
+            outer *= context.shape[d];                                                                                                                 \
+        }                                                                                                                                              \
+        context.cols = context.others > 0 ? context.shape[context.others - 1] : 1;                                                                     \
+        context.chunks = (context.cols + w_NDREDUCE_CHUNK_ - 1) / w_NDREDUCE_CHUNK_;                                                                   \
+        if (w_NDArrayView_size(T)(a) < w_NDREDUCE_PARALLEL_CUTOFF_)                                                                                    \
+        {                                                                                                                                              \
+            threadCount = 1;                                                                                                                           \
+        }                                                                                                                                              \
+        w_parallelFor_(outer * context.chunks, threadCount, w_NDArray_reduceTask_(T), &context);                                                       \
+    }
+
+// 多维数组归约结果初始化
+#define w_NDArray_initReduce(T) w_concat(w_NDArray(T), _initReduce)
+#define w_NDArray_initReduce_define_(T)                                                                                \
+    /**                                                                                                                \
+     * 多维数组按归约后的形状初始化（去掉归约的维度，一维输入的结果只有一个元素） \
+     * @param this 多维数组                                                                                        \
+     * @param a 输入视图                                                                                           \
+     * @param axis 归约的维度                                                                                     \
+     * @return void                                                                                                    \
+     */                                                                                                                \
+    static inline void w_NDArray_initReduce(T)(w_NDArray(T) * this, w_NDArrayView(T) a, int64_t axis)                  \
+    {                                                                                                                  \
+        w_check(axis >= 0 && axis < a.shapeSize);                                                                      \
+        int64_t shape[w_NDARRAY_MAX_RANK] = {1};                                                                       \
+        int64_t shapeSize = 0;                                                                                         \
+        for (int64_t d = 0; d < a.shapeSize; d++)                                                                      \
+        {                                                                                                              \
+            if (d != axis)                                                                                             \
+            {                                                                                                          \
+                shape[shapeSize++] = a.shape[d];                                                                       \
+            }                                                                                                          \
+        }                                                                                                              \
+        w_NDArray_initShape(T)(this, shape, shapeSize > 0 ? shapeSize : 1);                                            \
+    }
+
+// 多维数组视图沿维度归约
+#define w_NDArrayView_reduce(T) w_concat(w_NDArrayView(T), _reduce)
+#define w_NDArrayView_reduce_define_(T)                                                                                                           \
+    /**                                                                                                                                           \
+     * 多维数组视图沿维度归约，大数组多线程计算                                                                               \
+     * 整数求和、求积累加到 64 位整数，浮点数累加到 double；连续数据两两求和，跨行按列求和使用 Kahan 补偿 \
+     * @param op 归约运算（w_NDREDUCE_SUM ~ w_NDREDUCE_VAR）                                                                                \
+     * @param out 结果视图（形状为去掉 axis 后的形状，可以用 w_NDArray_initReduce 创建）                                     \
+     * @param a 输入视图                                                                                                                      \
+     * @param axis 归约的维度                                                                                                                \
+     * @param threadCount 线程数（<= 0 时使用默认线程数，1 为单线程）                                                           \
+     * @return void                                                                                                                               \
+     */                                                                                                                                           \
+    static inline void w_NDArrayView_reduce(T)(int32_t op, w_NDArrayView(T) out, w_NDArrayView(T) a, int64_t axis, int threadCount)               \
+    {                                                                                                                                             \
+        w_check(op >= w_NDREDUCE_SUM && op <= w_NDREDUCE_VAR);                                                                                    \
+        w_NDArray_reduceAxis_(T)(op, out, NULL, a, axis, threadCount);                                                                            \
+    }
+
+// 多维数组视图沿维度求索引
+#define w_NDArrayView_argReduce(T) w_concat(w_NDArrayView(T), _argReduce)
+#define w_NDArrayView_argReduce_define_(T)                                                                                          \
+    /**                                                                                                                             \
+     * 多维数组视图沿维度求第一个最小值 / 最大值的索引，大数组多线程计算                             \
+     * @param op 归约运算（w_NDREDUCE_ARGMIN、w_NDREDUCE_ARGMAX）                                                            \
+     * @param indices 结果（按去掉 axis 后的形状以 C 顺序存放）                                                     \
+     * @param a 输入视图                                                                                                        \
+     * @param axis 归约的维度                                                                                                  \
+     * @param threadCount 线程数（<= 0 时使用默认线程数，1 为单线程）                                             \
+     * @return void                                                                                                                 \
+     */                                                                                                                             \
+    static inline void w_NDArrayView_argReduce(T)(int32_t op, int64_t * indices, w_NDArrayView(T) a, int64_t axis, int threadCount) \
+    {                                                                                                                               \
+        w_check(w_NDREDUCE_isArg_(op));                                                                                             \
+        w_check(indices != NULL);                                                                                                   \
+        w_NDArray_reduceAxis_(T)(op, a, indices, a, axis, threadCount);                                                             \
+    }
+
+// 多维数组分段归约结果
+#define w_NDArrayReducePart_(T) w_concat(w_NDArrayReducePart_, T)
+#define w_NDArrayReducePart_type_define_(T)           \
+    typedef struct                                    \
+    {                                                 \
+        w_SumType_(T) sum; /* 和或积 */               \
+        T value;           /* 最小值或最大值 */       \
+        int64_t index;     /* 最小值或最大值的索引 */ \
+        double mean;       /* 均值 */                 \
+        double m2;         /* 偏差平方和 */           \
+    } w_NDArrayReducePart_(T);
+
+// 多维数组整体归约上下文
+#define w_NDArrayReduceAllContext_(T) w_concat(w_NDArrayReduceAllContext_, T)
+#define w_NDArrayReduceAllContext_type_define_(T)             \
+    typedef struct                                            \
+    {                                                         \
+        int32_t op;                        /* 归约运算 */     \
+        const T *data;                     /* 数据（连续） */ \
+        int64_t size;                      /* 元素数量 */     \
+        int64_t parts;                     /* 分段数 */       \
+        w_NDArrayReducePart_(T) *results;  /* 分段结果 */     \
+    } w_NDArrayReduceAllContext_(T);
+
+// 多维数组整体归约任务
+#define w_NDArray_reduceAllTask_(T) w_concat(w_NDArray(T), _reduceAllTask_)
+#define w_NDArray_reduceAllTask_define_(T)                                                                \
+    /**                                                                                                   \
+     * 多维数组整体归约任务，计算 [begin, end) 段的结果                                  \
+     * @param context 上下文                                                                           \
+     * @param begin 起始段                                                                             \
+     * @param end 结束段（不包含）                                                                \
+     * @return void                                                                                       \
+     */                                                                                                   \
+    static inline void w_NDArray_reduceAllTask_(T)(void *context, int64_t begin, int64_t end)             \
+    {                                                                                                     \
+        w_NDArrayReduceAllContext_(T) *reduce = context;                                                  \
+        for (int64_t part = begin; part < end; part++)                                                    \
+        {                                                                                                 \
+            int64_t low = reduce->size * part / reduce->parts;                                            \
+            int64_t high = reduce->size * (part + 1) / reduce->parts;                                     \
+            const T *data = reduce->data + low;                                                           \
+            w_NDArrayReducePart_(T) *result = &reduce->results[part];                                     \
+            switch (reduce->op)                                                                           \
+            {                                                                                             \
+            case w_NDREDUCE_SUM:                                                                          \
+            case w_NDREDUCE_MEAN:                                                                         \
+                result->sum = w_NDArray_pairwiseSum_(T)(data, high - low);                                \
+                break;                                                                                    \
+            case w_NDREDUCE_PROD:                                                                         \
+                result->sum = 1;                                                                          \
+                for (int64_t i = 0; i < high - low; i++)                                                  \
+                {                                                                                         \
+                    result->sum *= data[i];                                                               \
+                }                                                                                         \
+                break;                                                                                    \
+            case w_NDREDUCE_VAR:                                                                          \
+                result->mean = w_NDArray_moments_(T)(data, high - low, 1, &result->m2);                   \
+                break;                                                                                    \
+            default:                                                                                      \
+                result->value = w_NDArray_reduceRun_(T)(reduce->op, data, high - low, 1, &result->index); \
+                result->index += low;                                                                     \
+            }                                                                                             \
+        }                                                                                                 \
+    }
+
+// 多维数组整体归约
+#define w_NDArray_reduceAll_(T) w_concat(w_NDArray(T), _reduceAll_)
+#define w_NDArray_reduceAll_define_(T)                                                                            \
+    /**                                                                                                           \
+     * 多维数组整体归约，按段多线程计算后合并                                                  \
+     * @param op 归约运算                                                                                     \
+     * @param a 输入视图（不连续时先复制为连续数组）                                            \
+     * @param threadCount 线程数（<= 0 时使用默认线程数，1 为单线程）                           \
+     * @param index 索引运算的结果（按 C 顺序的线性索引）                                        \
+     * @return double 结果                                                                                      \
+     */                                                                                                           \
+    static inline double w_NDArray_reduceAll_(T)(int32_t op, w_NDArrayView(T) a, int threadCount, int64_t *index) \
+    {                                                                                                             \
+        int64_t size = w_NDArrayView_size(T)(a);                                                                  \
+        w_check(size > 0 || !w_NDREDUCE_needsElements_(op));                                                      \
+        w_NDArray(T) copy;                                                                                        \
+        bool copied = !w_NDArrayView_isContiguous(T)(a);                                                          \
+        if (copied)                                                                                               \
+        {                                                                                                         \
+            w_NDArrayView_contiguous(T)(a, &copy);                                                                \
+        }                                                                                                         \
+        w_NDArrayReduceAllContext_(T) context;                                                                    \
+        context.op = op;                                                                                          \
+        context.data = copied ? copy.elementData : a.elementData + a.offset;                                      \
+        context.size = size;                                                                                      \
+        if (threadCount <= 0)                                                                                     \
+        {                                                                                                         \
+            threadCount = w_defaultThreadCount();                                                                 \
+        }                                                                                                         \
+        context.parts = size < w_NDREDUCE_PARALLEL_CUTOFF_ || size < threadCount ? 1 : threadCount;               \
+        context.results = w_malloc(sizeof(w_NDArrayReducePart_(T)) * context.parts);                              \
+        w_assert(context.results != NULL);                                                                        \
+        w_parallelFor_(context.parts, threadCount, w_NDArray_reduceAllTask_(T), &context);                        \
+                                                                                                                  \
+        /* 合并各段结果 */                                                                                        \
+        double result = 0;                                                                                        \
+        w_NDArrayReducePart_(T) *parts = context.results;                                                         \
+        switch (op)                                                                                               \
+        {                                                                                                         \
+        case w_NDREDUCE_SUM:                                                                                      \
+        case w_NDREDUCE_MEAN:                                                                                     \
+        case w_NDREDUCE_PROD:                                                                                     \
+        {                                                                                                         \
+            w_SumType_(T) total = parts[0].sum;                                                                   \
+            for (int64_t i = 1; i < context.parts; i++)                                                           \
+            {                                                                                                     \
+                total = op == w_NDREDUCE_PROD ? total * parts[i].sum : total + parts[i].sum;                      \
+            }                                                                                                     \
+            result = op == w_NDREDUCE_MEAN ? (double)total / size : (double)total;                                \
+            break;                                                                                                \
+        }                                                                                                         \
+        case w_NDREDUCE_VAR:                                                                                      \
+        { /* 按各段的元素数量合并均值和偏差平方和 */                                                              \
+            double mean = 0, m2 = 0;                                                                              \
+            for (int64_t i = 0; i < context.parts; i++)                                                           \
+            {                                                                                                     \
+                mean += parts[i].mean * (double)(size * (i + 1) / context.parts - size * i / context.parts);      \
+            }                                                                                                     \
+            mean /= size;                                                                                         \
+            for (int64_t i = 0; i < context.parts; i++)                                                           \
+            {                                                                                                     \
+                double count = (double)(size * (i + 1) / context.parts - size * i / context.parts);               \
+                m2 += parts[i].m2 + count * (parts[i].mean - mean) * (parts[i].mean - mean);                      \
+            }                                                                                                     \
+            result = m2 / size;                                                                                   \
+            break;                                                                                                \
+        }                                                                                                         \
+        default:                                                                                                  \
+        {                                                                                                         \
+            bool isMin = op == w_NDREDUCE_MIN || op == w_NDREDUCE_ARGMIN;                                         \
+            int64_t best = 0;                                                                                     \
+            for (int64_t i = 1; i < context.parts; i++)                                                           \
+            {                                                                                                     \
+                if (isMin ? parts[i].value < parts[best].value : parts[i].value > parts[best].value)              \
+                {                                                                                                 \
+                    best = i;                                                                                     \
+                }                                                                                                 \
+            }                                                                                                     \
+            result = (double)parts[best].value;                                                                   \
+            *index = parts[best].index;                                                                           \
+        }                                                                                                         \
+        }                                                                                                         \
+        w_free(context.results);                                                                                  \
+        if (copied)                                                                                               \
+        {                                                                                                         \
+            w_NDArray_deinit(T)(&copy);                                                                           \
+        }                                                                                                         \
+        return result;                                                                                            \
+    }
+
+// 多维数组视图整体归约
+#define w_NDArrayView_reduceAll(T) w_concat(w_NDArrayView(T), _reduceAll)
+#define w_NDArrayView_reduceAll_define_(T)                                                           \
+    /**                                                                                              \
+     * 多维数组视图归约所有元素，大数组多线程计算                               \
+     * @param op 归约运算（w_NDREDUCE_SUM ~ w_NDREDUCE_VAR）                                   \
+     * @param a 输入视图                                                                         \
+     * @param threadCount 线程数（<= 0 时使用默认线程数，1 为单线程）              \
+     * @return double 结果                                                                         \
+     */                                                                                              \
+    static inline double w_NDArrayView_reduceAll(T)(int32_t op, w_NDArrayView(T) a, int threadCount) \
+    {                                                                                                \
+        w_check(op >= w_NDREDUCE_SUM && op <= w_NDREDUCE_VAR);                                       \
+        int64_t index = 0;                                                                           \
+        return w_NDArray_reduceAll_(T)(op, a, threadCount, &index);                                  \
+    }
+
+// 多维数组视图整体求索引
+#define w_NDArrayView_argReduceAll(T) w_concat(w_NDArrayView(T), _argReduceAll)
+#define w_NDArrayView_argReduceAll_define_(T)                                                                 \
+    /**                                                                                                       \
+     * 多维数组视图求所有元素中第一个最小值 / 最大值的索引，大数组多线程计算 \
+     * @param op 归约运算（w_NDREDUCE_ARGMIN、w_NDREDUCE_ARGMAX）                                      \
+     * @param a 输入视图（不能为空）                                                                \
+     * @param threadCount 线程数（<= 0 时使用默认线程数，1 为单线程）                       \
+     * @return int64_t 按 C 顺序的线性索引                                                            \
+     */                                                                                                       \
+    static inline int64_t w_NDArrayView_argReduceAll(T)(int32_t op, w_NDArrayView(T) a, int threadCount)      \
+    {                                                                                                         \
+        w_check(w_NDREDUCE_isArg_(op));                                                                       \
+        int64_t index = 0;                                                                                    \
+        w_NDArray_reduceAll_(T)(op, a, threadCount, &index);                                                  \
+        return index;                                                                                         \
+    }
+
+// 多维数组视图沿维度扫描
+#define w_NDArrayView_scan(T) w_concat(w_NDArrayView(T), _scan)
+#define w_NDArrayView_scan_define_(T)                                                                                          \
+    /**                                                                                                                        \
+     * 多维数组视图沿维度累加 / 累乘（结果类型为 T）                                                       \
+     * 扫描维度不是最内层时逐层做向量化的逐元素运算，否则逐段顺序扫描                           \
+     * @param op 扫描运算（w_NDREDUCE_SUM、w_NDREDUCE_PROD）                                                            \
+     * @param out 结果视图（形状与 a 相同，可以与 a 相同）                                                    \
+     * @param a 输入视图                                                                                                   \
+     * @param axis 扫描的维度                                                                                             \
+     * @return void                                                                                                            \
+     */                                                                                                                        \
+    static inline void w_NDArrayView_scan(T)(int32_t op, w_NDArrayView(T) out, w_NDArrayView(T) a, int64_t axis)               \
+    {                                                                                                                          \
+        w_check(op == w_NDREDUCE_SUM || op == w_NDREDUCE_PROD);                                                                \
+        w_check(axis >= 0 && axis < a.shapeSize);                                                                              \
+        w_check(out.shapeSize == a.shapeSize);                                                                                 \
+        for (int64_t d = 0; d < a.shapeSize; d++)                                                                              \
+        {                                                                                                                      \
+            w_check(out.shape[d] == a.shape[d]);                                                                               \
+        }                                                                                                                      \
+        int64_t size = a.shape[axis];                                                                                          \
+        if (size == 0 || w_NDArrayView_size(T)(a) == 0)                                                                        \
+        {                                                                                                                      \
+            return;                                                                                                            \
+        }                                                                                                                      \
+                                                                                                                               \
+        if (axis != a.shapeSize - 1)                                                                                           \
+        { /* out[i] = out[i - 1] op a[i]，每层都是连续的逐元素运算 */                                                          \
+            w_NDExpr(T) expr;                                                                                                  \
+            w_NDExpr_init(T)(&expr);                                                                                           \
+            w_NDExpr_load(T)(&expr, w_NDArrayView_select(T)(a, axis, 0));                                                      \
+            w_NDExpr_eval(T)(&expr, w_NDArrayView_select(T)(out, axis, 0));                                                    \
+            for (int64_t i = 1; i < size; i++)                                                                                 \
+            {                                                                                                                  \
+                w_NDArrayView_binary(T)(op == w_NDREDUCE_SUM ? w_NDOP_ADD : w_NDOP_MUL, w_NDArrayView_select(T)(out, axis, i), \
+                                        w_NDArrayView_select(T)(out, axis, i - 1), w_NDArrayView_select(T)(a, axis, i));       \
+            }                                                                                                                  \
+            return;                                                                                                            \
+        }                                                                                                                      \
+                                                                                                                               \
+        /* 最内层维度逐段扫描 */                                                                                               \
+        int64_t lanes = w_NDArrayView_size(T)(a) / size;                                                                       \
+        int64_t indices[w_NDARRAY_MAX_RANK] = {0};                                                                             \
+        int64_t stride = a.strides[axis], outStride = out.strides[axis];                                                       \
+        for (int64_t lane = 0; lane < lanes; lane++)                                                                           \
+        {                                                                                                                      \
+            const T *source = a.elementData + a.offset;                                                                        \
+            T *target = out.elementData + out.offset;                                                                          \
+            for (int64_t d = 0; d < axis; d++)                                                                                 \
+            {                                                                                                                  \
+                source += indices[d] * a.strides[d];                                                                           \
+                target += indices[d] * out.strides[d];                                                                         \
+            }                                                                                                                  \
+            T accumulator = source[0];                                                                                         \
+            target[0] = accumulator;                                                                                           \
+            for (int64_t i = 1; i < size; i++)                                                                                 \
+            {                                                                                                                  \
+                accumulator = op == w_NDREDUCE_SUM ? accumulator + source[i * stride] : accumulator * source[i * stride];      \
+                target[i * outStride] = accumulator;                                                                           \
+            }                                                                                                                  \
+            for (int64_t d = axis - 1; d >= 0; d--)                                                                            \
+            {                                                                                                                  \
+                if (++indices[d] < a.shape[d])                                                                                 \
+                {                                                                                                              \
+                    break;                                                                                                     \
+                }                                                                                                              \
+                indices[d] = 0;                                                                                                \
+            }                                                                                                                  \
+        }                                                                                                                      \
+    }
+
+// 多维数组归约定义
+// 需要先定义 w_NDArray_number_define(T)
+#define w_NDArray_reduce_define(T)             \
+    w_NDArray_pairwiseSum_define_(T);          \
+    w_NDArray_moments_define_(T);              \
+    w_NDArray_reduceRun_define_(T);            \
+    w_NDArray_reduceRows_define_(T);           \
+    w_NDArrayReduceContext_type_define_(T);    \
+    w_NDArray_reduceTask_define_(T);           \
+    w_NDArray_reduceAxis_define_(T);           \
+    w_NDArray_initReduce_define_(T);           \
+    w_NDArrayView_reduce_define_(T);           \
+    w_NDArrayView_argReduce_define_(T);        \
+    w_NDArrayReducePart_type_define_(T);       \
+    w_NDArrayReduceAllContext_type_define_(T); \
+    w_NDArray_reduceAllTask_define_(T);        \
+    w_NDArray_reduceAll_define_(T);            \
+    w_NDArrayView_reduceAll_define_(T);        \
+    w_NDArrayView_argReduceAll_define_(T);     \
+    w_NDArrayView_scan_define_(T);
+
+// ========================================================================================================================================================
+//  稀疏矩阵
+// ========================================================================================================================================================
+
+// 稀疏矩阵格式：坐标格式（三元组，用于构造）
+#define w_SPARSE_COO 1
+
+// 稀疏矩阵格式：压缩行格式（按行存放，适合矩阵乘向量）
+#define w_SPARSE_CSR 2
+
+// 稀疏矩阵格式：压缩列格式（按列存放）
+#define w_SPARSE_CSC 3
+
+// 非零元素数量低于该值时矩阵乘向量不启动线程
+#define w_SPARSE_PARALLEL_CUTOFF_ 65536
+
+// 稀疏矩阵类型
+#define w_SparseMatrix(T) w_concat(w_SparseMatrix_, T)
+
+// 稀疏矩阵类型定义
+// CSR 时 pointers[i] ~ pointers[i + 1] 为第 i 行的元素，indices 为列索引；CSC 时按列存放，indices 为行索引
+// COO 时 rowIndices / indices 为每个元素的行 / 列索引，pointers 为 NULL
+#define w_SparseMatrix_type_define_(T)                                                               \
+    typedef struct                                                                                   \
+    {                                                                                                \
+        int64_t rows;        /* 行数 */                                                              \
+        int64_t cols;        /* 列数 */                                                              \
+        int32_t format;      /* 格式 w_SPARSE_* */                                                   \
+        int64_t size;        /* 非零元素数量 */                                                      \
+        int64_t capacity;    /* COO 的容量 */                                                        \
+        int64_t *pointers;   /* CSR 的行起始位置（rows + 1 个）或 CSC 的列起始位置（cols + 1 个） */ \
+        int32_t *indices;    /* CSR / COO 的列索引，CSC 的行索引 */                                  \
+        int32_t *rowIndices; /* COO 的行索引 */                                                      \
+        T *values;           /* 元素值 */                                                            \
+    } w_SparseMatrix(T);
+
+// 稀疏矩阵初始化
+#define w_SparseMatrix_init(T) w_concat(w_SparseMatrix(T), _init)
+#define w_SparseMatrix_init_define_(T)                                                                 \
+    /**                                                                                                \
+     * 稀疏矩阵初始化为空的 COO 矩阵（用 append 添加元素，再用 compress 压缩） \
+     * @param this 稀疏矩阵                                                                        \
+     * @param rows 行数（不超过 INT32_MAX）                                                     \
+     * @param cols 列数（不超过 INT32_MAX）                                                     \
+     * @return void                                                                                    \
+     */                                                                                                \
+    static inline void w_SparseMatrix_init(T)(w_SparseMatrix(T) * this, int64_t rows, int64_t cols)    \
+    {                                                                                                  \
+        w_check(this != NULL);                                                                         \
+        w_check(rows >= 0 && rows <= INT32_MAX && cols >= 0 && cols <= INT32_MAX);                     \
+        memset(this, 0, sizeof(w_SparseMatrix(T)));                                                    \
+        this->rows = rows;                                                                             \
+        this->cols = cols;                                                                             \
+        this->format = w_SPARSE_COO;                                                                   \
+    }
+
+// 稀疏矩阵销毁
+#define w_SparseMatrix_deinit(T) w_concat(w_SparseMatrix(T), _deinit)
+#define w_SparseMatrix_deinit_define_(T)                                  \
+    /**                                                                   \
+     * 稀疏矩阵销毁                                                 \
+     * @param this 稀疏矩阵                                           \
+     * @return void                                                       \
+     */                                                                   \
+    static inline void w_SparseMatrix_deinit(T)(w_SparseMatrix(T) * this) \
+    {                                                                     \
+        w_check(this != NULL);                                            \
+        w_free(this->pointers);                                           \
+        w_free(this->indices);                                            \
+        w_free(this->rowIndices);                                         \
+        w_free(this->values);                                             \
+        memset(this, 0, sizeof(w_SparseMatrix(T)));                       \
+    }
+
+// 稀疏矩阵添加元素
+#define w_SparseMatrix_append(T) w_concat(w_SparseMatrix(T), _append)
+#define w_SparseMatrix_append_define_(T)                                                                                                            \
+    /**                                                                                                                                             \
+     * 稀疏矩阵添加元素（只用于 COO，同一位置的多个元素在压缩时相加）                                                  \
+     * @param this 稀疏矩阵                                                                                                                     \
+     * @param row 行索引                                                                                                                         \
+     * @param col 列索引                                                                                                                         \
+     * @param value 值                                                                                                                             \
+     * @return void                                                                                                                                 \
+     */                                                                                                                                             \
+    static inline void w_SparseMatrix_append(T)(w_SparseMatrix(T) * this, int64_t row, int64_t col, T value)                                        \
+    {                                                                                                                                               \
+        w_check(this != NULL && this->format == w_SPARSE_COO);                                                                                      \
+        w_checkIndex(row >= 0 && row < this->rows);                                                                                                 \
+        w_checkIndex(col >= 0 && col < this->cols);                                                                                                 \
+        if (this->size == this->capacity)                                                                                                           \
+        { /* 扩容为原来的 2 倍 */                                                                                                                   \
+            w_AllocPolicy policy = w_AllocPolicy_default();                                                                                         \
+            int64_t capacity = this->capacity < 16 ? 16 : this->capacity * 2;                                                                       \
+            this->rowIndices = w_AllocPolicy_realloc_(&policy, this->rowIndices, this->capacity * sizeof(int32_t),                                  \
+                                                      this->size * sizeof(int32_t), capacity * sizeof(int32_t));                                    \
+            this->indices = w_AllocPolicy_realloc_(&policy, this->indices, this->capacity * sizeof(int32_t),                                        \
+                                                   this->size * sizeof(int32_t), capacity * sizeof(int32_t));                                       \
+            this->values = w_AllocPolicy_realloc_(&policy, this->values, this->capacity * sizeof(T), this->size * sizeof(T), capacity * sizeof(T)); \
+            this->capacity = capacity;                                                                                                              \
+        }                                                                                                                                           \
+        this->rowIndices[this->size] = (int32_t)row;                                                                                                \
+        this->indices[this->size] = (int32_t)col;                                                                                                   \
+        this->values[this->size] = value;                                                                                                           \
+        this->size++;                                                                                                                               \
+    }
+
+// 稀疏矩阵计数排序
+#define w_SparseMatrix_countSort_(T) w_concat(w_SparseMatrix(T), _countSort_)
+#define w_SparseMatrix_countSort_define_(T)                                                                                    \
+    /**                                                                                                                        \
+     * 计数排序：按 keys 稳定排序 order 中的元素编号                                                           \
+     * @param keys 每个元素的键                                                                                          \
+     * @param keyCount 键的取值范围 [0, keyCount)                                                                        \
+     * @param order 输入的元素编号（NULL 表示 0 ~ size - 1）                                                        \
+     * @param size 元素数量                                                                                                \
+     * @param sorted 排序后的元素编号（输出）                                                                      \
+     * @param starts 每个键的起始位置（输出，keyCount + 1 个）                                                   \
+     * @return void                                                                                                            \
+     */                                                                                                                        \
+    static inline void w_SparseMatrix_countSort_(T)(const int32_t *keys, int64_t keyCount, const int64_t *order, int64_t size, \
+                                                    int64_t *sorted, int64_t *starts)                                          \
+    {                                                                                                                          \
+        memset(starts, 0, sizeof(int64_t) * (keyCount + 1));                                                                   \
+        for (int64_t i = 0; i < size; i++)                                                                                     \
+        {                                                                                                                      \
+            starts[keys[i] + 1]++;                                                                                             \
+        }                                                                                                                      \
+        for (int64_t i = 0; i < keyCount; i++)                                                                                 \
+        {                                                                                                                      \
+            starts[i + 1] += starts[i];                                                                                        \
+        }                                                                                                                      \
+        int64_t *next = w_malloc(sizeof(int64_t) * (keyCount + 1));                                                            \
+        w_assert(next != NULL);                                                                                                \
+        memcpy(next, starts, sizeof(int64_t) * (keyCount + 1));                                                                \
+        for (int64_t i = 0; i < size; i++)                                                                                     \
+        {                                                                                                                      \
+            int64_t element = order != NULL ? order[i] : i;                                                                    \
+            sorted[next[keys[element]]++] = element;                                                                           \
+        }                                                                                                                      \
+        w_free(next);                                                                                                          \
+    }
+
+// 稀疏矩阵压缩
+#define w_SparseMatrix_compress(T) w_concat(w_SparseMatrix(T), _compress)
+#define w_SparseMatrix_compress_define_(T)                                                                                                                       \
+    /**                                                                                                                                                          \
+     * 稀疏矩阵从 COO 压缩为 CSR 或 CSC（两趟计数排序，时间复杂度 O(非零元素数量 + 行数 + 列数)），同一位置的元素相加 \
+     * @param this 稀疏矩阵（COO）                                                                                                                         \
+     * @param format 目标格式 w_SPARSE_CSR / w_SPARSE_CSC                                                                                                    \
+     * @return void                                                                                                                                              \
+     */                                                                                                                                                          \
+    static inline void w_SparseMatrix_compress(T)(w_SparseMatrix(T) * this, int32_t format)                                                                      \
+    {                                                                                                                                                            \
+        w_check(this != NULL && this->format == w_SPARSE_COO);                                                                                                   \
+        w_check(format == w_SPARSE_CSR || format == w_SPARSE_CSC);                                                                                               \
+        const int32_t *major = format == w_SPARSE_CSR ? this->rowIndices : this->indices;                                                                        \
+        const int32_t *minor = format == w_SPARSE_CSR ? this->indices : this->rowIndices;                                                                        \
+        int64_t majorCount = format == w_SPARSE_CSR ? this->rows : this->cols;                                                                                   \
+        int64_t minorCount = format == w_SPARSE_CSR ? this->cols : this->rows;                                                                                   \
+                                                                                                                                                                 \
+        /* 先按次维度排序，再按主维度稳定排序 */                                                                                                                 \
+        int64_t *byMinor = w_malloc(sizeof(int64_t) * (this->size + 1));                                                                                         \
+        int64_t *byMajor = w_malloc(sizeof(int64_t) * (this->size + 1));                                                                                         \
+        int64_t *minorStarts = w_malloc(sizeof(int64_t) * (minorCount + 1));                                                                                     \
+        int64_t *pointers = w_malloc(sizeof(int64_t) * (majorCount + 1));                                                                                        \
+        w_assert(byMinor != NULL && byMajor != NULL && minorStarts != NULL && pointers != NULL);                                                                 \
+        w_SparseMatrix_countSort_(T)(minor, minorCount, NULL, this->size, byMinor, minorStarts);                                                                 \
+        w_SparseMatrix_countSort_(T)(major, majorCount, byMinor, this->size, byMajor, pointers);                                                                 \
+        w_free(byMinor);                                                                                                                                         \
+        w_free(minorStarts);                                                                                                                                     \
+                                                                                                                                                                 \
+        /* 按顺序写入，合并同一位置的元素 */                                                                                                                     \
+        int32_t *indices = w_malloc(sizeof(int32_t) * (this->size + 1));                                                                                         \
+        T *values = w_malloc(sizeof(T) * (this->size + 1));                                                                                                      \
+        w_assert(indices != NULL && values != NULL);                                                                                                             \
+        int64_t size = 0;                                                                                                                                        \
+        for (int64_t m = 0; m < majorCount; m++)                                                                                                                 \
+        {                                                                                                                                                        \
+            int64_t begin = size;                                                                                                                                \
+            for (int64_t p = pointers[m]; p < pointers[m + 1]; p++)                                                                                              \
+            {                                                                                                                                                    \
+                int64_t element = byMajor[p];                                                                                                                    \
+                if (size > begin && indices[size - 1] == minor[element])                                                                                         \
+                {                                                                                                                                                \
+                    values[size - 1] += this->values[element];                                                                                                   \
+                    continue;                                                                                                                                    \
+                }                                                                                                                                                \
+                indices[size] = minor[element];                                                                                                                  \
+                values[size] = this->values[element];                                                                                                            \
+                size++;                                                                                                                                          \
+            }                                                                                                                                                    \
+            pointers[m] = begin;                                                                                                                                 \
+        }                                                                                                                                                        \
+        pointers[majorCount] = size;                                                                                                                             \
+        w_free(byMajor);                                                                                                                                         \
+                                                                                                                                                                 \
+        w_free(this->indices);                                                                                                                                   \
+        w_free(this->rowIndices);                                                                                                                                \
+        w_free(this->values);                                                                                                                                    \
+        this->pointers = pointers;                                                                                                                               \
+        this->indices = indices;                                                                                                                                 \
+        this->rowIndices = NULL;                                                                                                                                 \
+        this->values = values;                                                                                                                                   \
+        this->size = size;                                                                                                                                       \
+        this->capacity = size;                                                                                                                                   \
+        this->format = format;                                                                                                                                   \
+    }
+
+// 稀疏矩阵转置存储
+#define w_SparseMatrix_transposeArrays_(T) w_concat(w_SparseMatrix(T), _transposeArrays_)
+#define w_SparseMatrix_transposeArrays_define_(T)                                                                                                 \
+    /**                                                                                                                                           \
+     * 压缩存储的主次维度互换（CSR 的数组转换为同一矩阵的 CSC 的数组，反之亦然），结果的次维度索引有序 \
+     * @param this 稀疏矩阵（CSR 或 CSC）                                                                                                  \
+     * @param pointers 新的起始位置（输出，需要使用 w_free 释放）                                                                \
+     * @param indices 新的索引（输出，需要使用 w_free 释放）                                                                       \
+     * @param values 新的元素值（输出，需要使用 w_free 释放）                                                                     \
+     * @return void                                                                                                                               \
+     */                                                                                                                                           \
+    static inline void w_SparseMatrix_transposeArrays_(T)(const w_SparseMatrix(T) * this, int64_t **pointers, int32_t **indices, T **values)      \
+    {                                                                                                                                             \
+        w_check(this->format == w_SPARSE_CSR || this->format == w_SPARSE_CSC);                                                                    \
+        int64_t majorCount = this->format == w_SPARSE_CSR ? this->rows : this->cols;                                                              \
+        int64_t minorCount = this->format == w_SPARSE_CSR ? this->cols : this->rows;                                                              \
+        *pointers = w_malloc(sizeof(int64_t) * (minorCount + 1));                                                                                 \
+        *indices = w_malloc(sizeof(int32_t) * (this->size + 1));                                                                                  \
+        *values = w_malloc(sizeof(T) * (this->size + 1));                                                                                         \
+        int64_t *next = w_malloc(sizeof(int64_t) * (minorCount + 1));                                                                             \
+        w_assert(*pointers != NULL && *indices != NULL && *values != NULL && next != NULL);                                                       \
+        memset(*pointers, 0, sizeof(int64_t) * (minorCount + 1));                                                                                 \
+        for (int64_t p = 0; p < this->size; p++)                                                                                                  \
+        {                                                                                                                                         \
+            (*pointers)[this->indices[p] + 1]++;                                                                                                  \
+        }                                                                                                                                         \
+        for (int64_t i = 0; i < minorCount; i++)                                                                                                  \
+        {                                                                                                                                         \
+            (*pointers)[i + 1] += (*pointers)[i];                                                                                                 \
+        }                                                                                                                                         \
+        memcpy(next, *pointers, sizeof(int64_t) * (minorCount + 1));                                                                              \
+        for (int64_t m = 0; m < majorCount; m++)                                                                                                  \
+        {                                                                                                                                         \
+            for (int64_t p = this->pointers[m]; p < this->pointers[m + 1]; p++)                                                                   \
+            {                                                                                                                                     \
+                int64_t position = next[this->indices[p]]++;                                                                                      \
+                (*indices)[position] = (int32_t)m;                                                                                                \
+                (*values)[position] = this->values[p];                                                                                            \
+            }                                                                                                                                     \
+        }                                                                                                                                         \
+        w_free(next);                                                                                                                             \
+    }
+
+// 稀疏矩阵转换格式
+#define w_SparseMatrix_convert(T) w_concat(w_SparseMatrix(T), _convert)
+#define w_SparseMatrix_convert_define_(T)                                                  \
+    /**                                                                                    \
+     * 稀疏矩阵在 CSR 和 CSC 之间转换（COO 时等同于 compress）             \
+     * @param this 稀疏矩阵                                                            \
+     * @param format 目标格式 w_SPARSE_CSR / w_SPARSE_CSC                              \
+     * @return void                                                                        \
+     */                                                                                    \
+    static inline void w_SparseMatrix_convert(T)(w_SparseMatrix(T) * this, int32_t format) \
+    {                                                                                      \
+        w_check(this != NULL);                                                             \
+        w_check(format == w_SPARSE_CSR || format == w_SPARSE_CSC);                         \
+        if (this->format == w_SPARSE_COO)                                                  \
+        {                                                                                  \
+            w_SparseMatrix_compress(T)(this, format);                                      \
+            return;                                                                        \
+        }                                                                                  \
+        if (this->format == format)                                                        \
+        {                                                                                  \
+            return;                                                                        \
+        }                                                                                  \
+        int64_t *pointers;                                                                 \
+        int32_t *indices;                                                                  \
+        T *values;                                                                         \
+        w_SparseMatrix_transposeArrays_(T)(this, &pointers, &indices, &values);            \
+        w_free(this->pointers);                                                            \
+        w_free(this->indices);                                                             \
+        w_free(this->values);                                                              \
+        this->pointers = pointers;                                                         \
+        this->indices = indices;                                                           \
+        this->values = values;                                                             \
+        this->format = format;                                                             \
+    }
+
+// 稀疏矩阵转置
+#define w_SparseMatrix_transpose(T) w_concat(w_SparseMatrix(T), _transpose)
+#define w_SparseMatrix_transpose_define_(T)                                                                 \
+    /**                                                                                                     \
+     * 稀疏矩阵转置（结果与 this 格式相同）                                                  \
+     * @param this 稀疏矩阵（CSR 或 CSC）                                                            \
+     * @param out 转置后的稀疏矩阵（未初始化，由调用者销毁）                           \
+     * @return void                                                                                         \
+     */                                                                                                     \
+    static inline void w_SparseMatrix_transpose(T)(const w_SparseMatrix(T) * this, w_SparseMatrix(T) * out) \
+    {                                                                                                       \
+        w_check(this != NULL && out != NULL && this != out);                                                \
+        /* A 的 CSC 数组就是 A^T 的 CSR 数组 */                                                             \
+        w_SparseMatrix_init(T)(out, this->cols, this->rows);                                                \
+        w_SparseMatrix_transposeArrays_(T)(this, &out->pointers, &out->indices, &out->values);              \
+        out->size = this->size;                                                                             \
+        out->capacity = this->size;                                                                         \
+        out->format = this->format;                                                                         \
+    }
+
+// 稀疏矩阵从视图初始化
+#define w_SparseMatrix_initFromView(T) w_concat(w_SparseMatrix(T), _initFromView)
+#define w_SparseMatrix_initFromView_define_(T)                                                                         \
+    /**                                                                                                                \
+     * 稀疏矩阵从二维视图初始化，只保存非零元素                                                    \
+     * @param this 稀疏矩阵                                                                                        \
+     * @param view 二维视图                                                                                        \
+     * @param format 格式 w_SPARSE_CSR / w_SPARSE_CSC                                                                \
+     * @return void                                                                                                    \
+     */                                                                                                                \
+    static inline void w_SparseMatrix_initFromView(T)(w_SparseMatrix(T) * this, w_NDArrayView(T) view, int32_t format) \
+    {                                                                                                                  \
+        w_check(view.shapeSize == 2);                                                                                  \
+        w_check(format == w_SPARSE_CSR || format == w_SPARSE_CSC);                                                     \
+        w_SparseMatrix_init(T)(this, view.shape[0], view.shape[1]);                                                    \
+        /* CSC 时按转置的视图逐行扫描 */                                                                               \
+        if (format == w_SPARSE_CSC)                                                                                    \
+        {                                                                                                              \
+            view = w_NDArrayView_transpose(T)(view);                                                                   \
+        }                                                                                                              \
+        int64_t majorCount = view.shape[0], minorCount = view.shape[1];                                                \
+        const T *data = view.elementData + view.offset;                                                                \
+        this->pointers = w_malloc(sizeof(int64_t) * (majorCount + 1));                                                 \
+        w_assert(this->pointers != NULL);                                                                              \
+        this->pointers[0] = 0;                                                                                         \
+        for (int64_t m = 0; m < majorCount; m++)                                                                       \
+        {                                                                                                              \
+            int64_t count = 0;                                                                                         \
+            for (int64_t n = 0; n < minorCount; n++)                                                                   \
+            {                                                                                                          \
+                count += data[m * view.strides[0] + n * view.strides[1]] != 0;                                         \
+            }                                                                                                          \
+            this->pointers[m + 1] = this->pointers[m] + count;                                                         \
+        }                                                                                                              \
+        this->size = this->pointers[majorCount];                                                                       \
+        this->capacity = this->size;                                                                                   \
+        this->indices = w_malloc(sizeof(int32_t) * (this->size + 1));                                                  \
+        this->values = w_malloc(sizeof(T) * (this->size + 1));                                                         \
+        w_assert(this->indices != NULL && this->values != NULL);                                                       \
+        for (int64_t m = 0, p = 0; m < majorCount; m++)                                                                \
+        {                                                                                                              \
+            for (int64_t n = 0; n < minorCount; n++)                                                                   \
+            {                                                                                                          \
+                T value = data[m * view.strides[0] + n * view.strides[1]];                                             \
+                if (value != 0)                                                                                        \
+                {                                                                                                      \
+                    this->indices[p] = (int32_t)n;                                                                     \
+                    this->values[p++] = value;                                                                         \
+                }                                                                                                      \
+            }                                                                                                          \
+        }                                                                                                              \
+        this->format = format;                                                                                         \
+    }
+
+// 稀疏矩阵转换为多维数组
+#define w_SparseMatrix_toNDArray(T) w_concat(w_SparseMatrix(T), _toNDArray)
+#define w_SparseMatrix_toNDArray_define_(T)                                                               \
+    /**                                                                                                   \
+     * 稀疏矩阵转换为稠密的二维数组                                                         \
+     * @param this 稀疏矩阵（任意格式，COO 中同一位置的元素相加）                    \
+     * @param out 多维数组（未初始化，由调用者销毁）                                     \
+     * @return void                                                                                       \
+     */                                                                                                   \
+    static inline void w_SparseMatrix_toNDArray(T)(const w_SparseMatrix(T) * this, w_NDArray(T) * out)    \
+    {                                                                                                     \
+        w_check(this != NULL && out != NULL);                                                             \
+        int64_t shape[2] = {this->rows, this->cols};                                                      \
+        w_NDArray_initShape(T)(out, shape, 2);                                                            \
+        memset(out->elementData, 0, sizeof(T) * out->size);                                               \
+        if (this->format == w_SPARSE_COO)                                                                 \
+        {                                                                                                 \
+            for (int64_t p = 0; p < this->size; p++)                                                      \
+            {                                                                                             \
+                out->elementData[this->rowIndices[p] * this->cols + this->indices[p]] += this->values[p]; \
+            }                                                                                             \
+            return;                                                                                       \
+        }                                                                                                 \
+        int64_t majorCount = this->format == w_SPARSE_CSR ? this->rows : this->cols;                      \
+        int64_t majorStride = this->format == w_SPARSE_CSR ? this->cols : 1;                              \
+        int64_t minorStride = this->format == w_SPARSE_CSR ? 1 : this->cols;                              \
+        for (int64_t m = 0; m < majorCount; m++)                                                          \
+        {                                                                                                 \
+            for (int64_t p = this->pointers[m]; p < this->pointers[m + 1]; p++)                           \
+            {                                                                                             \
+                out->elementData[m * majorStride + this->indices[p] * minorStride] = this->values[p];     \
+            }                                                                                             \
+        }                                                                                                 \
+    }
+
+// 稀疏矩阵获取元素
+#define w_SparseMatrix_get(T) w_concat(w_SparseMatrix(T), _get)
+#define w_SparseMatrix_get_define_(T)                                                                  \
+    /**                                                                                                \
+     * 稀疏矩阵获取元素（在行或列内二分查找）                                       \
+     * @param this 稀疏矩阵（CSR 或 CSC）                                                       \
+     * @param row 行索引                                                                            \
+     * @param col 列索引                                                                            \
+     * @return T 元素（不存在时为 0）                                                         \
+     */                                                                                                \
+    static inline T w_SparseMatrix_get(T)(const w_SparseMatrix(T) * this, int64_t row, int64_t col)    \
+    {                                                                                                  \
+        w_check(this != NULL);                                                                         \
+        w_check(this->format == w_SPARSE_CSR || this->format == w_SPARSE_CSC);                         \
+        w_checkIndex(row >= 0 && row < this->rows);                                                    \
+        w_checkIndex(col >= 0 && col < this->cols);                                                    \
+        int64_t major = this->format == w_SPARSE_CSR ? row : col;                                      \
+        int64_t minor = this->format == w_SPARSE_CSR ? col : row;                                      \
+        int64_t low = this->pointers[major], high = this->pointers[major + 1];                         \
+        while (low < high)                                                                             \
+        {                                                                                              \
+            int64_t middle = low + (high - low) / 2;                                                   \
+            if (this->indices[middle] < minor)                                                         \
+            {                                                                                          \
+                low = middle + 1;                                                                      \
+            }                                                                                          \
+            else                                                                                       \
+            {                                                                                          \
+                high = middle;                                                                         \
+            }                                                                                          \
+        }                                                                                              \
+        return low < this->pointers[major + 1] && this->indices[low] == minor ? this->values[low] : 0; \
+    }
+
+// 稀疏矩阵乘向量上下文
+#define w_SparseMatrixContext_(T) w_concat(w_SparseMatrixContext_, T)
+#define w_SparseMatrixContext_type_define_(T)                   \
+    typedef struct                                              \
+    {                                                           \
+        const w_SparseMatrix(T) * matrix; /* 稀疏矩阵（CSR） */ \
+        const T *x;                       /* 输入向量 */        \
+        T *y;                             /* 输出向量 */        \
+        int64_t parts;                    /* 分段数 */          \
+    } w_SparseMatrixContext_(T);
+
+// 稀疏矩阵乘向量任务
+#define w_SparseMatrix_mulVectorTask_(T) w_concat(w_SparseMatrix(T), _mulVectorTask_)
+#define w_SparseMatrix_mulVectorTask_define_(T)                                                                     \
+    /**                                                                                                             \
+     * 稀疏矩阵乘向量任务，按非零元素数量均分行，每段的计算量相同                      \
+     * @param context 上下文                                                                                     \
+     * @param begin 起始段                                                                                       \
+     * @param end 结束段（不包含）                                                                          \
+     * @return void                                                                                                 \
+     */                                                                                                             \
+    static inline w_SIMD_DISPATCH_ void w_SparseMatrix_mulVectorTask_(T)(void *context, int64_t begin, int64_t end) \
+    {                                                                                                               \
+        w_SparseMatrixContext_(T) *spmv = context;                                                                  \
+        const w_SparseMatrix(T) *matrix = spmv->matrix;                                                             \
+        const int64_t *pointers = matrix->pointers;                                                                 \
+        const int32_t *indices = matrix->indices;                                                                   \
+        const T *values = matrix->values;                                                                           \
+        /* 第一个起始位置不小于 target 的行 */                                                                      \
+        int64_t bounds[2];                                                                                          \
+        for (int64_t b = 0; b < 2; b++)                                                                             \
+        {                                                                                                           \
+            int64_t target = matrix->size * (b == 0 ? begin : end) / spmv->parts;                                   \
+            int64_t low = 0, high = matrix->rows;                                                                   \
+            while (low < high)                                                                                      \
+            {                                                                                                       \
+                int64_t middle = low + (high - low) / 2;                                                            \
+                if (pointers[middle] < target)                                                                      \
+                {                                                                                                   \
+                    low = middle + 1;                                                                               \
+                }                                                                                                   \
+                else                                                                                                \
+                {                                                                                                   \
+                    high = middle;                                                                                  \
+                }                                                                                                   \
+            }                                                                                                       \
+            bounds[b] = low;                                                                                        \
+        }                                                                                                           \
+        if (end == spmv->parts)                                                                                     \
+        {                                                                                                           \
+            bounds[1] = matrix->rows;                                                                               \
+        }                                                                                                           \
+        for (int64_t row = bounds[0]; row < bounds[1]; row++)                                                       \
+        {                                                                                                           \
+            w_SumType_(T) sum = 0;                                                                                  \
+            for (int64_t p = pointers[row]; p < pointers[row + 1]; p++)                                             \
+            {                                                                                                       \
+                sum += (w_SumType_(T))values[p] * spmv->x[indices[p]];                                              \
+            }                                                                                                       \
+            spmv->y[row] = (T)sum;                                                                                  \
+        }                                                                                                           \
+    }
+
+// 稀疏矩阵乘向量
+#define w_SparseMatrix_mulVector(T) w_concat(w_SparseMatrix(T), _mulVector)
+#define w_SparseMatrix_mulVector_define_(T)                                                                              \
+    /**                                                                                                                  \
+     * 稀疏矩阵乘向量 y = A * x                                                                                   \
+     * CSR 按行计算，非零元素较多时按非零元素数量均分到多个线程；CSC 按列累加，单线程 \
+     * @param this 稀疏矩阵（CSR 或 CSC）                                                                         \
+     * @param x 输入向量（长度为 cols）                                                                         \
+     * @param y 输出向量（长度为 rows，不能与 x 重叠）                                                    \
+     * @param threadCount 线程数（<= 0 时使用默认线程数，1 为单线程）                                  \
+     * @return void                                                                                                      \
+     */                                                                                                                  \
+    static inline void w_SparseMatrix_mulVector(T)(const w_SparseMatrix(T) * this, const T *x, T *y, int threadCount)    \
+    {                                                                                                                    \
+        w_check(this != NULL && x != NULL && y != NULL);                                                                 \
+        w_check(this->format == w_SPARSE_CSR || this->format == w_SPARSE_CSC);                                           \
+        if (this->format == w_SPARSE_CSC)                                                                                \
+        {                                                                                                                \
+            memset(y, 0, sizeof(T) * this->rows);                                                                        \
+            for (int64_t col = 0; col < this->cols; col++)                                                               \
+            {                                                                                                            \
+                for (int64_t p = this->pointers[col]; p < this->pointers[col + 1]; p++)                                  \
+                {                                                                                                        \
+                    y[this->indices[p]] += this->values[p] * x[col];                                                     \
+                }                                                                                                        \
+            }                                                                                                            \
+            return;                                                                                                      \
+        }                                                                                                                \
+        if (threadCount <= 0)                                                                                            \
+        {                                                                                                                \
+            threadCount = w_defaultThreadCount();                                                                        \
+        }                                                                                                                \
+        if (this->size < w_SPARSE_PARALLEL_CUTOFF_)                                                                      \
+        {                                                                                                                \
+            threadCount = 1;                                                                                             \
+        }                                                                                                                \
+        w_SparseMatrixContext_(T) context = {this, x, y, threadCount};                                                   \
+        w_parallelFor_(threadCount, threadCount, w_SparseMatrix_mulVectorTask_(T), &context);                            \
+    }
+
+// 稀疏矩阵定义（需要先定义 w_NDArray_define 和 w_NDArrayView_define，T 必须是数字类型）
+#define w_SparseMatrix_define(T)               \
+    w_SparseMatrix_type_define_(T);            \
+    w_SparseMatrix_init_define_(T);            \
+    w_SparseMatrix_deinit_define_(T);          \
+    w_SparseMatrix_append_define_(T);          \
+    w_SparseMatrix_countSort_define_(T);       \
+    w_SparseMatrix_compress_define_(T);        \
+    w_SparseMatrix_transposeArrays_define_(T); \
+    w_SparseMatrix_convert_define_(T);         \
+    w_SparseMatrix_transpose_define_(T);       \
+    w_SparseMatrix_initFromView_define_(T);    \
+    w_SparseMatrix_toNDArray_define_(T);       \
+    w_SparseMatrix_get_define_(T);             \
+    w_SparseMatrixContext_type_define_(T);     \
+    w_SparseMatrix_mulVectorTask_define_(T);   \
+    w_SparseMatrix_mulVector_define_(T);
+
+// ========================================================================================================================================================
+//  指针类型
+// ========================================================================================================================================================
+
+// 指针类型
+// 简单封装，为了传入 w_concat 后能输出有效标识符
+#define w_Ptr(T) w_concat(w_Ptr_, T)
+
+// 指针类型定义
+#define w_Ptr_define(T) typedef T *w_Ptr(T)
+
+// ========================================================================================================================================================
+//  数字格式化
+// ========================================================================================================================================================
+
+// 整数格式化的最大字节数（包括符号，不包括 '\0'）
+#define w_FORMAT_LONG_SIZE 20
+
+// 浮点数格式化的最大字节数（包括符号，不包括 '\0'）
+#define w_FORMAT_DOUBLE_SIZE 25
+
+/**
+ * 计算无符号整数的十进制位数（按二进制位数估算，再比较一次修正）
+ * @param value 整数
+ * @return int 位数
+ */
+static inline int w_decimalDigits_(uint64_t value)
+{
+    static const uint64_t powers[] = {
+        UINT64_C(0), UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000), UINT64_C(100000), UINT64_C(1000000),
+        UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000), UINT64_C(10000000000), UINT64_C(100000000000),
+        UINT64_C(1000000000000), UINT64_C(10000000000000), UINT64_C(100000000000000), UINT64_C(1000000000000000),
+        UINT64_C(10000000000000000), UINT64_C(100000000000000000), UINT64_C(1000000000000000000), UINT64_C(10000000000000000000)};
+    /* log10(2) ~= 1233 / 4096 */
+    int digits = ((64 - __builtin_clzll(value | 1)) * 1233 >> 12) + 1;
+    return digits - (value < powers[digits - 1]);
+}
+
+/**
+ * 格式化无符号整数（每次输出两位，不申请内存）
+ * @param buffer 缓冲区（至少 w_FORMAT_LONG_SIZE 字节，不写入 '\0'）
+ * @param value 整数
+ * @return int 写入的字节数
+ */
+static inline int w_formatUnsignedLong(char *buffer, uint64_t value)
+{
+    static const char pairs[] =
+        "0001020304050607080910111213141516171819"
+        "2021222324252627282930313233343536373839"
+        "4041424344454647484950515253545556575859"
+        "6061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    int length = w_decimalDigits_(value);
+    char *end = buffer + length;
+    while (value >= 100)
+    {
+        uint64_t pair = value % 100 * 2;
+        value /= 100;
+        end -= 2;
+        end[0] = pairs[pair];
+        end[1] = pairs[pair + 1];
+    }
+    if (value >= 10)
+    {
+        end[-2] = pairs[value * 2];
+        end[-1] = pairs[value * 2 + 1];
+    }
+    else
+    {
+        end[-1] = (char)('0' + value);
+    }
+    return length;
+}
+
+/**
+ * 格式化整数（不申请内存）
+ * @param buffer 缓冲区（至少 w_FORMAT_LONG_SIZE 字节，不写入 '\0'）
+ * @param value 整数
+ * @return int 写入的字节数
+ */
+static inline int w_formatLong(char *buffer, int64_t value)
+{
+    if (value < 0)
+    {
+        buffer[0] = '-';
+        return 1 + w_formatUnsignedLong(buffer + 1, (uint64_t)0 - (uint64_t)value);
+    }
+    return w_formatUnsignedLong(buffer, (uint64_t)value);
+}
+
+// 浮点数的尾数和二进制指数（值为 f * 2^e）
+typedef struct
+{
+    uint64_t f; /* 尾数 */
+    int e;      /* 二进制指数 */
+} w_DiyFp_;
+
+/**
+ * 规格化（尾数的最高位为 1）
+ * @param x 浮点数
+ * @return w_DiyFp_ 规格化后的浮点数
+ */
+static inline w_DiyFp_ w_DiyFp_normalize_(w_DiyFp_ x)
+{
+    int shift = __builtin_clzll(x.f);
+    x.f <<= shift;
+    x.e -= shift;
+    return x;
+}
+
+/**
+ * 乘法（尾数取乘积的高 64 位并四舍五入）
+ * @param x 浮点数
+ * @param y 浮点数
+ * @return w_DiyFp_ 乘积
+ */
+static inline w_DiyFp_ w_DiyFp_multiply_(w_DiyFp_ x, w_DiyFp_ y)
+{
+    const uint64_t mask = UINT64_C(0xFFFFFFFF);
+    uint64_t a = x.f >> 32, b = x.f & mask, c = y.f >> 32, d = y.f & mask;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & mask) + (bc & mask) + (UINT64_C(1) << 31);
+    w_DiyFp_ result = {ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64};
+    return result;
+}
+
+/**
+ * 查找缓存的 10 的幂，使乘积的二进制指数落在 [-60, -32] 内
+ * @param e 二进制指数
+ * @param k 十进制指数（输出，乘积为 value * 10^-k）
+ * @return w_DiyFp_ 10 的 -k 次幂
+ */
+static inline w_DiyFp_ w_cachedPower_(int e, int *k)
+{
+    /* 10^-348, 10^-340, ..., 10^340 */
+    static const uint64_t fractions[] = {
+    UINT64_C(0xfa8fd5a0081c0288), UINT64_C(0xbaaee17fa23ebf76), UINT64_C(0x8b16fb203055ac76), UINT64_C(0xcf42894a5dce35ea),
+    UINT64_C(0x9a6bb0aa55653b2d), UINT64_C(0xe61acf033d1a45df), UINT64_C(0xab70fe17c79ac6ca), UINT64_C(0xff77b1fcbebcdc4f),
+    UINT64_C(0xbe5691ef416bd60c), UINT64_C(0x8dd01fad907ffc3c), UINT64_C(0xd3515c2831559a83), UINT64_C(0x9d71ac8fada6c9b5),
+    UINT64_C(0xea9c227723ee8bcb), UINT64_C(0xaecc49914078536d), UINT64_C(0x823c12795db6ce57), UINT64_C(0xc21094364dfb5637),
+    UINT64_C(0x9096ea6f3848984f), UINT64_C(0xd77485cb25823ac7), UINT64_C(0xa086cfcd97bf97f4), UINT64_C(0xef340a98172aace5),
+    UINT64_C(0xb23867fb2a35b28e), UINT64_C(0x84c8d4dfd2c63f3b), UINT64_C(0xc5dd44271ad3cdba), UINT64_C(0x936b9fcebb25c996),
+    UINT64_C(0xdbac6c247d62a584), UINT64_C(0xa3ab66580d5fdaf6), UINT64_C(0xf3e2f893dec3f126), UINT64_C(0xb5b5ada8aaff80b8),
+    UINT64_C(0x87625f056c7c4a8b), UINT64_C(0xc9bcff6034c13053), UINT64_C(0x964e858c91ba2655), UINT64_C(0xdff9772470297ebd),
+    UINT64_C(0xa6dfbd9fb8e5b88f), UINT64_C(0xf8a95fcf88747d94), UINT64_C(0xb94470938fa89bcf), UINT64_C(0x8a08f0f8bf0f156b),
+    UINT64_C(0xcdb02555653131b6), UINT64_C(0x993fe2c6d07b7fac), UINT64_C(0xe45c10c42a2b3b06), UINT64_C(0xaa242499697392d3),
+    UINT64_C(0xfd87b5f28300ca0e), UINT64_C(0xbce5086492111aeb), UINT64_C(0x8cbccc096f5088cc), UINT64_C(0xd1b71758e219652c),
+    UINT64_C(0x9c40000000000000), UINT64_C(0xe8d4a51000000000), UINT64_C(0xad78ebc5ac620000), UINT64_C(0x813f3978f8940984),
+    UINT64_C(0xc097ce7bc90715b3), UINT64_C(0x8f7e32ce7bea5c70), UINT64_C(0xd5d238a4abe98068), UINT64_C(0x9f4f2726179a2245),
+    UINT64_C(0xed63a231d4c4fb27), UINT64_C(0xb0de65388cc8ada8), UINT64_C(0x83c7088e1aab65db), UINT64_C(0xc45d1df942711d9a),
+    UINT64_C(0x924d692ca61be758), UINT64_C(0xda01ee641a708dea), UINT64_C(0xa26da3999aef774a), UINT64_C(0xf209787bb47d6b85),
+    UINT64_C(0xb454e4a179dd1877), UINT64_C(0x865b86925b9bc5c2), UINT64_C(0xc83553c5c8965d3d), UINT64_C(0x952ab45cfa97a0b3),
+    UINT64_C(0xde469fbd99a05fe3), UINT64_C(0xa59bc234db398c25), UINT64_C(0xf6c69a72a3989f5c), UINT64_C(0xb7dcbf5354e9bece),
+    UINT64_C(0x88fcf317f22241e2), UINT64_C(0xcc20ce9bd35c78a5), UINT64_C(0x98165af37b2153df), UINT64_C(0xe2a0b5dc971f303a),
+    UINT64_C(0xa8d9d1535ce3b396), UINT64_C(0xfb9b7cd9a4a7443c), UINT64_C(0xbb764c4ca7a44410), UINT64_C(0x8bab8eefb6409c1a),
+    UINT64_C(0xd01fef10a657842c), UINT64_C(0x9b10a4e5e9913129), UINT64_C(0xe7109bfba19c0c9d), UINT64_C(0xac2820d9623bf429),
+    UINT64_C(0x80444b5e7aa7cf85), UINT64_C(0xbf21e44003acdd2d), UINT64_C(0x8e679c2f5e44ff8f), UINT64_C(0xd433179d9c8cb841),
+    UINT64_C(0x9e19db92b4e31ba9), UINT64_C(0xeb96bf6ebadf77d9), UINT64_C(0xaf87023b9bf0ee6b)};
+    static const int16_t exponents[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066};
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int index = (int)dk;
+    if (dk - index > 0.0)
+    {
+        index++;
+    }
+    index = (index >> 3) + 1;
+    *k = -(-348 + index * 8);
+    w_DiyFp_ power = {fractions[index], exponents[index]};
+    return power;
+}
+
+/**
+ * 修正最后一位数字，使结果最接近原值
+ * @param buffer 数字
+ * @param length 数字个数
+ * @param delta 允许的误差范围
+ * @param rest 剩余部分
+ * @param tenKappa 最后一位数字的单位
+ * @param distance 到上边界的距离
+ * @return void
+ */
+static inline void w_grisuRound_(char *buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    while (rest < distance && delta - rest >= tenKappa && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance))
+    {
+        buffer[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+/**
+ * Grisu2 生成十进制数字（结果为 buffer * 10^k，一定能还原出原值，绝大多数情况下最短；区间边界不计入，恰好落在边界上的更短结果会被错过）
+ * @param value 浮点数
+ * @param upper 上边界
+ * @param lower 下边界
+ * @param buffer 数字（输出，最多 17 个）
+ * @param k 十进制指数（输出）
+ * @return int 数字个数
+ */
+static inline int w_grisu2_(w_DiyFp_ value, w_DiyFp_ upper, w_DiyFp_ lower, char *buffer, int *k)
+{
+    static const uint64_t powers[] = {
+        UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000), UINT64_C(100000), UINT64_C(1000000),
+        UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000), UINT64_C(10000000000), UINT64_C(100000000000),
+        UINT64_C(1000000000000), UINT64_C(10000000000000), UINT64_C(100000000000000), UINT64_C(1000000000000000),
+        UINT64_C(10000000000000000), UINT64_C(100000000000000000), UINT64_C(1000000000000000000), UINT64_C(10000000000000000000)};
+    w_DiyFp_ power = w_cachedPower_(upper.e, k);
+    w_DiyFp_ w = w_DiyFp_multiply_(w_DiyFp_normalize_(value), power);
+    w_DiyFp_ high = w_DiyFp_multiply_(upper, power);
+    w_DiyFp_ low = w_DiyFp_multiply_(lower, power);
+    low.f++;
+    high.f--;
+
+    /* 按整数部分和小数部分逐位生成 */
+    uint64_t delta = high.f - low.f;
+    uint64_t distance = high.f - w.f;
+    int shift = -high.e;
+    uint64_t one = UINT64_C(1) << shift;
+    uint32_t integer = (uint32_t)(high.f >> shift);
+    uint64_t fraction = high.f & (one - 1);
+    int kappa = w_decimalDigits_(integer);
+    int length = 0;
+    while (kappa > 0)
+    {
+        uint32_t digit = (uint32_t)(integer / powers[kappa - 1]);
+        integer = (uint32_t)(integer % powers[kappa - 1]);
+        if (digit != 0 || length != 0)
+        {
+            buffer[length++] = (char)('0' + digit);
+        }
+        kappa--;
+        uint64_t rest = ((uint64_t)integer << shift) + fraction;
+        if (rest <= delta)
+        {
+            *k += kappa;
+            w_grisuRound_(buffer, length, delta, rest, (uint64_t)powers[kappa] << shift, distance);
+            return length;
+        }
+    }
+    while (true)
+    {
+        fraction *= 10;
+        delta *= 10;
+        char digit = (char)(fraction >> shift);
+        if (digit != 0 || length != 0)
+        {
+            buffer[length++] = (char)('0' + digit);
+        }
+        fraction &= one - 1;
+        kappa--;
+        if (fraction < delta)
+        {
+            *k += kappa;
+            w_grisuRound_(buffer, length, delta, fraction, one, -kappa < 20 ? distance * powers[-kappa] : 0);
+            return length;
+        }
+    }
+}
+
+/**
+ * 按十进制数字输出浮点数（指数在 [-4, 17) 内时使用小数形式，否则使用科学计数法，与 %g 的风格相同）
+ * @param buffer 缓冲区
+ * @param digits 数字
+ * @param length 数字个数
+ * @param k 十进制指数（值为 digits * 10^k）
+ * @return int 写入的字节数
+ */
+static inline int w_formatDigits_(char *buffer, const char *digits, int length, int k)
+{
+    int exponent = length + k - 1;
+    if (exponent >= -4 && exponent < 17)
+    {
+        if (k >= 0)
+        { /* 整数：数字后补 0 */
+            memcpy(buffer, digits, length);
+            memset(buffer + length, '0', k);
+            return length + k;
+        }
+        if (exponent >= 0)
+        { /* 小数点在数字中间 */
+            memcpy(buffer, digits, exponent + 1);
+            buffer[exponent + 1] = '.';
+            memcpy(buffer + exponent + 2, digits + exponent + 1, length - exponent - 1);
+            return length + 1;
+        }
+        /* 0.000ddd */
+        buffer[0] = '0';
+        buffer[1] = '.';
+        memset(buffer + 2, '0', -exponent - 1);
+        memcpy(buffer + 1 - exponent, digits, length);
+        return length + 1 - exponent;
+    }
+    /* d.ddde+XX */
+    int size = 0;
+    buffer[size++] = digits[0];
+    if (length > 1)
+    {
+        buffer[size++] = '.';
+        memcpy(buffer + size, digits + 1, length - 1);
+        size += length - 1;
+    }
+    buffer[size++] = 'e';
+    buffer[size++] = exponent < 0 ? '-' : '+';
+    int magnitude = exponent < 0 ? -exponent : exponent;
+    if (magnitude < 10)
+    {
+        buffer[size++] = '0';
+    }
+    return size + w_formatUnsignedLong(buffer + size, magnitude);
+}
+
+/**
+ * 格式化浮点数的公共部分（处理符号、0、无穷大和 NaN）
+ * @param buffer 缓冲区
+ * @param negative 是否为负数
+ * @param special 0:普通的数 1:零 2:无穷大 3:NaN
+ * @param size 已写入的字节数（输出）
+ * @return bool 是否已经完成
+ */
+static inline bool w_formatSpecial_(char *buffer, bool negative, int special, int *size)
+{
+    static const char *const names[] = {"", "0", "inf", "nan"};
+    *size = 0;
+    if (negative && special != 3)
+    {
+        buffer[(*size)++] = '-';
+    }
+    if (special == 0)
+    {
+        return false;
+    }
+    int length = (int)strlen(names[special]);
+    memcpy(buffer + *size, names[special], length);
+    *size += length;
+    return true;
+}
+
+/**
+ * 格式化 double（输出一定能还原出原值，通常是最短的十进制表示，约 0.1% 的值多 1 位，不申请内存）
+ * @param buffer 缓冲区（至少 w_FORMAT_DOUBLE_SIZE 字节，不写入 '\0'）
+ * @param value 浮点数
+ * @return int 写入的字节数
+ */
+static inline int w_formatDouble(char *buffer, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t mantissa = bits & ((UINT64_C(1) << 52) - 1);
+    int biased = (int)(bits >> 52 & 0x7FF);
+    int special = biased == 0x7FF ? (mantissa != 0 ? 3 : 2) : (biased == 0 && mantissa == 0 ? 1 : 0);
+    int size;
+    if (w_formatSpecial_(buffer, bits >> 63, special, &size))
+    {
+        return size;
+    }
+    w_DiyFp_ v = {biased != 0 ? mantissa | UINT64_C(1) << 52 : mantissa, biased != 0 ? biased - 1075 : -1074};
+    /* 边界为与相邻浮点数的中点；尾数为 2 的幂时下边界更近 */
+    w_DiyFp_ upper = {(v.f << 1) + 1, v.e - 1};
+    upper = w_DiyFp_normalize_(upper);
+    w_DiyFp_ lower = mantissa == 0 && biased > 1 ? (w_DiyFp_){(v.f << 2) - 1, v.e - 2} : (w_DiyFp_){(v.f << 1) - 1, v.e - 1};
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+    char digits[18];
+    int k;
+    int length = w_grisu2_(v, upper, lower, digits, &k);
+    return size + w_formatDigits_(buffer + size, digits, length, k);
+}
+
+/**
+ * 格式化 float（输出一定能还原出原值，通常是最短的十进制表示，约 0.2% 的值会多几位，不申请内存）
+ * @param buffer 缓冲区（至少 w_FORMAT_DOUBLE_SIZE 字节，不写入 '\0'）
+ * @param value 浮点数
+ * @return int 写入的字节数
+ */
+static inline int w_formatFloat(char *buffer, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t mantissa = bits & ((UINT32_C(1) << 23) - 1);
+    int biased = (int)(bits >> 23 & 0xFF);
+    int special = biased == 0xFF ? (mantissa != 0 ? 3 : 2) : (biased == 0 && mantissa == 0 ? 1 : 0);
+    int size;
+    if (w_formatSpecial_(buffer, bits >> 31, special, &size))
+    {
+        return size;
+    }
+    w_DiyFp_ v = {biased != 0 ? mantissa | UINT32_C(1) << 23 : mantissa, biased != 0 ? biased - 150 : -149};
+    w_DiyFp_ upper = {(v.f << 1) + 1, v.e - 1};
+    upper = w_DiyFp_normalize_(upper);
+    w_DiyFp_ lower = mantissa == 0 && biased > 1 ? (w_DiyFp_){(v.f << 2) - 1, v.e - 2} : (w_DiyFp_){(v.f << 1) - 1, v.e - 1};
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+    char digits[18];
+    int k;
+    int length = w_grisu2_(v, upper, lower, digits, &k);
+    return size + w_formatDigits_(buffer + size, digits, length, k);
+}
+
+// ========================================================================================================================================================
+//  字符串构造器
+// ========================================================================================================================================================
+
+// StringBuilder 类型定义
+typedef char w_StringBuilder_ValueType_;
+w_List_define(w_StringBuilder_ValueType_);
+typedef struct
+{
+    w_List(w_StringBuilder_ValueType_) list;
+    int64_t hash; /* 缓存的哈希值 */
+    bool hashed;  /* 哈希值是否有效（修改内容时清除；直接修改 list 后需要手动清除） */
+} w_StringBuilder;
+
+/**
+ * StringBuilder 初始化
+ * @param this
+ * @return void
+ */
+static inline void w_StringBuilder_init(w_StringBuilder *this)
+{
+    w_check(this != NULL);
+    w_List_init(w_StringBuilder_ValueType_)(&(this->list));
+    this->hash = 0;
+    this->hashed = false;
+}
+
+/**
+ * StringBuilder 释放
+ * @param this
+ * @return void
+ */
+static inline void w_StringBuilder_deinit(w_StringBuilder *this)
+{
+    w_check(this != NULL);
+    w_List_deinit(w_StringBuilder_ValueType_)(&(this->list));
+}
+
+/**
+ * 获取大小
+ * @param this
+ * @return int64_t
+ */
+static inline int64_t w_StringBuilder_size(w_StringBuilder *this)
+{
+    w_check(this != NULL);
+    return w_List_size(w_StringBuilder_ValueType_)(&(this->list));
+}
+
+/**
+ * 获取容量
+ * @param this
+ * @return int64_t
+ */
+static inline int64_t w_StringBuilder_capacity(w_StringBuilder *this)
+{
+    w_check(this != NULL);
+    return w_List_capacity(w_StringBuilder_ValueType_)(&(this->list));
+}
+
+/**
+ * 预留容量（容量不足时扩容到至少 capacity）
+ * @param this
+ * @param capacity 容量
+ * @return void
+ */
+static inline void w_StringBuilder_reserve(w_StringBuilder *this, int64_t capacity)
+{
+    w_check(this != NULL);
+    w_List_reserve(w_StringBuilder_ValueType_)(&(this->list), capacity);
+}
+
+/**
+ * 确保还能再写入 additional 个字符（容量不足时至少扩容到原来的 2 倍）
+ * @param this
+ * @param additional 要写入的字符数
+ * @return char * 当前末尾的地址（写入后由调用者增加 size）
+ */
+static inline char *w_StringBuilder_grow_(w_StringBuilder *this, int64_t additional)
+{
+    w_List(w_StringBuilder_ValueType_) *list = &(this->list);
+    int64_t required = list->size + additional;
+    this->hashed = false;
+    if (required > list->capacity)
+    {
+        w_List_reserve(w_StringBuilder_ValueType_)(list, required > list->capacity * 2 ? required : list->capacity * 2);
+    }
+    return list->elementData + list->size;
+}
+
+/**
+ * 写入到 C 字符串
+ * @param this
+ * @param buffer 要被写入的缓冲区
+ * @return void
+ */
+static inline void w_StringBuilder_toChars(w_StringBuilder *this, char *buffer)
+{
+    w_check(this != NULL);
+    w_check(buffer != NULL);
+    int64_t size = w_StringBuilder_size(this);
+    if (size > 0)
+    {
+        memcpy(buffer, w_List_data(w_StringBuilder_ValueType_)(&(this->list)), size);
+    }
+    buffer[size] = '\0';
+}
+
+/**
+ * 翻转序列
+ * @param this
+ * @return void
+ */
+static inline void w_StringBuilder_reverse(w_StringBuilder *this)
+{
+    w_check(this != NULL);
+    this->hashed = false;
+    int64_t i = 0, j = w_StringBuilder_size(this) - 1;
+    while (i < j)
+    {
+        char temp = w_List_get(w_StringBuilder_ValueType_)(&(this->list), i);
+        w_List_set(w_StringBuilder_ValueType_)(&(this->list), i, w_List_get(w_StringBuilder_ValueType_)(&(this->list), j));
+        w_List_set(w_StringBuilder_ValueType_)(&(this->list), j, temp);
+        i++;
+        j--;
+    }
+}
+
+/**
+ * 获取某个索引的元素
+ * @param this
+ * @param index 索引
+ * @return char
+ */
+static inline char w_StringBuilder_charAt(w_StringBuilder *this, int64_t index)
+{
+    w_check(this != NULL);
+    return w_List_get(w_StringBuilder_ValueType_)(&(this->list), index);
+}
+
+/**
+ * 设置某个索引的元素
+ * @param this
+ * @param index 索引
+ * @param value 要设置的字符
+ * @return void
+ */
+static inline void w_StringBuilder_setCharAt(w_StringBuilder *this, int64_t index, char value)
+{
+    w_check(this != NULL);
+    this->hashed = false;
+    w_List_set(w_StringBuilder_ValueType_)(&(this->list), index, value);
+}
+
+/**
+ * 获取某个索引的元素，不受检查级别影响，始终不做任何检查
+ * @param this
+ * @param index 索引（调用者保证在 [0, size) 内）
+ * @return char
+ */
+static inline char w_StringBuilder_charAtUnchecked(w_StringBuilder *this, int64_t index)
+{
+    return w_List_getUnchecked(w_StringBuilder_ValueType_)(&(this->list), index);
+}
+
+/**
+ * 将 char 插入到此序列
+ * @param this
+ * @param index 索引
+ * @param value 要插入的字符
+ * @return void
+ */
+static inline void w_StringBuilder_insertChar(w_StringBuilder *this, int64_t index, char value)
+{
+    // 断言
+    w_check(this != NULL);
+    // 插入
+    this->hashed = false;
+    w_List_add(w_StringBuilder_ValueType_)(&(this->list), index, value);
+}
+
+/**
+ * 将指定长度的字符插入到此序列（一次扩容和一次移动，不计算 strlen）
+ * @param this
+ * @param index 索引
+ * @param str 要插入的字符（可以包含 '\0'，不能指向 this 自身的内容）
+ * @param len 长度
+ * @return void
+ */
+static inline void w_StringBuilder_insertN(w_StringBuilder *this, int64_t index, const char *str, int64_t len)
+{
+    // 断言
+    w_check(this != NULL);
+    w_check(str != NULL || len == 0);
+    w_checkIndex(index >= 0 && index <= w_StringBuilder_size(this));
+    w_checkIndex(len >= 0);
+    if (len == 0)
+    {
+        return;
+    }
+    // 扩容，移动后面的字符，再复制
+    char *end = w_StringBuilder_grow_(this, len);
+    char *position = this->list.elementData + index;
+    memmove(position + len, position, end - position);
+    memcpy(position, str, len);
+    this->list.size += len;
+}
+
+/**
+ * 将 char[] 的子序列插入到此序列
+ * @param this
+ * @param index 索引
+ * @param str 要插入的字符串
+ * @param offset 子序列的起始索引
+ * @param len 子序列的长度
+ * @return void
+ */
+static inline void w_StringBuilder_insertSubChars(w_StringBuilder *this, int64_t index, const char *str, int64_t offset, int64_t len)
+{
+    // 断言（只检查子序列内没有 '\0'，不计算整个字符串的长度）
+    w_check(str != NULL);
+    w_checkIndex(offset >= 0 && len >= 0);
+    w_checkIndex(memchr(str, '\0', offset + len) == NULL);
+    // 插入
+    w_StringBuilder_insertN(this, index, str + offset, len);
+}
+
+/**
+ * 将 char[] 添加到此序列
+ * @param this
+ * @param str 要添加的字符串
+ * @return void
+ */
+static inline void w_StringBuilder_insertChars(w_StringBuilder *this, int64_t index, const char *str)
+{
+    w_check(str != NULL);
+    w_StringBuilder_insertN(this, index, str, strlen(str));
+}
+
+/**
+ * 将 bool 插入到此序列
+ * @param this
+ * @param index 索引
+ * @param value 要插入的布尔值
+ * @return void
+ */
+static inline void w_StringBuilder_insertBool(w_StringBuilder *this, int64_t index, bool value)
+{
+    w_StringBuilder_insertChars(this, index, value ? "true" : "false");
+}
+
+/**
+ * 将 double 插入到此序列
+ * @param this
+ * @param index 索引
+ * @param value 要插入的 double 值
+ * @return void
+ */
+static inline void w_StringBuilder_insertDouble(w_StringBuilder *this, int64_t index, double value)
+{
+    w_check(this != NULL);
+    char buffer[w_FORMAT_DOUBLE_SIZE];
+    w_StringBuilder_insertN(this, index, buffer, w_formatDouble(buffer, value));
+}
+
+/**
+ * 将 float 插入到此序列
+ * @param this
+ * @param index 索引
+ * @param value 要插入的 float 值
+ * @return void
+ */
+static inline void w_StringBuilder_insertFloat(w_StringBuilder *this, int64_t index, float value)
+{
+    w_check(this != NULL);
+    char buffer[w_FORMAT_DOUBLE_SIZE];
+    w_StringBuilder_insertN(this, index, buffer, w_formatFloat(buffer, value));
+}
+
+/**
+ * 将 long long (int64_t) 插入到此序列
+ * @param this
+ * @param index 索引
+ * @param value 要插入的 long long (int64_t) 值
+ * @return void
+ */
+static inline void w_StringBuilder_insertLong(w_StringBuilder *this, int64_t index, int64_t value)
+{
+    w_check(this != NULL);
+    char buffer[w_FORMAT_LONG_SIZE];
+    w_StringBuilder_insertN(this, index, buffer, w_formatLong(buffer, value));
+}
+
+/**
+ * 将 int 插入到此序列
+ * @param this
+ * @param index 索引
+ * @param value 要插入的 int 值
+ * @return void
+ */
+static inline void w_StringBuilder_insertInt(w_StringBuilder *this, int64_t index, int value)
+{
+    w_StringBuilder_insertLong(this, index, value);
+}
+
+/**
+ * 将 char 追加到此序列
+ * @param this
+ * @param value 要追加的 char 值
+ * @return void
+ */
+static inline void w_StringBuilder_appendChar(w_StringBuilder *this, char value)
+{
+    w_StringBuilder_insertChar(this, w_StringBuilder_size(this), value);
+}
+
+/**
+ * 将 char[] 的子序列追加到此序列
+ * @param this
+ * @param value 要追加的字符串
+ * @param offset 子序列的起始索引
+ * @param len 子序列的长度
+ * @return void
+ */
+static inline void w_StringBuilder_appendSubChars(w_StringBuilder *this, char *value, int64_t offset, int64_t len)
+{
+    w_StringBuilder_insertSubChars(this, w_StringBuilder_size(this), value, offset, len);
+}
+
+/**
+ * 将指定长度的字符追加到此序列（不计算 strlen）
+ * @param this
+ * @param value 要追加的字符（可以包含 '\0'，不能指向 this 自身的内容）
+ * @param len 长度
+ * @return void
+ */
+static inline void w_StringBuilder_appendN(w_StringBuilder *this, const char *value, int64_t len)
+{
+    w_check(this != NULL);
+    w_check(value != NULL || len == 0);
+    w_checkIndex(len >= 0);
+    if (len > 0)
+    {
+        memcpy(w_StringBuilder_grow_(this, len), value, len);
+        this->list.size += len;
+    }
+}
+
+/**
+ * 将 char[] 追加到此序列
+ * @param this
+ * @param value 要追加的字符串
+ * @return void
+ */
+static inline void w_StringBuilder_appendChars(w_StringBuilder *this, char *value)
+{
+    w_check(value != NULL);
+    w_StringBuilder_appendN(this, value, strlen(value));
+}
+
+/**
+ * 将 bool 追加到序列中
+ * @param this
+ * @param value 要追加的布尔值
+ * @return void
+ */
+static inline void w_StringBuilder_appendBool(w_StringBuilder *this, bool value)
+{
+    w_StringBuilder_insertBool(this, w_StringBuilder_size(this), value);
+}
+
+/**
+ * 将 double 加到此序列
+ * @param this
+ * @param value 要追加的 double 值
+ * @return void
+ */
+static inline void w_StringBuilder_appendDouble(w_StringBuilder *this, double value)
+{
+    w_check(this != NULL);
+    this->list.size += w_formatDouble(w_StringBuilder_grow_(this, w_FORMAT_DOUBLE_SIZE), value);
+}
+
+/**
+ * 将 float 追加到此序列
+ * @param this
+ * @param value 要追加的 float 值
+ * @return void
+ */
+static inline void w_StringBuilder_appendFloat(w_StringBuilder *this, float value)
+{
+    w_check(this != NULL);
+    this->list.size += w_formatFloat(w_StringBuilder_grow_(this, w_FORMAT_DOUBLE_SIZE), value);
+}
+
+/**
+ * 将 long 追加到此序列
+ * @param this
+ * @param value 要追加的 long 值
+ * @return void
+ */
+static inline void w_StringBuilder_appendLong(w_StringBuilder *this, int64_t value)
+{
+    w_check(this != NULL);
+    this->list.size += w_formatLong(w_StringBuilder_grow_(this, w_FORMAT_LONG_SIZE), value);
+}
 
-// Set Map 值类型
-typedef struct
+/**
+ * 将 int 追加到此序列
+ * @param this
+ * @param value 要追加的 int 值
+ * @return void
+ */
+static inline void w_StringBuilder_appendInt(w_StringBuilder *this, int value)
 {
-} w_Set_MapValueType_;
+    w_StringBuilder_appendLong(this, value);
+}
 
-// Set 类型定义
-#define w_Set_type_define_(T)              \
-    w_Map_define(T, w_Set_MapValueType_);  \
-    typedef struct                         \
-    {                                      \
-        w_Map(T, w_Set_MapValueType_) map; \
-    } w_Set(T);
+/**
+ * 删除字符
+ * @param this
+ * @param index 要删除的字符的索引
+ * @return void
+ */
+static inline void w_StringBuilder_removeCharAt(w_StringBuilder *this, int64_t index)
+{
+    w_check(this != NULL);
+    this->hashed = false;
+    w_List_remove(w_StringBuilder_ValueType_)(&(this->list), index);
+}
 
-// Set 初始化
-#define w_Set_init(T) w_concat(w_Set(T), _init)
-#define w_Set_init_define_(T)                           \
-    /**                                                 \
-     * Set 初始化                                    \
-     * @param this Set                                  \
-     * @return void                                     \
-     */                                                 \
-    static inline void w_Set_init(T)(w_Set(T) * this)   \
-    {                                                   \
-        w_assert(this != NULL);                         \
-        w_Map_init(T, w_Set_MapValueType_)(&this->map); \
+/**
+ * 删除序列
+ * @param this
+ * @param offset 要删除的子序列的起始索引
+ * @param len 要删除的子序列的长度
+ * @return void
+ */
+static inline void w_StringBuilder_remove(w_StringBuilder *this, int64_t offset, int64_t len)
+{
+    w_check(this != NULL);
+    int64_t size = w_StringBuilder_size(this);
+    w_checkIndex(offset >= 0 && len >= 0 && offset + len <= size);
+    if (len == 0)
+    {
+        return;
     }
+    // 一次移动后面的字符
+    char *position = this->list.elementData + offset;
+    memmove(position, position + len, size - offset - len);
+    this->list.size -= len;
+    this->hashed = false;
+}
 
-// Set 销毁
-#define w_Set_deinit(T) w_concat(w_Set(T), _deinit)
-#define w_Set_deinit_define_(T)                           \
-    /**                                                   \
-     * Set 销毁                                         \
-     * @param this Set                                    \
-     * @return void                                       \
-     */                                                   \
-    static inline void w_Set_deinit(T)(w_Set(T) * this)   \
-    {                                                     \
-        w_assert(this != NULL);                           \
-        w_Map_deinit(T, w_Set_MapValueType_)(&this->map); \
+/**
+ * 哈希函数（w_hashBytes，结果缓存到下一次修改）
+ * @param this
+ * @return int64_t
+ */
+static inline int64_t w_hash(w_StringBuilder)(w_StringBuilder *this)
+{
+    w_check(this != NULL);
+    if (!this->hashed)
+    {
+        this->hash = w_hashBytes(this->list.elementData, this->list.size);
+        this->hashed = true;
     }
+    return this->hash;
+}
 
-// Set 添加
-#define w_Set_add(T) w_concat(w_Set(T), _add)
-#define w_Set_add_define_(T)                                                           \
-    /**                                                                                \
-     * Set 添加                                                                      \
-     * @param this Set                                                                 \
-     * @param value 值                                                                \
-     * @return void                                                                    \
-     */                                                                                \
-    static inline void w_Set_add(T)(w_Set(T) * this, T value)                          \
-    {                                                                                  \
-        w_assert(this != NULL);                                                        \
-        w_Map_put(T, w_Set_MapValueType_)(&this->map, value, (w_Set_MapValueType_){}); \
+/**
+ * 查找两段内存第一个不同的字节（先按块 memcmp，再在块内每次比较 8 个字节）
+ * @param a
+ * @param b
+ * @param size 长度
+ * @return int64_t 第一个不同的字节的索引，完全相同返回 size
+ */
+static inline int64_t w_mismatchBytes_(const char *a, const char *b, int64_t size)
+{
+    int64_t i = 0;
+    while (i + 256 <= size && memcmp(a + i, b + i, 256) == 0)
+    {
+        i += 256;
     }
-
-// Set 移除
-#define w_Set_remove(T) w_concat(w_Set(T), _remove)
-#define w_Set_remove_define_(T)                                  \
-    /**                                                          \
-     * Set 移除                                                \
-     * @param this Set                                           \
-     * @param value 值                                          \
-     * @return void                                              \
-     */                                                          \
-    static inline void w_Set_remove(T)(w_Set(T) * this, T value) \
-    {                                                            \
-        w_assert(this != NULL);                                  \
-        w_Map_remove(T, w_Set_MapValueType_)(&this->map, value); \
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t diff = w_readLE64_((const uint8_t *)a + i) ^ w_readLE64_((const uint8_t *)b + i);
+        if (diff != 0)
+        {
+            return i + (__builtin_ctzll(diff) >> 3);
+        }
     }
-
-// Set 包含
-#define w_Set_contains(T) w_concat(w_Set(T), _contains)
-#define w_Set_contains_define_(T)                                            \
-    /**                                                                      \
-     * Set 包含                                                            \
-     * @param this Set                                                       \
-     * @param value 值                                                      \
-     * @return bool 是否包含                                             \
-     */                                                                      \
-    static inline bool w_Set_contains(T)(w_Set(T) * this, T value)           \
-    {                                                                        \
-        w_assert(this != NULL);                                              \
-        return w_Map_containsKey(T, w_Set_MapValueType_)(&this->map, value); \
+    for (; i < size; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return i;
+        }
     }
+    return size;
+}
 
-// Set 大小
-#define w_Set_size(T) w_concat(w_Set(T), _size)
-#define w_Set_size_define_(T)                                  \
-    /**                                                        \
-     * Set 大小                                              \
-     * @param this Set                                         \
-     * @return int 大小                                      \
-     */                                                        \
-    static inline int w_Set_size(T)(w_Set(T) * this)           \
-    {                                                          \
-        w_assert(this != NULL);                                \
-        return w_Map_size(T, w_Set_MapValueType_)(&this->map); \
-    }
+/**
+ * 将 8 个字节中的 ASCII 大写字母转换为小写（其他字节不变）
+ * @param x
+ * @return uint64_t
+ */
+static inline uint64_t w_toLower8_(uint64_t x)
+{
+    const uint64_t high = UINT64_C(0x8080808080808080);
+    const uint64_t low7 = x & ~high;
+    /* 每个字节的最高位：是否 >= 'A'，是否 > 'Z' */
+    uint64_t aboveA = low7 + UINT64_C(0x0101010101010101) * (0x80 - 'A');
+    uint64_t aboveZ = low7 + UINT64_C(0x0101010101010101) * (0x80 - 'Z' - 1);
+    uint64_t upper = (aboveA ^ aboveZ) & ~x & high;
+    return x | (upper >> 2);
+}
 
-// Set 迭代器
-#define w_Set_Iterator(T) w_concat(w_Set(T), _Iterator)
-#define w_Set_Iterator_type_define_(T)                      \
-    typedef struct                                          \
-    {                                                       \
-        w_Map_Iterator(T, w_Set_MapValueType_) mapIterator; \
-    } w_Set_Iterator(T);
+/**
+ * 将 ASCII 大写字母转换为小写（不受 locale 影响）
+ * @param c
+ * @return int 0 ~ 255
+ */
+static inline int w_toLowerAscii_(char c)
+{
+    unsigned char u = (unsigned char)c;
+    return u >= 'A' && u <= 'Z' ? u + ('a' - 'A') : u;
+}
 
-// Set 获取迭代器
-#define w_Set_iterator(T) w_concat(w_Set(T), _iterator)
-#define w_Set_iterator_define_(T)                                                                                  \
-    /**                                                                                                            \
-     * Set 获取迭代器                                                                                         \
-     * 使用完毕后不需要释放，使用期间不允许修改 Set，Set 修改后需要重新获取迭代器 \
-     * @param this Set                                                                                             \
-     * @return w_Set_Iterator(T) 迭代器                                                                         \
-     */                                                                                                            \
-    static inline w_Set_Iterator(T) w_Set_iterator(T)(w_Set(T) * this)                                             \
-    {                                                                                                              \
-        w_assert(this != NULL);                                                                                    \
-        return (w_Set_Iterator(T)){w_Map_iterator(T, w_Set_MapValueType_)(&this->map)};                            \
+/**
+ * 忽略 ASCII 大小写查找第一个不同的字节（每次比较 8 个字节）
+ * @param a
+ * @param b
+ * @param size 长度
+ * @return int64_t 第一个不同的字节的索引，完全相同返回 size
+ */
+static inline int64_t w_mismatchIgnoreCase_(const char *a, const char *b, int64_t size)
+{
+    int64_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t diff = w_toLower8_(w_readLE64_((const uint8_t *)a + i)) ^ w_toLower8_(w_readLE64_((const uint8_t *)b + i));
+        if (diff != 0)
+        {
+            return i + (__builtin_ctzll(diff) >> 3);
+        }
+    }
+    for (; i < size; i++)
+    {
+        if (w_toLowerAscii_(a[i]) != w_toLowerAscii_(b[i]))
+        {
+            return i;
+        }
     }
+    return size;
+}
 
-// Set 迭代器获取下一个元素
-#define w_Set_Iterator_next(T) w_concat(w_Set(T), _Iterator_next)
-#define w_Set_Iterator_next_define_(T)                                                                                \
-    /**                                                                                                               \
-     * Set 迭代器获取下一个元素                                                                             \
-     * @param this 迭代器                                                                                          \
-     * @param value 将下一个元素放入所指向的地址                                                        \
-     * @return bool 是否有下一个元素                                                                          \
-     */                                                                                                               \
-    static inline bool w_Set_Iterator_next(T)(w_Set_Iterator(T) * this, T * value)                                    \
-    {                                                                                                                 \
-        w_assert(this != NULL);                                                                                       \
-        w_Map_Entry(T, w_Set_MapValueType_) *entry = w_Map_Iterator_next(T, w_Set_MapValueType_)(&this->mapIterator); \
-        if (entry)                                                                                                    \
-        {                                                                                                             \
-            *value = entry->key;                                                                                      \
-            return true;                                                                                              \
-        }                                                                                                             \
-        return false;                                                                                                 \
+/**
+ * 按字节的字典序比较两段字符
+ * @param a
+ * @param aSize a 的长度
+ * @param b
+ * @param bSize b 的长度
+ * @param ignoreCase 是否忽略 ASCII 大小写
+ * @return int64_t
+ */
+static inline int64_t w_compareBytes_(const char *a, int64_t aSize, const char *b, int64_t bSize, bool ignoreCase)
+{
+    int64_t size = aSize < bSize ? aSize : bSize;
+    if (!ignoreCase)
+    {
+        int result = size > 0 ? memcmp(a, b, size) : 0;
+        if (result != 0)
+        {
+            return result > 0 ? 1 : -1;
+        }
+    }
+    else
+    {
+        int64_t index = w_mismatchIgnoreCase_(a, b, size);
+        if (index < size)
+        {
+            int c1 = w_toLowerAscii_(a[index]), c2 = w_toLowerAscii_(b[index]);
+            return c1 > c2 ? 1 : -1;
+        }
     }
+    return (aSize > bSize) - (aSize < bSize);
+}
 
-// Set 定义
-// 定义 Set 需要定义 T 的 w_hash 和 w_equals 函数
-#define w_Set_define(T)             \
-    w_Set_type_define_(T);          \
-    w_Set_init_define_(T);          \
-    w_Set_deinit_define_(T);        \
-    w_Set_add_define_(T);           \
-    w_Set_remove_define_(T);        \
-    w_Set_contains_define_(T);      \
-    w_Set_size_define_(T);          \
-    w_Set_Iterator_type_define_(T); \
-    w_Set_iterator_define_(T);      \
-    w_Set_Iterator_next_define_(T);
+/**
+ * 比较函数（按字节的字典序，与 StringView 一致）
+ * @param this
+ * @param other
+ * @return int64_t
+ */
+static inline int64_t w_compare(w_StringBuilder)(w_StringBuilder *this, w_StringBuilder *other)
+{
+    w_check(this != NULL);
+    w_check(other != NULL);
+    return w_compareBytes_(this->list.elementData, this->list.size, other->list.elementData, other->list.size, false);
+}
+
+/**
+ * 比较函数
+ * @param this
+ * @param other
+ * @return bool
+ */
+static inline bool w_equals(w_StringBuilder)(w_StringBuilder *this, w_StringBuilder *other)
+{
+    w_check(this != NULL);
+    w_check(other != NULL);
+    int64_t size = w_StringBuilder_size(this);
+    if (size != w_StringBuilder_size(other) || (this->hashed && other->hashed && this->hash != other->hash))
+    {
+        // 长度或缓存的哈希值不同
+        return false;
+    }
+    return size == 0 || memcmp(this->list.elementData, other->list.elementData, size) == 0;
+}
+
+/**
+ * 忽略 ASCII 大小写比较
+ * @param this
+ * @param other
+ * @return int64_t
+ */
+static inline int64_t w_StringBuilder_compareIgnoreCase(w_StringBuilder *this, w_StringBuilder *other)
+{
+    w_check(this != NULL);
+    w_check(other != NULL);
+    return w_compareBytes_(this->list.elementData, this->list.size, other->list.elementData, other->list.size, true);
+}
 
-// ========================================================================================================================================================
-//  数字类型的哈希和比较操作定义
-// ========================================================================================================================================================
+/**
+ * 忽略 ASCII 大小写判断是否相等
+ * @param this
+ * @param other
+ * @return bool
+ */
+static inline bool w_StringBuilder_equalsIgnoreCase(w_StringBuilder *this, w_StringBuilder *other)
+{
+    w_check(this != NULL);
+    w_check(other != NULL);
+    int64_t size = w_StringBuilder_size(this);
+    return size == w_StringBuilder_size(other) && w_mismatchIgnoreCase_(this->list.elementData, other->list.elementData, size) == size;
+}
 
-// 数字类型哈希函数
-#define w_number_hash_define_(T)               \
-    static inline int64_t w_hash(T)(T * value) \
-    {                                          \
-        w_assert(value != NULL);               \
-        return (int64_t)*value;                \
-    }
+/**
+ * 查找第一个不同的字符
+ * @param this
+ * @param other
+ * @return int64_t 第一个不同的字符的索引；一个是另一个的前缀时返回较短的长度；相等返回 -1
+ */
+static inline int64_t w_StringBuilder_mismatch(w_StringBuilder *this, w_StringBuilder *other)
+{
+    w_check(this != NULL);
+    w_check(other != NULL);
+    int64_t size = this->list.size < other->list.size ? this->list.size : other->list.size;
+    int64_t index = w_mismatchBytes_(this->list.elementData, other->list.elementData, size);
+    return index == size && this->list.size == other->list.size ? -1 : index;
+}
 
-// 数字类型比较函数
-#define w_number_equals_define_(T)               \
-    static inline bool w_equals(T)(T * a, T * b) \
-    {                                            \
-        w_assert(a != NULL && b != NULL);        \
-        return *a == *b;                         \
-    }
+/**
+ * 判断是否以指定的字符串开头
+ * @param this
+ * @param prefix 前缀
+ * @return bool
+ */
+static inline bool w_StringBuilder_startsWith(w_StringBuilder *this, const char *prefix)
+{
+    w_check(this != NULL);
+    w_check(prefix != NULL);
+    int64_t len = strlen(prefix);
+    return len <= this->list.size && (len == 0 || memcmp(this->list.elementData, prefix, len) == 0);
+}
 
-// 数字类型比较函数
-#define w_number_compare_define_(T)                  \
-    static inline int64_t w_compare(T)(T * a, T * b) \
-    {                                                \
-        w_assert(a != NULL && b != NULL);            \
-        T sub = *a - *b;                             \
-        if (sub < 0)                                 \
-        {                                            \
-            return -1;                               \
-        }                                            \
-        else if (sub > 0)                            \
-        {                                            \
-            return 1;                                \
-        }                                            \
-        else                                         \
-        {                                            \
-            return 0;                                \
-        }                                            \
-    }
+/**
+ * 判断是否以指定的字符串结尾
+ * @param this
+ * @param suffix 后缀
+ * @return bool
+ */
+static inline bool w_StringBuilder_endsWith(w_StringBuilder *this, const char *suffix)
+{
+    w_check(this != NULL);
+    w_check(suffix != NULL);
+    int64_t len = strlen(suffix);
+    return len <= this->list.size && (len == 0 || memcmp(this->list.elementData + this->list.size - len, suffix, len) == 0);
+}
 
-// 数字比较和哈希函数类型定义
-#define w_number_type_hash_and_compare_define_(T) \
-    w_number_hash_define_(T);                     \
-    w_number_equals_define_(T);                   \
-    w_number_compare_define_(T);
+// 字符串视图（不持有内存，不以 '\0' 结尾）
+typedef struct
+{
+    const char *data; /* 数据 */
+    int64_t size;     /* 长度 */
+} w_StringView;
 
-// 使用宏定义定义所有数字类型的比较和哈希函数
-w_number_type_hash_and_compare_define_(int8_t);
-w_number_type_hash_and_compare_define_(int16_t);
-w_number_type_hash_and_compare_define_(int32_t);
-w_number_type_hash_and_compare_define_(int64_t);
-w_number_type_hash_and_compare_define_(uint8_t);
-w_number_type_hash_and_compare_define_(uint16_t);
-w_number_type_hash_and_compare_define_(uint32_t);
-w_number_type_hash_and_compare_define_(uint64_t);
-w_number_type_hash_and_compare_define_(bool);
-w_number_type_hash_and_compare_define_(char);
-w_number_type_hash_and_compare_define_(short);
-w_number_type_hash_and_compare_define_(int);
-w_number_type_hash_and_compare_define_(long);
-w_number_type_hash_and_compare_define_(float);
-w_number_type_hash_and_compare_define_(double);
+/**
+ * 从内存创建字符串视图
+ * @param data 数据
+ * @param size 长度
+ * @return w_StringView
+ */
+static inline w_StringView w_StringView_of(const char *data, int64_t size)
+{
+    w_check(data != NULL || size == 0);
+    w_check(size >= 0);
+    w_StringView view = {data, size};
+    return view;
+}
 
-// ========================================================================================================================================================
-//  指针类型
-// ========================================================================================================================================================
+/**
+ * 从 C 字符串创建字符串视图
+ * @param str C 字符串
+ * @return w_StringView
+ */
+static inline w_StringView w_StringView_ofChars(const char *str)
+{
+    w_check(str != NULL);
+    return w_StringView_of(str, strlen(str));
+}
 
-// 指针类型
-// 简单封装，为了传入 w_concat 后能输出有效标识符
-#define w_Ptr(T) w_concat(w_Ptr_, T)
+/**
+ * 获取 StringBuilder 内容的视图（不复制，修改 StringBuilder 后失效）
+ * @param this
+ * @return w_StringView
+ */
+static inline w_StringView w_StringBuilder_view(w_StringBuilder *this)
+{
+    w_check(this != NULL);
+    return w_StringView_of(w_List_data(w_StringBuilder_ValueType_)(&(this->list)), w_StringBuilder_size(this));
+}
 
-// 指针类型定义
-#define w_Ptr_define(T) typedef T *w_Ptr(T)
+/**
+ * 获取长度
+ * @param view
+ * @return int64_t
+ */
+static inline int64_t w_StringView_size(w_StringView view)
+{
+    return view.size;
+}
 
-// ========================================================================================================================================================
-//  字符串构造器
-// ========================================================================================================================================================
+/**
+ * 获取某个索引的字符
+ * @param view
+ * @param index 索引
+ * @return char
+ */
+static inline char w_StringView_charAt(w_StringView view, int64_t index)
+{
+    w_checkIndex(index >= 0 && index < view.size);
+    return view.data[index];
+}
 
-// StringBuilder 类型定义
-typedef char w_StringBuilder_ValueType_;
-w_List_define(w_StringBuilder_ValueType_);
-typedef struct
+/**
+ * 子视图
+ * @param view
+ * @param offset 起始索引
+ * @param len 长度
+ * @return w_StringView
+ */
+static inline w_StringView w_StringView_subview(w_StringView view, int64_t offset, int64_t len)
 {
-    w_List(w_StringBuilder_ValueType_) list;
-} w_StringBuilder;
+    w_checkIndex(offset >= 0 && offset <= view.size);
+    w_checkIndex(len >= 0 && offset + len <= view.size);
+    return w_StringView_of(view.data + offset, len);
+}
 
 /**
- * StringBuilder 初始化
+ * 追加字符串视图
  * @param this
+ * @param view 字符串视图（不能指向 this 自身的内容）
  * @return void
  */
-static inline void w_StringBuilder_init(w_StringBuilder *this)
+static inline void w_StringBuilder_appendView(w_StringBuilder *this, w_StringView view)
 {
-    w_assert(this != NULL);
-    w_List_init(w_StringBuilder_ValueType_)(&(this->list));
+    w_StringBuilder_appendN(this, view.data, view.size);
 }
 
 /**
- * StringBuilder 释放
+ * 哈希函数（与 StringBuilder 的哈希值一致）
  * @param this
- * @return void
+ * @return int64_t
  */
-static inline void w_StringBuilder_deinit(w_StringBuilder *this)
+static inline int64_t w_hash(w_StringView)(w_StringView *this)
 {
-    w_assert(this != NULL);
-    w_List_deinit(w_StringBuilder_ValueType_)(&(this->list));
+    w_check(this != NULL);
+    return w_hashBytes(this->data, this->size);
 }
 
 /**
- * 获取大小
+ * 比较函数（按字节的字典序）
  * @param this
+ * @param other
  * @return int64_t
  */
-static inline int64_t w_StringBuilder_size(w_StringBuilder *this)
+static inline int64_t w_compare(w_StringView)(w_StringView *this, w_StringView *other)
 {
-    w_assert(this != NULL);
-    return w_List_size(w_StringBuilder_ValueType_)(&(this->list));
+    w_check(this != NULL);
+    w_check(other != NULL);
+    return w_compareBytes_(this->data, this->size, other->data, other->size, false);
 }
 
 /**
- * 获取容量
+ * 比较函数
  * @param this
+ * @param other
+ * @return bool
+ */
+static inline bool w_equals(w_StringView)(w_StringView *this, w_StringView *other)
+{
+    w_check(this != NULL);
+    w_check(other != NULL);
+    return this->size == other->size && (this->size == 0 || memcmp(this->data, other->data, this->size) == 0);
+}
+
+/**
+ * 忽略 ASCII 大小写比较
+ * @param view
+ * @param other
  * @return int64_t
  */
-static inline int64_t w_StringBuilder_capacity(w_StringBuilder *this)
+static inline int64_t w_StringView_compareIgnoreCase(w_StringView view, w_StringView other)
 {
-    w_assert(this != NULL);
-    return w_List_capacity(w_StringBuilder_ValueType_)(&(this->list));
+    return w_compareBytes_(view.data, view.size, other.data, other.size, true);
 }
 
 /**
- * 写入到 C 字符串
- * @param this
- * @param buffer 要被写入的缓冲区
- * @return void
+ * 忽略 ASCII 大小写判断是否相等
+ * @param view
+ * @param other
+ * @return bool
  */
-static inline void w_StringBuilder_toChars(w_StringBuilder *this, char *buffer)
+static inline bool w_StringView_equalsIgnoreCase(w_StringView view, w_StringView other)
 {
-    w_assert(this != NULL);
-    w_assert(buffer != NULL);
-    int64_t size = w_StringBuilder_size(this);
-    memcpy(buffer, w_List_data(w_StringBuilder_ValueType_)(&(this->list)), size);
-    buffer[size] = '\0';
+    return view.size == other.size && w_mismatchIgnoreCase_(view.data, other.data, view.size) == view.size;
 }
 
 /**
- * 翻转序列
- * @param this
- * @return void
+ * 查找第一个不同的字符
+ * @param view
+ * @param other
+ * @return int64_t 第一个不同的字符的索引；一个是另一个的前缀时返回较短的长度；相等返回 -1
  */
-static inline void w_StringBuilder_reverse(w_StringBuilder *this)
+static inline int64_t w_StringView_mismatch(w_StringView view, w_StringView other)
 {
-    w_assert(this != NULL);
-    int64_t i = 0, j = w_StringBuilder_size(this) - 1;
-    while (i < j)
+    int64_t size = view.size < other.size ? view.size : other.size;
+    int64_t index = w_mismatchBytes_(view.data, other.data, size);
+    return index == size && view.size == other.size ? -1 : index;
+}
+
+/**
+ * 判断是否以指定的前缀开头
+ * @param view
+ * @param prefix 前缀
+ * @return bool
+ */
+static inline bool w_StringView_startsWith(w_StringView view, w_StringView prefix)
+{
+    return prefix.size <= view.size && (prefix.size == 0 || memcmp(view.data, prefix.data, prefix.size) == 0);
+}
+
+/**
+ * 判断是否以指定的后缀结尾
+ * @param view
+ * @param suffix 后缀
+ * @return bool
+ */
+static inline bool w_StringView_endsWith(w_StringView view, w_StringView suffix)
+{
+    return suffix.size <= view.size && (suffix.size == 0 || memcmp(view.data + view.size - suffix.size, suffix.data, suffix.size) == 0);
+}
+
+
+// ========================================================================================================================================================
+//  字符串查找
+// ========================================================================================================================================================
+
+// 模式串长度不超过此值时，StringBuilder 的一次性查找在栈上构建 KMP 表
+#define w_STRING_SEARCH_STACK_SIZE_ 64
+
+/**
+ * 估计字节在文本中出现的频率（值越大越常见）
+ * @param c 字节
+ * @return int 频率等级
+ */
+static inline int w_byteRank_(unsigned char c)
+{
+    /* 英文小写字母按常见程度排序 */
+    static const char letters[] = "etaoinsrhldcumfpgwybvkxjqz";
+    if (c == ' ')
     {
-        char temp = w_List_get(w_StringBuilder_ValueType_)(&(this->list), i);
-        w_List_set(w_StringBuilder_ValueType_)(&(this->list), i, w_List_get(w_StringBuilder_ValueType_)(&(this->list), j));
-        w_List_set(w_StringBuilder_ValueType_)(&(this->list), j, temp);
-        i++;
-        j--;
+        return 255;
+    }
+    if (c >= 'a' && c <= 'z')
+    {
+        return 220 - (int)(strchr(letters, c) - letters) * 4;
+    }
+    if (c >= '0' && c <= '9')
+    {
+        return 130;
     }
+    if (c == '\n' || c == '\t' || (c != 0 && strchr(".,:;/-_=\"'()", c) != NULL))
+    {
+        return 120;
+    }
+    if (c >= 'A' && c <= 'Z')
+    {
+        return 100;
+    }
+    if (c >= 0x20 && c < 0x7F)
+    {
+        return 60;
+    }
+    return c >= 0x80 ? 40 : 20;
 }
 
 /**
- * 获取某个索引的元素
- * @param this
- * @param index 索引
- * @return char
+ * 选择模式串中最少见的字节（查找时先用 memchr 定位它，再从候选位置匹配）
+ * @param pattern 模式串
+ * @param size 长度（大于 0）
+ * @return int64_t 字节在模式串中的索引
  */
-static inline char w_StringBuilder_charAt(w_StringBuilder *this, int64_t index)
+static inline int64_t w_rareByteIndex_(const char *pattern, int64_t size)
 {
-    w_assert(this != NULL);
-    return w_List_get(w_StringBuilder_ValueType_)(&(this->list), index);
+    int64_t index = 0;
+    int best = w_byteRank_((unsigned char)pattern[0]);
+    for (int64_t i = 1; i < size; i++)
+    {
+        int rank = w_byteRank_((unsigned char)pattern[i]);
+        if (rank < best)
+        {
+            best = rank;
+            index = i;
+        }
+    }
+    return index;
 }
 
 /**
- * 设置某个索引的元素
- * @param this
- * @param index 索引
- * @param value 要设置的字符
+ * 构建 KMP 表（next[i] 为 pattern[0, i] 的最长真前后缀长度）
+ * @param pattern 模式串
+ * @param size 长度
+ * @param reverse 是否按反向的模式串构建（用于从后向前查找）
+ * @param next KMP 表（输出，长度为 size）
  * @return void
  */
-static inline void w_StringBuilder_setCharAt(w_StringBuilder *this, int64_t index, char value)
+static inline void w_kmpTable_(const char *pattern, int64_t size, bool reverse, int64_t *next)
 {
-    w_assert(this != NULL);
-    w_List_set(w_StringBuilder_ValueType_)(&(this->list), index, value);
+#define w_KMP_AT_(i) (reverse ? pattern[size - 1 - (i)] : pattern[i])
+    if (size > 0)
+    {
+        next[0] = 0;
+    }
+    int64_t j = 0;
+    for (int64_t i = 1; i < size; i++)
+    {
+        while (j > 0 && w_KMP_AT_(i) != w_KMP_AT_(j))
+        {
+            j = next[j - 1];
+        }
+        if (w_KMP_AT_(i) == w_KMP_AT_(j))
+        {
+            j++;
+        }
+        next[i] = j;
+    }
+#undef w_KMP_AT_
 }
 
 /**
- * 将 char 插入到此序列
- * @param this
- * @param index 索引
- * @param value 要插入的字符
- * @return void
+ * 从前向后查找（没有部分匹配时用 memchr 跳到模式串中罕见字节的下一个候选位置，总时间为线性）
+ * @param data 文本
+ * @param n 文本长度
+ * @param fromIndex 起始索引
+ * @param pattern 模式串
+ * @param size 模式串长度
+ * @param next KMP 表
+ * @param rareIndex 罕见字节在模式串中的索引
+ * @return int64_t 起始索引，未找到返回 -1
  */
-static inline void w_StringBuilder_insertChar(w_StringBuilder *this, int64_t index, char value)
+static inline int64_t w_kmpIndexOf_(const char *data, int64_t n, int64_t fromIndex, const char *pattern, int64_t size, const int64_t *next, int64_t rareIndex)
 {
-    // 断言
-    w_assert(this != NULL);
-    // 插入
-    w_List_add(w_StringBuilder_ValueType_)(&(this->list), index, value);
+    if (size == 0)
+    {
+        return fromIndex <= n ? fromIndex : -1;
+    }
+    int64_t j = 0;
+    for (int64_t i = fromIndex; i < n; i++)
+    {
+        if (j == 0)
+        {
+            if (n - i < size)
+            {
+                return -1;
+            }
+            const char *hit = memchr(data + i + rareIndex, pattern[rareIndex], n - size + 1 - i);
+            if (hit == NULL)
+            {
+                return -1;
+            }
+            i = hit - data - rareIndex;
+        }
+        while (j > 0 && data[i] != pattern[j])
+        {
+            j = next[j - 1];
+        }
+        if (data[i] == pattern[j] && ++j == size)
+        {
+            return i + 1 - size;
+        }
+    }
+    return -1;
+}
+
+/**
+ * 从后向前查找（按反向的模式串匹配）
+ * @param data 文本
+ * @param n 文本长度
+ * @param fromIndex 最大的起始索引
+ * @param pattern 模式串
+ * @param size 模式串长度
+ * @param next 反向模式串的 KMP 表
+ * @param rareIndex 罕见字节在模式串中的索引
+ * @return int64_t 起始索引，未找到返回 -1
+ */
+static inline int64_t w_kmpLastIndexOf_(const char *data, int64_t n, int64_t fromIndex, const char *pattern, int64_t size, const int64_t *next, int64_t rareIndex)
+{
+    if (fromIndex > n - size)
+    {
+        fromIndex = n - size;
+    }
+    if (fromIndex < 0)
+    {
+        return -1;
+    }
+    if (size == 0)
+    {
+        return fromIndex;
+    }
+    int64_t j = 0;
+    for (int64_t i = fromIndex + size - 1; i >= 0; i--)
+    {
+        if (j == 0)
+        {
+            /* 候选位置的起始索引为 i - size + 1 */
+            int64_t k = i - size + 1 + rareIndex;
+            while (k >= rareIndex && data[k] != pattern[rareIndex])
+            {
+                k--;
+            }
+            if (k < rareIndex)
+            {
+                return -1;
+            }
+            i = k - rareIndex + size - 1;
+        }
+        while (j > 0 && data[i] != pattern[size - 1 - j])
+        {
+            j = next[j - 1];
+        }
+        if (data[i] == pattern[size - 1 - j] && ++j == size)
+        {
+            return i;
+        }
+    }
+    return -1;
 }
 
+// 预编译的子串查找器（构建一次，可以在多段文本中重复查找）
+typedef struct
+{
+    char *pattern;        /* 模式串（复制） */
+    int64_t size;         /* 模式串长度 */
+    int64_t *next;        /* KMP 表 */
+    int64_t *nextReverse; /* 反向模式串的 KMP 表 */
+    int64_t rareIndex;    /* 罕见字节在模式串中的索引 */
+} w_StringSearcher;
+
 /**
- * 将 char[] 的子序列插入到此序列
+ * 初始化
  * @param this
- * @param index 索引
- * @param str 要插入的字符串
- * @param offset 子序列的起始索引
- * @param len 子序列的长度
+ * @param pattern 模式串（会被复制）
  * @return void
  */
-static inline void w_StringBuilder_insertSubChars(w_StringBuilder *this, int64_t index, const char *str, int64_t offset, int64_t len)
+static inline void w_StringSearcher_init(w_StringSearcher *this, w_StringView pattern)
 {
-    // 断言
-    w_assert(this != NULL);
-    w_assert(str != NULL);
-    int64_t strSize = strlen(str);
-    w_assert(offset >= 0 && offset <= strSize);
-    w_assert(len >= 0 && offset + len <= strSize);
-
-    // 循环插入
-    for (int64_t i = 0; i < len; i++)
+    w_check(this != NULL);
+    w_check(pattern.data != NULL || pattern.size == 0);
+    /* 两个 KMP 表和模式串放在同一块内存中 */
+    int64_t *tables = w_malloc(sizeof(int64_t) * pattern.size * 2 + pattern.size + 1);
+    w_assert(tables != NULL);
+    this->size = pattern.size;
+    this->next = tables;
+    this->nextReverse = tables + pattern.size;
+    this->pattern = (char *)(tables + pattern.size * 2);
+    if (pattern.size > 0)
     {
-        w_StringBuilder_insertChar(this, index + i, str[offset + i]);
+        memcpy(this->pattern, pattern.data, pattern.size);
     }
+    this->pattern[pattern.size] = '\0';
+    w_kmpTable_(this->pattern, this->size, false, this->next);
+    w_kmpTable_(this->pattern, this->size, true, this->nextReverse);
+    this->rareIndex = this->size > 0 ? w_rareByteIndex_(this->pattern, this->size) : 0;
 }
 
 /**
- * 将 char[] 添加到此序列
+ * 释放
  * @param this
- * @param str 要添加的字符串
  * @return void
  */
-static inline void w_StringBuilder_insertChars(w_StringBuilder *this, int64_t index, const char *str)
+static inline void w_StringSearcher_deinit(w_StringSearcher *this)
 {
-    w_StringBuilder_insertSubChars(this, index, str, 0, strlen(str));
+    w_check(this != NULL);
+    w_free(this->next);
+    this->next = NULL;
+    this->nextReverse = NULL;
+    this->pattern = NULL;
 }
 
 /**
- * 将 bool 插入到此序列
+ * 查找第一次出现的位置
  * @param this
- * @param index 索引
- * @param value 要插入的布尔值
- * @return void
+ * @param text 文本
+ * @param fromIndex 起始索引
+ * @return int64_t 起始索引，未找到返回 -1（模式串为空时返回 fromIndex）
  */
-static inline void w_StringBuilder_insertBool(w_StringBuilder *this, int64_t index, bool value)
+static inline int64_t w_StringSearcher_indexOf(w_StringSearcher *this, w_StringView text, int64_t fromIndex)
 {
-    w_StringBuilder_insertChars(this, index, value ? "true" : "false");
+    w_check(this != NULL);
+    w_checkIndex(fromIndex >= 0);
+    return w_kmpIndexOf_(text.data, text.size, fromIndex, this->pattern, this->size, this->next, this->rareIndex);
 }
 
 /**
- * 将 double 插入到此序列
+ * 查找最后一次出现的位置
  * @param this
- * @param index 索引
- * @param value 要插入的 double 值
- * @return void
+ * @param text 文本
+ * @param fromIndex 最大的起始索引（大于等于 text.size 时查找整个文本）
+ * @return int64_t 起始索引，未找到返回 -1
  */
-static inline void w_StringBuilder_insertDouble(w_StringBuilder *this, int64_t index, double value)
+static inline int64_t w_StringSearcher_lastIndexOf(w_StringSearcher *this, w_StringView text, int64_t fromIndex)
 {
-    w_assert(this != NULL);
-    char buffer[32];
-    snprintf(buffer, sizeof(buffer), "%.15g", value);
-    w_StringBuilder_insertChars(this, index, buffer);
+    w_check(this != NULL);
+    w_checkIndex(fromIndex >= 0);
+    return w_kmpLastIndexOf_(text.data, text.size, fromIndex, this->pattern, this->size, this->nextReverse, this->rareIndex);
 }
 
 /**
- * 将 float 插入到此序列
+ * 查找所有不重叠的出现位置（模式串为空时每个位置都匹配）
  * @param this
- * @param index 索引
- * @param value 要插入的 float 值
- * @return void
+ * @param text 文本
+ * @param indices 起始索引（输出，最多写入 capacity 个，可以为 NULL）
+ * @param capacity indices 的容量
+ * @return int64_t 出现的总次数（可能大于 capacity）
  */
-static inline void w_StringBuilder_insertFloat(w_StringBuilder *this, int64_t index, float value)
+static inline int64_t w_StringSearcher_findAll(w_StringSearcher *this, w_StringView text, int64_t *indices, int64_t capacity)
 {
-    w_StringBuilder_insertDouble(this, index, value);
+    w_check(this != NULL);
+    w_check(indices != NULL || capacity == 0);
+    int64_t count = 0;
+    int64_t index = w_kmpIndexOf_(text.data, text.size, 0, this->pattern, this->size, this->next, this->rareIndex);
+    while (index >= 0)
+    {
+        if (count < capacity)
+        {
+            indices[count] = index;
+        }
+        count++;
+        index = w_kmpIndexOf_(text.data, text.size, index + (this->size > 0 ? this->size : 1), this->pattern, this->size, this->next, this->rareIndex);
+    }
+    return count;
 }
 
 /**
- * 将 long long (int64_t) 插入到此序列
+ * 统计不重叠的出现次数
  * @param this
- * @param index 索引
- * @param value 要插入的 long long (int64_t) 值
- * @return void
+ * @param text 文本
+ * @return int64_t
  */
-static inline void w_StringBuilder_insertLong(w_StringBuilder *this, int64_t index, int64_t value)
+static inline int64_t w_StringSearcher_count(w_StringSearcher *this, w_StringView text)
 {
-    w_assert(this != NULL);
-    char buffer[32];
-    sprintf(buffer, "%lld", value);
-    w_StringBuilder_insertChars(this, index, buffer);
+    return w_StringSearcher_findAll(this, text, NULL, 0);
 }
 
-/**
- * 将 int 插入到此序列
- * @param this
- * @param index 索引
- * @param value 要插入的 int 值
- * @return void
- */
-static inline void w_StringBuilder_insertInt(w_StringBuilder *this, int64_t index, int value)
+// 多模式串查找器（Aho-Corasick 自动机，字节按是否出现在模式串中压缩为字节类）
+typedef struct
 {
-    w_StringBuilder_insertLong(this, index, value);
-}
+    int32_t *transitions;  /* 状态转移表（stateCount * classCount） */
+    int32_t *matches;      /* 以该状态结尾的最长模式串中索引最小的一个，没有则为 -1 */
+    int32_t *duplicates;   /* 与该模式串相同的下一个模式串索引，没有则为 -1 */
+    int32_t *outputs;      /* 沿失配链的下一个有匹配的状态，没有则为 0 */
+    int32_t *depths;       /* 状态对应的前缀长度 */
+    int64_t patternCount;  /* 模式串数量 */
+    int32_t stateCount;    /* 状态数量 */
+    int32_t classCount;    /* 字节类数量（0 为不出现在任何模式串中的字节） */
+    uint16_t classes[256]; /* 字节 -> 字节类 */
+    bool starts[256];      /* 字节是否为某个模式串的首字节 */
+} w_MultiStringSearcher;
 
 /**
- * 将 char 追加到此序列
+ * 初始化
  * @param this
- * @param value 要追加的 char 值
+ * @param patterns 模式串（不能为空串，不会被引用，相同的模式串会分别报告）
+ * @param count 模式串数量
  * @return void
  */
-static inline void w_StringBuilder_appendChar(w_StringBuilder *this, char value)
+static inline void w_MultiStringSearcher_init(w_MultiStringSearcher *this, const w_StringView *patterns, int64_t count)
 {
-    w_StringBuilder_insertChar(this, w_StringBuilder_size(this), value);
+    w_check(this != NULL);
+    w_check(patterns != NULL || count == 0);
+    w_check(count >= 0 && count <= INT32_MAX);
+    memset(this->classes, 0, sizeof(this->classes));
+    memset(this->starts, 0, sizeof(this->starts));
+    int64_t total = 1;
+    for (int64_t p = 0; p < count; p++)
+    {
+        w_check(patterns[p].size > 0);
+        total += patterns[p].size;
+        this->starts[(unsigned char)patterns[p].data[0]] = true;
+        for (int64_t i = 0; i < patterns[p].size; i++)
+        {
+            this->classes[(unsigned char)patterns[p].data[i]] = 1;
+        }
+    }
+    w_assert(total <= INT32_MAX);
+    int32_t classCount = 1;
+    for (int c = 0; c < 256; c++)
+    {
+        if (this->classes[c] != 0)
+        {
+            this->classes[c] = (uint16_t)classCount++;
+        }
+    }
+    this->classCount = classCount;
+    this->patternCount = count;
+    this->transitions = w_malloc(sizeof(int32_t) * total * classCount);
+    w_assert(this->transitions != NULL);
+    this->matches = w_malloc(sizeof(int32_t) * (total * 3 + count));
+    w_assert(this->matches != NULL);
+    this->outputs = this->matches + total;
+    this->depths = this->outputs + total;
+    this->duplicates = this->depths + total;
+    memset(this->transitions, 0, sizeof(int32_t) * total * classCount);
+    int32_t *fail = w_malloc(sizeof(int32_t) * total * 2);
+    w_assert(fail != NULL);
+
+    /* 构建字典树（转移为 0 表示没有子节点），相同的模式串按索引顺序串成链表，fail 暂时记录链表尾 */
+    int32_t stateCount = 1;
+    this->matches[0] = -1;
+    this->depths[0] = 0;
+    for (int64_t p = 0; p < count; p++)
+    {
+        int32_t state = 0;
+        for (int64_t i = 0; i < patterns[p].size; i++)
+        {
+            int32_t *slot = &this->transitions[(int64_t)state * classCount + this->classes[(unsigned char)patterns[p].data[i]]];
+            if (*slot == 0)
+            {
+                this->matches[stateCount] = -1;
+                this->depths[stateCount] = this->depths[state] + 1;
+                *slot = stateCount++;
+            }
+            state = *slot;
+        }
+        this->duplicates[p] = -1;
+        if (this->matches[state] < 0)
+        {
+            this->matches[state] = (int32_t)p;
+        }
+        else
+        {
+            this->duplicates[fail[state]] = (int32_t)p;
+        }
+        fail[state] = (int32_t)p;
+    }
+    this->stateCount = stateCount;
+
+    /* 按广度优先顺序计算失配链，并把缺失的转移补全为完整的自动机 */
+    int32_t *queue = fail + stateCount;
+    int32_t head = 0, tail = 0;
+    fail[0] = 0;
+    this->outputs[0] = 0;
+    for (int32_t c = 1; c < classCount; c++)
+    {
+        int32_t child = this->transitions[c];
+        if (child != 0)
+        {
+            fail[child] = 0;
+            this->outputs[child] = 0;
+            queue[tail++] = child;
+        }
+    }
+    while (head < tail)
+    {
+        int32_t state = queue[head++];
+        int32_t *row = &this->transitions[(int64_t)state * classCount];
+        const int32_t *failRow = &this->transitions[(int64_t)fail[state] * classCount];
+        for (int32_t c = 1; c < classCount; c++)
+        {
+            int32_t child = row[c];
+            if (child != 0)
+            {
+                fail[child] = failRow[c];
+                this->outputs[child] = this->matches[fail[child]] >= 0 ? fail[child] : this->outputs[fail[child]];
+                queue[tail++] = child;
+            }
+            else
+            {
+                row[c] = failRow[c];
+            }
+        }
+    }
+    w_free(fail);
 }
 
 /**
- * 将 char[] 的子序列追加到此序列
+ * 释放
  * @param this
- * @param value 要追加的字符串
- * @param offset 子序列的起始索引
- * @param len 子序列的长度
  * @return void
  */
-static inline void w_StringBuilder_appendSubChars(w_StringBuilder *this, char *value, int64_t offset, int64_t len)
+static inline void w_MultiStringSearcher_deinit(w_MultiStringSearcher *this)
 {
-    w_StringBuilder_insertSubChars(this, w_StringBuilder_size(this), value, offset, len);
+    w_check(this != NULL);
+    w_free(this->transitions);
+    w_free(this->matches);
+    this->transitions = NULL;
+    this->matches = NULL;
+    this->outputs = NULL;
+    this->depths = NULL;
+    this->duplicates = NULL;
 }
 
 /**
- * 将 char[] 追加到此序列
+ * 在文本中运行自动机，依次报告匹配（按结束位置排序，结束位置相同时从长到短，相同的模式串按索引从小到大）
  * @param this
- * @param value 要追加的字符串
- * @return void
+ * @param text 文本
+ * @param fromIndex 起始索引
+ * @param first 是否在第一个匹配后停止
+ * @param starts 起始索引（输出，最多写入 capacity 个，可以为 NULL）
+ * @param patternIndices 模式串索引（输出，最多写入 capacity 个，可以为 NULL）
+ * @param capacity 输出的容量
+ * @return int64_t 匹配的总次数
  */
-static inline void w_StringBuilder_appendChars(w_StringBuilder *this, char *value)
+static inline int64_t w_MultiStringSearcher_run_(w_MultiStringSearcher *this, w_StringView text, int64_t fromIndex, bool first, int64_t *starts, int64_t *patternIndices, int64_t capacity)
 {
-    w_StringBuilder_insertChars(this, w_StringBuilder_size(this), value);
+    const unsigned char *data = (const unsigned char *)text.data;
+    const int32_t *transitions = this->transitions;
+    int64_t classCount = this->classCount;
+    int64_t count = 0;
+    int32_t state = 0;
+    for (int64_t i = fromIndex; i < text.size; i++)
+    {
+        if (state == 0)
+        {
+            /* 在根状态跳过不可能开始匹配的字节 */
+            while (i < text.size && !this->starts[data[i]])
+            {
+                i++;
+            }
+            if (i == text.size)
+            {
+                break;
+            }
+        }
+        state = transitions[state * classCount + this->classes[data[i]]];
+        int32_t match = this->matches[state] >= 0 ? state : this->outputs[state];
+        while (match != 0)
+        {
+            for (int32_t p = this->matches[match]; p >= 0; p = this->duplicates[p])
+            {
+                if (count < capacity)
+                {
+                    if (starts != NULL)
+                    {
+                        starts[count] = i + 1 - this->depths[match];
+                    }
+                    if (patternIndices != NULL)
+                    {
+                        patternIndices[count] = p;
+                    }
+                }
+                count++;
+                if (first)
+                {
+                    return count;
+                }
+            }
+            match = this->outputs[match];
+        }
+    }
+    return count;
 }
 
 /**
- * 将 bool 追加到序列中
+ * 查找最先结束的匹配（结束位置相同时取最长的模式串，有相同的模式串时取索引最小的）
  * @param this
- * @param value 要追加的布尔值
- * @return void
+ * @param text 文本
+ * @param fromIndex 起始索引
+ * @param patternIndex 匹配的模式串索引（输出，可以为 NULL）
+ * @return int64_t 起始索引，未找到返回 -1
  */
-static inline void w_StringBuilder_appendBool(w_StringBuilder *this, bool value)
+static inline int64_t w_MultiStringSearcher_indexOf(w_MultiStringSearcher *this, w_StringView text, int64_t fromIndex, int64_t *patternIndex)
 {
-    w_StringBuilder_insertBool(this, w_StringBuilder_size(this), value);
+    w_check(this != NULL);
+    w_checkIndex(fromIndex >= 0);
+    int64_t start = -1;
+    if (w_MultiStringSearcher_run_(this, text, fromIndex, true, &start, patternIndex, 1) == 0 && patternIndex != NULL)
+    {
+        *patternIndex = -1;
+    }
+    return start;
 }
 
 /**
- * 将 double 加到此序列
+ * 查找所有模式串的所有出现位置（包括重叠的匹配）
  * @param this
- * @param value 要追加的 double 值
- * @return void
+ * @param text 文本
+ * @param starts 起始索引（输出，最多写入 capacity 个，可以为 NULL）
+ * @param patternIndices 模式串索引（输出，最多写入 capacity 个，可以为 NULL）
+ * @param capacity 输出的容量
+ * @return int64_t 匹配的总次数（可能大于 capacity）
  */
-static inline void w_StringBuilder_appendDouble(w_StringBuilder *this, double value)
+static inline int64_t w_MultiStringSearcher_findAll(w_MultiStringSearcher *this, w_StringView text, int64_t *starts, int64_t *patternIndices, int64_t capacity)
 {
-    w_StringBuilder_insertDouble(this, w_StringBuilder_size(this), value);
+    w_check(this != NULL);
+    w_check(capacity >= 0);
+    return w_MultiStringSearcher_run_(this, text, 0, false, starts, patternIndices, capacity);
 }
 
 /**
- * 将 float 追加到此序列
+ * 查找子串
  * @param this
- * @param value 要追加的 float 值
- * @return void
+ * @param fromIndex 起始索引
+ * @param value 要查找的字符串
+ * @return int64_t 起始索引，未找到返回 -1
  */
-static inline void w_StringBuilder_appendFloat(w_StringBuilder *this, float value)
+static inline int64_t w_StringBuilder_indexOfWithFromIndex(w_StringBuilder *this, int64_t fromIndex, const char *value)
 {
-    w_StringBuilder_insertFloat(this, w_StringBuilder_size(this), value);
+    w_check(this != NULL);
+    w_check(value != NULL);
+    w_checkIndex(fromIndex >= 0);
+    w_StringView text = w_StringBuilder_view(this);
+    int64_t size = strlen(value);
+    if (size > w_STRING_SEARCH_STACK_SIZE_)
+    {
+        w_StringSearcher searcher;
+        w_StringSearcher_init(&searcher, w_StringView_of(value, size));
+        int64_t index = w_StringSearcher_indexOf(&searcher, text, fromIndex);
+        w_StringSearcher_deinit(&searcher);
+        return index;
+    }
+    int64_t next[w_STRING_SEARCH_STACK_SIZE_];
+    w_kmpTable_(value, size, false, next);
+    return w_kmpIndexOf_(text.data, text.size, fromIndex, value, size, next, size > 0 ? w_rareByteIndex_(value, size) : 0);
 }
 
 /**
- * 将 long 追加到此序列
+ * 查找子串
  * @param this
- * @param value 要追加的 long 值
- * @return void
+ * @param value 要查找的子串
+ * @return int64_t 起始索引，未找到返回 -1
  */
-static inline void w_StringBuilder_appendLong(w_StringBuilder *this, int64_t value)
+static inline int64_t w_StringBuilder_indexOf(w_StringBuilder *this, const char *value)
 {
-    w_StringBuilder_insertLong(this, w_StringBuilder_size(this), value);
+    return w_StringBuilder_indexOfWithFromIndex(this, 0, value);
 }
 
 /**
- * 将 int 追加到此序列
+ * 从后向前查找子串
  * @param this
- * @param value 要追加的 int 值
- * @return void
+ * @param value 要查找的子串
+ * @return int64_t 最后一次出现的起始索引，未找到返回 -1
  */
-static inline void w_StringBuilder_appendInt(w_StringBuilder *this, int value)
+static inline int64_t w_StringBuilder_lastIndexOf(w_StringBuilder *this, const char *value)
 {
-    w_StringBuilder_insertInt(this, w_StringBuilder_size(this), value);
+    w_check(this != NULL);
+    w_check(value != NULL);
+    w_StringView text = w_StringBuilder_view(this);
+    int64_t size = strlen(value);
+    if (size > w_STRING_SEARCH_STACK_SIZE_)
+    {
+        w_StringSearcher searcher;
+        w_StringSearcher_init(&searcher, w_StringView_of(value, size));
+        int64_t index = w_StringSearcher_lastIndexOf(&searcher, text, text.size);
+        w_StringSearcher_deinit(&searcher);
+        return index;
+    }
+    int64_t next[w_STRING_SEARCH_STACK_SIZE_];
+    w_kmpTable_(value, size, true, next);
+    return w_kmpLastIndexOf_(text.data, text.size, text.size, value, size, next, size > 0 ? w_rareByteIndex_(value, size) : 0);
 }
 
+
+// ========================================================================================================================================================
+//  字符串池
+// ========================================================================================================================================================
+
+// 字符串池每块内存的大小（超过 1/4 的字符串单独申请一块）
+#define w_STRING_POOL_CHUNK_SIZE_ (64 * 1024)
+
+// 字符串池的初始槽数量（2 的幂）
+#define w_STRING_POOL_INITIAL_SLOTS_ 64
+
+// 字符串池的内存块（块头后紧跟数据）
+typedef struct w_StringPoolChunk_
+{
+    struct w_StringPoolChunk_ *next; /* 下一块 */
+} w_StringPoolChunk_;
+
+// 字符串池中的字符串
+typedef struct
+{
+    const char *data; /* 数据（在池中，以 '\0' 结尾） */
+    int64_t size;     /* 长度 */
+    int64_t hash;     /* 哈希值（w_hashBytes） */
+} w_StringPoolEntry_;
+
+// 字符串池（相同内容只保存一份，用 32 位句柄表示，句柄从 0 开始连续分配）
+typedef struct
+{
+    w_StringPoolChunk_ *chunks;  /* 内存块链表（当前块在最前） */
+    char *cursor;                /* 当前块的下一个空闲字节 */
+    int64_t remaining;           /* 当前块的剩余字节数 */
+    int64_t chunkBytes;          /* 所有内存块的字节数 */
+    w_StringPoolEntry_ *entries; /* 句柄 -> 字符串 */
+    int64_t size;                /* 字符串数量 */
+    int64_t capacity;            /* entries 的容量 */
+    uint64_t *slots;             /* 开放寻址的哈希表（高 32 位为哈希值的高位，低 32 位为句柄 + 1，0 表示空） */
+    int64_t slotCount;           /* 槽数量（2 的幂） */
+} w_StringPool;
+
 /**
- * 删除字符
+ * 初始化
  * @param this
- * @param index 要删除的字符的索引
  * @return void
  */
-static inline void w_StringBuilder_removeCharAt(w_StringBuilder *this, int64_t index)
+static inline void w_StringPool_init(w_StringPool *this)
 {
-    w_assert(this != NULL);
-    w_List_remove(w_StringBuilder_ValueType_)(&(this->list), index);
+    w_check(this != NULL);
+    this->chunks = NULL;
+    this->cursor = NULL;
+    this->remaining = 0;
+    this->chunkBytes = 0;
+    this->entries = NULL;
+    this->size = 0;
+    this->capacity = 0;
+    this->slots = w_malloc(sizeof(uint64_t) * w_STRING_POOL_INITIAL_SLOTS_);
+    w_assert(this->slots != NULL);
+    memset(this->slots, 0, sizeof(uint64_t) * w_STRING_POOL_INITIAL_SLOTS_);
+    this->slotCount = w_STRING_POOL_INITIAL_SLOTS_;
 }
 
 /**
- * 删除序列
+ * 释放（所有句柄和指针失效）
  * @param this
- * @param offset 要删除的子序列的起始索引
- * @param len 要删除的子序列的长度
  * @return void
  */
-static inline void w_StringBuilder_remove(w_StringBuilder *this, int64_t offset, int64_t len)
+static inline void w_StringPool_deinit(w_StringPool *this)
 {
-    w_assert(this != NULL);
-    for (int64_t i = 0; i < len; i++)
+    w_check(this != NULL);
+    while (this->chunks != NULL)
     {
-        w_StringBuilder_removeCharAt(this, offset);
+        w_StringPoolChunk_ *next = this->chunks->next;
+        w_free(this->chunks);
+        this->chunks = next;
     }
+    w_free(this->entries);
+    w_free(this->slots);
+    this->entries = NULL;
+    this->slots = NULL;
+    this->size = 0;
 }
 
 /**
- * 哈希函数
+ * 从内存块中分配（指针在池释放前保持不变）
  * @param this
- * @return int64_t
+ * @param size 字节数
+ * @return char*
  */
-static inline int64_t w_hash(w_StringBuilder)(w_StringBuilder *this)
+static inline char *w_StringPool_allocate_(w_StringPool *this, int64_t size)
 {
-    w_assert(this != NULL);
-    int64_t hash = 0;
-    int64_t size = w_StringBuilder_size(this);
-    for (int64_t i = 0; i < size; i++)
+    if (size > this->remaining)
     {
-        hash = hash * 31 + w_StringBuilder_charAt(this, i);
+        int64_t chunkSize = size > w_STRING_POOL_CHUNK_SIZE_ / 4 ? size : w_STRING_POOL_CHUNK_SIZE_;
+        w_StringPoolChunk_ *chunk = w_malloc(sizeof(w_StringPoolChunk_) + chunkSize);
+        w_assert(chunk != NULL);
+        this->chunkBytes += sizeof(w_StringPoolChunk_) + chunkSize;
+        if (chunkSize == size && this->chunks != NULL)
+        {
+            /* 大字符串单独一块，插在当前块后面，当前块继续使用 */
+            chunk->next = this->chunks->next;
+            this->chunks->next = chunk;
+            return (char *)(chunk + 1);
+        }
+        chunk->next = this->chunks;
+        this->chunks = chunk;
+        this->cursor = (char *)(chunk + 1);
+        this->remaining = chunkSize;
     }
-    return hash;
+    char *data = this->cursor;
+    this->cursor += size;
+    this->remaining -= size;
+    return data;
 }
 
 /**
- * 比较函数
+ * 查找字符串所在的槽
  * @param this
- * @param other
- * @return int64_t
+ * @param data 数据
+ * @param size 长度
+ * @param hash 哈希值
+ * @return int64_t 槽索引（槽为空表示不存在）
  */
-static inline int64_t w_compare(w_StringBuilder)(w_StringBuilder *this, w_StringBuilder *other)
+static inline int64_t w_StringPool_probe_(w_StringPool *this, const char *data, int64_t size, int64_t hash)
 {
-    w_assert(this != NULL);
-    w_assert(other != NULL);
-    int64_t i = 0;
-    while (true)
+    uint64_t tag = (uint64_t)hash >> 32;
+    int64_t mask = this->slotCount - 1;
+    for (int64_t index = hash & mask;; index = (index + 1) & mask)
     {
-        int64_t c1 = i < w_StringBuilder_size(this) ? w_StringBuilder_charAt(this, i) : '\0';
-        int64_t c2 = i < w_StringBuilder_size(other) ? w_StringBuilder_charAt(other, i) : '\0';
-        if (c1 > c2)
+        uint64_t slot = this->slots[index];
+        if (slot == 0)
         {
-            return 1;
+            return index;
         }
-        else if (c1 < c2)
+        if (slot >> 32 == tag)
         {
-            return -1;
+            const w_StringPoolEntry_ *entry = &this->entries[(uint32_t)slot - 1];
+            if (entry->size == size && (size == 0 || memcmp(entry->data, data, size) == 0))
+            {
+                return index;
+            }
         }
-        i++;
     }
-    return 0;
 }
 
 /**
- * 比较函数
+ * 哈希表扩容为两倍（负载超过 3/4 时）
  * @param this
- * @param other
- * @return bool
+ * @return void
  */
-static inline bool w_equals(w_StringBuilder)(w_StringBuilder *this, w_StringBuilder *other)
+static inline void w_StringPool_rehash_(w_StringPool *this)
 {
-    w_assert(this != NULL);
-    w_assert(other != NULL);
-    if (w_StringBuilder_size(this) != w_StringBuilder_size(other))
+    int64_t slotCount = this->slotCount * 2;
+    uint64_t *slots = w_malloc(sizeof(uint64_t) * slotCount);
+    w_assert(slots != NULL);
+    memset(slots, 0, sizeof(uint64_t) * slotCount);
+    for (int64_t i = 0; i < this->slotCount; i++)
     {
-        // 长度不同
-        return false;
+        uint64_t slot = this->slots[i];
+        if (slot != 0)
+        {
+            int64_t index = this->entries[(uint32_t)slot - 1].hash & (slotCount - 1);
+            while (slots[index] != 0)
+            {
+                index = (index + 1) & (slotCount - 1);
+            }
+            slots[index] = slot;
+        }
     }
-    return w_compare(w_StringBuilder)(this, other) == 0;
+    w_free(this->slots);
+    this->slots = slots;
+    this->slotCount = slotCount;
 }
 
 /**
- * 查找子串
+ * 查找字符串（不插入）
  * @param this
- * @param fromIndex 起始索引
- * @param value 要查找的字符串
- * @return int64_t 起始索引，未找到返回 -1
+ * @param data 数据
+ * @param size 长度
+ * @return int64_t 句柄，不存在返回 -1
  */
-static inline int64_t w_StringBuilder_indexOfWithFromIndex(w_StringBuilder *this, int64_t fromIndex, const char *value)
+static inline int64_t w_StringPool_find(w_StringPool *this, const char *data, int64_t size)
+{
+    w_check(this != NULL);
+    w_check(data != NULL || size == 0);
+    w_check(size >= 0);
+    uint64_t slot = this->slots[w_StringPool_probe_(this, data, size, w_hashBytes(data, size))];
+    return slot != 0 ? (int64_t)(uint32_t)slot - 1 : -1;
+}
+
+/**
+ * 将字符串放入池中（内容相同的字符串返回相同的句柄）
+ * @param this
+ * @param data 数据（会被复制，可以包含 '\0'）
+ * @param size 长度
+ * @return uint32_t 句柄
+ */
+static inline uint32_t w_StringPool_intern(w_StringPool *this, const char *data, int64_t size)
 {
-    // 字符串长度
-    int64_t thisLen = w_StringBuilder_size(this);
-    int64_t valueLen = strlen(value);
-    // 构建 next 数组
-    int64_t *next = w_malloc(sizeof(int64_t) * valueLen);
-    next[0] = -1;
-    int i = -1, j = 1;
-    while (j < valueLen - 1)
+    w_check(this != NULL);
+    w_check(data != NULL || size == 0);
+    w_check(size >= 0);
+    int64_t hash = w_hashBytes(data, size);
+    int64_t index = w_StringPool_probe_(this, data, size, hash);
+    if (this->slots[index] != 0)
     {
-        if (i == -1 || value[i] == value[j])
-        {
-            i++;
-            j++;
-            next[j] = i;
-        }
-        else
-        {
-            i = next[i];
-        }
+        return (uint32_t)this->slots[index] - 1;
     }
-    // KMP 算法核心
-    i = fromIndex;
-    j = 0;
-    while (i < thisLen && j < valueLen)
+    w_assert(this->size < UINT32_MAX - 1);
+    if (this->size == this->capacity)
     {
-        if (j == -1 || w_StringBuilder_charAt(this, i) == value[j])
+        int64_t capacity = this->capacity > 0 ? this->capacity * 2 : 16;
+        w_StringPoolEntry_ *entries = w_malloc(sizeof(w_StringPoolEntry_) * capacity);
+        w_assert(entries != NULL);
+        if (this->size > 0)
         {
-            i++;
-            j++;
-        }
-        else
-        {
-            j = next[j];
+            memcpy(entries, this->entries, sizeof(w_StringPoolEntry_) * this->size);
         }
+        w_free(this->entries);
+        this->entries = entries;
+        this->capacity = capacity;
     }
-    // 返回
-    int64_t ret;
-    if (j >= valueLen)
+    char *copy = w_StringPool_allocate_(this, size + 1);
+    if (size > 0)
     {
-        ret = i - valueLen;
+        memcpy(copy, data, size);
     }
-    else
+    copy[size] = '\0';
+    uint32_t handle = (uint32_t)this->size++;
+    w_StringPoolEntry_ entry = {copy, size, hash};
+    this->entries[handle] = entry;
+    this->slots[index] = ((uint64_t)hash & UINT64_C(0xFFFFFFFF00000000)) | ((uint64_t)handle + 1);
+    if (this->size * 4 > this->slotCount * 3)
     {
-        ret = -1;
+        w_StringPool_rehash_(this);
     }
-    w_free(next);
-    return ret;
+    return handle;
 }
 
 /**
- * 查找子串
+ * 将 C 字符串放入池中
  * @param this
- * @param value 要查找的子串
- * @return int64_t 起始索引，未找到返回 -1
+ * @param str C 字符串
+ * @return uint32_t 句柄
  */
-static inline int64_t w_StringBuilder_indexOf(w_StringBuilder *this, const char *value)
+static inline uint32_t w_StringPool_internChars(w_StringPool *this, const char *str)
 {
-    return w_StringBuilder_indexOfWithFromIndex(this, 0, value);
+    w_check(str != NULL);
+    return w_StringPool_intern(this, str, strlen(str));
+}
+
+/**
+ * 获取池中的规范指针（内容相同的字符串返回相同的指针，可以直接比较指针）
+ * @param this
+ * @param data 数据
+ * @param size 长度
+ * @return const char* 以 '\0' 结尾，池释放前保持有效
+ */
+static inline const char *w_StringPool_canonical(w_StringPool *this, const char *data, int64_t size)
+{
+    w_check(this != NULL);
+    return this->entries[w_StringPool_intern(this, data, size)].data;
+}
+
+/**
+ * 获取句柄对应的字符串
+ * @param this
+ * @param handle 句柄
+ * @return const char* 以 '\0' 结尾，池释放前保持有效
+ */
+static inline const char *w_StringPool_data(w_StringPool *this, uint32_t handle)
+{
+    w_check(this != NULL);
+    w_checkIndex(handle < this->size);
+    return this->entries[handle].data;
+}
+
+/**
+ * 获取句柄对应的字符串长度
+ * @param this
+ * @param handle 句柄
+ * @return int64_t
+ */
+static inline int64_t w_StringPool_length(w_StringPool *this, uint32_t handle)
+{
+    w_check(this != NULL);
+    w_checkIndex(handle < this->size);
+    return this->entries[handle].size;
+}
+
+/**
+ * 获取句柄对应的字符串视图
+ * @param this
+ * @param handle 句柄
+ * @return w_StringView
+ */
+static inline w_StringView w_StringPool_view(w_StringPool *this, uint32_t handle)
+{
+    w_check(this != NULL);
+    w_checkIndex(handle < this->size);
+    return w_StringView_of(this->entries[handle].data, this->entries[handle].size);
+}
+
+/**
+ * 获取句柄对应的哈希值（与 w_hash(w_StringView) 相同，不需要重新计算）
+ * @param this
+ * @param handle 句柄
+ * @return int64_t
+ */
+static inline int64_t w_StringPool_hash(w_StringPool *this, uint32_t handle)
+{
+    w_check(this != NULL);
+    w_checkIndex(handle < this->size);
+    return this->entries[handle].hash;
+}
+
+/**
+ * 获取字符串数量（有效句柄为 [0, size)）
+ * @param this
+ * @return int64_t
+ */
+static inline int64_t w_StringPool_size(w_StringPool *this)
+{
+    w_check(this != NULL);
+    return this->size;
+}
+
+/**
+ * 获取占用的内存（字节）
+ * @param this
+ * @return int64_t
+ */
+static inline int64_t w_StringPool_memoryUsage(w_StringPool *this)
+{
+    w_check(this != NULL);
+    return (int64_t)sizeof(w_StringPool) + this->chunkBytes + (int64_t)sizeof(w_StringPoolEntry_) * this->capacity + (int64_t)sizeof(uint64_t) * this->slotCount;
 }
 
 #endif
\ No newline at end of file